@@ -24,6 +24,12 @@ NEUROUNZIP_BIN = r"C:\Users\admin\python\neurozip\build\src\cli\neurounzip.exe"
 # It must point to the exported tiny_lstm.bin model.
 MODEL_PATH = r"C:\Users\admin\python\neurozip\tiny_lstm.bin"
 
+# Primed state of the model to compress from (0 = cold start). Short
+# messages code better from a state primed on typical text; make one with
+# `neurozip -m tiny_lstm.bin --prime-model primed.bin sample.txt` and point
+# MODEL_PATH at primed.bin. neurounzip reads the id from each frame.
+PRIMED_STATE = int(os.environ.get("NEUROZIP_PRIMED_STATE", "0"))
+
 # Ensure model exists
 if not os.path.exists(MODEL_PATH):
     print("WARNING: MODEL FILE NOT FOUND:", MODEL_PATH)
@@ -93,13 +99,18 @@ def compress(req: CompressRequest):
     with tempfile.NamedTemporaryFile(delete=False) as tmp_out:
         output_path = tmp_out.name
 
-    # Run the neurozip CLI
+    # Run the neurozip CLI. Messages here are short, so use a compact frame
+    # (a few bytes of framing instead of the 48-byte .nzp header);
+    # neurounzip recognizes both formats.
     cmd = [
         NEUROZIP_BIN,
         "-m", MODEL_PATH,
+        "--compact",
         "-o", output_path,
         input_path
     ]
+    if PRIMED_STATE:
+        cmd[3:3] = ["--primed", str(PRIMED_STATE)]
 
     code, out, err = run_cmd(cmd)
 
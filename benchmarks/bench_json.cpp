@@ -0,0 +1,206 @@
+#include "bench_json.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+namespace neurozip {
+namespace bench {
+
+const JsonValue* JsonValue::get(const std::string& key) const
+{
+    if (type != Type::Object) return nullptr;
+    for (const auto& kv : object) {
+        if (kv.first == key) return &kv.second;
+    }
+    return nullptr;
+}
+
+namespace {
+
+class Parser {
+public:
+    explicit Parser(const std::string& text) : s_(text) {}
+
+    bool parse(JsonValue& out, std::string* error)
+    {
+        bool ok = value(out);
+        skip_ws();
+        if (ok && pos_ != s_.size()) ok = fail("trailing characters");
+        if (!ok && error) *error = error_ + " at offset " + std::to_string(pos_);
+        return ok;
+    }
+
+private:
+    const std::string& s_;
+    size_t pos_ = 0;
+    std::string error_;
+
+    bool fail(const char* msg)
+    {
+        if (error_.empty()) error_ = msg;
+        return false;
+    }
+
+    void skip_ws()
+    {
+        while (pos_ < s_.size() && std::isspace((unsigned char)s_[pos_])) ++pos_;
+    }
+
+    bool literal(const char* word)
+    {
+        size_t n = std::char_traits<char>::length(word);
+        if (s_.compare(pos_, n, word) != 0) return fail("invalid literal");
+        pos_ += n;
+        return true;
+    }
+
+    bool value(JsonValue& out)
+    {
+        skip_ws();
+        if (pos_ >= s_.size()) return fail("unexpected end of input");
+
+        char c = s_[pos_];
+        if (c == '{') return object(out);
+        if (c == '[') return array(out);
+        if (c == '"') {
+            out.type = JsonValue::Type::String;
+            return string(out.string);
+        }
+        if (c == 't' || c == 'f') {
+            out.type = JsonValue::Type::Bool;
+            out.boolean = (c == 't');
+            return literal(c == 't' ? "true" : "false");
+        }
+        if (c == 'n') {
+            out.type = JsonValue::Type::Null;
+            return literal("null");
+        }
+        return number(out);
+    }
+
+    bool number(JsonValue& out)
+    {
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        double v = std::strtod(begin, &end);
+        if (end == begin) return fail("invalid value");
+        pos_ += (size_t)(end - begin);
+        out.type = JsonValue::Type::Number;
+        out.number = v;
+        return true;
+    }
+
+    bool string(std::string& out)
+    {
+        ++pos_; // opening quote
+        out.clear();
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) break;
+            char e = s_[pos_++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (pos_ + 4 > s_.size()) return fail("bad escape");
+                    unsigned cp = (unsigned)std::strtoul(s_.substr(pos_, 4).c_str(), nullptr, 16);
+                    pos_ += 4;
+                    // Result files only contain ASCII; keep anything else as '?'.
+                    out += cp < 0x80 ? (char)cp : '?';
+                    break;
+                }
+                default: out += e; break;
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool array(JsonValue& out)
+    {
+        ++pos_;
+        out.type = JsonValue::Type::Array;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == ']') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            out.array.emplace_back();
+            if (!value(out.array.back())) return false;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == ',') { ++pos_; continue; }
+            if (pos_ < s_.size() && s_[pos_] == ']') { ++pos_; return true; }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool object(JsonValue& out)
+    {
+        ++pos_;
+        out.type = JsonValue::Type::Object;
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '}') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_] != '"') return fail("expected key");
+            std::string key;
+            if (!string(key)) return false;
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_] != ':') return fail("expected ':'");
+            ++pos_;
+            out.object.emplace_back(std::move(key), JsonValue());
+            if (!value(out.object.back().second)) return false;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == ',') { ++pos_; continue; }
+            if (pos_ < s_.size() && s_[pos_] == '}') { ++pos_; return true; }
+            return fail("expected ',' or '}'");
+        }
+    }
+};
+
+} // namespace
+
+bool parse_json(const std::string& text, JsonValue& out, std::string* error)
+{
+    out = JsonValue();
+    return Parser(text).parse(out, error);
+}
+
+std::string json_quote(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace bench
+} // namespace neurozip
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace neurozip {
+namespace bench {
+
+/// Just enough JSON to read back the benchmark's own result files
+/// (objects, arrays, numbers, strings, true/false/null).
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    /// Member lookup; nullptr if this is not an object or the key is absent.
+    const JsonValue* get(const std::string& key) const;
+
+    double number_or(double fallback) const { return type == Type::Number ? number : fallback; }
+};
+
+/// Parse a JSON document. Returns false (and sets error) on malformed input.
+bool parse_json(const std::string& text, JsonValue& out, std::string* error = nullptr);
+
+/// Quote and escape a string for JSON output.
+std::string json_quote(const std::string& s);
+
+} // namespace bench
+} // namespace neurozip
@@ -0,0 +1,572 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "../src/api/neurozip_cpp.h"
+#include "../src/core/file_format.h"
+#include "../src/core/numa.h"
+#include "bench_json.h"
+
+namespace fs = std::filesystem;
+using neurozip::bench::JsonValue;
+
+static void print_usage() {
+    std::cout << "Usage: neurozip-benchmark [options] -m <model.bin> <dir|file>...\n"
+              << "Options:\n"
+              << "  -m <model.bin>        Tiny LSTM model file\n"
+              << "  -r <n>                Timed runs per configuration (default 5)\n"
+              << "  --warmup <n>          Untimed runs first (default 1)\n"
+              << "  --threads <list>      Comma-separated thread counts (default 1);\n"
+              << "                        n > 1 uses two-phase encoding\n"
+              << "  --pipeline            Also time one-stream pipelined encoding (model\n"
+              << "                        and range coder on two threads), row '1p'\n"
+              << "  --max-bytes <n>       Only use the first n bytes of each file\n"
+              << "  --fixed-point         Deterministic fixed-point inference\n"
+              << "  --no-numa             Do not pin threads or replicate weights per\n"
+              << "                        NUMA node (compare against the default)\n"
+              << "  --json <file>         Write results as JSON\n"
+              << "  --baseline <file>     Compare against a previous --json result;\n"
+              << "                        exit code 2 on regression\n"
+              << "  --speed-tolerance <f> Allowed MB/s drop vs baseline (default 0.10)\n"
+              << "  --bpb-tolerance <f>   Allowed relative bpb growth (default 0.005)\n"
+              << "Directories are scanned for regular files; *.nzp* outputs are skipped.\n";
+}
+
+struct Dataset {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+// Mean with a two-sided 95% confidence half-width (Student's t).
+struct Summary {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double ci95 = 0.0;
+};
+
+struct ThreadResult {
+    unsigned threads = 1;
+    bool pipelined = false;
+    Summary compressMBps;
+    Summary decompressMBps;
+};
+
+struct DatasetResult {
+    std::string name;
+    uint64_t bytes = 0;
+    uint64_t compressedBytes = 0;
+    double bpb = 0.0;
+    uint64_t peakRssKb = 0;
+    std::vector<ThreadResult> threads;
+};
+
+static double t_critical_95(size_t df)
+{
+    static const double table[] = {
+        0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df == 0) return 0.0;
+    if (df < sizeof(table) / sizeof(table[0])) return table[df];
+    return 1.960;
+}
+
+static Summary summarize(const std::vector<double>& samples)
+{
+    Summary s;
+    if (samples.empty()) return s;
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    s.mean = sum / (double)samples.size();
+    if (samples.size() > 1) {
+        double sq = 0.0;
+        for (double v : samples) sq += (v - s.mean) * (v - s.mean);
+        s.stddev = std::sqrt(sq / (double)(samples.size() - 1));
+        s.ci95 = t_critical_95(samples.size() - 1) * s.stddev / std::sqrt((double)samples.size());
+    }
+    return s;
+}
+
+/// Restart the peak RSS measurement, so peak_rss_kb() covers one dataset.
+/// Only Linux can reset the high-water mark (VmHWM, via clear_refs);
+/// elsewhere, or if that fails, peak_rss_kb() stays the process peak and
+/// this returns false.
+static bool reset_peak_rss()
+{
+#if defined(__linux__)
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    clear.flush();
+    return (bool)clear;
+#else
+    return false;
+#endif
+}
+
+/// Peak resident set size since reset_peak_rss (or of the whole process),
+/// in KiB (0 if unknown).
+static uint64_t peak_rss_kb()
+{
+#if defined(__linux__)
+    // ru_maxrss is never reset; VmHWM is.
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10);
+    }
+#endif
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return (uint64_t)pmc.PeakWorkingSetSize / 1024;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (uint64_t)usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return (uint64_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+static bool read_file(const fs::path& path, size_t maxBytes, std::vector<uint8_t>& out)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    out.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if (maxBytes && out.size() > maxBytes) out.resize(maxBytes);
+    return true;
+}
+
+static bool collect_datasets(
+    const std::vector<std::string>& inputs,
+    size_t maxBytes,
+    std::vector<Dataset>& out
+) {
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        std::vector<fs::path> files;
+        if (fs::is_directory(input, ec)) {
+            for (const auto& entry : fs::directory_iterator(input, ec)) {
+                if (!entry.is_regular_file()) continue;
+                std::string name = entry.path().filename().string();
+                if (name.find(".nzp") != std::string::npos) continue;
+                files.push_back(entry.path());
+            }
+            std::sort(files.begin(), files.end());
+        } else if (fs::is_regular_file(input, ec)) {
+            files.push_back(input);
+        } else {
+            std::cerr << "No such file or directory: " << input << "\n";
+            return false;
+        }
+
+        for (const auto& path : files) {
+            Dataset ds;
+            ds.name = path.filename().string();
+            if (!read_file(path, maxBytes, ds.data)) {
+                std::cerr << "Cannot read " << path.string() << "\n";
+                return false;
+            }
+            out.push_back(std::move(ds));
+        }
+    }
+    return true;
+}
+
+static bool parse_thread_list(const std::string& list, std::vector<unsigned>& out)
+{
+    out.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) return false;
+        out.push_back((unsigned)std::stoul(item));
+    }
+    return !out.empty();
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static double mbps(size_t bytes, double seconds)
+{
+    return seconds > 0.0 ? (double)bytes / 1e6 / seconds : 0.0;
+}
+
+/// Time compression and decompression of one dataset at one thread count.
+/// Returns false if the output does not round-trip.
+static bool run_config(
+    const Dataset& ds,
+    const neurozip::Model& model,
+    unsigned threads,
+    bool pipelined,
+    bool numaAware,
+    unsigned warmup,
+    unsigned runs,
+    ThreadResult& result,
+    std::vector<uint8_t>& compressed
+) {
+    nzp_compress_options_t options;
+    nzp_compress_options_init(&options);
+    if (threads != 1) {
+        options.two_phase = 1;
+        options.threads = threads;
+    }
+    options.numa_aware = numaAware ? 1 : 0;
+    options.pipelined = pipelined ? 1 : 0;
+
+    std::vector<double> comp, decomp;
+    std::vector<uint8_t> restored;
+    for (unsigned i = 0; i < warmup + runs; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (neurozip::compress_memory(ds.data, compressed, model, &options) != NZP_OK) return false;
+        double tc = seconds_since(t0);
+
+        t0 = std::chrono::steady_clock::now();
+        if (neurozip::decompress_memory(compressed, restored, model) != NZP_OK) return false;
+        double td = seconds_since(t0);
+
+        if (restored != ds.data) return false;
+        if (i >= warmup) {
+            comp.push_back(mbps(ds.data.size(), tc));
+            decomp.push_back(mbps(ds.data.size(), td));
+        }
+    }
+
+    result.threads = threads;
+    result.pipelined = pipelined;
+    result.compressMBps = summarize(comp);
+    result.decompressMBps = summarize(decomp);
+    return true;
+}
+
+static void write_summary(std::ostream& os, const Summary& s)
+{
+    os << "{\"mean\": " << s.mean << ", \"stddev\": " << s.stddev << ", \"ci95\": " << s.ci95 << "}";
+}
+
+static bool write_json(
+    const std::string& path,
+    const std::string& modelPath,
+    uint64_t modelHash,
+    bool fixedPoint,
+    bool numaAware,
+    bool rssPerDataset,
+    unsigned runs,
+    const std::vector<DatasetResult>& results
+) {
+    std::ofstream os(path);
+    if (!os) return false;
+
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "0x%016llx", (unsigned long long)modelHash);
+
+    os.precision(6);
+    os << "{\n"
+       << "  \"model\": " << neurozip::bench::json_quote(modelPath) << ",\n"
+       << "  \"model_hash\": \"" << hash << "\",\n"
+       << "  \"fixed_point\": " << (fixedPoint ? "true" : "false") << ",\n"
+       << "  \"numa_aware\": " << (numaAware ? "true" : "false") << ",\n"
+       << "  \"numa_nodes\": " << neurozip::numa_topology().node_count() << ",\n"
+       << "  \"runs\": " << runs << ",\n"
+       << "  \"peak_rss_scope\": \"" << (rssPerDataset ? "dataset" : "process") << "\",\n"
+       << "  \"datasets\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        os << (i ? ",\n" : "\n")
+           << "    {\n"
+           << "      \"name\": " << neurozip::bench::json_quote(r.name) << ",\n"
+           << "      \"bytes\": " << r.bytes << ",\n"
+           << "      \"compressed_bytes\": " << r.compressedBytes << ",\n"
+           << "      \"bpb\": " << r.bpb << ",\n"
+           << "      \"peak_rss_kb\": " << r.peakRssKb << ",\n"
+           << "      \"threads\": [";
+        for (size_t j = 0; j < r.threads.size(); ++j) {
+            const auto& t = r.threads[j];
+            os << (j ? ",\n" : "\n")
+               << "        {\"threads\": " << t.threads
+               << ", \"pipelined\": " << (t.pipelined ? "true" : "false") << ", \"compress_mbps\": ";
+            write_summary(os, t.compressMBps);
+            os << ", \"decompress_mbps\": ";
+            write_summary(os, t.decompressMBps);
+            os << "}";
+        }
+        os << "\n      ]\n    }";
+    }
+    os << "\n  ]\n}\n";
+    return (bool)os;
+}
+
+/// Compare results against a baseline file. Returns the number of
+/// regressions, or -1 if the baseline cannot be used.
+static int compare_baseline(
+    const std::string& path,
+    uint64_t modelHash,
+    bool fixedPoint,
+    double speedTolerance,
+    double bpbTolerance,
+    const std::vector<DatasetResult>& results
+) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        std::cerr << "Cannot read baseline " << path << "\n";
+        return -1;
+    }
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    JsonValue base;
+    std::string error;
+    if (!neurozip::bench::parse_json(text, base, &error)) {
+        std::cerr << "Invalid baseline " << path << ": " << error << "\n";
+        return -1;
+    }
+
+    // Ratios are only comparable for the same model and inference mode.
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "0x%016llx", (unsigned long long)modelHash);
+    const JsonValue* baseHash = base.get("model_hash");
+    const JsonValue* baseFixed = base.get("fixed_point");
+    if (!baseHash || baseHash->string != hash ||
+        (baseFixed && baseFixed->boolean != fixedPoint)) {
+        std::cerr << "Baseline " << path << " was recorded with a different model or mode\n";
+        return -1;
+    }
+
+    const JsonValue* datasets = base.get("datasets");
+    if (!datasets || datasets->type != JsonValue::Type::Array) {
+        std::cerr << "Baseline " << path << " has no datasets\n";
+        return -1;
+    }
+
+    int regressions = 0;
+    std::cout << "\nBaseline: " << path << "\n";
+    for (const auto& r : results) {
+        const JsonValue* b = nullptr;
+        for (const auto& d : datasets->array) {
+            const JsonValue* name = d.get("name");
+            if (name && name->string == r.name) { b = &d; break; }
+        }
+        if (!b) {
+            std::cout << "  " << r.name << ": not in baseline, skipped\n";
+            continue;
+        }
+
+        const JsonValue* bpbValue = b->get("bpb");
+        double baseBpb = bpbValue ? bpbValue->number_or(0.0) : 0.0;
+        if (baseBpb > 0.0 && r.bpb > baseBpb * (1.0 + bpbTolerance)) {
+            std::printf("  REGRESSION %s: bpb %.4f > baseline %.4f\n", r.name.c_str(), r.bpb, baseBpb);
+            ++regressions;
+        }
+
+        const JsonValue* baseThreads = b->get("threads");
+        if (!baseThreads) continue;
+        for (const auto& t : r.threads) {
+            for (const auto& bt : baseThreads->array) {
+                const JsonValue* n = bt.get("threads");
+                if (!n || (unsigned)n->number_or(-1) != t.threads) continue;
+                const JsonValue* p = bt.get("pipelined");
+                if ((p && p->boolean) != t.pipelined) continue;
+
+                auto check = [&](const char* what, const char* key, const Summary& cur) {
+                    const JsonValue* s = bt.get(key);
+                    const JsonValue* mean = s ? s->get("mean") : nullptr;
+                    double baseMean = mean ? mean->number_or(0.0) : 0.0;
+                    if (baseMean > 0.0 && cur.mean < baseMean * (1.0 - speedTolerance)) {
+                        std::printf("  REGRESSION %s (%u threads%s): %s %.3f MB/s < baseline %.3f MB/s\n",
+                                    r.name.c_str(), t.threads, t.pipelined ? ", pipelined" : "",
+                                    what, cur.mean, baseMean);
+                        ++regressions;
+                    }
+                };
+                check("compress", "compress_mbps", t.compressMBps);
+                check("decompress", "decompress_mbps", t.decompressMBps);
+            }
+        }
+    }
+    std::cout << "  " << (regressions ? std::to_string(regressions) + " regression(s)" : "no regressions")
+              << "\n";
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    std::string modelPath;
+    std::string jsonPath;
+    std::string baselinePath;
+    std::vector<std::string> inputs;
+    std::vector<unsigned> threadCounts = {1};
+    unsigned runs = 5;
+    unsigned warmup = 1;
+    size_t maxBytes = 0;
+    bool fixedPoint = false;
+    bool numaAware = true;
+    bool pipeline = false;
+    double speedTolerance = 0.10;
+    double bpbTolerance = 0.005;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "-m" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (a == "-r" && i + 1 < argc) {
+            runs = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--warmup" && i + 1 < argc) {
+            warmup = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--threads" && i + 1 < argc) {
+            if (!parse_thread_list(argv[++i], threadCounts)) {
+                print_usage();
+                return 1;
+            }
+        } else if (a == "--pipeline") {
+            pipeline = true;
+        } else if (a == "--max-bytes" && i + 1 < argc) {
+            maxBytes = (size_t)std::stoull(argv[++i]);
+        } else if (a == "--fixed-point") {
+            fixedPoint = true;
+        } else if (a == "--no-numa") {
+            numaAware = false;
+        } else if (a == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (a == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (a == "--speed-tolerance" && i + 1 < argc) {
+            speedTolerance = std::stod(argv[++i]);
+        } else if (a == "--bpb-tolerance" && i + 1 < argc) {
+            bpbTolerance = std::stod(argv[++i]);
+        } else if (a[0] == '-') {
+            print_usage();
+            return 1;
+        } else {
+            inputs.push_back(a);
+        }
+    }
+
+    if (modelPath.empty() || inputs.empty() || runs == 0) {
+        print_usage();
+        return 1;
+    }
+
+    neurozip::Model model(modelPath);
+    if (!model.valid()) {
+        std::cerr << "Failed to load model: " << modelPath << "\n";
+        return 1;
+    }
+    model.set_fixed_point(fixedPoint);
+
+    std::vector<Dataset> datasets;
+    if (!collect_datasets(inputs, maxBytes, datasets)) return 1;
+    if (datasets.empty()) {
+        std::cerr << "No datasets found\n";
+        return 1;
+    }
+
+    std::printf("NUMA nodes: %zu (%s)\n\n", neurozip::numa_topology().node_count(),
+                numaAware ? "pinned, per-node weights" : "off");
+    std::printf("%-24s %10s %8s %4s %22s %22s %10s\n",
+                "dataset", "bytes", "bpb", "thr", "compress MB/s", "decompress MB/s", "peak KiB");
+
+    uint64_t modelHash = 0;
+    bool rssPerDataset = true;
+    std::vector<DatasetResult> results;
+    for (const auto& ds : datasets) {
+        rssPerDataset = reset_peak_rss() && rssPerDataset;
+        DatasetResult r;
+        r.name = ds.name;
+        r.bytes = ds.data.size();
+
+        // Thread counts, then the single-stream pipeline if requested.
+        std::vector<std::pair<unsigned, bool>> configs;
+        for (unsigned threads : threadCounts) configs.push_back({ threads, false });
+        if (pipeline) configs.push_back({ 1u, true });
+
+        for (const auto& config : configs) {
+            const unsigned threads = config.first;
+            ThreadResult tr;
+            std::vector<uint8_t> compressed;
+            if (!run_config(ds, model, threads, config.second, numaAware, warmup, runs, tr, compressed)) {
+                std::cerr << "Round trip failed: " << ds.name << " (" << threads << " threads)\n";
+                return 1;
+            }
+
+            // Every thread count must produce the same stream.
+            if (r.threads.empty()) {
+                r.compressedBytes = compressed.size();
+                r.bpb = r.bytes ? 8.0 * (double)compressed.size() / (double)r.bytes : 0.0;
+                neurozip::FileHeader header;
+                std::memcpy(&header, compressed.data(), sizeof(header));
+                modelHash = header.modelHash;
+            } else if (compressed.size() != r.compressedBytes) {
+                std::cerr << "Output differs across thread counts: " << ds.name << "\n";
+                return 1;
+            }
+            r.threads.push_back(tr);
+        }
+        r.peakRssKb = peak_rss_kb();
+
+        const ThreadResult* serial = nullptr;
+        for (size_t j = 0; j < r.threads.size(); ++j) {
+            const auto& t = r.threads[j];
+            if (t.threads == 1 && !t.pipelined) serial = &t;
+            char thr[16], comp[32], decomp[32];
+            std::snprintf(thr, sizeof(thr), t.pipelined ? "%up" : "%u", t.threads);
+            std::snprintf(comp, sizeof(comp), "%.3f +- %.3f", t.compressMBps.mean, t.compressMBps.ci95);
+            std::snprintf(decomp, sizeof(decomp), "%.3f +- %.3f", t.decompressMBps.mean, t.decompressMBps.ci95);
+            if (j == 0) {
+                std::printf("%-24s %10llu %8.4f %4s %22s %22s %10llu\n",
+                            r.name.c_str(), (unsigned long long)r.bytes, r.bpb, thr,
+                            comp, decomp, (unsigned long long)r.peakRssKb);
+            } else {
+                std::printf("%-24s %10s %8s %4s %22s %22s %10s\n", "", "", "", thr, comp, decomp, "");
+            }
+            // Pipelining overlaps range coding with inference; the speedup
+            // over the serial loop is the share of coding time hidden.
+            if (t.pipelined && serial && serial->compressMBps.mean > 0.0) {
+                std::printf("%-24s %10s %8s %4s %16.2fx vs 1\n", "", "", "", "",
+                            t.compressMBps.mean / serial->compressMBps.mean);
+            }
+        }
+        results.push_back(std::move(r));
+    }
+    if (!rssPerDataset) {
+        std::printf("\npeak KiB is the peak of the whole process so far, not per dataset\n");
+    }
+
+    if (!jsonPath.empty()) {
+        if (!write_json(jsonPath, modelPath, modelHash, fixedPoint, numaAware, rssPerDataset, runs, results)) {
+            std::cerr << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+    }
+
+    if (!baselinePath.empty()) {
+        int regressions = compare_baseline(baselinePath, modelHash, fixedPoint,
+                                           speedTolerance, bpbTolerance, results);
+        if (regressions < 0) return 1;
+        if (regressions > 0) return 2;
+    }
+
+    return 0;
+}
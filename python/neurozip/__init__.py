@@ -4,5 +4,6 @@ __all__ = [
     "tokenize",
     "model",
     "export",
+    "prune",
     "evaluate",
 ]
@@ -3,18 +3,25 @@ import torch.nn.functional as F
 from torch.utils.data import DataLoader
 
 from .dataset import ByteDataset
-from .model import TinyLSTM
-from .nz_tokenize import file_to_bytes
+from .model import build_model, nibble_cross_entropy
+from .nz_tokenize import file_to_bytes, tokenize
 
 def evaluate(checkpoint_path: str, data_path: str, seq_len: int = 256):
     ckpt = torch.load(checkpoint_path, map_location="cpu")
     hidden_size = ckpt["hidden_size"]
+    output_head = ckpt.get("output_head", "byte")
 
-    model = TinyLSTM(hidden_size=hidden_size)
+    vocab = ckpt.get("vocab", [])
+    symbols = 256 + len(vocab)
+    model = build_model(output_head, hidden_size=hidden_size, cell=ckpt.get("cell", "lstm"),
+                        vocab_size=symbols if vocab else 0)
     model.load_state_dict(ckpt["model_state"])
     model.eval()
 
     data = file_to_bytes(data_path)
+    size = len(data)
+    if vocab:
+        data = tokenize(data, vocab)
     dataset = ByteDataset(data, seq_len)
     loader = DataLoader(dataset, batch_size=1)
 
@@ -23,10 +30,15 @@ def evaluate(checkpoint_path: str, data_path: str, seq_len: int = 256):
 
     with torch.no_grad():
         for x, y in loader:
-            logits, _ = model(x)
-            loss = F.cross_entropy(logits.reshape(-1, 256), y.reshape(-1), reduction="sum")
+            if output_head == "nibble":
+                hi_logits, lo_logits, _ = model(x)
+                loss = nibble_cross_entropy(hi_logits, lo_logits, y, reduction="sum")
+            else:
+                logits, _ = model(x)
+                loss = F.cross_entropy(logits.reshape(-1, symbols), y.reshape(-1), reduction="sum")
             total_logloss += loss.item()
             total_tokens += y.numel()
 
-    bpb = total_logloss / total_tokens / torch.log(torch.tensor(2.0))
+    # Token models: scale the per-step loss by steps per byte.
+    bpb = total_logloss / total_tokens * (len(data) / size) / torch.log(torch.tensor(2.0))
     print(f"Bits per byte: {bpb:.4f}")
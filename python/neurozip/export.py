@@ -1,29 +1,162 @@
 import torch
 import struct
 
+LSTM_SPARSE_HH = 1 << 8
+LSTM_SPARSE_OUT = 1 << 9
+
+
+def write_block_sparse(f, weight: torch.Tensor, block: int):
+    """
+    Write a [rows, cols] matrix in the block-sparse layout read by
+    read_block_sparse(): all-zero tiles are dropped.
+    """
+    rows, cols = weight.shape
+    tiles = weight.reshape(rows // block, block, cols // block, block).permute(0, 2, 1, 3)
+    nonzero = tiles.abs().sum(dim=(2, 3)) > 0
+
+    row_ptr = [0]
+    col_idx = []
+    values = []
+    for br in range(rows // block):
+        for bc in range(cols // block):
+            if nonzero[br, bc]:
+                col_idx.append(bc)
+                values.append(tiles[br, bc].reshape(-1))
+        row_ptr.append(len(col_idx))
+
+    f.write(struct.pack("<II", block, len(col_idx)))
+    f.write(struct.pack(f"<{len(row_ptr)}I", *row_ptr))
+    f.write(struct.pack(f"<{len(col_idx)}I", *col_idx))
+    if values:
+        f.write(torch.cat(values).cpu().numpy().astype("float32").tobytes())
+    return len(col_idx) / nonzero.numel()
+
+RNN_MAGIC = {"gru": 0x31475A4E, "mgu": 0x314D5A4E}  # "NZG1" / "NZM1"
+
+
+def export_tiny_rnn(ckpt, output_path: str):
+    """GRU / MGU layout read by TinyRnnModel::load_from_file."""
+    cell = ckpt["cell"]
+    hidden_size = int(ckpt["hidden_size"])
+    state = ckpt["model_state"]
+    prefix = "gru" if cell == "gru" else "mgu"
+
+    tensors = [
+        state[f"{prefix}.weight_ih_l0"],  # (G*H, 256), G = 3 (r, z, n) or 2 (f, n)
+        state[f"{prefix}.weight_hh_l0"],  # (G*H, H)
+        state[f"{prefix}.bias_ih_l0"],    # (G*H)
+        state[f"{prefix}.bias_hh_l0"],    # (G*H)
+        state["fc.weight"],               # (256, H)
+        state["fc.bias"],                 # (256)
+    ]
+
+    with open(output_path, "wb") as f:
+        f.write(struct.pack("<I", RNN_MAGIC[cell]))
+        f.write(struct.pack("<I", 256))          # inputSize
+        f.write(struct.pack("<I", hidden_size))  # hiddenSize
+        f.write(struct.pack("<I", 0))            # outputHead (byte)
+        for tensor in tensors:
+            arr = tensor.contiguous().view(-1).cpu().numpy()
+            f.write(arr.astype("float32").tobytes())
+
+    print(f"[+] Exported {cell.upper()} to {output_path}")
+
+
+TOKEN_MAGIC = 0x31545A4E  # "NZT1"
+
+
+def export_token_lstm(ckpt, output_path: str):
+    """Token model layout read by TokenLstmModel::load_from_file."""
+    hidden_size = int(ckpt["hidden_size"])
+    vocab = ckpt["vocab"]
+    state = ckpt["model_state"]
+
+    # Fold the embedding into the input weights: one column per token.
+    W_ih = state["lstm.weight_ih_l0"] @ state["embed.weight"].t()  # (4H, V)
+    tensors = [
+        W_ih,
+        state["lstm.weight_hh_l0"],  # (4H, H)
+        state["lstm.bias_ih_l0"],    # (4H)
+        state["lstm.bias_hh_l0"],    # (4H)
+        state["fc.weight"],          # (V, H)
+        state["fc.bias"],            # (V)
+    ]
+
+    with open(output_path, "wb") as f:
+        f.write(struct.pack("<I", TOKEN_MAGIC))
+        f.write(struct.pack("<I", 256 + len(vocab)))  # vocabSize
+        f.write(struct.pack("<I", hidden_size))       # hiddenSize
+        f.write(struct.pack("<I", 0))                 # reserved
+        for token in vocab:
+            f.write(struct.pack("<B", len(token)))
+            f.write(bytes(token))
+        for tensor in tensors:
+            arr = tensor.contiguous().view(-1).cpu().numpy()
+            f.write(arr.astype("float32").tobytes())
+
+    print(f"[+] Exported token LSTM ({256 + len(vocab)} tokens) to {output_path}")
+
+
 def export_tiny_lstm(checkpoint_path: str, output_path: str):
     ckpt = torch.load(checkpoint_path, map_location="cpu")
+    if "vocab" in ckpt:
+        export_token_lstm(ckpt, output_path)
+        return
+    if ckpt.get("cell", "lstm") != "lstm":
+        export_tiny_rnn(ckpt, output_path)
+        return
 
     hidden_size = int(ckpt["hidden_size"])
+    output_head = ckpt.get("output_head", "byte")
     state = ckpt["model_state"]
+    sparse = ckpt.get("sparse", {})
+    sparse_block = int(sparse.get("block", 0))
+    sparse_tensors = set(sparse.get("tensors", []))
 
     # Extract weights
     W_ih = state["lstm.weight_ih_l0"]     # (4H, 256)
     W_hh = state["lstm.weight_hh_l0"]     # (4H, H)
     b_ih = state["lstm.bias_ih_l0"]       # (4H)
     b_hh = state["lstm.bias_hh_l0"]       # (4H)
-    W_out = state["fc.weight"]            # (256, H)
-    b_out = state["fc.bias"]              # (256)
+
+    if output_head == "nibble":
+        head_type = 1
+        head = [
+            state["fc_hi.weight"],        # (16, H)
+            state["fc_hi.bias"],          # (16)
+            state["fc_lo.weight"],        # (256, H): 16 heads x 16 rows
+            state["fc_lo.bias"],          # (256)
+        ]
+    else:
+        head_type = 0
+        head = [
+            state["fc.weight"],           # (256, H)
+            state["fc.bias"],             # (256)
+        ]
+
+    flags = 0
+    if "lstm.weight_hh_l0" in sparse_tensors:
+        flags |= LSTM_SPARSE_HH
+    if "fc.weight" in sparse_tensors and head_type == 0:
+        flags |= LSTM_SPARSE_OUT
+    # (tensor, flag that stores it block sparse)
+    arrays = [(W_ih, 0), (W_hh, LSTM_SPARSE_HH), (b_ih, 0), (b_hh, 0)]
+    arrays += [(head[0], LSTM_SPARSE_OUT if head_type == 0 else 0)] + [(t, 0) for t in head[1:]]
 
     with open(output_path, "wb") as f:
         # Header
         f.write(struct.pack("<I", 256))         # inputSize
         f.write(struct.pack("<I", hidden_size)) # hiddenSize
         f.write(struct.pack("<I", 1))           # numLayers
-        f.write(struct.pack("<I", 0))           # reserved
+        f.write(struct.pack("<I", head_type | flags)) # outputHead (0 = byte, 1 = nibble) | LSTM_SPARSE_*
 
-        # Write weight arrays as float32 little-endian
-        for tensor in [W_ih, W_hh, b_ih, b_hh, W_out, b_out]:
+        # Write weight arrays as float32 little-endian; pruned matrices in
+        # the block-sparse layout
+        for tensor, flag in arrays:
+            if flags & flag:
+                density = write_block_sparse(f, tensor, sparse_block)
+                print(f"[+] Block sparse {tuple(tensor.shape)}: {density:.0%} of tiles stored")
+                continue
             arr = tensor.contiguous().view(-1).cpu().numpy()
             f.write(arr.astype("float32").tobytes())
 
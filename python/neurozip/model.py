@@ -1,5 +1,6 @@
 import torch
 import torch.nn as nn
+import torch.nn.functional as F
 
 class TinyLSTM(nn.Module):
     def __init__(self, hidden_size: int = 256):
@@ -23,3 +24,182 @@ class TinyLSTM(nn.Module):
         out, h = self.lstm(onehot, h)
         logits = self.fc(out)
         return logits, h
+
+
+class TinyLSTMNibble(nn.Module):
+    """
+    TinyLSTM with a nibble-factored output head.
+
+    The next byte's high nibble is predicted with a 16-way softmax, then its
+    low nibble with one of 16 16-way heads selected by the high nibble, so
+    each step needs 16 + 16 logits instead of 256.
+    """
+    def __init__(self, hidden_size: int = 256):
+        super().__init__()
+        self.hidden_size = hidden_size
+
+        self.lstm = nn.LSTM(
+            input_size=256,     # byte one-hot
+            hidden_size=hidden_size,
+            num_layers=1,
+            batch_first=True,
+        )
+
+        self.fc_hi = nn.Linear(hidden_size, 16)
+        self.fc_lo = nn.Linear(hidden_size, 256)  # 16 heads x 16 rows
+
+    def forward(self, x, h=None):
+        onehot = torch.nn.functional.one_hot(x, num_classes=256).float()
+
+        out, h = self.lstm(onehot, h)
+        return self.fc_hi(out), self.fc_lo(out), h
+
+
+class TinyGRU(nn.Module):
+    """
+    GRU cell with the byte head: 3 gate blocks (r, z, n) and no cell
+    state, so each step does 3/4 of the LSTM's recurrent work.
+    """
+    def __init__(self, hidden_size: int = 256):
+        super().__init__()
+        self.hidden_size = hidden_size
+
+        self.gru = nn.GRU(
+            input_size=256,
+            hidden_size=hidden_size,
+            num_layers=1,
+            batch_first=True,
+        )
+
+        self.fc = nn.Linear(hidden_size, 256)
+
+    def forward(self, x, h=None):
+        onehot = torch.nn.functional.one_hot(x, num_classes=256).float()
+
+        out, h = self.gru(onehot, h)
+        return self.fc(out), h
+
+
+class MinimalGatedUnit(nn.Module):
+    """
+    Minimal gated unit (one forget gate f and a candidate n):
+
+        f  = sigmoid(W_if x + b_if + W_hf h + b_hf)
+        n  = tanh(W_in x + b_in + W_hn (f * h) + b_hn)
+        h' = (1 - f) * h + f * n
+
+    Parameters are named like nn.GRU's (gate blocks f, n stacked).
+    """
+    def __init__(self, input_size: int, hidden_size: int):
+        super().__init__()
+        self.hidden_size = hidden_size
+        k = 1.0 / hidden_size ** 0.5
+        self.weight_ih_l0 = nn.Parameter(torch.empty(2 * hidden_size, input_size).uniform_(-k, k))
+        self.weight_hh_l0 = nn.Parameter(torch.empty(2 * hidden_size, hidden_size).uniform_(-k, k))
+        self.bias_ih_l0 = nn.Parameter(torch.empty(2 * hidden_size).uniform_(-k, k))
+        self.bias_hh_l0 = nn.Parameter(torch.empty(2 * hidden_size).uniform_(-k, k))
+
+    def forward(self, x, h=None):
+        # x: (batch, seq_len, input_size)
+        H = self.hidden_size
+        if h is None:
+            h = x.new_zeros(x.shape[0], H)
+        xw = F.linear(x, self.weight_ih_l0, self.bias_ih_l0)
+        w_hf, w_hn = self.weight_hh_l0[:H], self.weight_hh_l0[H:]
+        b_hf, b_hn = self.bias_hh_l0[:H], self.bias_hh_l0[H:]
+
+        outs = []
+        for t in range(x.shape[1]):
+            xf, xn = xw[:, t, :H], xw[:, t, H:]
+            f = torch.sigmoid(xf + F.linear(h, w_hf, b_hf))
+            n = torch.tanh(xn + F.linear(f * h, w_hn, b_hn))
+            h = (1.0 - f) * h + f * n
+            outs.append(h)
+        return torch.stack(outs, dim=1), h
+
+
+class TinyMGU(nn.Module):
+    """Minimal gated unit with the byte head: half the LSTM's recurrent work."""
+    def __init__(self, hidden_size: int = 256):
+        super().__init__()
+        self.hidden_size = hidden_size
+        self.mgu = MinimalGatedUnit(256, hidden_size)
+        self.fc = nn.Linear(hidden_size, 256)
+
+    def forward(self, x, h=None):
+        onehot = torch.nn.functional.one_hot(x, num_classes=256).float()
+
+        out, h = self.mgu(onehot, h)
+        return self.fc(out), h
+
+
+class TinyTokenLSTM(nn.Module):
+    """
+    LSTM over a multi-byte token vocabulary (ids 0..255 are single bytes,
+    256.. the tokens built by nz_tokenize.build_vocab): one step per token.
+
+    Inputs go through an embedding instead of a one-hot vector; the export
+    folds it into W_ih (W_ih @ E^T, one column per token), which is what
+    TokenLstmModel reads.
+    """
+    def __init__(self, vocab_size: int, hidden_size: int = 256, embed_size: int = 64):
+        super().__init__()
+        self.vocab_size = vocab_size
+        self.hidden_size = hidden_size
+
+        self.embed = nn.Embedding(vocab_size, embed_size)
+        self.lstm = nn.LSTM(
+            input_size=embed_size,
+            hidden_size=hidden_size,
+            num_layers=1,
+            batch_first=True,
+        )
+
+        self.fc = nn.Linear(hidden_size, vocab_size)
+
+    def forward(self, x, h=None):
+        # x: (batch, seq_len) token ids
+        out, h = self.lstm(self.embed(x), h)
+        return self.fc(out), h
+
+
+def nibble_cross_entropy(hi_logits, lo_logits, y, reduction="mean"):
+    """
+    Byte-level cross entropy of a nibble head: CE(high) + CE(low | high).
+
+    hi_logits: (..., 16), lo_logits: (..., 256), y: (...) target bytes.
+    """
+    hi = y // 16
+    lo = y % 16
+
+    lo_heads = lo_logits.reshape(*y.shape, 16, 16)
+    index = hi[..., None, None].expand(*y.shape, 1, 16)
+    lo_sel = lo_heads.gather(-2, index).squeeze(-2)
+
+    loss_hi = F.cross_entropy(hi_logits.reshape(-1, 16), hi.reshape(-1), reduction=reduction)
+    loss_lo = F.cross_entropy(lo_sel.reshape(-1, 16), lo.reshape(-1), reduction=reduction)
+    return loss_hi + loss_lo
+
+
+def build_model(output_head: str = "byte", hidden_size: int = 256, cell: str = "lstm",
+                vocab_size: int = 0):
+    """
+    Construct the model for a cell ("lstm", "gru" or "mgu") and an output
+    head name ("byte" or "nibble"; GRU and MGU only have the byte head).
+    With vocab_size > 0 the model codes tokens instead (LSTM only).
+    """
+    if vocab_size:
+        if cell != "lstm" or output_head != "byte":
+            raise ValueError("token models are byte-head LSTMs")
+        return TinyTokenLSTM(vocab_size, hidden_size=hidden_size)
+    if cell in ("gru", "mgu"):
+        if output_head != "byte":
+            raise ValueError(f"{cell} models only support the byte head")
+        return TinyGRU(hidden_size=hidden_size) if cell == "gru" else TinyMGU(hidden_size=hidden_size)
+    if cell != "lstm":
+        raise ValueError(f"unknown cell: {cell}")
+    if output_head == "nibble":
+        return TinyLSTMNibble(hidden_size=hidden_size)
+    if output_head == "byte":
+        return TinyLSTM(hidden_size=hidden_size)
+    raise ValueError(f"unknown output head: {output_head}")
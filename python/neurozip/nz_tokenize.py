@@ -7,3 +7,50 @@ def file_to_bytes(path: str) -> bytes:
     """Load a text or binary file as raw bytes."""
     with open(path, "rb") as f:
         return f.read()
+
+
+MAX_TOKEN_BYTES = 32    # kMaxTokenBytes in core/token_vocab.h
+MAX_TOKEN_VOCAB = 8192  # kMaxTokenVocab
+
+
+def build_vocab(data: bytes, vocab_size: int, max_len: int = 16, sample: int = 1 << 18):
+    """
+    Pick vocab_size - 256 multi-byte tokens for a token model: the
+    substrings of 2..max_len bytes that save the most steps in a sample of
+    the data (count * (length - 1)). Returns them as a list of bytes, in
+    id order (256..).
+    """
+    if not 256 < vocab_size <= MAX_TOKEN_VOCAB:
+        raise ValueError(f"vocab size must be in 257..{MAX_TOKEN_VOCAB}")
+    max_len = min(max_len, MAX_TOKEN_BYTES)
+    data = data[:sample]
+
+    counts = {}
+    for n in range(2, max_len + 1):
+        for i in range(len(data) - n + 1):
+            gram = data[i:i + n]
+            counts[gram] = counts.get(gram, 0) + 1
+
+    ranked = sorted(counts.items(), key=lambda kv: (-kv[1] * (len(kv[0]) - 1), kv[0]))
+    return [gram for gram, count in ranked[:vocab_size - 256] if count > 1]
+
+
+def tokenize(data: bytes, vocab):
+    """
+    Greedy longest-match tokenization, as TokenVocab::tokenize does:
+    single bytes are ids 0..255, vocab[k] is id 256 + k.
+    """
+    ids = {tok: 256 + k for k, tok in enumerate(vocab)}
+    max_len = max((len(t) for t in vocab), default=1)
+    out = []
+    pos = 0
+    while pos < len(data):
+        token, length = data[pos], 1
+        for n in range(min(max_len, len(data) - pos), 1, -1):
+            t = ids.get(data[pos:pos + n])
+            if t is not None:
+                token, length = t, n
+                break
+        out.append(token)
+        pos += length
+    return out
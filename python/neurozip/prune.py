@@ -0,0 +1,70 @@
+import torch
+
+# Parameters that can be stored block sparse (LSTM_SPARSE_HH / LSTM_SPARSE_OUT).
+RECURRENT_WEIGHT = "lstm.weight_hh_l0"
+OUTPUT_WEIGHT = "fc.weight"
+
+
+def block_norms(weight: torch.Tensor, block: int) -> torch.Tensor:
+    """L2 norm of every block x block tile: (rows / block, cols / block)."""
+    rows, cols = weight.shape
+    tiles = weight.reshape(rows // block, block, cols // block, block)
+    return tiles.pow(2).sum(dim=(1, 3)).sqrt()
+
+
+def block_mask(weight: torch.Tensor, block: int, sparsity: float) -> torch.Tensor:
+    """
+    Elementwise 0/1 mask that drops the 'sparsity' fraction of tiles with
+    the smallest norms.
+    """
+    norms = block_norms(weight, block)
+    drop = int(round(sparsity * norms.numel()))
+    keep = torch.ones_like(norms)
+    if drop > 0:
+        order = norms.flatten().argsort()
+        keep.view(-1)[order[:drop]] = 0.0
+    return keep.repeat_interleave(block, 0).repeat_interleave(block, 1)
+
+
+class BlockPruner:
+    """
+    Gradual block-magnitude pruning.
+
+    Sparsity ramps to 'sparsity' over the first 'epochs' epochs with the
+    cubic schedule s_t = s * (1 - (1 - t / epochs)^3); masks are recomputed
+    at the start of each epoch and reapplied after every optimizer step,
+    so later epochs fine-tune the surviving tiles.
+    """
+    def __init__(self, model, names, block: int = 8, sparsity: float = 0.75, epochs: int = 1):
+        params = dict(model.named_parameters())
+        self.params = {}
+        for name in names:
+            w = params[name]
+            if w.shape[0] % block or w.shape[1] % block:
+                raise ValueError(f"{name} {tuple(w.shape)} is not a multiple of block {block}")
+            self.params[name] = w
+        self.block = block
+        self.sparsity = sparsity
+        self.epochs = max(1, epochs)
+        self.masks = {}
+
+    def target(self, epoch: int) -> float:
+        t = min(epoch, self.epochs) / self.epochs
+        return self.sparsity * (1.0 - (1.0 - t) ** 3)
+
+    @torch.no_grad()
+    def update(self, epoch: int):
+        s = self.target(epoch)
+        for name, w in self.params.items():
+            self.masks[name] = block_mask(w, self.block, s)
+        self.apply()
+        return s
+
+    @torch.no_grad()
+    def apply(self):
+        for name, w in self.params.items():
+            w.mul_(self.masks[name])
+
+    def state(self):
+        """Checkpoint entry read by export.py."""
+        return {"block": self.block, "tensors": list(self.params)}
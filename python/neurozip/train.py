@@ -3,8 +3,9 @@ import torch.nn as nn
 from torch.utils.data import DataLoader
 
 from .dataset import ByteDataset
-from .model import TinyLSTM
-from .nz_tokenize import file_to_bytes
+from .model import build_model, nibble_cross_entropy
+from .nz_tokenize import build_vocab, file_to_bytes, tokenize
+from .prune import BlockPruner, RECURRENT_WEIGHT, OUTPUT_WEIGHT
 
 import argparse
 import time
@@ -18,35 +19,74 @@ def train_model(
     epochs: int,
     lr: float,
     output: str,
+    output_head: str = "byte",
+    prune_sparsity: float = 0.0,
+    prune_block: int = 8,
+    prune_epochs: int = 0,
+    prune_output: bool = False,
+    cell: str = "lstm",
+    vocab_size: int = 0,
 ):
     device = torch.device("cuda" if torch.cuda.is_available() else "cpu")
 
     print(f"[+] Loading data from {data_path}")
     data = file_to_bytes(data_path)
+    vocab = []
+    symbols = 256
+    if vocab_size:
+        if prune_sparsity > 0.0:
+            raise ValueError("block pruning is not supported for token models")
+        vocab = build_vocab(data, vocab_size)
+        size = len(data)
+        data = tokenize(data, vocab)
+        symbols = 256 + len(vocab)
+        print(f"[+] {symbols} tokens: {len(data)} steps for {size} bytes")
     dataset = ByteDataset(data, seq_len)
     loader = DataLoader(dataset, batch_size=batch_size, shuffle=True)
 
-    model = TinyLSTM(hidden_size=hidden_size).to(device)
+    model = build_model(output_head, hidden_size=hidden_size, cell=cell,
+                        vocab_size=symbols if vocab else 0).to(device)
     opt = torch.optim.Adam(model.parameters(), lr=lr)
     criterion = nn.CrossEntropyLoss()
 
+    pruner = None
+    if prune_sparsity > 0.0:
+        if cell != "lstm":
+            raise ValueError("block pruning is only supported for the LSTM")
+        names = [RECURRENT_WEIGHT]
+        if prune_output:
+            if output_head != "byte":
+                raise ValueError("--prune-output needs the byte head")
+            names.append(OUTPUT_WEIGHT)
+        pruner = BlockPruner(model, names, block=prune_block, sparsity=prune_sparsity,
+                             epochs=prune_epochs or epochs)
+
     print("[+] Starting training")
     start = time.time()
 
     for epoch in range(1, epochs + 1):
         model.train()
         total_loss = 0.0
+        if pruner is not None:
+            s = pruner.update(epoch)
+            print(f"[+] Block sparsity {s:.2f} ({prune_block}x{prune_block} tiles)")
 
         for x, y in loader:
             x = x.to(device)
             y = y.to(device)
 
             opt.zero_grad()
-            logits, _ = model(x)
-            loss = criterion(logits.reshape(-1, 256), y.reshape(-1))
+            if output_head == "nibble":
+                hi_logits, lo_logits, _ = model(x)
+                loss = nibble_cross_entropy(hi_logits, lo_logits, y)
+            else:
+                logits, _ = model(x)
+                loss = criterion(logits.reshape(-1, symbols), y.reshape(-1))
             loss.backward()
             torch.nn.utils.clip_grad_norm_(model.parameters(), 1.0)
             opt.step()
+            if pruner is not None:
+                pruner.apply()
 
             total_loss += loss.item()
 
@@ -57,10 +97,17 @@ def train_model(
     print(f"[+] Training finished in {dur:.1f}s")
 
     print(f"[+] Saving checkpoint to {output}")
-    torch.save({
+    ckpt = {
         "hidden_size": hidden_size,
+        "output_head": output_head,
+        "cell": cell,
         "model_state": model.state_dict(),
-    }, output)
+    }
+    if pruner is not None:
+        ckpt["sparse"] = pruner.state()
+    if vocab:
+        ckpt["vocab"] = vocab
+    torch.save(ckpt, output)
 
 
 def main():
@@ -72,6 +119,21 @@ def main():
     ap.add_argument("--epochs", type=int, default=2)
     ap.add_argument("--lr", type=float, default=1e-3)
     ap.add_argument("--output", required=True)
+    ap.add_argument("--output-head", choices=["byte", "nibble"], default="byte",
+                    help="nibble: factor each byte into high/low nibbles (16+16 logits)")
+    ap.add_argument("--cell", choices=["lstm", "gru", "mgu"], default="lstm",
+                    help="recurrent cell: gru (3 gates) and mgu (2 gates) are cheaper per byte")
+    ap.add_argument("--prune-sparsity", type=float, default=0.0,
+                    help="fraction of W_hh tiles to prune (e.g. 0.75); exported block sparse")
+    ap.add_argument("--prune-block", type=int, default=8,
+                    help="tile size for block pruning (must divide the hidden size)")
+    ap.add_argument("--prune-epochs", type=int, default=0,
+                    help="epochs to ramp up sparsity over (default: all)")
+    ap.add_argument("--prune-output", action="store_true",
+                    help="also prune the byte head's W_out")
+    ap.add_argument("--vocab-size", type=int, default=0,
+                    help="train a token model over this many ids (256 bytes + multi-byte tokens), "
+                         "for fewer recurrent steps per byte")
 
     args = ap.parse_args()
 
@@ -83,6 +145,13 @@ def main():
         epochs=args.epochs,
         lr=args.lr,
         output=args.output,
+        output_head=args.output_head,
+        prune_sparsity=args.prune_sparsity,
+        prune_block=args.prune_block,
+        prune_epochs=args.prune_epochs,
+        prune_output=args.prune_output,
+        cell=args.cell,
+        vocab_size=args.vocab_size,
     )
 
 
@@ -1,25 +1,119 @@
 #include "neurozip_c.h"
 
+#include "../core/archive.h"
+#include "../core/autotune.h"
+#include "../core/checkpoint.h"
+#include "../core/compact_frame.h"
+#include "../core/estimate.h"
 #include "../core/file_format.h"
+#include "../core/hot_swap.h"
+#include "../core/io_backend.h"
+#include "../core/job_queue.h"
 #include "../core/model_interface.h"
-#include "../models/tiny_lstm.h"
+#include "../core/result_cache.h"
+#include "../core/segments.h"
+#include "../core/stream_state.h"
+#include "../core/task_scheduler.h"
+#include "../core/trace.h"
+#include "../core/worker_pool.h"
+#include "../models/model_loader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
+struct nzp_model;
+
+// Models in a slot are deleted by whichever lease is released last.
+struct ModelDeleter {
+    void operator()(nzp_model* model) const;
+};
+using ModelSwap = neurozip::HotSwap<nzp_model, ModelDeleter>;
+
 struct nzp_model {
-    std::unique_ptr<neurozip::TinyLstmModel> impl;
+    std::unique_ptr<neurozip::ICompressionModel> impl;
+
+    // Set while the model belongs to a slot (see nzp_model_slot_swap).
+    ModelSwap::Entry* slotEntry = nullptr;
+
+    // Output-layer worker pool, created on first threaded call and kept
+    // (with its per-node weight replicas) while the settings match.
+    mutable std::mutex poolMutex;
+    mutable std::shared_ptr<neurozip::WorkerPool> pool;
+    mutable unsigned poolThreads = 0;
+    mutable bool poolNuma = false;
+
+    // Host tuning profile for auto_tune, loaded from the default path on
+    // first use unless set by nzp_tune / nzp_model_set_tune_profile.
+    mutable std::mutex tuneMutex;
+    mutable bool tuneLoaded = false;
+    mutable std::unique_ptr<neurozip::TuneProfile> tune;
+
+    // Result cache set with nzp_model_set_cache (may be shared).
+    mutable std::mutex cacheMutex;
+    std::shared_ptr<neurozip::ResultCache> cache;
+
+    // Executor for nzp_submit_* jobs, created by the first submit. Last
+    // member, so it is destroyed first: its queued jobs run while the rest
+    // of the model is still there.
+    mutable std::mutex jobsMutex;
+    mutable std::shared_ptr<neurozip::JobQueue> jobs;
+    unsigned jobThreads = 0;
+};
+
+// An asynchronous job. Referenced by the caller's handle and by the
+// executor task; whichever lets go last deletes it.
+struct nzp_job {
+    std::atomic<int> refs{ 2 };
+    std::atomic<int> status{ NZP_JOB_QUEUED };
+    std::function<nzp_error_t(nzp_job*)> work;
+    nzp_job_callback_t callback = nullptr;
+    void* userData = nullptr;
+
+    nzp_error_t result = NZP_OK;   // set before status becomes DONE
+    bool memoryJob = false;
+    uint8_t* output = nullptr;     // memory jobs, until taken
+    uint64_t outputSize = 0;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;         // callback has run
+
+    ~nzp_job() { std::free(output); }
+};
+
+struct nzp_cache {
+    std::shared_ptr<neurozip::ResultCache> impl;
+};
+
+struct nzp_model_slot {
+    ModelSwap models;
 };
 
+void ModelDeleter::operator()(nzp_model* model) const
+{
+    delete model;
+}
+
 extern "C" {
 
 nzp_model_t* nzp_model_load(const char* path)
 {
     if (!path) return nullptr;
-    auto modelPtr = std::make_unique<neurozip::TinyLstmModel>();
-    if (!modelPtr->load_from_file(path)) {
+    auto modelPtr = neurozip::load_model(path);
+    if (!modelPtr) {
         return nullptr;
     }
     auto wrapper = new nzp_model;
@@ -29,9 +123,75 @@ nzp_model_t* nzp_model_load(const char* path)
 
 void nzp_model_free(nzp_model_t* model)
 {
+    if (model && model->slotEntry) return;
     delete model;
 }
 
+uint64_t nzp_model_hash(const nzp_model_t* model)
+{
+    if (!model || !model->impl) return 0;
+    return model->impl->model_hash();
+}
+
+void nzp_model_set_fixed_point(nzp_model_t* model, int enable)
+{
+    if (!model || !model->impl) return;
+    model->impl->set_fixed_point(enable != 0);
+}
+
+int nzp_model_fixed_point(const nzp_model_t* model)
+{
+    if (!model || !model->impl) return 0;
+    return model->impl->fixed_point() ? 1 : 0;
+}
+
+void nzp_model_set_step_threads(nzp_model_t* model, unsigned threads)
+{
+    if (!model || !model->impl) return;
+    model->impl->set_step_threads(threads);
+}
+
+unsigned nzp_model_step_threads(const nzp_model_t* model)
+{
+    if (!model || !model->impl) return 1;
+    return model->impl->step_threads();
+}
+
+uint32_t nzp_model_primed_state_count(const nzp_model_t* model)
+{
+    if (!model || !model->impl) return 0;
+    return model->impl->primed_state_count();
+}
+
+nzp_error_t nzp_model_set_primed_state(nzp_model_t* model, uint32_t id)
+{
+    if (!model || !model->impl) return NZP_ERR_INTERNAL;
+    return model->impl->set_primed_state(id) ? NZP_OK : NZP_ERR_MODEL_MISMATCH;
+}
+
+uint32_t nzp_model_primed_state(const nzp_model_t* model)
+{
+    if (!model || !model->impl) return 0;
+    return model->impl->primed_state();
+}
+
+nzp_error_t nzp_prime_model(
+    const char* model_path,
+    const char* out_path,
+    const char* const* prefix_paths,
+    size_t count
+) {
+    if (!model_path || !out_path || (count && !prefix_paths)) return NZP_ERR_INTERNAL;
+    std::vector<std::vector<uint8_t>> prefixes;
+    for (size_t i = 0; i < count; ++i) {
+        std::ifstream ifs(prefix_paths[i] ? prefix_paths[i] : "", std::ios::binary);
+        if (!ifs) return NZP_ERR_IO;
+        prefixes.emplace_back(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    if (!std::ifstream(model_path)) return NZP_ERR_IO;
+    return neurozip::write_primed_model(model_path, out_path, prefixes) ? NZP_OK : NZP_ERR_INVALID_FORMAT;
+}
+
 static nzp_error_t to_nzp_error(neurozip::ErrorCode e)
 {
     using E = neurozip::ErrorCode;
@@ -46,10 +206,139 @@ static nzp_error_t to_nzp_error(neurozip::ErrorCode e)
     }
 }
 
+static std::shared_ptr<neurozip::WorkerPool> model_pool(
+    const nzp_model_t* model,
+    unsigned threads,
+    bool numaAware
+) {
+    std::lock_guard<std::mutex> lock(model->poolMutex);
+    if (!model->pool || model->poolThreads != threads || model->poolNuma != numaAware) {
+        model->pool = std::make_shared<neurozip::WorkerPool>(threads, numaAware);
+        model->poolThreads = threads;
+        model->poolNuma = numaAware;
+    }
+    return model->pool;
+}
+
+static std::shared_ptr<neurozip::ResultCache> model_cache(const nzp_model_t* model)
+{
+    std::lock_guard<std::mutex> lock(model->cacheMutex);
+    return model->cache;
+}
+
+// Cache variants of whole outputs (the core caches bare streams with
+// RESULT_CACHE_STREAM). Only options that change the bytes are included.
+static uint64_t image_cache_variant(const nzp_compress_options_t* options)
+{
+    uint64_t v = 1u << 8;
+    if (options) {
+        v |= (options->appendable ? 1u : 0u) | (options->checkpoint_int8 ? 2u : 0u) |
+             (options->reduced_alphabet ? 4u : 0u);
+        v |= (uint64_t)options->checkpoint_interval << 32;
+    }
+    return v;
+}
+
+static uint64_t frame_cache_variant(int checksum)
+{
+    return (2u << 8) | (checksum ? 1u : 0u);
+}
+
+/// The model's tuning profile adjusted to its current weights and mode,
+/// or false if there is none.
+static bool model_tune_profile(const nzp_model_t* model, neurozip::TuneProfile& out)
+{
+    std::lock_guard<std::mutex> lock(model->tuneMutex);
+    if (!model->tuneLoaded) {
+        model->tuneLoaded = true;
+        neurozip::TuneProfile profile;
+        if (neurozip::load_tune_profile(neurozip::default_tune_profile_path(), profile)) {
+            model->tune = std::make_unique<neurozip::TuneProfile>(profile);
+        }
+    }
+    if (!model->tune) return false;
+    out = neurozip::profile_for_model(*model->tune, *model->impl);
+    return true;
+}
+
+/// 'pool' keeps the model's worker pool alive for the duration of a call.
+/// 'inputSize' only matters for auto_tune.
+static neurozip::CompressOptions to_compress_options(
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    std::shared_ptr<neurozip::WorkerPool>& pool,
+    uint64_t inputSize = 0
+) {
+    neurozip::CompressOptions opts;
+    if (options) {
+        opts.twoPhase = options->two_phase != 0;
+        opts.pipelined = options->pipelined != 0;
+        opts.threads = options->threads;
+        opts.numaAware = options->numa_aware != 0;
+        opts.checkpointInterval = options->checkpoint_interval;
+        opts.checkpointInt8 = options->checkpoint_int8 != 0;
+        opts.reducedAlphabet = options->reduced_alphabet != 0;
+    }
+    neurozip::TuneProfile profile;
+    if (options && options->auto_tune && model_tune_profile(model, profile)) {
+        auto tuned = neurozip::tune_stream(profile, inputSize);
+        opts.twoPhase = tuned.kernel == neurozip::EncoderKernel::TwoPhase;
+        opts.pipelined = tuned.kernel == neurozip::EncoderKernel::Pipelined;
+        opts.threads = tuned.threads;
+    }
+    if (opts.twoPhase && opts.threads != 1) {
+        pool = model_pool(model, opts.threads, opts.numaAware);
+        opts.pool = pool.get();
+    }
+    return opts;
+}
+
+static void compress_impl(
+    const uint8_t* data,
+    size_t size,
+    const neurozip::ICompressionModel& model,
+    const neurozip::CompressOptions& options,
+    neurozip::FileHeader& header,
+    std::vector<uint8_t>& payload,
+    bool appendable = false
+) {
+    header.originalSize = size;
+    header.modelId = model.model_id();
+    header.modelHash = model.model_hash();
+    header.checksum = neurozip::crc32(data, size);
+    if (model.fixed_point()) {
+        header.flags |= neurozip::NZP_FLAG_FIXED_POINT;
+    }
+    header.primedState = neurozip::primed_state_tag(model);
+
+    // Token streams cannot be continued in place; appends rewrite them.
+    if (model.token_vocab()) appendable = false;
+
+    // Appended bytes could fall outside a reduced alphabet.
+    if (options.reducedAlphabet && !appendable && neurozip::reduces_alphabet(model)) {
+        header.flags |= neurozip::NZP_FLAG_ALPHABET;
+    }
+
+    neurozip::CheckpointIndex checkpoints;
+    neurozip::StreamState state;
+    payload = neurozip::compress_buffer(model, data, size, options, &checkpoints,
+                                        appendable ? &state : nullptr);
+    if (checkpoints.enabled()) {
+        neurozip::append_checkpoint_index(checkpoints, payload);
+        header.flags |= neurozip::NZP_FLAG_CHECKPOINTS;
+    }
+    if (appendable) {
+        neurozip::append_stream_state(state, payload);
+        header.flags |= neurozip::NZP_FLAG_APPENDABLE;
+    }
+}
+
 static nzp_error_t compress_file_impl(
     const char* input_path,
     const char* output_path,
-    const neurozip::ICompressionModel& model
+    const neurozip::ICompressionModel& model,
+    const neurozip::CompressOptions& options,
+    bool appendable = false
 ) {
     // Read input
     std::ifstream ifs(input_path, std::ios::binary);
@@ -60,38 +349,106 @@ static nzp_error_t compress_file_impl(
     );
 
     neurozip::FileHeader header;
-    header.originalSize = data.size();
-    header.modelId = model.model_id();
-    header.modelHash = model.model_hash();
-    header.checksum = neurozip::crc32(data.data(), data.size());
-
-    auto payload = neurozip::compress_buffer(model, data.data(), data.size());
+    std::vector<uint8_t> payload;
+    compress_impl(data.data(), data.size(), model, options, header, payload, appendable);
 
     auto ec = neurozip::write_nzp_file(output_path, header, payload);
     return to_nzp_error(ec);
 }
 
-static nzp_error_t decompress_file_impl(
-    const char* input_path,
-    const char* output_path,
+static nzp_error_t check_model(
+    const neurozip::FileHeader& header,
     const neurozip::ICompressionModel& model
 ) {
-    neurozip::FileHeader header;
-    std::vector<uint8_t> payload;
-    auto ec = neurozip::read_nzp_file(input_path, header, payload);
-    if (ec != neurozip::ErrorCode::Ok) {
-        return to_nzp_error(ec);
-    }
-
     // Check model id + hash match
     if (header.modelId != model.model_id() ||
         (header.modelHash != 0 && header.modelHash != model.model_hash())) {
         return NZP_ERR_MODEL_MISMATCH;
     }
 
-    std::vector<uint8_t> out;
-    if (!neurozip::decompress_buffer(model, payload.data(), payload.size(), header.originalSize, out)) {
-        return NZP_ERR_CORRUPT;
+    // Fixed-point and float inference produce different probabilities.
+    bool fixedPoint = (header.flags & neurozip::NZP_FLAG_FIXED_POINT) != 0;
+    if (fixedPoint != model.fixed_point()) {
+        return NZP_ERR_MODEL_MISMATCH;
+    }
+
+    // So do cold and primed starts, and different snapshots.
+    if (header.primedState != neurozip::primed_state_tag(model)) {
+        return NZP_ERR_MODEL_MISMATCH;
+    }
+
+    return NZP_OK;
+}
+
+/// 'model' in the inference mode and primed state a file was coded with:
+/// the model itself if it matches, else a copy kept in 'variants' and
+/// reused for later files. nullptr if the model has no such snapshot.
+static const neurozip::ICompressionModel* model_for_file(
+    const neurozip::ICompressionModel& model,
+    bool fixedPoint,
+    uint32_t primedState,
+    std::vector<std::unique_ptr<neurozip::ICompressionModel>>& variants
+) {
+    if (model.fixed_point() == fixedPoint && model.primed_state() == primedState) return &model;
+    for (const auto& v : variants) {
+        if (v->fixed_point() == fixedPoint && v->primed_state() == primedState) return v.get();
+    }
+    auto copy = model.clone();
+    if (!copy || !copy->set_primed_state(primedState)) return nullptr;
+    copy->set_fixed_point(fixedPoint);
+    variants.push_back(std::move(copy));
+    return variants.back().get();
+}
+
+/// Separate the range coder stream from any trailing checkpoint index and
+/// saved encoder state (stored in that order).
+static nzp_error_t split_payload(
+    const neurozip::FileHeader& header,
+    const std::vector<uint8_t>& payload,
+    size_t& streamSize,
+    neurozip::CheckpointIndex& checkpoints
+) {
+    streamSize = payload.size();
+    if (header.flags & neurozip::NZP_FLAG_APPENDABLE) {
+        neurozip::StreamState state;
+        if (!neurozip::split_stream_state(payload.data(), payload.size(), streamSize, state)) {
+            return NZP_ERR_CORRUPT;
+        }
+    }
+    if (header.flags & neurozip::NZP_FLAG_CHECKPOINTS) {
+        if (!neurozip::split_checkpoint_index(payload.data(), streamSize, streamSize, checkpoints)) {
+            return NZP_ERR_CORRUPT;
+        }
+    }
+    return NZP_OK;
+}
+
+static nzp_error_t decompress_impl(
+    const neurozip::FileHeader& header,
+    const std::vector<uint8_t>& payload,
+    const neurozip::ICompressionModel& model,
+    std::vector<uint8_t>& out
+) {
+    nzp_error_t err = check_model(header, model);
+    if (err != NZP_OK) return err;
+
+    if (header.flags & neurozip::NZP_FLAG_SEGMENTED) {
+        neurozip::SegmentTable table;
+        if (!neurozip::parse_segment_table(payload.data(), payload.size(), table) ||
+            !neurozip::decompress_segments(model, payload.data(), payload.size(), table, out)) {
+            return NZP_ERR_CORRUPT;
+        }
+    } else {
+        size_t streamSize = 0;
+        neurozip::CheckpointIndex checkpoints;
+        err = split_payload(header, payload, streamSize, checkpoints);
+        if (err != NZP_OK) return err;
+
+        bool reduced = (header.flags & neurozip::NZP_FLAG_ALPHABET) != 0;
+        if (!neurozip::decompress_buffer(model, payload.data(), streamSize, header.originalSize, out,
+                                         &checkpoints, reduced)) {
+            return NZP_ERR_CORRUPT;
+        }
     }
 
     // Verify checksum
@@ -100,6 +457,43 @@ static nzp_error_t decompress_file_impl(
         return NZP_ERR_CORRUPT;
     }
 
+    return NZP_OK;
+}
+
+/// First byte of a file, to tell compact frames from .nzp files.
+static bool read_first_byte(const char* path, uint8_t& out)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    char c;
+    if (!ifs.get(c)) return false;
+    out = (uint8_t)c;
+    return true;
+}
+
+static nzp_error_t decompress_file_impl(
+    const char* input_path,
+    const char* output_path,
+    const neurozip::ICompressionModel& model
+) {
+    std::vector<uint8_t> out;
+    uint8_t first = 0;
+    if (read_first_byte(input_path, first) && neurozip::is_compact_frame(&first, 1)) {
+        std::ifstream ifs(input_path, std::ios::binary);
+        std::vector<uint8_t> frame((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        auto ec = neurozip::read_compact_frame(model, frame.data(), frame.size(), out);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    } else {
+        neurozip::FileHeader header;
+        std::vector<uint8_t> payload;
+        auto ec = neurozip::read_nzp_file(input_path, header, payload);
+        if (ec != neurozip::ErrorCode::Ok) {
+            return to_nzp_error(ec);
+        }
+
+        nzp_error_t err = decompress_impl(header, payload, model, out);
+        if (err != NZP_OK) return err;
+    }
+
     std::ofstream ofs(output_path, std::ios::binary);
     if (!ofs) return NZP_ERR_IO;
     ofs.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
@@ -108,6 +502,20 @@ static nzp_error_t decompress_file_impl(
     return NZP_OK;
 }
 
+/// Hand a result to the caller as a malloc'd buffer (see nzp_buffer_free).
+static nzp_error_t export_buffer(
+    const std::vector<uint8_t>& data,
+    uint8_t** out_data,
+    uint64_t* out_size
+) {
+    uint8_t* buf = static_cast<uint8_t*>(std::malloc(data.empty() ? 1 : data.size()));
+    if (!buf) return NZP_ERR_INTERNAL;
+    if (!data.empty()) std::memcpy(buf, data.data(), data.size());
+    *out_data = buf;
+    *out_size = data.size();
+    return NZP_OK;
+}
+
 nzp_error_t nzp_compress_file(
     const char* input_path,
     const char* output_path,
@@ -116,7 +524,40 @@ nzp_error_t nzp_compress_file(
     if (!input_path || !output_path || !model || !model->impl) {
         return NZP_ERR_INTERNAL;
     }
-    return compress_file_impl(input_path, output_path, *model->impl);
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    return compress_file_impl(input_path, output_path, *model->impl,
+                              to_compress_options(model, nullptr, pool));
+}
+
+void nzp_compress_options_init(nzp_compress_options_t* options)
+{
+    if (!options) return;
+    options->two_phase = 0;
+    options->pipelined = 0;
+    options->threads = 1;
+    options->numa_aware = 1;
+    options->checkpoint_interval = 0;
+    options->checkpoint_int8 = 0;
+    options->appendable = 0;
+    options->auto_tune = 0;
+    options->reduced_alphabet = 0;
+}
+
+nzp_error_t nzp_compress_file_ex(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+) {
+    if (!input_path || !output_path || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(input_path, ec);
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    return compress_file_impl(input_path, output_path, *model->impl,
+                              to_compress_options(model, options, pool, ec ? 0 : size),
+                              options && options->appendable);
 }
 
 nzp_error_t nzp_decompress_file(
@@ -130,6 +571,1353 @@ nzp_error_t nzp_decompress_file(
     return decompress_file_impl(input_path, output_path, *model->impl);
 }
 
+nzp_error_t nzp_compress_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    uint8_t** out_data,
+    uint64_t* out_size
+) {
+    if ((!input && input_size) || !model || !model->impl || !out_data || !out_size) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_data = nullptr;
+    *out_size = 0;
+
+    std::vector<uint8_t> image;
+    auto cache = model_cache(model);
+    neurozip::ResultCacheKey key;
+    if (cache) {
+        key = neurozip::result_cache_key(*model->impl, input, (size_t)input_size,
+                                         image_cache_variant(options));
+        if (cache->lookup(key, image)) return export_buffer(image, out_data, out_size);
+    }
+
+    neurozip::FileHeader header;
+    std::vector<uint8_t> payload;
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    compress_impl(input, (size_t)input_size, *model->impl,
+                  to_compress_options(model, options, pool, input_size),
+                  header, payload, options && options->appendable);
+
+    neurozip::serialize_nzp(header, payload, image);
+    if (cache) cache->insert(key, image.data(), image.size());
+    return export_buffer(image, out_data, out_size);
+}
+
+nzp_error_t nzp_decompress_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    uint8_t** out_data,
+    uint64_t* out_size
+) {
+    if (!input || !model || !model->impl || !out_data || !out_size) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_data = nullptr;
+    *out_size = 0;
+
+    if (neurozip::is_compact_frame(input, (size_t)input_size)) {
+        return nzp_decompress_frame(input, input_size, model, out_data, out_size);
+    }
+
+    neurozip::FileHeader header;
+    std::vector<uint8_t> payload;
+    auto ec = neurozip::parse_nzp(input, (size_t)input_size, header, payload);
+    if (ec != neurozip::ErrorCode::Ok) {
+        return to_nzp_error(ec);
+    }
+
+    std::vector<uint8_t> out;
+    nzp_error_t err = decompress_impl(header, payload, *model->impl, out);
+    if (err != NZP_OK) return err;
+    return export_buffer(out, out_data, out_size);
+}
+
+void nzp_buffer_free(uint8_t* data)
+{
+    std::free(data);
+}
+
+nzp_error_t nzp_compress_frame(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    int checksum,
+    uint8_t** out_data,
+    uint64_t* out_size
+) {
+    if ((!input && input_size) || !model || !model->impl || !out_data || !out_size) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_data = nullptr;
+    *out_size = 0;
+
+    std::vector<uint8_t> frame;
+    auto cache = model_cache(model);
+    neurozip::ResultCacheKey key;
+    if (cache) {
+        key = neurozip::result_cache_key(*model->impl, input, (size_t)input_size,
+                                         frame_cache_variant(checksum));
+        if (cache->lookup(key, frame)) return export_buffer(frame, out_data, out_size);
+    }
+
+    neurozip::write_compact_frame(*model->impl, input, (size_t)input_size, checksum != 0, frame);
+    if (cache) cache->insert(key, frame.data(), frame.size());
+    return export_buffer(frame, out_data, out_size);
+}
+
+nzp_error_t nzp_decompress_frame(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    uint8_t** out_data,
+    uint64_t* out_size
+) {
+    if (!input || !model || !model->impl || !out_data || !out_size) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_data = nullptr;
+    *out_size = 0;
+
+    std::vector<uint8_t> out;
+    auto ec = neurozip::read_compact_frame(*model->impl, input, (size_t)input_size, out);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    return export_buffer(out, out_data, out_size);
+}
+
+nzp_error_t nzp_file_fixed_point(const char* path, int* out_fixed_point)
+{
+    if (!path || !out_fixed_point) return NZP_ERR_INTERNAL;
+    uint8_t first = 0;
+    if (read_first_byte(path, first) && neurozip::is_compact_frame(&first, 1)) {
+        *out_fixed_point = (first & neurozip::NZC_FRAME_FIXED_POINT) ? 1 : 0;
+        return NZP_OK;
+    }
+    uint8_t magic[4] = { 0, 0, 0, 0 };
+    std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(magic), sizeof(magic));
+    if (neurozip::is_archive(magic, sizeof(magic))) {
+        neurozip::ArchiveIndex index;
+        auto ec = neurozip::read_archive_index(path, index);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+        *out_fixed_point = index.fixedPoint ? 1 : 0;
+        return NZP_OK;
+    }
+    neurozip::FileHeader header;
+    auto ec = neurozip::read_nzp_header(path, header);
+    if (ec != neurozip::ErrorCode::Ok) {
+        return to_nzp_error(ec);
+    }
+    *out_fixed_point = (header.flags & neurozip::NZP_FLAG_FIXED_POINT) ? 1 : 0;
+    return NZP_OK;
+}
+
+nzp_error_t nzp_file_primed_state(const char* path, uint32_t* out_id)
+{
+    if (!path || !out_id) return NZP_ERR_INTERNAL;
+    uint8_t head[32];
+    std::ifstream ifs(path, std::ios::binary);
+    ifs.read(reinterpret_cast<char*>(head), sizeof(head));
+    const size_t n = (size_t)ifs.gcount();
+    if (neurozip::is_compact_frame(head, n)) {
+        neurozip::CompactFrameInfo info;
+        auto ec = neurozip::parse_compact_frame(head, n, info);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+        *out_id = info.primedState;
+        return NZP_OK;
+    }
+    if (neurozip::is_archive(head, n)) {
+        neurozip::ArchiveIndex index;
+        auto ec = neurozip::read_archive_index(path, index);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+        *out_id = index.primedState;
+        return NZP_OK;
+    }
+    neurozip::FileHeader header;
+    auto ec = neurozip::read_nzp_header(path, header);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    *out_id = (uint32_t)header.primedState;
+    return NZP_OK;
+}
+
+nzp_error_t nzp_decompress_range(
+    const char* input_path,
+    const nzp_model_t* model,
+    uint64_t offset,
+    uint64_t length,
+    uint8_t* out_buffer,
+    uint64_t* out_size
+) {
+    if (!input_path || !model || !model->impl || !out_size || (length && !out_buffer)) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_size = 0;
+
+    neurozip::FileHeader header;
+    std::vector<uint8_t> payload;
+    auto ec = neurozip::read_nzp_file(input_path, header, payload);
+    if (ec != neurozip::ErrorCode::Ok) {
+        return to_nzp_error(ec);
+    }
+
+    nzp_error_t err = check_model(header, *model->impl);
+    if (err != NZP_OK) return err;
+
+    std::vector<uint8_t> out;
+    if (header.flags & neurozip::NZP_FLAG_SEGMENTED) {
+        // Decode only the segments that overlap the range.
+        neurozip::SegmentTable table;
+        if (!neurozip::parse_segment_table(payload.data(), payload.size(), table)) {
+            return NZP_ERR_CORRUPT;
+        }
+        uint64_t end = std::min<uint64_t>(header.originalSize, offset + length);
+        uint64_t segStart = 0;
+        size_t streamPos = table.dataOffset;
+        std::vector<uint8_t> segment;
+        for (size_t i = 0; i < table.count() && segStart < end; ++i) {
+            uint64_t segEnd = segStart + table.originalSizes[i];
+            if (segEnd > offset) {
+                if (!neurozip::decompress_buffer(*model->impl, payload.data() + streamPos,
+                                                 (size_t)table.streamSizes[i],
+                                                 (size_t)table.originalSizes[i], segment)) {
+                    return NZP_ERR_CORRUPT;
+                }
+                size_t lo = (size_t)(std::max(offset, segStart) - segStart);
+                size_t hi = (size_t)(std::min(end, segEnd) - segStart);
+                out.insert(out.end(), segment.begin() + lo, segment.begin() + hi);
+            }
+            segStart = segEnd;
+            streamPos += (size_t)table.streamSizes[i];
+        }
+    } else {
+        size_t streamSize = 0;
+        neurozip::CheckpointIndex checkpoints;
+        err = split_payload(header, payload, streamSize, checkpoints);
+        if (err != NZP_OK) return err;
+
+        bool reduced = (header.flags & neurozip::NZP_FLAG_ALPHABET) != 0;
+        if (!neurozip::decompress_range(*model->impl, payload.data(), streamSize, header.originalSize,
+                                        checkpoints, offset, (size_t)length, out, reduced)) {
+            return NZP_ERR_CORRUPT;
+        }
+    }
+
+    std::copy(out.begin(), out.end(), out_buffer);
+    *out_size = out.size();
+    return NZP_OK;
+}
+
+void nzp_estimate_options_init(nzp_estimate_options_t* options)
+{
+    if (!options) return;
+    neurozip::EstimateOptions defaults;
+    options->sample_bytes = defaults.sampleBytes;
+    options->windows = (uint32_t)defaults.windows;
+    options->threads = 1;
+}
+
+nzp_error_t nzp_estimate_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t* out_estimate
+) {
+    if ((!input && input_size) || !model || !model->impl || !out_estimate) {
+        return NZP_ERR_INTERNAL;
+    }
+    nzp_estimate_options_t opts;
+    nzp_estimate_options_init(&opts);
+    if (options) opts = *options;
+
+    neurozip::EstimateOptions eo;
+    eo.sampleBytes = opts.sample_bytes;
+    eo.windows = opts.windows;
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    if (opts.threads != 1) {
+        pool = model_pool(model, opts.threads, true);
+        eo.pool = pool.get();
+    }
+
+    neurozip::SizeEstimate e = neurozip::estimate_size(*model->impl, input, (size_t)input_size, eo);
+    out_estimate->input_bytes = e.inputBytes;
+    out_estimate->sampled_bytes = e.sampledBytes;
+    out_estimate->bits_per_byte = e.bits_per_byte();
+    out_estimate->estimated_bytes = e.file_bytes();
+    return NZP_OK;
+}
+
+nzp_error_t nzp_estimate_file(
+    const char* input_path,
+    const nzp_model_t* model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t* out_estimate
+) {
+    if (!input_path) return NZP_ERR_INTERNAL;
+    std::ifstream ifs(input_path, std::ios::binary);
+    if (!ifs) return NZP_ERR_IO;
+    std::vector<uint8_t> input((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return nzp_estimate_memory(input.data(), input.size(), model, options, out_estimate);
+}
+
+nzp_error_t nzp_profile_file(
+    const char* nzp_path,
+    const nzp_model_t* model,
+    uint64_t region_size,
+    double** out_bits_per_byte,
+    uint64_t* out_regions
+) {
+    if (!nzp_path || !model || !model->impl || region_size == 0 || !out_bits_per_byte || !out_regions) {
+        return NZP_ERR_INTERNAL;
+    }
+    *out_bits_per_byte = nullptr;
+    *out_regions = 0;
+
+    std::ifstream ifs(nzp_path, std::ios::binary);
+    if (!ifs) return NZP_ERR_IO;
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    // Cost the data in the mode it was coded in.
+    int fixedPoint = 0;
+    uint32_t primedState = 0;
+    nzp_error_t err = nzp_file_fixed_point(nzp_path, &fixedPoint);
+    if (err == NZP_OK) err = nzp_file_primed_state(nzp_path, &primedState);
+    if (err != NZP_OK) return err;
+    std::vector<std::unique_ptr<neurozip::ICompressionModel>> variants;
+    const neurozip::ICompressionModel* m = model_for_file(*model->impl, fixedPoint != 0, primedState, variants);
+    if (!m) return NZP_ERR_MODEL_MISMATCH;
+
+    std::vector<uint8_t> data;
+    std::vector<uint64_t> streamSizes;
+    if (!file.empty() && neurozip::is_compact_frame(file.data(), 1)) {
+        auto ec = neurozip::read_compact_frame(*m, file.data(), file.size(), data);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    } else {
+        neurozip::FileHeader header;
+        std::vector<uint8_t> payload;
+        auto ec = neurozip::read_nzp_file(nzp_path, header, payload);
+        if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+        err = decompress_impl(header, payload, *m, data);
+        if (err != NZP_OK) return err;
+        if (header.flags & neurozip::NZP_FLAG_SEGMENTED) {
+            neurozip::SegmentTable table;
+            neurozip::parse_segment_table(payload.data(), payload.size(), table);
+            streamSizes = table.originalSizes;
+        }
+    }
+
+    std::vector<double> bpb = neurozip::bit_profile(*m, data.data(), data.size(), (size_t)region_size,
+                                                    streamSizes);
+    double* buf = static_cast<double*>(std::malloc(bpb.empty() ? sizeof(double) : bpb.size() * sizeof(double)));
+    if (!buf) return NZP_ERR_INTERNAL;
+    std::copy(bpb.begin(), bpb.end(), buf);
+    *out_bits_per_byte = buf;
+    *out_regions = bpb.size();
+    return NZP_OK;
+}
+
+void nzp_profile_free(double* bits_per_byte)
+{
+    std::free(bits_per_byte);
+}
+
+void nzp_batch_options_init(nzp_batch_options_t* options)
+{
+    if (!options) return;
+    options->threads = 0;
+    options->segment_size = 1u << 20;
+    nzp_compress_options_init(&options->compress);
+    options->io_backend = NZP_IO_BLOCKING;
+    options->auto_tune = 0;
+    options->target_mbps = 0.0;
+    options->max_ratio_loss = 0.01;
+}
+
+int nzp_io_backend_available(nzp_io_backend_t backend)
+{
+    switch (backend) {
+        case NZP_IO_BLOCKING: return 1;
+        case NZP_IO_URING: return neurozip::io_backend_available(neurozip::IoBackendKind::IoUring) ? 1 : 0;
+        default: return 0;
+    }
+}
+
+static std::unique_ptr<neurozip::IoBackend> make_batch_io(const nzp_batch_options_t& opts)
+{
+    return neurozip::make_io_backend(opts.io_backend == NZP_IO_URING
+                                         ? neurozip::IoBackendKind::IoUring
+                                         : neurozip::IoBackendKind::Blocking);
+}
+
+/// A read started by a task's prepare() and collected by its run().
+using PendingRead = std::shared_ptr<std::future<neurozip::IoReadResult>>;
+
+/// Per-file state shared by the tasks of one batch entry.
+struct BatchFile {
+    std::string inputPath;
+    std::string outputPath;
+    neurozip::FileHeader header;        // decompression: input header
+    neurozip::SegmentTable table;       // segmented files
+    const neurozip::ICompressionModel* model = nullptr;
+
+    std::vector<std::vector<uint8_t>> streams; // compression: one per segment
+    std::vector<uint32_t> crcs;
+    std::vector<uint8_t> output;               // decompression: whole file
+    std::future<neurozip::ErrorCode> written;  // output write in flight
+
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    nzp_error_t error = NZP_OK;
+
+    void fail(nzp_error_t err)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error == NZP_OK) error = err;
+    }
+};
+
+/// Queue the output file on the batch's I/O backend; see wait_for_writes.
+static void write_output(BatchFile& f, neurozip::IoBackend& io, std::vector<uint8_t> data)
+{
+    f.written = io.write(f.outputPath, std::move(data));
+}
+
+static void wait_for_writes(const std::vector<std::unique_ptr<BatchFile>>& files)
+{
+    for (const auto& f : files) {
+        if (f->written.valid()) f->fail(to_nzp_error(f->written.get()));
+    }
+}
+
+/// Block on a queued read; the span shows how long a worker sat idle.
+static neurozip::IoReadResult wait_input(std::future<neurozip::IoReadResult>& input)
+{
+    neurozip::TraceSpan span("wait_input", "io");
+    return input.get();
+}
+
+static bool read_range(const std::string& path, uint64_t offset, size_t size, std::vector<uint8_t>& out)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    ifs.seekg((std::streamoff)offset, std::ios::beg);
+    out.resize(size);
+    if (size > 0) ifs.read(reinterpret_cast<char*>(out.data()), (std::streamsize)size);
+    return (bool)ifs;
+}
+
+/// All segments of a file are coded: checksum and write it.
+static void finish_compressed_file(BatchFile& f, neurozip::IoBackend& io)
+{
+    uint32_t crc = 0;
+    uint64_t total = 0;
+    std::vector<uint64_t> sizes;
+    for (size_t i = 0; i < f.streams.size(); ++i) {
+        sizes.push_back(f.table.originalSizes[i]);
+        crc = i == 0 ? f.crcs[0] : neurozip::crc32_combine(crc, f.crcs[i], sizes.back());
+        total += sizes.back();
+    }
+
+    neurozip::FileHeader header;
+    header.originalSize = total;
+    header.modelId = f.model->model_id();
+    header.modelHash = f.model->model_hash();
+    header.checksum = crc;
+    header.flags = neurozip::NZP_FLAG_SEGMENTED;
+    if (f.model->fixed_point()) header.flags |= neurozip::NZP_FLAG_FIXED_POINT;
+    header.primedState = neurozip::primed_state_tag(*f.model);
+
+    std::vector<uint8_t> payload;
+    neurozip::build_segmented_payload(f.streams, sizes, payload);
+    f.streams.clear();
+    std::vector<uint8_t> image;
+    neurozip::serialize_nzp(header, payload, image);
+    write_output(f, io, std::move(image));
+}
+
+/// All segments of a file are decoded: verify and write it.
+static void finish_decompressed_file(BatchFile& f, neurozip::IoBackend& io)
+{
+    if (f.error == NZP_OK) {
+        if (neurozip::crc32(f.output.data(), f.output.size()) != f.header.checksum) {
+            f.fail(NZP_ERR_CORRUPT);
+        } else {
+            write_output(f, io, std::move(f.output));
+        }
+    }
+    std::vector<uint8_t>().swap(f.output);
+}
+
+static nzp_error_t collect_errors(
+    const std::vector<std::unique_ptr<BatchFile>>& files,
+    nzp_error_t* out_errors
+) {
+    nzp_error_t first = NZP_OK;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (out_errors) out_errors[i] = files[i]->error;
+        if (first == NZP_OK) first = files[i]->error;
+    }
+    return first;
+}
+
+/// Pick workers and segment size for a batch from the tuning profile.
+static void auto_tune_batch(
+    const nzp_model_t* model,
+    const char* const* input_paths,
+    size_t count,
+    nzp_batch_options_t& opts
+) {
+    neurozip::TuneProfile profile;
+    if (!model_tune_profile(model, profile)) return;
+
+    std::vector<uint64_t> sizes;
+    size_t largest = count;
+    for (size_t i = 0; i < count; ++i) {
+        std::error_code ec;
+        uint64_t size = input_paths[i] ? std::filesystem::file_size(input_paths[i], ec) : 0;
+        sizes.push_back(ec ? 0 : size);
+        if (largest == count || sizes[i] > sizes[largest]) largest = i;
+    }
+
+    // Segmenting costs ratio in proportion to how much the model gains
+    // from warming up on this kind of input.
+    neurozip::CompressibilitySample sample;
+    std::vector<uint8_t> head;
+    if (largest < count && read_range(input_paths[largest], 0,
+                                      (size_t)std::min<uint64_t>(sizes[largest], 4096), head)) {
+        sample = neurozip::sample_compressibility(*model->impl, head.data(), head.size());
+    }
+
+    neurozip::TuneTarget target;
+    target.minMBps = opts.target_mbps;
+    target.maxRatioLoss = opts.max_ratio_loss;
+    auto tuned = neurozip::tune_batch(profile, sizes, sample, target, opts.threads);
+    opts.threads = tuned.threads;
+    opts.segment_size = tuned.segmentSize;
+}
+
+nzp_error_t nzp_compress_batch(
+    const char* const* input_paths,
+    const char* const* output_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_batch_options_t* options,
+    nzp_error_t* out_errors
+) {
+    if ((count && (!input_paths || !output_paths)) || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+    nzp_batch_options_t opts;
+    nzp_batch_options_init(&opts);
+    if (options) opts = *options;
+    if (opts.auto_tune) auto_tune_batch(model, input_paths, count, opts);
+
+    // Tasks code sequentially; the parallelism is across tasks.
+    neurozip::CompressOptions compress;
+    compress.checkpointInterval = opts.compress.checkpoint_interval;
+    compress.checkpointInt8 = opts.compress.checkpoint_int8 != 0;
+    const bool appendable = opts.compress.appendable != 0;
+    auto pool = model_pool(model, opts.threads, opts.compress.numa_aware != 0);
+    auto io = make_batch_io(opts);
+
+    std::vector<std::unique_ptr<BatchFile>> files;
+    std::vector<neurozip::ScheduledTask> tasks;
+    for (size_t i = 0; i < count; ++i) {
+        files.push_back(std::make_unique<BatchFile>());
+        BatchFile& f = *files.back();
+        f.inputPath = input_paths[i] ? input_paths[i] : "";
+        f.outputPath = output_paths[i] ? output_paths[i] : "";
+        f.model = model->impl.get();
+
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(f.inputPath, ec);
+        if (ec || f.outputPath.empty()) {
+            f.error = NZP_ERR_IO;
+            continue;
+        }
+
+        // Small files, and files with checkpoints or appendable, are one
+        // task and come out exactly as nzp_compress_file would write them.
+        if (opts.segment_size == 0 || size <= opts.segment_size || compress.checkpointInterval ||
+            appendable) {
+            auto input = std::make_shared<std::future<neurozip::IoReadResult>>();
+            tasks.push_back({ size, [&f, &pool, &io, input, compress, appendable](unsigned worker) {
+                neurozip::IoReadResult in = wait_input(*input);
+                if (in.error != neurozip::ErrorCode::Ok) {
+                    f.fail(to_nzp_error(in.error));
+                    return;
+                }
+                const auto& local = pool->local_model(*f.model, worker);
+                neurozip::FileHeader header;
+                std::vector<uint8_t> payload, image;
+                compress_impl(in.data.data(), in.data.size(), local, compress, header, payload,
+                              appendable);
+                neurozip::serialize_nzp(header, payload, image);
+                write_output(f, *io, std::move(image));
+            }, [&f, &io, input] { *input = io->read(f.inputPath); } });
+            continue;
+        }
+
+        size_t segments = (size_t)((size + opts.segment_size - 1) / opts.segment_size);
+        f.streams.resize(segments);
+        f.crcs.resize(segments);
+        for (size_t k = 0; k < segments; ++k) {
+            uint64_t offset = (uint64_t)k * opts.segment_size;
+            f.table.originalSizes.push_back(std::min<uint64_t>(opts.segment_size, size - offset));
+        }
+        f.remaining = segments;
+
+        for (size_t k = 0; k < segments; ++k) {
+            uint64_t offset = (uint64_t)k * opts.segment_size;
+            size_t length = (size_t)f.table.originalSizes[k];
+            auto input = std::make_shared<std::future<neurozip::IoReadResult>>();
+            tasks.push_back({ length, [&f, &pool, &io, input, k](unsigned worker) {
+                neurozip::IoReadResult in = wait_input(*input);
+                if (in.error != neurozip::ErrorCode::Ok) {
+                    f.fail(to_nzp_error(in.error));
+                } else {
+                    const auto& local = pool->local_model(*f.model, worker);
+                    f.streams[k] = neurozip::compress_buffer(local, in.data.data(), in.data.size());
+                    f.crcs[k] = neurozip::crc32(in.data.data(), in.data.size());
+                }
+                if (--f.remaining == 0 && f.error == NZP_OK) finish_compressed_file(f, *io);
+            }, [&f, &io, input, offset, length] { *input = io->read(f.inputPath, offset, length); } });
+        }
+    }
+
+    neurozip::run_work_stealing(*pool, tasks);
+    wait_for_writes(files);
+    return collect_errors(files, out_errors);
+}
+
+/// Read the header and, for segmented files, the segment table.
+static nzp_error_t read_batch_header(BatchFile& f)
+{
+    auto ec = neurozip::read_nzp_header(f.inputPath, f.header);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    if (!(f.header.flags & neurozip::NZP_FLAG_SEGMENTED)) return NZP_OK;
+
+    std::error_code fsErr;
+    uint64_t fileSize = std::filesystem::file_size(f.inputPath, fsErr);
+    if (fsErr || fileSize < sizeof(neurozip::FileHeader) + 4) return NZP_ERR_CORRUPT;
+    size_t payloadSize = (size_t)(fileSize - sizeof(neurozip::FileHeader));
+
+    std::vector<uint8_t> count;
+    if (!read_range(f.inputPath, sizeof(neurozip::FileHeader), 4, count)) return NZP_ERR_IO;
+    size_t tableSize = 4 + 16 * (size_t)(count[0] | (count[1] << 8) | (count[2] << 16) | ((uint32_t)count[3] << 24));
+    if (tableSize > payloadSize) return NZP_ERR_CORRUPT;
+
+    // parse_segment_table checks the streams against the real payload size,
+    // so pass that along with just the table bytes.
+    std::vector<uint8_t> table;
+    if (!read_range(f.inputPath, sizeof(neurozip::FileHeader), tableSize, table)) return NZP_ERR_IO;
+    table.resize(payloadSize);
+    if (!neurozip::parse_segment_table(table.data(), table.size(), f.table)) return NZP_ERR_CORRUPT;
+
+    uint64_t total = 0;
+    for (uint64_t n : f.table.originalSizes) total += n;
+    return total == f.header.originalSize ? NZP_OK : NZP_ERR_CORRUPT;
+}
+
+nzp_error_t nzp_decompress_batch(
+    const char* const* input_paths,
+    const char* const* output_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_batch_options_t* options,
+    nzp_error_t* out_errors
+) {
+    if ((count && (!input_paths || !output_paths)) || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+    nzp_batch_options_t opts;
+    nzp_batch_options_init(&opts);
+    if (options) opts = *options;
+
+    auto pool = model_pool(model, opts.threads, opts.compress.numa_aware != 0);
+    auto io = make_batch_io(opts);
+
+    // Files coded in the other inference mode or from another primed
+    // state use a copy of the model.
+    std::vector<std::unique_ptr<neurozip::ICompressionModel>> variants;
+
+    std::vector<std::unique_ptr<BatchFile>> files;
+    std::vector<neurozip::ScheduledTask> tasks;
+    for (size_t i = 0; i < count; ++i) {
+        files.push_back(std::make_unique<BatchFile>());
+        BatchFile& f = *files.back();
+        f.inputPath = input_paths[i] ? input_paths[i] : "";
+        f.outputPath = output_paths[i] ? output_paths[i] : "";
+        if (f.outputPath.empty()) {
+            f.error = NZP_ERR_IO;
+            continue;
+        }
+
+        f.error = read_batch_header(f);
+        if (f.error != NZP_OK) continue;
+
+        bool fixedPoint = (f.header.flags & neurozip::NZP_FLAG_FIXED_POINT) != 0;
+        f.model = model_for_file(*model->impl, fixedPoint, (uint32_t)f.header.primedState, variants);
+        if (!f.model) {
+            f.error = NZP_ERR_MODEL_MISMATCH;
+            continue;
+        }
+        f.error = check_model(f.header, *f.model);
+        if (f.error != NZP_OK) continue;
+
+        if (!(f.header.flags & neurozip::NZP_FLAG_SEGMENTED)) {
+            auto input = std::make_shared<std::future<neurozip::IoReadResult>>();
+            tasks.push_back({ f.header.originalSize, [&f, &pool, &io, input](unsigned worker) {
+                neurozip::IoReadResult in = wait_input(*input);
+                neurozip::FileHeader header;
+                std::vector<uint8_t> payload, out;
+                nzp_error_t err = to_nzp_error(in.error);
+                if (err == NZP_OK) {
+                    err = to_nzp_error(neurozip::parse_nzp(in.data.data(), in.data.size(), header, payload));
+                }
+                if (err == NZP_OK) {
+                    err = decompress_impl(header, payload, pool->local_model(*f.model, worker), out);
+                }
+                if (err != NZP_OK) {
+                    f.fail(err);
+                    return;
+                }
+                write_output(f, *io, std::move(out));
+            }, [&f, &io, input] { *input = io->read(f.inputPath); } });
+            continue;
+        }
+
+        f.remaining = f.table.count();
+        if (f.table.count() == 0) {
+            finish_decompressed_file(f, *io);
+            continue;
+        }
+
+        uint64_t outOffset = 0;
+        uint64_t streamOffset = sizeof(neurozip::FileHeader) + f.table.dataOffset;
+        for (size_t k = 0; k < f.table.count(); ++k) {
+            uint64_t length = f.table.originalSizes[k];
+            size_t streamSize = (size_t)f.table.streamSizes[k];
+            auto input = std::make_shared<std::future<neurozip::IoReadResult>>();
+            tasks.push_back({ length, [&f, &pool, &io, input, outOffset, length](unsigned worker) {
+                std::vector<uint8_t> segment;
+                neurozip::IoReadResult stream = wait_input(*input);
+                const auto& local = pool->local_model(*f.model, worker);
+                if (stream.error != neurozip::ErrorCode::Ok) {
+                    f.fail(to_nzp_error(stream.error));
+                } else if (!neurozip::decompress_buffer(local, stream.data.data(), stream.data.size(),
+                                                        (size_t)length, segment)) {
+                    f.fail(NZP_ERR_CORRUPT);
+                } else {
+                    {
+                        // The whole-file buffer exists only while the file is in flight.
+                        std::lock_guard<std::mutex> lock(f.mutex);
+                        if (f.output.empty()) f.output.resize((size_t)f.header.originalSize);
+                    }
+                    std::copy(segment.begin(), segment.end(), f.output.begin() + (size_t)outOffset);
+                }
+                if (--f.remaining == 0) finish_decompressed_file(f, *io);
+            }, [&f, &io, input, streamOffset, streamSize] {
+                *input = io->read(f.inputPath, streamOffset, streamSize);
+            } });
+            outOffset += length;
+            streamOffset += streamSize;
+        }
+    }
+
+    neurozip::run_work_stealing(*pool, tasks);
+    wait_for_writes(files);
+    return collect_errors(files, out_errors);
+}
+
+/// Rewrite a file that has no saved encoder state as an appendable one.
+static nzp_error_t append_by_rewrite(
+    const char* nzp_path,
+    const uint8_t* data,
+    size_t size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+) {
+    neurozip::FileHeader header;
+    std::vector<uint8_t> payload, contents;
+    auto ec = neurozip::read_nzp_file(nzp_path, header, payload);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    nzp_error_t err = decompress_impl(header, payload, *model->impl, contents);
+    if (err != NZP_OK) return err;
+    contents.insert(contents.end(), data, data + size);
+
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    neurozip::FileHeader newHeader;
+    compress_impl(contents.data(), contents.size(), *model->impl,
+                  to_compress_options(model, options, pool, contents.size()), newHeader, payload, true);
+    const std::string tmpPath = neurozip::replacement_path(nzp_path);
+    ec = neurozip::write_nzp_file(tmpPath, newHeader, payload);
+    if (ec != neurozip::ErrorCode::Ok) {
+        std::error_code fsErr;
+        std::filesystem::remove(tmpPath, fsErr);
+        return to_nzp_error(ec);
+    }
+    return to_nzp_error(neurozip::replace_file(tmpPath, nzp_path));
+}
+
+/// Read the u64 stored at payload offset 'pos' of an open .nzp file.
+static bool read_payload_u64(std::fstream& fs, uint64_t pos, uint64_t& value)
+{
+    uint8_t b[8];
+    fs.seekg((std::streamoff)(sizeof(neurozip::FileHeader) + pos), std::ios::beg);
+    if (!fs.read(reinterpret_cast<char*>(b), 8)) return false;
+    value = 0;
+    for (int i = 0; i < 8; i++) value |= (uint64_t)b[i] << (8 * i);
+    return true;
+}
+
+nzp_error_t nzp_append_memory(
+    const char* nzp_path,
+    const uint8_t* data,
+    uint64_t size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+) {
+    if (!nzp_path || (!data && size) || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+
+    neurozip::FileHeader header;
+    auto ec = neurozip::read_nzp_header(nzp_path, header);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    nzp_error_t err = check_model(header, *model->impl);
+    if (err != NZP_OK) return err;
+
+    if (!(header.flags & neurozip::NZP_FLAG_APPENDABLE) ||
+        (header.flags & neurozip::NZP_FLAG_SEGMENTED)) {
+        return append_by_rewrite(nzp_path, data, (size_t)size, model, options);
+    }
+
+    std::error_code fsErr;
+    uint64_t fileSize = std::filesystem::file_size(nzp_path, fsErr);
+    if (fsErr || fileSize < sizeof(neurozip::FileHeader) + 8) return NZP_ERR_CORRUPT;
+    const uint64_t payloadSize = fileSize - sizeof(neurozip::FileHeader);
+
+    std::fstream fs(nzp_path, std::ios::in | std::ios::binary);
+    if (!fs) return NZP_ERR_IO;
+
+    // Only the trailers are read: [stream][checkpoint index][state].
+    uint64_t stateSize = 0, indexSize = 0;
+    if (!read_payload_u64(fs, payloadSize - 8, stateSize)) return NZP_ERR_IO;
+    if (stateSize > payloadSize - 8) return NZP_ERR_CORRUPT;
+    uint64_t tailStart = payloadSize - 8 - stateSize;
+    if (header.flags & neurozip::NZP_FLAG_CHECKPOINTS) {
+        if (tailStart < 8 || !read_payload_u64(fs, tailStart - 8, indexSize)) return NZP_ERR_CORRUPT;
+        if (indexSize > tailStart - 8) return NZP_ERR_CORRUPT;
+        tailStart -= 8 + indexSize;
+    }
+
+    std::vector<uint8_t> tail((size_t)(payloadSize - tailStart));
+    fs.seekg((std::streamoff)(sizeof(neurozip::FileHeader) + tailStart), std::ios::beg);
+    if (!fs.read(reinterpret_cast<char*>(tail.data()), (std::streamsize)tail.size())) return NZP_ERR_IO;
+
+    neurozip::StreamState state;
+    neurozip::CheckpointIndex checkpoints;
+    size_t rest = 0, streamSize = 0;
+    if (!neurozip::split_stream_state(tail.data(), tail.size(), rest, state, tailStart)) {
+        return NZP_ERR_CORRUPT;
+    }
+    streamSize = rest;
+    if ((header.flags & neurozip::NZP_FLAG_CHECKPOINTS) &&
+        !neurozip::split_checkpoint_index(tail.data(), (size_t)(rest - tailStart), streamSize,
+                                          checkpoints, tailStart)) {
+        return NZP_ERR_CORRUPT;
+    }
+    if (streamSize != state.streamPos + 4 || state.bytePos != header.originalSize) {
+        return NZP_ERR_CORRUPT;
+    }
+
+    // Replace the final flush with the continued stream, then the trailers.
+    std::shared_ptr<neurozip::WorkerPool> pool;
+    auto opts = to_compress_options(model, options, pool, size);
+    std::vector<uint8_t> out = neurozip::continue_buffer(*model->impl, state, data, (size_t)size, opts,
+                                                         &checkpoints);
+    if (checkpoints.enabled()) neurozip::append_checkpoint_index(checkpoints, out);
+    neurozip::append_stream_state(state, out);
+
+    fs.close();
+
+    // The update goes to a copy that replaces the file once complete, so a
+    // crash or a full disk midway leaves the old file decodable. Copying
+    // does not decode anything; only the new data is coded.
+    const std::string tmpPath = neurozip::replacement_path(nzp_path);
+    auto fail = [&] {
+        std::filesystem::remove(tmpPath, fsErr);
+        return NZP_ERR_IO;
+    };
+    std::filesystem::copy_file(nzp_path, tmpPath, std::filesystem::copy_options::overwrite_existing, fsErr);
+    if (fsErr) return fail();
+    std::fstream tmp(tmpPath, std::ios::in | std::ios::out | std::ios::binary);
+    if (!tmp) return fail();
+
+    const uint64_t writePos = sizeof(neurozip::FileHeader) + (streamSize - 4);
+    tmp.seekp((std::streamoff)writePos, std::ios::beg);
+    tmp.write(reinterpret_cast<const char*>(out.data()), (std::streamsize)out.size());
+
+    // Size and CRC of the concatenated input.
+    header.checksum = neurozip::crc32_combine(header.checksum, neurozip::crc32(data, (size_t)size), size);
+    header.originalSize += size;
+    tmp.seekp(0, std::ios::beg);
+    tmp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    tmp.close();
+    if (!tmp) return fail();
+
+    uint64_t newSize = writePos + out.size();
+    if (newSize < fileSize) {
+        std::filesystem::resize_file(tmpPath, newSize, fsErr);
+        if (fsErr) return fail();
+    }
+    return to_nzp_error(neurozip::replace_file(tmpPath, nzp_path));
+}
+
+nzp_error_t nzp_append_file(
+    const char* nzp_path,
+    const char* input_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+) {
+    if (!nzp_path || !input_path || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+    std::ifstream ifs(input_path, std::ios::binary);
+    if (!ifs) return NZP_ERR_IO;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return nzp_append_memory(nzp_path, data.data(), data.size(), model, options);
+}
+
+nzp_error_t nzp_tune(const nzp_model_t* model, const char* profile_path)
+{
+    if (!model || !model->impl) return NZP_ERR_INTERNAL;
+    auto profile = neurozip::calibrate_host(*model->impl);
+    std::string path = profile_path ? profile_path : neurozip::default_tune_profile_path();
+    if (!neurozip::save_tune_profile(profile, path)) return NZP_ERR_IO;
+
+    std::lock_guard<std::mutex> lock(model->tuneMutex);
+    model->tune = std::make_unique<neurozip::TuneProfile>(profile);
+    model->tuneLoaded = true;
+    return NZP_OK;
+}
+
+nzp_error_t nzp_model_set_tune_profile(nzp_model_t* model, const char* profile_path)
+{
+    if (!model || !model->impl) return NZP_ERR_INTERNAL;
+    neurozip::TuneProfile profile;
+    std::string path = profile_path ? profile_path : neurozip::default_tune_profile_path();
+    if (!std::filesystem::exists(path)) return NZP_ERR_IO;
+    if (!neurozip::load_tune_profile(path, profile)) return NZP_ERR_INVALID_FORMAT;
+
+    std::lock_guard<std::mutex> lock(model->tuneMutex);
+    model->tune = std::make_unique<neurozip::TuneProfile>(profile);
+    model->tuneLoaded = true;
+    return NZP_OK;
+}
+
+const char* nzp_tune_default_path(void)
+{
+    static const std::string path = neurozip::default_tune_profile_path();
+    return path.c_str();
+}
+
+void nzp_archive_options_init(nzp_archive_options_t* options)
+{
+    if (!options) return;
+    options->threads = 0;
+    options->chunk_size = 64 * 1024;
+    options->base_path = nullptr;
+}
+
+nzp_error_t nzp_archive_create(
+    const char* archive_path,
+    const char* const* input_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_archive_options_t* options,
+    nzp_archive_stats_t* out_stats
+) {
+    if (!archive_path || (count && !input_paths) || !model || !model->impl) {
+        return NZP_ERR_INTERNAL;
+    }
+    nzp_archive_options_t opts;
+    nzp_archive_options_init(&opts);
+    if (options) opts = *options;
+
+    std::vector<std::string> inputs;
+    for (size_t i = 0; i < count; ++i) {
+        if (!input_paths[i]) return NZP_ERR_INTERNAL;
+        inputs.push_back(input_paths[i]);
+    }
+    neurozip::ArchiveOptions archive;
+    if (opts.chunk_size) archive.chunkSize = opts.chunk_size;
+    if (opts.base_path) archive.basePath = opts.base_path;
+
+    auto pool = model_pool(model, opts.threads, true);
+    neurozip::ArchiveStats stats;
+    auto ec = neurozip::create_archive(*model->impl, *pool, inputs, archive_path, archive, &stats);
+    if (ec != neurozip::ErrorCode::Ok) return to_nzp_error(ec);
+    if (out_stats) {
+        out_stats->input_bytes = stats.inputBytes;
+        out_stats->chunks = stats.chunks;
+        out_stats->unique_chunks = stats.uniqueChunks;
+        out_stats->unique_bytes = stats.uniqueBytes;
+        out_stats->coded_chunks = stats.codedChunks;
+        out_stats->coded_bytes = stats.codedBytes;
+        out_stats->archive_bytes = stats.archiveBytes;
+    }
+    return NZP_OK;
+}
+
+nzp_error_t nzp_archive_extract(
+    const char* archive_path,
+    const char* output_dir,
+    const nzp_model_t* model,
+    unsigned threads
+) {
+    if (!archive_path || !output_dir || !model || !model->impl) return NZP_ERR_INTERNAL;
+    auto pool = model_pool(model, threads, true);
+    return to_nzp_error(neurozip::extract_archive(*model->impl, *pool, archive_path, output_dir));
+}
+
+nzp_cache_t* nzp_cache_create(uint64_t capacity_bytes)
+{
+    auto cache = new nzp_cache;
+    cache->impl = std::make_shared<neurozip::ResultCache>((size_t)capacity_bytes);
+    return cache;
+}
+
+void nzp_cache_free(nzp_cache_t* cache)
+{
+    delete cache;
+}
+
+void nzp_cache_clear(nzp_cache_t* cache)
+{
+    if (cache) cache->impl->clear();
+}
+
+void nzp_cache_get_stats(const nzp_cache_t* cache, nzp_cache_stats_t* out_stats)
+{
+    if (!cache || !out_stats) return;
+    neurozip::ResultCacheStats s = cache->impl->stats();
+    out_stats->hits = s.hits;
+    out_stats->misses = s.misses;
+    out_stats->insertions = s.insertions;
+    out_stats->evictions = s.evictions;
+    out_stats->entries = s.entries;
+    out_stats->bytes = s.bytes;
+    out_stats->capacity_bytes = s.capacity;
+}
+
+void nzp_model_set_cache(nzp_model_t* model, const nzp_cache_t* cache)
+{
+    if (!model) return;
+    std::lock_guard<std::mutex> lock(model->cacheMutex);
+    model->cache = cache ? cache->impl : nullptr;
+}
+
+void nzp_trace_start(void)
+{
+    neurozip::trace_start();
+}
+
+void nzp_trace_stop(void)
+{
+    neurozip::trace_stop();
+}
+
+nzp_error_t nzp_trace_write(const char* path)
+{
+    if (!path) return NZP_ERR_INTERNAL;
+    return neurozip::write_chrome_trace(path) ? NZP_OK : NZP_ERR_IO;
+}
+
+void nzp_model_set_job_threads(nzp_model_t* model, unsigned threads)
+{
+    if (!model) return;
+    std::shared_ptr<neurozip::JobQueue> old;
+    {
+        std::lock_guard<std::mutex> lock(model->jobsMutex);
+        if (model->jobThreads == threads) return;
+        model->jobThreads = threads;
+        old = std::move(model->jobs);
+    }
+    // Runs the old executor's queue and joins it, outside the lock.
+}
+
+static void release_job(nzp_job_t* job)
+{
+    if (job->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete job;
+}
+
+/// Call back (unless 'notify' is false) and wake the waiters.
+static void finish_job(nzp_job_t* job, nzp_error_t result, bool notify)
+{
+    if (notify && job->callback) job->callback(job, result, job->userData);
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+    }
+    job->done.notify_all();
+}
+
+static nzp_job_t* submit_job(
+    const nzp_model_t* model,
+    std::function<nzp_error_t(nzp_job_t*)> work,
+    bool memoryJob,
+    nzp_job_callback_t callback,
+    void* userData
+) {
+    std::shared_ptr<neurozip::JobQueue> jobs;
+    {
+        std::lock_guard<std::mutex> lock(model->jobsMutex);
+        if (!model->jobs) model->jobs = std::make_shared<neurozip::JobQueue>(model->jobThreads);
+        jobs = model->jobs;
+    }
+
+    auto job = new nzp_job;
+    job->work = std::move(work);
+    job->memoryJob = memoryJob;
+    job->callback = callback;
+    job->userData = userData;
+
+    jobs->post([job] {
+        int queued = NZP_JOB_QUEUED;
+        if (job->status.compare_exchange_strong(queued, NZP_JOB_RUNNING)) {
+            neurozip::TraceSpan span("job", "api");
+            job->result = job->work(job);
+            job->work = nullptr;
+            job->status.store(NZP_JOB_DONE, std::memory_order_release);
+            finish_job(job, job->result, true);
+        }
+        release_job(job);
+    });
+    return job;
+}
+
+nzp_job_t* nzp_submit_compress(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    nzp_job_callback_t callback,
+    void* user_data
+) {
+    if ((!input && input_size) || !model || !model->impl) return nullptr;
+    nzp_compress_options_t opts;
+    nzp_compress_options_init(&opts);
+    if (options) opts = *options;
+    return submit_job(model, [=](nzp_job_t* job) {
+        return nzp_compress_memory(input, input_size, model, &opts, &job->output, &job->outputSize);
+    }, true, callback, user_data);
+}
+
+nzp_job_t* nzp_submit_decompress(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    nzp_job_callback_t callback,
+    void* user_data
+) {
+    if ((!input && input_size) || !model || !model->impl) return nullptr;
+    return submit_job(model, [=](nzp_job_t* job) {
+        return nzp_decompress_memory(input, input_size, model, &job->output, &job->outputSize);
+    }, true, callback, user_data);
+}
+
+nzp_job_t* nzp_submit_compress_file(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    nzp_job_callback_t callback,
+    void* user_data
+) {
+    if (!input_path || !output_path || !model || !model->impl) return nullptr;
+    nzp_compress_options_t opts;
+    nzp_compress_options_init(&opts);
+    if (options) opts = *options;
+    std::string in(input_path), out(output_path);
+    return submit_job(model, [=](nzp_job_t*) {
+        return nzp_compress_file_ex(in.c_str(), out.c_str(), model, &opts);
+    }, false, callback, user_data);
+}
+
+nzp_job_t* nzp_submit_decompress_file(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    nzp_job_callback_t callback,
+    void* user_data
+) {
+    if (!input_path || !output_path || !model || !model->impl) return nullptr;
+    std::string in(input_path), out(output_path);
+    return submit_job(model, [=](nzp_job_t*) {
+        return nzp_decompress_file(in.c_str(), out.c_str(), model);
+    }, false, callback, user_data);
+}
+
+nzp_job_status_t nzp_job_poll(const nzp_job_t* job)
+{
+    if (!job) return NZP_JOB_CANCELLED;
+    return (nzp_job_status_t)job->status.load(std::memory_order_acquire);
+}
+
+int nzp_job_wait(nzp_job_t* job, int64_t timeout_ms)
+{
+    if (!job) return 1;
+    std::unique_lock<std::mutex> lock(job->mutex);
+    if (timeout_ms < 0) {
+        job->done.wait(lock, [&] { return job->finished; });
+        return 1;
+    }
+    return job->done.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                              [&] { return job->finished; }) ? 1 : 0;
+}
+
+nzp_error_t nzp_job_result(const nzp_job_t* job)
+{
+    switch (nzp_job_poll(job)) {
+        case NZP_JOB_DONE: return job->result;
+        case NZP_JOB_CANCELLED: return NZP_ERR_CANCELLED;
+        default: return NZP_ERR_INTERNAL;
+    }
+}
+
+int nzp_job_cancel(nzp_job_t* job)
+{
+    if (!job) return 0;
+    int queued = NZP_JOB_QUEUED;
+    if (!job->status.compare_exchange_strong(queued, NZP_JOB_CANCELLED)) return 0;
+    finish_job(job, NZP_ERR_CANCELLED, true);
+    return 1;
+}
+
+nzp_error_t nzp_job_take_output(nzp_job_t* job, uint8_t** out_data, uint64_t* out_size)
+{
+    if (!job || !out_data || !out_size) return NZP_ERR_INTERNAL;
+    nzp_error_t result = nzp_job_result(job);
+    if (nzp_job_poll(job) != NZP_JOB_DONE || result != NZP_OK) return result;
+    if (!job->memoryJob || !job->output) return NZP_ERR_INTERNAL;
+    *out_data = job->output;
+    *out_size = job->outputSize;
+    job->output = nullptr;
+    job->outputSize = 0;
+    return NZP_OK;
+}
+
+void nzp_job_free(nzp_job_t* job)
+{
+    if (!job) return;
+    int queued = NZP_JOB_QUEUED;
+    if (job->status.compare_exchange_strong(queued, NZP_JOB_CANCELLED)) {
+        finish_job(job, NZP_ERR_CANCELLED, false);
+    }
+    release_job(job);
+}
+
+nzp_model_slot_t* nzp_model_slot_create(nzp_model_t* model)
+{
+    if (model && (!model->impl || model->slotEntry)) return nullptr;
+    auto slot = new nzp_model_slot;
+    if (model) nzp_model_slot_swap(slot, model, 0);
+    return slot;
+}
+
+void nzp_model_slot_free(nzp_model_slot_t* slot)
+{
+    delete slot;
+}
+
+nzp_error_t nzp_model_slot_swap(nzp_model_slot_t* slot, nzp_model_t* model, int keep_previous)
+{
+    if (!slot || !model || !model->impl || model->slotEntry) return NZP_ERR_INTERNAL;
+    // The entry is recorded before publishing, so any lease can find it.
+    model->slotEntry = slot->models.create(model, model->impl->model_hash());
+    slot->models.publish(model->slotEntry, keep_previous != 0);
+    return NZP_OK;
+}
+
+nzp_model_t* nzp_model_slot_acquire(const nzp_model_slot_t* slot)
+{
+    if (!slot) return nullptr;
+    ModelSwap::Entry* e = slot->models.acquire();
+    return e ? e->object : nullptr;
+}
+
+/// Lease on the model that wrote the data starting with 'head' (at most
+/// 'size' bytes), else on the current one. 'archiveHash' is the model hash
+/// of an archive, already read by the caller.
+static nzp_model_t* acquire_for_head(
+    const nzp_model_slot_t* slot,
+    const uint8_t* head,
+    size_t size,
+    uint64_t archiveHash
+) {
+    ModelSwap::Entry* e = nullptr;
+    neurozip::FileHeader header;
+    if (archiveHash != 0) {
+        e = slot->models.acquire_if([&](const ModelSwap::Entry& m) { return m.key == archiveHash; });
+    } else if (neurozip::is_compact_frame(head, size)) {
+        neurozip::CompactFrameInfo info;
+        if (neurozip::parse_compact_frame(head, size, info) == neurozip::ErrorCode::Ok) {
+            e = slot->models.acquire_if([&](const ModelSwap::Entry& m) {
+                return neurozip::model_tag(*m.object->impl) == info.modelTag;
+            });
+        }
+    } else if (size >= sizeof(header)) {
+        std::memcpy(&header, head, sizeof(header));
+        // Hash 0 (older writers) decodes with any model of the right id.
+        if (header.magic == neurozip::NZP_MAGIC && header.modelHash != 0) {
+            e = slot->models.acquire_if([&](const ModelSwap::Entry& m) { return m.key == header.modelHash; });
+        }
+    }
+    if (!e) e = slot->models.acquire();
+    return e ? e->object : nullptr;
+}
+
+nzp_model_t* nzp_model_slot_acquire_for_memory(
+    const nzp_model_slot_t* slot,
+    const uint8_t* input,
+    uint64_t input_size
+) {
+    if (!slot) return nullptr;
+    if (!input) return nzp_model_slot_acquire(slot);
+    return acquire_for_head(slot, input, (size_t)input_size, 0);
+}
+
+nzp_model_t* nzp_model_slot_acquire_for_file(const nzp_model_slot_t* slot, const char* path)
+{
+    if (!slot) return nullptr;
+    if (!path) return nzp_model_slot_acquire(slot);
+    uint8_t head[sizeof(neurozip::FileHeader)];
+    std::ifstream ifs(path, std::ios::binary);
+    ifs.read(reinterpret_cast<char*>(head), sizeof(head));
+    const size_t n = (size_t)ifs.gcount();
+    uint64_t archiveHash = 0;
+    if (neurozip::is_archive(head, n)) {
+        neurozip::ArchiveIndex index;
+        if (neurozip::read_archive_index(path, index) == neurozip::ErrorCode::Ok) archiveHash = index.modelHash;
+    }
+    return acquire_for_head(slot, head, n, archiveHash);
+}
+
+void nzp_model_slot_release(nzp_model_t* model)
+{
+    if (model && model->slotEntry) ModelSwap::release(model->slotEntry);
+}
+
+size_t nzp_model_slot_forget(nzp_model_slot_t* slot, uint64_t model_hash)
+{
+    if (!slot) return 0;
+    return slot->models.drop(model_hash);
+}
+
 const char* nzp_strerror(nzp_error_t err)
 {
     switch (err) {
@@ -140,6 +1928,7 @@ const char* nzp_strerror(nzp_error_t err)
         case NZP_ERR_MODEL_MISMATCH: return "model mismatch";
         case NZP_ERR_CORRUPT: return "corrupt compressed data";
         case NZP_ERR_INTERNAL: return "internal error";
+        case NZP_ERR_CANCELLED: return "cancelled";
         default: return "unknown error";
     }
 }
@@ -8,6 +8,8 @@ extern "C" {
 #endif
 
 typedef struct nzp_model nzp_model_t;
+typedef struct nzp_cache nzp_cache_t;
+typedef struct nzp_model_slot nzp_model_slot_t;
 
 typedef enum {
     NZP_OK = 0,
@@ -16,15 +18,280 @@ typedef enum {
     NZP_ERR_UNSUPPORTED_VERSION,
     NZP_ERR_MODEL_MISMATCH,
     NZP_ERR_CORRUPT,
-    NZP_ERR_INTERNAL
+    NZP_ERR_INTERNAL,
+    NZP_ERR_CANCELLED
 } nzp_error_t;
 
+/// Encoder tuning knobs for nzp_compress_file_ex.
+typedef struct {
+    /// Two-phase encoding: recurrence pass, then a batched (and threaded)
+    /// output layer, then serial range coding. Output is identical to the
+    /// default path.
+    int two_phase;
+
+    /// Threads for the batched output layer (0 = all hardware threads).
+    unsigned threads;
+
+    /// Pin output-layer threads per NUMA node, each reading a node-local
+    /// copy of the weights (default 1). The threads and replicas are kept
+    /// with the model and reused by later calls.
+    int numa_aware;
+
+    /// Store a model-state checkpoint every N input bytes (0 = off), so
+    /// nzp_decompress_range can start near any offset. Token-vocabulary
+    /// models write no checkpoints.
+    uint32_t checkpoint_interval;
+
+    /// Store checkpoint states as int8 instead of fp16 (smaller, lossier).
+    int checkpoint_int8;
+
+    /// Run range coding on a second thread fed by the model thread, so a
+    /// single stream uses two cores. Output is identical; ignored when
+    /// two_phase applies.
+    int pipelined;
+
+    /// End the file with the final model and range coder state (8 bytes
+    /// per hidden unit plus 37) so nzp_append_* can extend it without
+    /// recoding the old contents.
+    /// Ignored for token-vocabulary models, whose files are rewritten.
+    int appendable;
+
+    /// Choose two_phase / threads / pipelined from the host's tuning
+    /// profile (see nzp_tune) and the input size, overriding those fields.
+    /// Without a profile the fields are used as given. Output is the same.
+    int auto_tune;
+
+    /// Code over only the byte values the input contains: the stream
+    /// starts with a 32-byte bitmap of them, and the output layer computes
+    /// and normalizes just those rows. Faster and slightly smaller on text
+    /// that uses few distinct bytes. Ignored for appendable files and for
+    /// nibble-head and token-vocabulary models.
+    int reduced_alphabet;
+} nzp_compress_options_t;
+
+/// Fill options with defaults (single-threaded, one step at a time).
+void nzp_compress_options_init(nzp_compress_options_t* options);
+
+/// How batch calls read inputs and write outputs.
+typedef enum {
+    /// Blocking reads and writes on the worker threads (portable default).
+    NZP_IO_BLOCKING = 0,
+    /// Linux io_uring: each worker queues the read for its next task before
+    /// running the current one, and outputs are written in the background.
+    /// Falls back to NZP_IO_BLOCKING where io_uring is unavailable.
+    NZP_IO_URING = 1
+} nzp_io_backend_t;
+
+/// Nonzero if 'backend' can be used on this build and machine.
+int nzp_io_backend_available(nzp_io_backend_t backend);
+
+/// Options for nzp_compress_batch / nzp_decompress_batch.
+typedef struct {
+    /// Worker threads shared by the whole batch (0 = all cores).
+    unsigned threads;
+
+    /// Files larger than this are split into segments of this size that
+    /// are coded independently (each from a fresh model state) so one
+    /// large file can use several cores. 0 = never split. Default 1 MiB.
+    uint64_t segment_size;
+
+    /// Encoder options applied to every file. two_phase/threads/pipelined
+    /// are ignored (the batch is parallel across tasks instead); files with
+    /// checkpoints are never split. numa_aware pins the batch workers.
+    nzp_compress_options_t compress;
+
+    /// I/O backend for input and output files (default NZP_IO_BLOCKING).
+    nzp_io_backend_t io_backend;
+
+    /// Choose the worker count (threads is then an upper bound) and
+    /// segment_size from the tuning profile, the file sizes and a sample
+    /// of the largest file. Without a profile the fields are used as given.
+    int auto_tune;
+
+    /// Auto-tune target: the best ratio predicted to reach this many MB/s
+    /// (0 = no speed target; then the fastest setting whose estimated
+    /// ratio loss from segmenting is at most max_ratio_loss, default 0.01).
+    double target_mbps;
+    double max_ratio_loss;
+} nzp_batch_options_t;
+
+/// Fill batch options with defaults.
+void nzp_batch_options_init(nzp_batch_options_t* options);
+
+/// Microbenchmark the model, memory bandwidth and core count on this host
+/// and save the result as a tuning profile at profile_path (NULL = the
+/// default path). The profile is also used by later auto_tune calls with
+/// this model. Takes a few seconds.
+nzp_error_t nzp_tune(const nzp_model_t* model, const char* profile_path);
+
+/// Use the tuning profile at profile_path (NULL = default path) for
+/// auto_tune calls with this model. Without this call the default profile
+/// is loaded on first use, if it exists.
+nzp_error_t nzp_model_set_tune_profile(nzp_model_t* model, const char* profile_path);
+
+/// $NEUROZIP_TUNE_PROFILE, else $XDG_CONFIG_HOME/neurozip/tune.profile,
+/// else ~/.config/neurozip/tune.profile.
+const char* nzp_tune_default_path(void);
+
+/// Options for nzp_archive_create.
+typedef struct {
+    /// Worker threads coding distinct chunks (0 = all cores).
+    unsigned threads;
+
+    /// Target average chunk size in bytes (default 64 KiB).
+    uint32_t chunk_size;
+
+    /// Optional earlier archive made with the same model: chunks it already
+    /// holds are copied as coded instead of being coded again. The new
+    /// archive does not depend on it. NULL = none.
+    const char* base_path;
+} nzp_archive_options_t;
+
+/// What nzp_archive_create did.
+typedef struct {
+    uint64_t input_bytes;
+    uint64_t chunks;        // over all members
+    uint64_t unique_chunks; // stored once each
+    uint64_t unique_bytes;
+    uint64_t coded_chunks;  // unique chunks not found in the base archive
+    uint64_t coded_bytes;
+    uint64_t archive_bytes;
+} nzp_archive_stats_t;
+
+void nzp_archive_options_init(nzp_archive_options_t* options);
+
+/// Write the inputs into one deduplicating archive (.nza): each file is
+/// split into content-defined chunks, every distinct chunk is coded once
+/// from a fresh model state, and repeats are stored as references, so
+/// near-identical files cost little more than one. out_stats may be NULL.
+nzp_error_t nzp_archive_create(
+    const char* archive_path,
+    const char* const* input_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_archive_options_t* options,
+    nzp_archive_stats_t* out_stats
+);
+
+/// Extract every member of an archive under output_dir, keeping the
+/// stored relative paths. Members are decoded in parallel on 'threads'
+/// workers (0 = all cores). nzp_file_fixed_point reports the inference
+/// mode the archive needs.
+nzp_error_t nzp_archive_extract(
+    const char* archive_path,
+    const char* output_dir,
+    const nzp_model_t* model,
+    unsigned threads
+);
+
+/// Result cache counters (see nzp_cache_get_stats).
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t entries;
+    uint64_t bytes;          // values plus a fixed per-entry overhead
+    uint64_t capacity_bytes;
+} nzp_cache_stats_t;
+
+/// Create a cache of compressed results bounded by capacity_bytes, with
+/// least recently used eviction. Results are keyed by a 128-bit hash of
+/// the input, its size, the model hash and inference mode and the options
+/// that change the output, so one cache can serve several models. The
+/// hash is not cryptographic: do not share a cache between untrusted
+/// clients. Thread-safe.
+nzp_cache_t* nzp_cache_create(uint64_t capacity_bytes);
+
+/// Free a cache. Models it is attached to keep it alive until detached
+/// or freed.
+void nzp_cache_free(nzp_cache_t* cache);
+
+/// Drop all entries (counters are kept).
+void nzp_cache_clear(nzp_cache_t* cache);
+
+void nzp_cache_get_stats(const nzp_cache_t* cache, nzp_cache_stats_t* out_stats);
+
+/// Use 'cache' (NULL = none) for nzp_compress_memory and
+/// nzp_compress_frame with this model: a repeated input then costs a hash
+/// and a copy of the stored result instead of a model run.
+void nzp_model_set_cache(nzp_model_t* model, const nzp_cache_t* cache);
+
+/// Start recording a timeline of library work (model load, compression
+/// blocks, checksums, file I/O) from all threads. Recording uses a
+/// per-thread ring buffer; while tracing is off each span costs one
+/// atomic load.
+void nzp_trace_start(void);
+
+/// Stop recording. What was recorded is kept for nzp_trace_write.
+void nzp_trace_stop(void);
+
+/// Write the recording as Chrome trace-event JSON (open in
+/// chrome://tracing or ui.perfetto.dev). Call after nzp_trace_stop.
+nzp_error_t nzp_trace_write(const char* path);
+
 /// Load a Tiny LSTM model from a binary file.
 nzp_model_t* nzp_model_load(const char* path);
 
-/// Free a model object.
+/// Free a model object. Models owned by a slot are ignored (the slot
+/// frees them).
 void nzp_model_free(nzp_model_t* model);
 
+/// Hash of the model weights, as recorded in the .nzp files it writes.
+uint64_t nzp_model_hash(const nzp_model_t* model);
+
+/// Enable (1) or disable (0) deterministic fixed-point inference.
+/// Files compressed in this mode decode bit-exactly on any compiler/CPU,
+/// but must also be decompressed with fixed-point enabled.
+void nzp_model_set_fixed_point(nzp_model_t* model, int enable);
+
+/// Returns 1 if the model is in fixed-point mode.
+int nzp_model_fixed_point(const nzp_model_t* model);
+
+/// Split every step of the model across 'threads' threads (1 = serial,
+/// the default): the recurrent and output matrix-vector products are
+/// divided by rows between a team of helpers pinned to one CPU each, so a
+/// single stream decodes faster once the weights outgrow one core's cache
+/// (hidden sizes of roughly 512 and up). Output is bit-identical, so files
+/// decode with any setting. Models without support ignore it.
+void nzp_model_set_step_threads(nzp_model_t* model, unsigned threads);
+
+/// Threads per step (1 = serial).
+unsigned nzp_model_step_threads(const nzp_model_t* model);
+
+/// Read the header of a .nzp file and report whether it was coded with
+/// fixed-point inference.
+nzp_error_t nzp_file_fixed_point(const char* path, int* out_fixed_point);
+
+/// Primed initial states: snapshots of the model state taken after a
+/// representative prefix (see nzp_prime_model), stored in the model file.
+/// Coding from one makes short messages start warm instead of from
+/// h = c = 0, without coding the prefix. Ids run 1..count; 0 = cold start.
+uint32_t nzp_model_primed_state_count(const nzp_model_t* model);
+
+/// Start every stream (file, segment, frame, archive chunk) from snapshot
+/// 'id'. The id and a digest of the snapshot are recorded in what is
+/// written, which then only decodes with the same snapshot selected.
+/// NZP_ERR_MODEL_MISMATCH if the model has no such snapshot.
+nzp_error_t nzp_model_set_primed_state(nzp_model_t* model, uint32_t id);
+
+uint32_t nzp_model_primed_state(const nzp_model_t* model);
+
+/// The primed state id a .nzp file, compact frame or archive was coded
+/// from (0 = cold start).
+nzp_error_t nzp_file_primed_state(const char* path, uint32_t* out_id);
+
+/// Write a copy of the model at model_path to out_path with one primed
+/// state per prefix file, computed by running the model (float inference)
+/// over it. New snapshots get the ids after any the model already has.
+/// A few KiB of text like the expected messages is enough.
+nzp_error_t nzp_prime_model(
+    const char* model_path,
+    const char* out_path,
+    const char* const* prefix_paths,
+    size_t count
+);
+
 /// Compress a file (input_path) into output_path.
 /// Returns NZP_OK on success.
 nzp_error_t nzp_compress_file(
@@ -33,6 +300,14 @@ nzp_error_t nzp_compress_file(
     const nzp_model_t* model
 );
 
+/// Compress a file with explicit encoder options (NULL = defaults).
+nzp_error_t nzp_compress_file_ex(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+);
+
 /// Decompress a .nzp file into output_path.
 /// Returns NZP_OK on success.
 nzp_error_t nzp_decompress_file(
@@ -41,6 +316,318 @@ nzp_error_t nzp_decompress_file(
     const nzp_model_t* model
 );
 
+/// Compress an in-memory buffer into a complete .nzp image (header +
+/// payload). On success *out_data is allocated by the library and must be
+/// released with nzp_buffer_free.
+nzp_error_t nzp_compress_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    uint8_t** out_data,
+    uint64_t* out_size
+);
+
+/// Decompress an in-memory .nzp image. On success *out_data is allocated
+/// by the library and must be released with nzp_buffer_free.
+nzp_error_t nzp_decompress_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    uint8_t** out_data,
+    uint64_t* out_size
+);
+
+/// Release a buffer returned by nzp_compress_memory / nzp_decompress_memory
+/// / nzp_compress_frame / nzp_decompress_frame.
+void nzp_buffer_free(uint8_t* data);
+
+/// Compress a short message into a compact frame: 1 byte magic/version, a
+/// varint size, a 2-byte model tag, an optional 2-byte checksum and the
+/// coded data with a 0-4 byte flush (about 3-9 bytes of overhead instead
+/// of 52). Frames carry no checkpoints or append state.
+/// nzp_decompress_memory and nzp_decompress_file recognize frames too.
+nzp_error_t nzp_compress_frame(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    int checksum,
+    uint8_t** out_data,
+    uint64_t* out_size
+);
+
+/// Decompress a frame written by nzp_compress_frame.
+nzp_error_t nzp_decompress_frame(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    uint8_t** out_data,
+    uint64_t* out_size
+);
+
+/// Append data to the .nzp file at nzp_path. For a file written with
+/// 'appendable', coding resumes from the saved state, so only 'size' bytes
+/// are coded. Other files are decoded and rewritten as appendable once.
+/// The result decodes to the old contents followed by 'data'. two_phase /
+/// threads / pipelined apply to the new data; checkpoint settings only
+/// apply when a file is rewritten (an existing checkpoint index is
+/// extended). Either way the new file is built next to the old one and
+/// renamed over it when complete: after a crash or an error the file at
+/// nzp_path holds the old contents or the new, never a mix.
+nzp_error_t nzp_append_memory(
+    const char* nzp_path,
+    const uint8_t* data,
+    uint64_t size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+);
+
+/// nzp_append_memory with the contents of input_path.
+nzp_error_t nzp_append_file(
+    const char* nzp_path,
+    const char* input_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options
+);
+
+/// Decompress bytes [offset, offset + length) of a .nzp file into
+/// out_buffer (at least 'length' bytes). Files written with checkpoints
+/// only decode from the nearest checkpoint; others decode from the start.
+/// The CRC cannot be verified for partial reads.
+nzp_error_t nzp_decompress_range(
+    const char* input_path,
+    const nzp_model_t* model,
+    uint64_t offset,
+    uint64_t length,
+    uint8_t* out_buffer,
+    uint64_t* out_size
+);
+
+/// Options for nzp_estimate_memory / nzp_estimate_file.
+typedef struct {
+    /// Bytes to model, taken as evenly spaced windows across the input
+    /// (0 = the whole input). Default 1 MiB.
+    uint64_t sample_bytes;
+
+    /// Number of sample windows (default 16). Each starts from a fresh
+    /// model state, so tiny windows overestimate the size.
+    uint32_t windows;
+
+    /// Threads modelling windows in parallel (0 = all cores, default 1).
+    /// A whole-input estimate is split into one window per thread.
+    unsigned threads;
+} nzp_estimate_options_t;
+
+/// Result of a size estimate.
+typedef struct {
+    uint64_t input_bytes;
+    uint64_t sampled_bytes;
+    double bits_per_byte;      // ideal code length of the sample
+    uint64_t estimated_bytes;  // .nzp file size extrapolated to the input
+} nzp_estimate_t;
+
+void nzp_estimate_options_init(nzp_estimate_options_t* options);
+
+/// Estimate the compressed size of 'input' from the model's code length
+/// on a sample, without range coding or writing output. With the whole
+/// input sampled the estimate is within a few bytes of a single-stream
+/// nzp_compress_memory; sampled estimates are only as representative as
+/// the windows. options may be NULL.
+nzp_error_t nzp_estimate_memory(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t* out_estimate
+);
+
+/// nzp_estimate_memory with the contents of input_path.
+nzp_error_t nzp_estimate_file(
+    const char* input_path,
+    const nzp_model_t* model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t* out_estimate
+);
+
+/// Bit-cost profile of a .nzp file or compact frame: decode it, then
+/// report the bits per byte the model spent on each region_size-byte
+/// region of the original data (*out_regions entries, the last region may
+/// be shorter). Segments are costed from a fresh state, as they were
+/// coded. The inference mode is taken from the file. On success
+/// *out_bits_per_byte is allocated by the library and must be released
+/// with nzp_profile_free.
+nzp_error_t nzp_profile_file(
+    const char* nzp_path,
+    const nzp_model_t* model,
+    uint64_t region_size,
+    double** out_bits_per_byte,
+    uint64_t* out_regions
+);
+
+void nzp_profile_free(double* bits_per_byte);
+
+/// Compress input_paths[i] into output_paths[i] for all i < count, using
+/// one shared model and a work-stealing pool: files are split into tasks
+/// (see segment_size) and run longest first. Per-file results are written
+/// to out_errors (optional, count entries); returns the first error.
+nzp_error_t nzp_compress_batch(
+    const char* const* input_paths,
+    const char* const* output_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_batch_options_t* options,
+    nzp_error_t* out_errors
+);
+
+/// Decompress a batch of .nzp files the same way; segmented files are
+/// decoded one task per segment. Files coded in the other inference mode
+/// (fixed-point vs float) are handled automatically.
+nzp_error_t nzp_decompress_batch(
+    const char* const* input_paths,
+    const char* const* output_paths,
+    size_t count,
+    const nzp_model_t* model,
+    const nzp_batch_options_t* options,
+    nzp_error_t* out_errors
+);
+
+/// Asynchronous jobs. nzp_submit_* queue the work on an executor shared
+/// by all jobs of the model and return at once with a job handle (NULL on
+/// invalid arguments). The executor's threads run queued jobs in order,
+/// each with the same code and result as the blocking call.
+typedef struct nzp_job nzp_job_t;
+
+typedef enum {
+    NZP_JOB_QUEUED = 0,
+    NZP_JOB_RUNNING,
+    NZP_JOB_DONE,
+    NZP_JOB_CANCELLED
+} nzp_job_status_t;
+
+/// Called once per job when it finishes or is cancelled: on an executor
+/// thread, or in nzp_job_cancel. 'job' stays valid for the duration of
+/// the call (it may call nzp_job_take_output or nzp_job_free).
+typedef void (*nzp_job_callback_t)(nzp_job_t* job, nzp_error_t result, void* user_data);
+
+/// Threads of the model's job executor (0 = all cores, the default). The
+/// executor is created by the first submit. Changing the count replaces
+/// it; this blocks until the jobs already queued on the old one have run.
+/// nzp_model_free likewise runs every queued job first, so neither may be
+/// called from a job callback.
+void nzp_model_set_job_threads(nzp_model_t* model, unsigned threads);
+
+/// Asynchronous nzp_compress_memory. 'input' must stay valid until the
+/// job finishes; options (may be NULL) are copied. The .nzp image is
+/// fetched with nzp_job_take_output. callback may be NULL.
+nzp_job_t* nzp_submit_compress(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    nzp_job_callback_t callback,
+    void* user_data
+);
+
+/// Asynchronous nzp_decompress_memory (also for compact frames).
+nzp_job_t* nzp_submit_decompress(
+    const uint8_t* input,
+    uint64_t input_size,
+    const nzp_model_t* model,
+    nzp_job_callback_t callback,
+    void* user_data
+);
+
+/// Asynchronous nzp_compress_file_ex; the paths are copied.
+nzp_job_t* nzp_submit_compress_file(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    const nzp_compress_options_t* options,
+    nzp_job_callback_t callback,
+    void* user_data
+);
+
+/// Asynchronous nzp_decompress_file.
+nzp_job_t* nzp_submit_decompress_file(
+    const char* input_path,
+    const char* output_path,
+    const nzp_model_t* model,
+    nzp_job_callback_t callback,
+    void* user_data
+);
+
+nzp_job_status_t nzp_job_poll(const nzp_job_t* job);
+
+/// Block until the job is done or cancelled, or for at most timeout_ms
+/// milliseconds (negative = no limit). Returns 1 if it has finished, 0 on
+/// timeout. Returns after the callback has run.
+int nzp_job_wait(nzp_job_t* job, int64_t timeout_ms);
+
+/// Result of a finished job (NZP_ERR_CANCELLED if cancelled); undefined
+/// while it is queued or running.
+nzp_error_t nzp_job_result(const nzp_job_t* job);
+
+/// Cancel a job that has not started: it never runs and finishes with
+/// NZP_ERR_CANCELLED (the callback runs here). Returns 1 if cancelled, 0
+/// if the job is already running or finished; running jobs complete.
+int nzp_job_cancel(nzp_job_t* job);
+
+/// Move the output of a successful memory job to the caller, to be
+/// released with nzp_buffer_free. Returns the job's error if it failed,
+/// and NZP_ERR_INTERNAL if it has not finished, is a file job or the
+/// output was already taken.
+nzp_error_t nzp_job_take_output(nzp_job_t* job, uint8_t** out_data, uint64_t* out_size);
+
+/// Release the handle; it may not be used afterwards, except by the
+/// job's own callback. A job still queued is cancelled without calling
+/// back; a running one finishes in the background and still calls back.
+void nzp_job_free(nzp_job_t* job);
+
+/// Model slots, for replacing a model in a running process without
+/// stopping traffic. A slot owns its models. Callers acquire a lease on
+/// the current one (a model usable with every call above), use it and
+/// release it; acquiring takes no lock. nzp_model_slot_swap publishes a
+/// new model: later acquires get it, leases already held keep the old one,
+/// and the old one is freed when its last lease is released.
+///
+/// Create a slot owning 'model' (NULL = empty until the first swap).
+/// NULL if the model already belongs to a slot.
+nzp_model_slot_t* nzp_model_slot_create(nzp_model_t* model);
+
+/// Free the slot and its models. Every lease must have been released.
+void nzp_model_slot_free(nzp_model_slot_t* slot);
+
+/// Make 'model' (loaded and configured, not in any slot) current; the
+/// slot takes ownership. With keep_previous the replaced model stays
+/// available to nzp_model_slot_acquire_for_* so files it wrote still
+/// decode, until nzp_model_slot_forget.
+nzp_error_t nzp_model_slot_swap(nzp_model_slot_t* slot, nzp_model_t* model, int keep_previous);
+
+/// Lease on the current model (NULL if the slot is empty).
+nzp_model_t* nzp_model_slot_acquire(const nzp_model_slot_t* slot);
+
+/// Lease on the model that wrote the .nzp image or compact frame at
+/// 'input' (chosen by the header's model hash or the frame's model tag):
+/// the current model or a kept one. Falls back to the current model, so
+/// decoding then reports NZP_ERR_MODEL_MISMATCH.
+nzp_model_t* nzp_model_slot_acquire_for_memory(
+    const nzp_model_slot_t* slot,
+    const uint8_t* input,
+    uint64_t input_size
+);
+
+/// The same for a .nzp file, compact frame or archive on disk.
+nzp_model_t* nzp_model_slot_acquire_for_file(const nzp_model_slot_t* slot, const char* path);
+
+/// Release a lease from nzp_model_slot_acquire*. Release only after the
+/// model's asynchronous jobs have finished, and not from their callbacks:
+/// the last release frees a replaced model.
+void nzp_model_slot_release(nzp_model_t* model);
+
+/// Stop keeping replaced models with this hash (see nzp_model_hash).
+/// Returns how many were dropped; each is freed by its last lease.
+size_t nzp_model_slot_forget(nzp_model_slot_t* slot, uint64_t model_hash);
+
 /// Get human-readable error string.
 const char* nzp_strerror(nzp_error_t err);
 
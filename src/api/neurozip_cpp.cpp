@@ -29,6 +29,16 @@ nzp_error_t compress_file(
     return nzp_compress_file(input_path.c_str(), output_path.c_str(), model.raw());
 }
 
+nzp_error_t compress_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    const Model& model,
+    const nzp_compress_options_t& options
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_compress_file_ex(input_path.c_str(), output_path.c_str(), model.raw(), &options);
+}
+
 nzp_error_t decompress_file(
     const std::string& input_path,
     const std::string& output_path,
@@ -38,4 +48,199 @@ nzp_error_t decompress_file(
     return nzp_decompress_file(input_path.c_str(), output_path.c_str(), model.raw());
 }
 
+nzp_error_t compress_memory(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model,
+    const nzp_compress_options_t* options
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_compress_memory(input.data(), input.size(), model.raw(), options,
+                                          &data, &size);
+    out.assign(data, data + (err == NZP_OK ? size : 0));
+    nzp_buffer_free(data);
+    return err;
+}
+
+nzp_error_t decompress_memory(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_decompress_memory(input.data(), input.size(), model.raw(), &data, &size);
+    out.assign(data, data + (err == NZP_OK ? size : 0));
+    nzp_buffer_free(data);
+    return err;
+}
+
+nzp_error_t compress_frame(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model,
+    bool checksum
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_compress_frame(input.data(), input.size(), model.raw(), checksum ? 1 : 0,
+                                         &data, &size);
+    out.assign(data, data + (err == NZP_OK ? size : 0));
+    nzp_buffer_free(data);
+    return err;
+}
+
+nzp_error_t decompress_frame(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_decompress_frame(input.data(), input.size(), model.raw(), &data, &size);
+    out.assign(data, data + (err == NZP_OK ? size : 0));
+    nzp_buffer_free(data);
+    return err;
+}
+
+nzp_error_t append_memory(
+    const std::string& nzp_path,
+    const std::vector<uint8_t>& data,
+    const Model& model,
+    const nzp_compress_options_t* options
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_append_memory(nzp_path.c_str(), data.data(), data.size(), model.raw(), options);
+}
+
+nzp_error_t append_file(
+    const std::string& nzp_path,
+    const std::string& input_path,
+    const Model& model,
+    const nzp_compress_options_t* options
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_append_file(nzp_path.c_str(), input_path.c_str(), model.raw(), options);
+}
+
+nzp_error_t tune(const Model& model, const std::string& profile_path)
+{
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_tune(model.raw(), profile_path.empty() ? nullptr : profile_path.c_str());
+}
+
+static std::vector<const char*> c_strings(const std::vector<std::string>& v)
+{
+    std::vector<const char*> out;
+    for (const auto& s : v) out.push_back(s.c_str());
+    return out;
+}
+
+nzp_error_t prime_model(
+    const std::string& model_path,
+    const std::string& out_path,
+    const std::vector<std::string>& prefix_paths
+) {
+    auto prefixes = c_strings(prefix_paths);
+    return nzp_prime_model(model_path.c_str(), out_path.c_str(), prefixes.data(), prefixes.size());
+}
+
+nzp_error_t compress_batch(
+    const std::vector<std::string>& input_paths,
+    const std::vector<std::string>& output_paths,
+    const Model& model,
+    const nzp_batch_options_t& options,
+    std::vector<nzp_error_t>& errors
+) {
+    if (!model.raw() || input_paths.size() != output_paths.size()) return NZP_ERR_INTERNAL;
+    auto in = c_strings(input_paths);
+    auto out = c_strings(output_paths);
+    errors.assign(input_paths.size(), NZP_OK);
+    return nzp_compress_batch(in.data(), out.data(), in.size(), model.raw(), &options, errors.data());
+}
+
+nzp_error_t decompress_batch(
+    const std::vector<std::string>& input_paths,
+    const std::vector<std::string>& output_paths,
+    const Model& model,
+    const nzp_batch_options_t& options,
+    std::vector<nzp_error_t>& errors
+) {
+    if (!model.raw() || input_paths.size() != output_paths.size()) return NZP_ERR_INTERNAL;
+    auto in = c_strings(input_paths);
+    auto out = c_strings(output_paths);
+    errors.assign(input_paths.size(), NZP_OK);
+    return nzp_decompress_batch(in.data(), out.data(), in.size(), model.raw(), &options, errors.data());
+}
+
+nzp_error_t create_archive(
+    const std::string& archive_path,
+    const std::vector<std::string>& input_paths,
+    const Model& model,
+    const nzp_archive_options_t* options,
+    nzp_archive_stats_t* stats
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    auto in = c_strings(input_paths);
+    return nzp_archive_create(archive_path.c_str(), in.data(), in.size(), model.raw(), options, stats);
+}
+
+nzp_error_t extract_archive(
+    const std::string& archive_path,
+    const std::string& output_dir,
+    const Model& model,
+    unsigned threads
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_archive_extract(archive_path.c_str(), output_dir.c_str(), model.raw(), threads);
+}
+
+nzp_error_t decompress_range(
+    const std::string& input_path,
+    const Model& model,
+    uint64_t offset,
+    uint64_t length,
+    std::vector<uint8_t>& out
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    out.resize(length);
+    uint64_t n = 0;
+    nzp_error_t err = nzp_decompress_range(input_path.c_str(), model.raw(), offset, length,
+                                           out.data(), &n);
+    out.resize(err == NZP_OK ? n : 0);
+    return err;
+}
+
+nzp_error_t estimate_file(
+    const std::string& input_path,
+    const Model& model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t& out
+) {
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    return nzp_estimate_file(input_path.c_str(), model.raw(), options, &out);
+}
+
+nzp_error_t profile_file(
+    const std::string& nzp_path,
+    const Model& model,
+    uint64_t region_size,
+    std::vector<double>& bits_per_byte
+) {
+    bits_per_byte.clear();
+    if (!model.raw()) return NZP_ERR_INTERNAL;
+    double* data = nullptr;
+    uint64_t n = 0;
+    nzp_error_t err = nzp_profile_file(nzp_path.c_str(), model.raw(), region_size, &data, &n);
+    if (err != NZP_OK) return err;
+    bits_per_byte.assign(data, data + n);
+    nzp_profile_free(data);
+    return NZP_OK;
+}
+
 } // namespace neurozip
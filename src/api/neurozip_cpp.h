@@ -2,11 +2,80 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "neurozip_c.h"
 
 namespace neurozip {
 
+/// Owning wrapper around nzp_cache_t (see nzp_cache_create).
+class Cache {
+public:
+    explicit Cache(uint64_t capacity_bytes) : cache_(nzp_cache_create(capacity_bytes)) {}
+    ~Cache() { nzp_cache_free(cache_); }
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    nzp_cache_stats_t stats() const
+    {
+        nzp_cache_stats_t s{};
+        nzp_cache_get_stats(cache_, &s);
+        return s;
+    }
+    void clear() { nzp_cache_clear(cache_); }
+
+    nzp_cache_t* raw() const { return cache_; }
+
+private:
+    nzp_cache_t* cache_;
+};
+
+/// Owning wrapper around an asynchronous job (see nzp_submit_compress);
+/// e.g. Job job(nzp_submit_compress(data, size, model.raw(), nullptr, cb, ctx)).
+class Job {
+public:
+    explicit Job(nzp_job_t* job = nullptr) : job_(job) {}
+    ~Job() { nzp_job_free(job_); }
+
+    Job(Job&& other) noexcept : job_(other.job_) { other.job_ = nullptr; }
+    Job& operator=(Job&& other) noexcept
+    {
+        if (this != &other) {
+            nzp_job_free(job_);
+            job_ = other.job_;
+            other.job_ = nullptr;
+        }
+        return *this;
+    }
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    bool valid() const { return job_ != nullptr; }
+    nzp_job_status_t poll() const { return nzp_job_poll(job_); }
+    bool wait(int64_t timeout_ms = -1) { return nzp_job_wait(job_, timeout_ms) != 0; }
+    bool cancel() { return nzp_job_cancel(job_) != 0; }
+    nzp_error_t result() const { return nzp_job_result(job_); }
+
+    /// Output of a finished memory job (see nzp_job_take_output).
+    nzp_error_t take_output(std::vector<uint8_t>& out)
+    {
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        nzp_error_t err = nzp_job_take_output(job_, &data, &size);
+        if (err != NZP_OK) return err;
+        out.assign(data, data + size);
+        nzp_buffer_free(data);
+        return NZP_OK;
+    }
+
+    nzp_job_t* raw() const { return job_; }
+
+private:
+    nzp_job_t* job_;
+};
+
 class Model {
 public:
     Model() = default;
@@ -16,22 +85,236 @@ public:
     bool load(const std::string& path);
     bool valid() const { return model_ != nullptr; }
 
+    void set_fixed_point(bool enable) { nzp_model_set_fixed_point(model_, enable ? 1 : 0); }
+    bool fixed_point() const { return nzp_model_fixed_point(model_) != 0; }
+
+    /// Threads per inference step for single-stream latency; see
+    /// nzp_model_set_step_threads.
+    void set_step_threads(unsigned threads) { nzp_model_set_step_threads(model_, threads); }
+    unsigned step_threads() const { return nzp_model_step_threads(model_); }
+
+    /// Primed initial state new streams start from (0 = cold start); see
+    /// nzp_model_set_primed_state.
+    bool set_primed_state(uint32_t id) { return nzp_model_set_primed_state(model_, id) == NZP_OK; }
+    uint32_t primed_state() const { return nzp_model_primed_state(model_); }
+    uint32_t primed_state_count() const { return nzp_model_primed_state_count(model_); }
+
+    /// Threads running this model's asynchronous jobs (0 = all cores);
+    /// see nzp_model_set_job_threads.
+    void set_job_threads(unsigned threads) { nzp_model_set_job_threads(model_, threads); }
+
+    /// Attach a result cache (nullptr detaches); see nzp_model_set_cache.
+    void set_cache(const Cache* cache) { nzp_model_set_cache(model_, cache ? cache->raw() : nullptr); }
+
     nzp_model_t* raw() const { return model_; }
 
+    /// Give up ownership, e.g. to a ModelSlot.
+    nzp_model_t* release()
+    {
+        nzp_model_t* model = model_;
+        model_ = nullptr;
+        return model;
+    }
+
 private:
     nzp_model_t* model_ = nullptr;
 };
 
+/// Lease on a slot's model, released on destruction (see
+/// nzp_model_slot_acquire).
+class ModelLease {
+public:
+    explicit ModelLease(nzp_model_t* model = nullptr) : model_(model) {}
+    ~ModelLease() { nzp_model_slot_release(model_); }
+
+    ModelLease(ModelLease&& other) noexcept : model_(other.model_) { other.model_ = nullptr; }
+    ModelLease& operator=(ModelLease&& other) noexcept
+    {
+        if (this != &other) {
+            nzp_model_slot_release(model_);
+            model_ = other.model_;
+            other.model_ = nullptr;
+        }
+        return *this;
+    }
+    ModelLease(const ModelLease&) = delete;
+    ModelLease& operator=(const ModelLease&) = delete;
+
+    bool valid() const { return model_ != nullptr; }
+    nzp_model_t* raw() const { return model_; }
+
+private:
+    nzp_model_t* model_;
+};
+
+/// Owning wrapper around nzp_model_slot_t: a model that can be replaced
+/// while other threads use it. Leases must not outlive the slot.
+class ModelSlot {
+public:
+    ModelSlot() : slot_(nzp_model_slot_create(nullptr)) {}
+    explicit ModelSlot(Model&& model) : ModelSlot() { swap(std::move(model)); }
+    ~ModelSlot() { nzp_model_slot_free(slot_); }
+
+    ModelSlot(const ModelSlot&) = delete;
+    ModelSlot& operator=(const ModelSlot&) = delete;
+
+    /// Publish 'model' (see nzp_model_slot_swap); it is moved into the slot.
+    nzp_error_t swap(Model&& model, bool keep_previous = false)
+    {
+        if (!model.valid()) return NZP_ERR_INTERNAL;
+        nzp_error_t err = nzp_model_slot_swap(slot_, model.raw(), keep_previous ? 1 : 0);
+        if (err == NZP_OK) model.release();
+        return err;
+    }
+
+    ModelLease acquire() const { return ModelLease(nzp_model_slot_acquire(slot_)); }
+
+    /// Lease on the model that wrote 'input' (see nzp_model_slot_acquire_for_memory).
+    ModelLease acquire_for(const std::vector<uint8_t>& input) const
+    {
+        return ModelLease(nzp_model_slot_acquire_for_memory(slot_, input.data(), input.size()));
+    }
+    ModelLease acquire_for_file(const std::string& path) const
+    {
+        return ModelLease(nzp_model_slot_acquire_for_file(slot_, path.c_str()));
+    }
+
+    size_t forget(uint64_t model_hash) { return nzp_model_slot_forget(slot_, model_hash); }
+
+    nzp_model_slot_t* raw() const { return slot_; }
+
+private:
+    nzp_model_slot_t* slot_;
+};
+
 nzp_error_t compress_file(
     const std::string& input_path,
     const std::string& output_path,
     const Model& model
 );
 
+nzp_error_t compress_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    const Model& model,
+    const nzp_compress_options_t& options
+);
+
 nzp_error_t decompress_file(
     const std::string& input_path,
     const std::string& output_path,
     const Model& model
 );
 
+nzp_error_t compress_memory(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model,
+    const nzp_compress_options_t* options = nullptr
+);
+
+nzp_error_t decompress_memory(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model
+);
+
+/// Compact frame for short messages (see nzp_compress_frame).
+nzp_error_t compress_frame(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model,
+    bool checksum = true
+);
+
+nzp_error_t decompress_frame(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    const Model& model
+);
+
+/// Append to an existing .nzp file (see nzp_append_memory).
+nzp_error_t append_memory(
+    const std::string& nzp_path,
+    const std::vector<uint8_t>& data,
+    const Model& model,
+    const nzp_compress_options_t* options = nullptr
+);
+
+nzp_error_t append_file(
+    const std::string& nzp_path,
+    const std::string& input_path,
+    const Model& model,
+    const nzp_compress_options_t* options = nullptr
+);
+
+/// Copy a model file with one primed state per prefix file added (see
+/// nzp_prime_model).
+nzp_error_t prime_model(
+    const std::string& model_path,
+    const std::string& out_path,
+    const std::vector<std::string>& prefix_paths
+);
+
+/// Calibrate the host for auto_tune (see nzp_tune); empty path = default.
+nzp_error_t tune(const Model& model, const std::string& profile_path = "");
+
+/// Batch compression; 'errors' receives one result per input.
+nzp_error_t compress_batch(
+    const std::vector<std::string>& input_paths,
+    const std::vector<std::string>& output_paths,
+    const Model& model,
+    const nzp_batch_options_t& options,
+    std::vector<nzp_error_t>& errors
+);
+
+nzp_error_t decompress_batch(
+    const std::vector<std::string>& input_paths,
+    const std::vector<std::string>& output_paths,
+    const Model& model,
+    const nzp_batch_options_t& options,
+    std::vector<nzp_error_t>& errors
+);
+
+/// Deduplicating archive of several files (see nzp_archive_create).
+nzp_error_t create_archive(
+    const std::string& archive_path,
+    const std::vector<std::string>& input_paths,
+    const Model& model,
+    const nzp_archive_options_t* options = nullptr,
+    nzp_archive_stats_t* stats = nullptr
+);
+
+nzp_error_t extract_archive(
+    const std::string& archive_path,
+    const std::string& output_dir,
+    const Model& model,
+    unsigned threads = 0
+);
+
+nzp_error_t decompress_range(
+    const std::string& input_path,
+    const Model& model,
+    uint64_t offset,
+    uint64_t length,
+    std::vector<uint8_t>& out
+);
+
+/// Compressed size from the model's code length on a sample (see
+/// nzp_estimate_file); options nullptr = defaults.
+nzp_error_t estimate_file(
+    const std::string& input_path,
+    const Model& model,
+    const nzp_estimate_options_t* options,
+    nzp_estimate_t& out
+);
+
+/// Bits per byte of each region of a compressed file (see nzp_profile_file).
+nzp_error_t profile_file(
+    const std::string& nzp_path,
+    const Model& model,
+    uint64_t region_size,
+    std::vector<double>& bits_per_byte
+);
+
 } // namespace neurozip
@@ -1,11 +1,25 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 
+#include "../api/neurozip_cpp.h"
+#include "../core/alphabet.h"
+#include "../core/archive.h"
+#include "../core/checkpoint.h"
+#include "../core/compact_frame.h"
 #include "../core/file_format.h"
+#include "../core/segments.h"
+#include "../core/stream_state.h"
 
 static void usage() {
-    std::cout << "Usage: neurozip-inspect <file.nzp>\n";
+    std::cout << "Usage: neurozip-inspect <file.nzp|archive.nza>\n"
+              << "       neurozip-inspect --profile <file.nzp> -m <model.bin> [--region <n>]\n"
+              << "  --profile       Decode the file and print the bits per byte the\n"
+              << "                  model spent on each region (default 4096 bytes)\n";
 }
 
 static void print_header(const neurozip::FileHeader& h) {
@@ -13,19 +27,147 @@ static void print_header(const neurozip::FileHeader& h) {
     std::cout << "Format version: " << (int)h.formatVersion << "\n";
     std::cout << "Model ID:       " << h.modelId << "\n";
     std::cout << "Model Hash:     " << h.modelHash << "\n";
+    std::cout << "Flags:          0x" << std::hex << (int)h.flags << std::dec;
+    if (h.flags & neurozip::NZP_FLAG_FIXED_POINT) std::cout << " (fixed-point)";
+    if (h.flags & neurozip::NZP_FLAG_CHECKPOINTS) std::cout << " (checkpoints)";
+    if (h.flags & neurozip::NZP_FLAG_SEGMENTED) std::cout << " (segmented)";
+    if (h.flags & neurozip::NZP_FLAG_APPENDABLE) std::cout << " (appendable)";
+    if (h.flags & neurozip::NZP_FLAG_ALPHABET) std::cout << " (reduced alphabet)";
+    std::cout << "\n";
     std::cout << "Original size:  " << h.originalSize << "\n";
     std::cout << "CRC32:          0x" << std::hex << h.checksum << std::dec << "\n";
-    std::cout << "Reserved:       " << h.reserved << "\n";
+    if (h.primedState) {
+        std::cout << "Primed state:   " << (uint32_t)h.primedState << " (digest 0x" << std::hex
+                  << (uint32_t)(h.primedState >> 32) << std::dec << ")\n";
+    } else {
+        std::cout << "Primed state:   none\n";
+    }
+}
+
+/// Compact frames have no FileHeader; print what the frame carries.
+static int inspect_frame(const std::vector<uint8_t>& frame) {
+    neurozip::CompactFrameInfo info;
+    if (neurozip::parse_compact_frame(frame.data(), frame.size(), info) != neurozip::ErrorCode::Ok) {
+        std::cerr << "Error: corrupt compact frame\n";
+        return 1;
+    }
+    std::cout << "Compact frame:  version " << (frame[0] & 0x03);
+    if (info.fixedPoint) std::cout << " (fixed-point)";
+    std::cout << "\n";
+    std::cout << "Model tag:      0x" << std::hex << info.modelTag << std::dec << "\n";
+    if (info.primedState) std::cout << "Primed state:   " << info.primedState << "\n";
+    std::cout << "Original size:  " << info.originalSize << "\n";
+    if (info.hasChecksum) {
+        std::cout << "Checksum:       0x" << std::hex << info.checksum << std::dec << "\n";
+    }
+    std::cout << "Framing bytes:  " << info.streamOffset << "\n";
+    std::cout << "Stream bytes:   " << (frame.size() - info.streamOffset) << "\n";
+    return 0;
+}
+
+/// Archives: model, chunk pool and members.
+static int inspect_archive(const std::string& path) {
+    neurozip::ArchiveIndex index;
+    auto err = neurozip::read_archive_index(path, index);
+    if (err != neurozip::ErrorCode::Ok) {
+        std::cerr << "Error: cannot read archive index: " << (int)err << "\n";
+        return 1;
+    }
+    uint64_t unique = 0, coded = 0, total = 0, refs = 0;
+    for (const auto& c : index.chunks) {
+        unique += c.originalSize;
+        coded += c.streamSize;
+    }
+    for (const auto& m : index.members) {
+        total += m.size;
+        refs += m.chunks.size();
+    }
+    std::cout << "Archive:        version " << (int)neurozip::NZA_FORMAT_VERSION;
+    if (index.fixedPoint) std::cout << " (fixed-point)";
+    std::cout << "\n";
+    std::cout << "Model ID:       " << index.modelId << "\n";
+    std::cout << "Model Hash:     " << index.modelHash << "\n";
+    std::cout << "Members:        " << index.members.size() << " (" << total << " bytes, "
+              << refs << " chunk references)\n";
+    std::cout << "Chunks:         " << index.chunks.size() << " distinct (" << unique
+              << " bytes -> " << coded << " bytes)\n";
+    for (const auto& m : index.members) {
+        std::cout << "  " << m.name << ": " << m.size << " bytes, " << m.chunks.size()
+                  << " chunks, CRC32 0x" << std::hex << m.checksum << std::dec << "\n";
+    }
+    return 0;
+}
+
+/// Bit-cost map: one line per region with its offset, bits per byte and
+/// a bar scaled to 8 bits per byte (the cost of storing it raw).
+static int profile_file(const std::string& path, const std::string& modelPath, uint64_t regionSize) {
+    neurozip::Model model(modelPath);
+    if (!model.valid()) {
+        std::cerr << "Failed to load model: " << modelPath << "\n";
+        return 1;
+    }
+    std::vector<double> bpb;
+    auto err = neurozip::profile_file(path, model, regionSize, bpb);
+    if (err != NZP_OK) {
+        std::cerr << "Error: " << nzp_strerror(err) << "\n";
+        return 1;
+    }
+
+    const int width = 40;
+    double sum = 0.0, lo = 8.0, hi = 0.0;
+    for (size_t r = 0; r < bpb.size(); ++r) {
+        int bar = (int)(bpb[r] / 8.0 * width + 0.5);
+        if (bar > width) bar = width;
+        char line[64];
+        std::snprintf(line, sizeof(line), "%12llu  %6.3f  ", (unsigned long long)(r * regionSize), bpb[r]);
+        std::cout << line << std::string((size_t)bar, '#') << (bpb[r] > 8.0 ? "!" : "") << "\n";
+        sum += bpb[r];
+        lo = std::min(lo, bpb[r]);
+        hi = std::max(hi, bpb[r]);
+    }
+    if (!bpb.empty()) {
+        char line[128];
+        std::snprintf(line, sizeof(line), "%zu regions of %llu bytes: mean %.3f, min %.3f, max %.3f bits/byte",
+                      bpb.size(), (unsigned long long)regionSize, sum / (double)bpb.size(), lo, hi);
+        std::cout << line << "\n";
+    }
+    return 0;
 }
 
 int main(int argc, char** argv)
 {
-    if (argc != 2) {
+    std::string path;
+    std::string modelPath;
+    uint64_t regionSize = 4096;
+    bool profile = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--profile" && i + 1 < argc) {
+            profile = true;
+            path = argv[++i];
+        } else if (a == "-m" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (a == "--region" && i + 1 < argc) {
+            regionSize = std::stoull(argv[++i]);
+        } else if (a[0] != '-' && path.empty()) {
+            path = a;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (path.empty() || (profile && (modelPath.empty() || regionSize == 0))) {
         usage();
         return 1;
     }
+    if (profile) return profile_file(path, modelPath, regionSize);
 
-    const std::string path = argv[1];
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        std::vector<uint8_t> head((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        if (neurozip::is_compact_frame(head.data(), head.size())) return inspect_frame(head);
+        if (neurozip::is_archive(head.data(), head.size())) return inspect_archive(path);
+    }
 
     neurozip::FileHeader h;
     std::vector<uint8_t> payload;
@@ -40,5 +182,50 @@ int main(int argc, char** argv)
 
     std::cout << "Payload bytes:  " << payload.size() << "\n";
 
+    // Trailers from the end: saved encoder state, then checkpoint index.
+    size_t indexEnd = payload.size();
+    if (h.flags & neurozip::NZP_FLAG_APPENDABLE) {
+        neurozip::StreamState state;
+        if (!neurozip::split_stream_state(payload.data(), payload.size(), indexEnd, state)) {
+            std::cout << "Append state:   (corrupt)\n";
+        } else {
+            std::cout << "Append state:   " << (payload.size() - indexEnd) << " bytes ("
+                      << state.stateSize << " floats per vector)\n";
+        }
+    }
+
+    if (h.flags & neurozip::NZP_FLAG_CHECKPOINTS) {
+        size_t streamSize = 0;
+        neurozip::CheckpointIndex index;
+        if (!neurozip::split_checkpoint_index(payload.data(), indexEnd, streamSize, index)) {
+            std::cout << "Checkpoints:    (corrupt index)\n";
+        } else {
+            std::cout << "Stream bytes:   " << streamSize << "\n";
+            std::cout << "Checkpoints:    " << index.entries.size() << " every "
+                      << index.interval << " bytes ("
+                      << (index.precision == neurozip::CheckpointPrecision::Int8 ? "int8" : "fp16")
+                      << ", " << (indexEnd - streamSize) << " index bytes)\n";
+        }
+    }
+
+    if ((h.flags & neurozip::NZP_FLAG_ALPHABET) && payload.size() >= neurozip::kAlphabetBitmapBytes) {
+        neurozip::ByteAlphabet alphabet;
+        alphabet.read_bitmap(payload.data());
+        std::cout << "Alphabet:       " << alphabet.size() << " byte values\n";
+    }
+
+    if (h.flags & neurozip::NZP_FLAG_SEGMENTED) {
+        neurozip::SegmentTable table;
+        if (!neurozip::parse_segment_table(payload.data(), payload.size(), table)) {
+            std::cout << "Segments:       (corrupt table)\n";
+        } else {
+            std::cout << "Segments:       " << table.count() << "\n";
+            for (size_t i = 0; i < table.count(); ++i) {
+                std::cout << "  [" << i << "] " << table.originalSizes[i] << " -> "
+                          << table.streamSizes[i] << " bytes\n";
+            }
+        }
+    }
+
     return 0;
 }
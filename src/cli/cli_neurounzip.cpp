@@ -1,14 +1,53 @@
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "../api/neurozip_cpp.h"
+#include "../core/archive.h"
 #include "../core/file_format.h"
+#include "../core/trace.h"
 
 static void print_usage() {
-    std::cout << "Usage: neurounzip [options] <input-file.nzp>\n"
+    std::cout << "Usage: neurounzip [options] <input-file.nzp>...\n"
+              << "       neurounzip [options] [-o <dir>] <archive.nza>\n"
               << "Options:\n"
-              << "  -o <file>       Output file\n"
-              << "  -m <model.bin>  Tiny LSTM model file\n"
-              << "  -v              Verbose output\n";
+              << "  -o <file>       Output file (single input only; for an archive,\n"
+              << "                  the directory to extract into)\n"
+              << "  -m <model.bin>  Model file (LSTM, GRU or MGU)\n"
+              << "  -v              Verbose output\n"
+              << "  -j <n>          Batch mode: decompress all inputs on n worker\n"
+              << "                  threads (0 = all cores) with one shared model\n"
+              << "  --io <backend>  Batch mode file I/O: blocking (default) or uring\n"
+              << "  --step-threads <n> Split each model step across n threads\n"
+              << "                  (lower latency for one stream with a large model)\n"
+              << "  --offset <n>    Only extract bytes starting at offset n\n"
+              << "  --length <n>    Number of bytes to extract with --offset\n"
+              << "  --trace <file>  Write a timeline of model load, decoding, checksum\n"
+              << "                  and I/O spans per thread as Chrome trace JSON\n";
+}
+
+/// With --trace: stop recording and write the timeline when main returns.
+struct TraceOutput {
+    std::string path;
+    ~TraceOutput()
+    {
+        if (path.empty()) return;
+        nzp_trace_stop();
+        if (nzp_trace_write(path.c_str()) != NZP_OK) {
+            std::cerr << "Cannot write trace " << path << "\n";
+        }
+    }
+};
+
+static std::string default_output_path(const std::string& inputPath)
+{
+    // remove .nzp / .nza if present
+    if (inputPath.size() > 4 &&
+        (inputPath.substr(inputPath.size() - 4) == ".nzp" ||
+         inputPath.substr(inputPath.size() - 4) == ".nza")) {
+        return inputPath.substr(0, inputPath.size() - 4);
+    }
+    return inputPath + ".out";
 }
 
 int main(int argc, char** argv)
@@ -18,10 +57,18 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    std::string inputPath;
+    std::vector<std::string> inputPaths;
     std::string outputPath;
     std::string modelPath;
     bool verbose = false;
+    bool ranged = false;
+    bool batch = false;
+    TraceOutput trace;
+    nzp_batch_options_t batchOptions;
+    nzp_batch_options_init(&batchOptions);
+    uint64_t offset = 0;
+    uint64_t length = UINT64_MAX;
+    unsigned stepThreads = 1;
 
     for (int i = 1; i < argc; ++i) {
         std::string a = argv[i];
@@ -29,29 +76,65 @@ int main(int argc, char** argv)
             outputPath = argv[++i];
         } else if (a == "-m" && i + 1 < argc) {
             modelPath = argv[++i];
+        } else if (a == "-j" && i + 1 < argc) {
+            batch = true;
+            batchOptions.threads = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--io" && i + 1 < argc) {
+            std::string io = argv[++i];
+            if (io == "uring") {
+                batchOptions.io_backend = NZP_IO_URING;
+            } else if (io != "blocking") {
+                print_usage();
+                return 1;
+            }
+        } else if (a == "--step-threads" && i + 1 < argc) {
+            stepThreads = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--offset" && i + 1 < argc) {
+            offset = std::stoull(argv[++i]);
+            ranged = true;
+        } else if (a == "--length" && i + 1 < argc) {
+            length = std::stoull(argv[++i]);
+            ranged = true;
+        } else if (a == "--trace" && i + 1 < argc) {
+            trace.path = argv[++i];
         } else if (a == "-v") {
             verbose = true;
         } else if (a[0] == '-') {
             print_usage();
             return 1;
         } else {
-            inputPath = a;
+            inputPaths.push_back(a);
         }
     }
 
-    if (inputPath.empty()) {
+    if (inputPaths.empty()) {
         print_usage();
         return 1;
     }
+    if (!trace.path.empty()) {
+        neurozip::trace_set_thread_name("main");
+        nzp_trace_start();
+    }
+    // An archive is one input; -j sets its extraction threads.
+    bool archive = false;
+    if (inputPaths.size() == 1) {
+        uint8_t magic[4] = { 0, 0, 0, 0 };
+        std::ifstream(inputPaths[0], std::ios::binary).read(reinterpret_cast<char*>(magic), sizeof(magic));
+        archive = neurozip::is_archive(magic, sizeof(magic));
+    }
+    if (inputPaths.size() > 1) {
+        batch = true;
+    } else if (archive) {
+        batch = false;
+    }
+    if (batch && (!outputPath.empty() || ranged)) {
+        std::cerr << "Error: -o, --offset and --length take a single input file\n";
+        return 1;
+    }
 
+    const std::string& inputPath = inputPaths[0];
     if (outputPath.empty()) {
-        // remove .nzp if present
-        if (inputPath.size() > 4 && 
-            inputPath.substr(inputPath.size() - 4) == ".nzp") {
-            outputPath = inputPath.substr(0, inputPath.size() - 4);
-        } else {
-            outputPath = inputPath + ".out";
-        }
+        outputPath = default_output_path(inputPath);
     }
 
     if (modelPath.empty()) {
@@ -68,12 +151,88 @@ int main(int argc, char** argv)
         std::cerr << "Failed to load model\n";
         return 1;
     }
+    model.set_step_threads(stepThreads);
+
+    if (batch) {
+        // The batch API picks the inference mode per file.
+        std::vector<std::string> outputPaths;
+        for (const auto& in : inputPaths) outputPaths.push_back(default_output_path(in));
+
+        if (verbose) {
+            std::cout << "Decompressing " << inputPaths.size() << " files\n";
+            if (batchOptions.io_backend == NZP_IO_URING && !nzp_io_backend_available(NZP_IO_URING)) {
+                std::cout << "io_uring unavailable, using blocking I/O\n";
+            }
+        }
+
+        std::vector<nzp_error_t> errors;
+        auto err = neurozip::decompress_batch(inputPaths, outputPaths, model, batchOptions, errors);
+        for (size_t i = 0; i < errors.size(); ++i) {
+            if (errors[i] != NZP_OK) {
+                std::cerr << inputPaths[i] << ": " << nzp_strerror(errors[i]) << "\n";
+            } else if (verbose) {
+                std::cout << inputPaths[i] << " -> " << outputPaths[i] << "\n";
+            }
+        }
+        return err == NZP_OK ? 0 : 1;
+    }
+
+    // Match the inference mode the file was encoded with.
+    int fixedPoint = 0;
+    if (nzp_file_fixed_point(inputPath.c_str(), &fixedPoint) == NZP_OK) {
+        model.set_fixed_point(fixedPoint != 0);
+        if (verbose && fixedPoint) {
+            std::cout << "Using fixed-point inference\n";
+        }
+    }
+    uint32_t primedState = 0;
+    if (nzp_file_primed_state(inputPath.c_str(), &primedState) == NZP_OK && primedState) {
+        if (!model.set_primed_state(primedState)) {
+            std::cerr << "Error: " << inputPath << " was coded from primed state " << primedState
+                      << ", which " << modelPath << " does not have\n";
+            return 1;
+        }
+        if (verbose) {
+            std::cout << "Starting from primed state " << primedState << "\n";
+        }
+    }
+
+    if (archive) {
+        if (verbose) {
+            std::cout << "Extracting " << inputPath << " -> " << outputPath << "/\n";
+        }
+        auto err = neurozip::extract_archive(inputPath, outputPath, model, batchOptions.threads);
+        if (err != NZP_OK) {
+            std::cerr << "Extraction error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
     if (verbose) {
         std::cout << "Decompressing " << inputPath << " -> " << outputPath << "\n";
     }
 
-    auto err = neurozip::decompress_file(inputPath, outputPath, model);
+    nzp_error_t err;
+    if (ranged) {
+        neurozip::FileHeader header;
+        if (neurozip::read_nzp_header(inputPath, header) != neurozip::ErrorCode::Ok) {
+            std::cerr << "Error: cannot read header of " << inputPath << "\n";
+            return 1;
+        }
+        uint64_t avail = offset < header.originalSize ? header.originalSize - offset : 0;
+        if (length > avail) length = avail;
+
+        std::vector<uint8_t> out;
+        err = neurozip::decompress_range(inputPath, model, offset, length, out);
+        if (err == NZP_OK) {
+            std::ofstream ofs(outputPath, std::ios::binary);
+            ofs.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+            if (!ofs) err = NZP_ERR_IO;
+        }
+    } else {
+        err = neurozip::decompress_file(inputPath, outputPath, model);
+    }
 
     if (err != NZP_OK) {
         std::cerr << "Decompression error: " << nzp_strerror(err) << "\n";
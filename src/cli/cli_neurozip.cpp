@@ -1,15 +1,131 @@
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <vector>
 #include "../api/neurozip_cpp.h"
+#include "../core/trace.h"
+#ifdef NEUROZIP_HAVE_DAEMON
+#include "../daemon/daemon_client.h"
+#endif
 
 static void print_usage() {
-    std::cout << "Usage: neurozip [options] <input-file>\n"
+    std::cout << "Usage: neurozip [options] <input-file>...\n"
+              << "       neurozip [options] --append <new-data> <file.nzp>\n"
+              << "       neurozip [options] --archive <out.nza> <input-file>...\n"
+              << "       neurozip -m <model.bin> --tune\n"
+              << "       neurozip -m <model.bin> --estimate <input-file>...\n"
+              << "       neurozip -m <model.bin> --prime-model <out.bin> <prefix-file>...\n"
               << "Options:\n"
-              << "  -o <file>       Output file (.nzp)\n"
-              << "  -m <model.bin>  Tiny LSTM model file\n"
-              << "  -v              Verbose output\n";
+              << "  -o <file>       Output file (.nzp; single input only)\n"
+              << "  -m <model.bin>  Model file (LSTM, GRU or MGU)\n"
+              << "  -v              Verbose output\n"
+              << "  -t <n>          Two-phase encoding with n output-layer\n"
+              << "                  threads (0 = all cores)\n"
+              << "  --pipeline      Range-code on a second thread while the model\n"
+              << "                  runs (same output, lower latency)\n"
+              << "  --step-threads <n> Split each model step across n threads\n"
+              << "                  (same output; for one stream with a large model)\n"
+              << "  -j <n>          Batch mode: compress all inputs on n worker\n"
+              << "                  threads (0 = all cores) with one shared model\n"
+              << "  --segment <n>   Batch mode: split files larger than n bytes\n"
+              << "                  into independently coded segments (default 1 MiB)\n"
+              << "  --io <backend>  Batch mode file I/O: blocking (default) or uring\n"
+              << "  --checkpoint <n>  Store an LSTM state checkpoint every n bytes\n"
+              << "                  (random access with neurounzip --offset)\n"
+              << "  --checkpoint-int8 Store checkpoints as int8 instead of fp16\n"
+              << "  --appendable    Save the final encoder state so --append can\n"
+              << "                  extend the file without recompressing it\n"
+              << "  --append <file> Append the contents of <file> to an existing .nzp\n"
+              << "  --alphabet      Code over only the byte values the input uses (a\n"
+              << "                  32-byte bitmap; smaller output layer on text)\n"
+              << "  --archive <out.nza> Write all inputs into one deduplicating archive:\n"
+              << "                  content-defined chunks, each distinct chunk coded once\n"
+              << "  --base <old.nza> With --archive: copy chunks already coded in an\n"
+              << "                  earlier archive instead of coding them again\n"
+              << "  --chunk <n>     With --archive: average chunk size (default 64 KiB)\n"
+              << "  --compact       Write a compact frame (a few bytes of framing\n"
+              << "                  instead of a 48-byte header) for short messages\n"
+              << "  --no-checksum   With --compact: leave out the 2-byte checksum\n"
+              << "  --tune          Measure model speed, memory bandwidth and cores on\n"
+              << "                  this host and save a tuning profile\n"
+              << "  --auto          Pick encoder, threads and (batch) segment size\n"
+              << "                  from the tuning profile\n"
+              << "  --target <MB/s> With --auto in batch mode: best ratio that is\n"
+              << "                  predicted to reach this speed\n"
+              << "  --profile <file> Tuning profile to write or use (default\n"
+              << "                  ~/.config/neurozip/tune.profile)\n"
+              << "  --estimate      Print the expected compressed size of each input\n"
+              << "                  from the model's code length on a sample; writes\n"
+              << "                  nothing (-j sets the threads)\n"
+              << "  --sample <n>    With --estimate: bytes to model per file\n"
+              << "                  (default 1 MiB, 0 = whole file)\n"
+              << "  --primed <id>   Start coding from primed state <id> of the model\n"
+              << "                  (a warm start for short messages; 0 = cold)\n"
+              << "  --prime-model <out.bin> Write a copy of the model with one primed\n"
+              << "                  state per input file, run over it as a prefix\n"
+              << "  --fixed-point   Deterministic fixed-point inference\n"
+              << "                  (bit-exact decoding on any machine)\n"
+              << "  --trace <file>  Write a timeline of model load, coding, checksum\n"
+              << "                  and I/O spans per thread as Chrome trace JSON\n"
+#ifdef NEUROZIP_HAVE_DAEMON
+              << "  --daemon <sock> Compress through a running neurozipd\n"
+              << "                  (no -m needed; encoder options are ignored)\n"
+#endif
+              ;
 }
 
+/// With --trace: stop recording and write the timeline when main returns.
+struct TraceOutput {
+    std::string path;
+    ~TraceOutput()
+    {
+        if (path.empty()) return;
+        nzp_trace_stop();
+        if (nzp_trace_write(path.c_str()) != NZP_OK) {
+            std::cerr << "Cannot write trace " << path << "\n";
+        }
+    }
+};
+
+#ifdef NEUROZIP_HAVE_DAEMON
+static int compress_via_daemon(
+    const std::string& socketPath,
+    const std::string& inputPath,
+    const std::string& outputPath,
+    bool fixedPoint
+) {
+    std::ifstream ifs(inputPath, std::ios::binary);
+    if (!ifs) {
+        std::cerr << "Cannot read " << inputPath << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    neurozip::daemon::DaemonClient client;
+    if (!client.connect(socketPath)) {
+        std::cerr << "Cannot connect to neurozipd at " << socketPath << "\n";
+        return 1;
+    }
+
+    std::vector<uint8_t> out;
+    nzp_error_t err = client.compress(data, out, fixedPoint);
+    if (err != NZP_OK) {
+        std::cerr << "Compression error: " << nzp_strerror(err) << "\n";
+        return 1;
+    }
+
+    std::ofstream ofs(outputPath, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    if (!ofs) {
+        std::cerr << "Cannot write " << outputPath << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -17,10 +133,33 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    std::string inputPath;
+    std::vector<std::string> inputPaths;
     std::string outputPath;
     std::string modelPath;
+    std::string daemonSocket;
+    std::string appendPath;
+    std::string profilePath;
+    std::string archivePath;
+    nzp_archive_options_t archiveOptions;
+    nzp_archive_options_init(&archiveOptions);
+    std::string basePath;
+    bool tune = false;
+    bool estimate = false;
+    std::string primeModelPath;
+    uint32_t primedState = 0;
+    nzp_estimate_options_t estimateOptions;
+    nzp_estimate_options_init(&estimateOptions);
+    bool compact = false;
+    bool frameChecksum = true;
     bool verbose = false;
+    bool fixedPoint = false;
+    unsigned stepThreads = 1;
+    bool batch = false;
+    TraceOutput trace;
+    nzp_compress_options_t options;
+    nzp_compress_options_init(&options);
+    nzp_batch_options_t batchOptions;
+    nzp_batch_options_init(&batchOptions);
 
     // Parse args
     for (int i = 1; i < argc; ++i) {
@@ -29,30 +168,134 @@ int main(int argc, char** argv)
             outputPath = argv[++i];
         } else if (a == "-m" && i + 1 < argc) {
             modelPath = argv[++i];
+        } else if (a == "-t" && i + 1 < argc) {
+            options.two_phase = 1;
+            options.threads = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--pipeline") {
+            options.pipelined = 1;
+        } else if (a == "--step-threads" && i + 1 < argc) {
+            stepThreads = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "-j" && i + 1 < argc) {
+            batch = true;
+            batchOptions.threads = (unsigned)std::stoul(argv[++i]);
+            estimateOptions.threads = batchOptions.threads;
+        } else if (a == "--io" && i + 1 < argc) {
+            std::string io = argv[++i];
+            if (io == "uring") {
+                batchOptions.io_backend = NZP_IO_URING;
+            } else if (io != "blocking") {
+                print_usage();
+                return 1;
+            }
+        } else if (a == "--segment" && i + 1 < argc) {
+            batchOptions.segment_size = std::stoull(argv[++i]);
+        } else if (a == "--checkpoint" && i + 1 < argc) {
+            options.checkpoint_interval = (uint32_t)std::stoul(argv[++i]);
+        } else if (a == "--checkpoint-int8") {
+            options.checkpoint_int8 = 1;
+        } else if (a == "--appendable") {
+            options.appendable = 1;
+        } else if (a == "--alphabet") {
+            options.reduced_alphabet = 1;
+        } else if (a == "--append" && i + 1 < argc) {
+            appendPath = argv[++i];
+        } else if (a == "--archive" && i + 1 < argc) {
+            archivePath = argv[++i];
+        } else if (a == "--base" && i + 1 < argc) {
+            basePath = argv[++i];
+        } else if (a == "--chunk" && i + 1 < argc) {
+            archiveOptions.chunk_size = (uint32_t)std::stoul(argv[++i]);
+        } else if (a == "--compact") {
+            compact = true;
+        } else if (a == "--no-checksum") {
+            frameChecksum = false;
+        } else if (a == "--estimate") {
+            estimate = true;
+        } else if (a == "--sample" && i + 1 < argc) {
+            estimateOptions.sample_bytes = std::stoull(argv[++i]);
+        } else if (a == "--primed" && i + 1 < argc) {
+            primedState = (uint32_t)std::stoul(argv[++i]);
+        } else if (a == "--prime-model" && i + 1 < argc) {
+            primeModelPath = argv[++i];
+        } else if (a == "--tune") {
+            tune = true;
+        } else if (a == "--auto") {
+            options.auto_tune = 1;
+            batchOptions.auto_tune = 1;
+        } else if (a == "--target" && i + 1 < argc) {
+            options.auto_tune = 1;
+            batchOptions.auto_tune = 1;
+            batchOptions.target_mbps = std::stod(argv[++i]);
+        } else if (a == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (a == "--trace" && i + 1 < argc) {
+            trace.path = argv[++i];
+        } else if (a == "--daemon" && i + 1 < argc) {
+            daemonSocket = argv[++i];
         } else if (a == "-v") {
             verbose = true;
+        } else if (a == "--fixed-point") {
+            fixedPoint = true;
         } else if (a[0] == '-') {
             print_usage();
             return 1;
         } else {
-            inputPath = a;
+            inputPaths.push_back(a);
         }
     }
 
-    if (inputPath.empty()) {
+    if (inputPaths.empty() && !tune) {
         print_usage();
         return 1;
     }
+    if (!trace.path.empty()) {
+        neurozip::trace_set_thread_name("main");
+        nzp_trace_start();
+    }
+    if (inputPaths.size() > 1) {
+        batch = true;
+    }
+    if (!archivePath.empty() || estimate || !primeModelPath.empty()) {
+        batch = false; // one output; -j sets the coding threads
+    }
+    if (batch && (!outputPath.empty() || !daemonSocket.empty() || !appendPath.empty() || compact)) {
+        std::cerr << "Error: -o, --daemon, --append and --compact take a single input file\n";
+        return 1;
+    }
 
-    if (outputPath.empty()) {
+    const std::string inputPath = inputPaths.empty() ? std::string() : inputPaths[0];
+    if (outputPath.empty() && !inputPath.empty()) {
         outputPath = inputPath + ".nzp";
     }
 
+#ifdef NEUROZIP_HAVE_DAEMON
+    if (!daemonSocket.empty() && !tune) {
+        if (verbose) {
+            std::cout << "Compressing " << inputPath << " -> " << outputPath
+                      << " via " << daemonSocket << "\n";
+        }
+        return compress_via_daemon(daemonSocket, inputPath, outputPath, fixedPoint);
+    }
+#endif
+
     if (modelPath.empty()) {
         std::cerr << "Error: You must specify a model file with -m\n";
         return 1;
     }
 
+    if (!primeModelPath.empty()) {
+        auto err = neurozip::prime_model(modelPath, primeModelPath, inputPaths);
+        if (err != NZP_OK) {
+            std::cerr << "Priming error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        if (verbose) {
+            neurozip::Model primed(primeModelPath);
+            std::cout << primeModelPath << ": " << primed.primed_state_count() << " primed states\n";
+        }
+        return 0;
+    }
+
     if (verbose) {
         std::cout << "Loading model: " << modelPath << "\n";
     }
@@ -62,12 +305,157 @@ int main(int argc, char** argv)
         std::cerr << "Failed to load model: " << modelPath << "\n";
         return 1;
     }
+    model.set_fixed_point(fixedPoint);
+    model.set_step_threads(stepThreads);
+    if (!model.set_primed_state(primedState)) {
+        std::cerr << "Error: " << modelPath << " has no primed state " << primedState << " (it has "
+                  << model.primed_state_count() << ")\n";
+        return 1;
+    }
+
+    if (tune) {
+        const std::string path = profilePath.empty() ? nzp_tune_default_path() : profilePath;
+        std::cout << "Calibrating " << modelPath << " on this host...\n";
+        auto err = neurozip::tune(model, path);
+        if (err != NZP_OK) {
+            std::cerr << "Tuning error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        std::cout << "Saved tuning profile to " << path << "\n";
+        if (verbose) {
+            std::ifstream ifs(path);
+            std::cout << ifs.rdbuf();
+        }
+        if (inputPaths.empty()) return 0;
+    } else if (!profilePath.empty() && options.auto_tune) {
+        auto err = nzp_model_set_tune_profile(model.raw(), profilePath.c_str());
+        if (err != NZP_OK) {
+            std::cerr << "Cannot load tuning profile " << profilePath << ": " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+    }
+
+    if (estimate) {
+        int failed = 0;
+        for (const auto& in : inputPaths) {
+            nzp_estimate_t e;
+            auto err = neurozip::estimate_file(in, model, &estimateOptions, e);
+            if (err != NZP_OK) {
+                std::cerr << in << ": " << nzp_strerror(err) << "\n";
+                failed = 1;
+                continue;
+            }
+            double ratio = e.input_bytes ? (double)e.estimated_bytes / (double)e.input_bytes : 1.0;
+            char line[160];
+            std::snprintf(line, sizeof(line), "%llu bytes, %.3f bits/byte -> ~%llu bytes (%.1f%%)",
+                          (unsigned long long)e.input_bytes, e.bits_per_byte,
+                          (unsigned long long)e.estimated_bytes, ratio * 100.0);
+            std::cout << in << ": " << line;
+            if (e.estimated_bytes >= e.input_bytes) std::cout << "  [incompressible]";
+            if (verbose && e.sampled_bytes < e.input_bytes) {
+                std::cout << "  (sampled " << e.sampled_bytes << " bytes)";
+            }
+            std::cout << "\n";
+        }
+        return failed;
+    }
+
+    if (!archivePath.empty()) {
+        archiveOptions.threads = batchOptions.threads;
+        archiveOptions.base_path = basePath.empty() ? nullptr : basePath.c_str();
+        if (verbose) {
+            std::cout << "Archiving " << inputPaths.size() << " files -> " << archivePath << "\n";
+        }
+        nzp_archive_stats_t stats;
+        auto err = neurozip::create_archive(archivePath, inputPaths, model, &archiveOptions, &stats);
+        if (err != NZP_OK) {
+            std::cerr << "Archive error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        if (verbose) {
+            std::cout << stats.input_bytes << " bytes in " << stats.chunks << " chunks, "
+                      << stats.unique_chunks << " distinct (" << stats.unique_bytes << " bytes), "
+                      << stats.coded_chunks << " coded (" << stats.coded_bytes << " bytes) -> "
+                      << stats.archive_bytes << " bytes\n";
+        }
+        return 0;
+    }
+
+    if (!appendPath.empty()) {
+        // The new data is coded in the mode the file was written with.
+        int fileFixedPoint = 0;
+        if (nzp_file_fixed_point(inputPath.c_str(), &fileFixedPoint) == NZP_OK) {
+            model.set_fixed_point(fileFixedPoint != 0);
+        }
+        uint32_t filePrimedState = 0;
+        if (nzp_file_primed_state(inputPath.c_str(), &filePrimedState) == NZP_OK) {
+            model.set_primed_state(filePrimedState);
+        }
+        if (verbose) {
+            std::cout << "Appending " << appendPath << " -> " << inputPath << "\n";
+        }
+        auto err = neurozip::append_file(inputPath, appendPath, model, &options);
+        if (err != NZP_OK) {
+            std::cerr << "Append error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (batch) {
+        std::vector<std::string> outputPaths;
+        for (const auto& in : inputPaths) outputPaths.push_back(in + ".nzp");
+        batchOptions.compress = options;
+
+        if (verbose) {
+            std::cout << "Compressing " << inputPaths.size() << " files\n";
+            if (batchOptions.io_backend == NZP_IO_URING && !nzp_io_backend_available(NZP_IO_URING)) {
+                std::cout << "io_uring unavailable, using blocking I/O\n";
+            }
+        }
+
+        std::vector<nzp_error_t> errors;
+        auto err = neurozip::compress_batch(inputPaths, outputPaths, model, batchOptions, errors);
+        for (size_t i = 0; i < errors.size(); ++i) {
+            if (errors[i] != NZP_OK) {
+                std::cerr << inputPaths[i] << ": " << nzp_strerror(errors[i]) << "\n";
+            } else if (verbose) {
+                std::cout << inputPaths[i] << " -> " << outputPaths[i] << "\n";
+            }
+        }
+        return err == NZP_OK ? 0 : 1;
+    }
 
     if (verbose) {
         std::cout << "Compressing " << inputPath << " -> " << outputPath << "\n";
     }
 
-    auto err = neurozip::compress_file(inputPath, outputPath, model);
+    if (compact) {
+        std::ifstream ifs(inputPath, std::ios::binary);
+        if (!ifs) {
+            std::cerr << "Cannot read " << inputPath << "\n";
+            return 1;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        std::vector<uint8_t> frame;
+        auto err = neurozip::compress_frame(data, frame, model, frameChecksum);
+        if (err != NZP_OK) {
+            std::cerr << "Compression error: " << nzp_strerror(err) << "\n";
+            return 1;
+        }
+        std::ofstream ofs(outputPath, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+        if (!ofs) {
+            std::cerr << "Cannot write " << outputPath << "\n";
+            return 1;
+        }
+        if (verbose) {
+            std::cout << "OK (" << data.size() << " -> " << frame.size() << " bytes)\n";
+        }
+        return 0;
+    }
+
+    auto err = neurozip::compress_file(inputPath, outputPath, model, options);
 
     if (err != NZP_OK) {
         std::cerr << "Compression error: " << nzp_strerror(err) << "\n";
@@ -0,0 +1,97 @@
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <pthread.h>
+#include "../daemon/daemon_server.h"
+
+static void print_usage() {
+    std::cout << "Usage: neurozipd [options] -m <model.bin> -s <socket>\n"
+              << "Options:\n"
+              << "  -m <model.bin>  Model file (LSTM, GRU or MGU)\n"
+              << "  -s <socket>     Unix domain socket path to listen on\n"
+              << "  -j <n>          Worker threads (0 = all cores, default)\n"
+              << "  --cache <bytes> Keep up to this many bytes of compressed results\n"
+              << "                  so repeated payloads skip the model (LRU)\n"
+              << "  --primed <id>   Compress from this primed state of the model\n"
+              << "  -v              Verbose output\n"
+              << "Signals:\n"
+              << "  SIGHUP          Reload the model file\n"
+              << "  SIGINT/SIGTERM  Shut down\n";
+}
+
+int main(int argc, char** argv)
+{
+    neurozip::daemon::DaemonConfig config;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "-m" && i + 1 < argc) {
+            config.modelPath = argv[++i];
+        } else if (a == "-s" && i + 1 < argc) {
+            config.socketPath = argv[++i];
+        } else if (a == "-j" && i + 1 < argc) {
+            config.workers = (unsigned)std::stoul(argv[++i]);
+        } else if (a == "--cache" && i + 1 < argc) {
+            config.cacheBytes = std::stoull(argv[++i]);
+        } else if (a == "--primed" && i + 1 < argc) {
+            config.primedState = (uint32_t)std::stoul(argv[++i]);
+        } else if (a == "-v") {
+            verbose = true;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (config.modelPath.empty() || config.socketPath.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    // Block the signals before any thread starts so that only the sigwait
+    // loop below sees them; the workers inherit the mask.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    neurozip::daemon::DaemonServer server(config);
+    std::string error;
+    if (!server.start(&error)) {
+        std::cerr << "neurozipd: " << error << "\n";
+        return 1;
+    }
+
+    if (verbose) {
+        std::cout << "neurozipd: listening on " << config.socketPath << "\n";
+    }
+
+    for (;;) {
+        int sig = 0;
+        if (sigwait(&signals, &sig) != 0) continue;
+        if (sig == SIGHUP) {
+            if (server.reload()) {
+                if (verbose) std::cout << "neurozipd: reloaded " << config.modelPath << "\n";
+            } else {
+                std::cerr << "neurozipd: reload failed, keeping previous model\n";
+            }
+            continue;
+        }
+        break;
+    }
+
+    server.stop();
+    if (verbose) {
+        std::cout << "neurozipd: served " << server.requests_served() << " requests\n";
+        if (config.cacheBytes) {
+            nzp_cache_stats_t s = server.cache_stats();
+            std::cout << "neurozipd: cache " << s.hits << " hits, " << s.misses << " misses, "
+                      << s.entries << " entries, " << s.bytes << " bytes\n";
+        }
+    }
+    return 0;
+}
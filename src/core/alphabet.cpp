@@ -0,0 +1,38 @@
+#include "alphabet.h"
+
+namespace neurozip {
+
+/// Fill symbols / rank / count from a 256-entry presence table.
+static void build_alphabet(const bool* used, ByteAlphabet& out)
+{
+    out.count = 0;
+    for (uint32_t s = 0; s < 256; ++s) {
+        out.rank[s] = 0;
+        if (used[s]) {
+            out.rank[s] = (uint8_t)out.count;
+            out.symbols[out.count++] = (uint8_t)s;
+        }
+    }
+}
+
+void ByteAlphabet::scan(const uint8_t* data, size_t size)
+{
+    bool used[256] = {};
+    for (size_t i = 0; i < size; ++i) used[data[i]] = true;
+    build_alphabet(used, *this);
+}
+
+void ByteAlphabet::write_bitmap(uint8_t* out) const
+{
+    for (size_t i = 0; i < kAlphabetBitmapBytes; ++i) out[i] = 0;
+    for (uint32_t k = 0; k < count; ++k) out[symbols[k] >> 3] |= (uint8_t)(1u << (symbols[k] & 7));
+}
+
+void ByteAlphabet::read_bitmap(const uint8_t* in)
+{
+    bool used[256];
+    for (uint32_t s = 0; s < 256; ++s) used[s] = (in[s >> 3] >> (s & 7)) & 1u;
+    build_alphabet(used, *this);
+}
+
+} // namespace neurozip
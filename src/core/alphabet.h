@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace neurozip {
+
+/// Bytes of the used-symbol bitmap at the start of a reduced-alphabet
+/// stream (CompressOptions::reducedAlphabet): bit (s & 7) of byte s / 8 is
+/// set if byte value s occurs in the stream's input.
+constexpr size_t kAlphabetBitmapBytes = 32;
+
+/// The byte values a block uses. Coding ranks symbols by value: the
+/// output layer computes only these rows, and the softmax and the CDF run
+/// over size() symbols instead of 256.
+struct ByteAlphabet {
+    uint8_t symbols[256]; // used byte values, ascending
+    uint8_t rank[256];    // index of a used value in symbols (else 0)
+    uint32_t count = 0;
+
+    uint32_t size() const { return count; }
+
+    /// Collect the byte values of data[0, size).
+    void scan(const uint8_t* data, size_t size);
+
+    void write_bitmap(uint8_t* out) const;
+    void read_bitmap(const uint8_t* in);
+};
+
+} // namespace neurozip
@@ -0,0 +1,518 @@
+#include "archive.h"
+
+#include "chunking.h"
+#include "task_scheduler.h"
+#include "trace.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace neurozip {
+
+static void put_u16(std::vector<uint8_t>& out, uint16_t v)
+{
+    for (int i = 0; i < 2; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+namespace {
+
+/// Bounds-checked little-endian reader over the index.
+struct IndexReader {
+    const uint8_t* p;
+    size_t left;
+    bool ok = true;
+
+    bool take(size_t n)
+    {
+        if (!ok || left < n) return ok = false;
+        return true;
+    }
+    uint32_t u32()
+    {
+        if (!take(4)) return 0;
+        uint32_t v = get_u32(p);
+        p += 4;
+        left -= 4;
+        return v;
+    }
+    uint64_t u64()
+    {
+        if (!take(8)) return 0;
+        uint64_t v = get_u64(p);
+        p += 8;
+        left -= 8;
+        return v;
+    }
+    std::string str(size_t n)
+    {
+        if (!take(n)) return std::string();
+        std::string s((const char*)p, n);
+        p += n;
+        left -= n;
+        return s;
+    }
+};
+
+struct ChunkId {
+    uint64_t lo;
+    uint64_t hi;
+    uint64_t size;
+
+    bool operator==(const ChunkId& o) const { return lo == o.lo && hi == o.hi && size == o.size; }
+};
+
+struct ChunkIdHash {
+    size_t operator()(const ChunkId& id) const { return (size_t)(id.lo ^ id.size); }
+};
+
+// ResultCacheKey variant of a decoded chunk during extraction.
+constexpr uint64_t kDecodedChunkVariant = 3u << 8;
+
+} // namespace
+
+static void serialize_index(const ArchiveIndex& index, std::vector<uint8_t>& out)
+{
+    put_u32(out, (uint32_t)index.chunks.size());
+    for (const auto& c : index.chunks) {
+        put_u64(out, c.hash.lo);
+        put_u64(out, c.hash.hi);
+        put_u64(out, c.originalSize);
+        put_u64(out, c.streamSize);
+    }
+    put_u32(out, (uint32_t)index.members.size());
+    for (const auto& m : index.members) {
+        put_u32(out, (uint32_t)m.name.size());
+        out.insert(out.end(), m.name.begin(), m.name.end());
+        put_u64(out, m.size);
+        put_u32(out, m.checksum);
+        put_u32(out, (uint32_t)m.chunks.size());
+        for (uint32_t c : m.chunks) put_u32(out, c);
+    }
+}
+
+static bool parse_index(const uint8_t* data, size_t size, ArchiveIndex& index)
+{
+    IndexReader r{ data, size };
+    uint32_t chunkCount = r.u32();
+    if (!r.ok || (uint64_t)chunkCount * 32 > r.left) return false;
+    index.chunks.resize(chunkCount);
+    uint64_t offset = NZA_HEADER_SIZE;
+    for (auto& c : index.chunks) {
+        c.hash.lo = r.u64();
+        c.hash.hi = r.u64();
+        c.originalSize = r.u64();
+        c.streamSize = r.u64();
+        c.streamOffset = offset;
+        offset += c.streamSize;
+    }
+
+    uint32_t memberCount = r.u32();
+    if (!r.ok || (uint64_t)memberCount * 20 > r.left) return false;
+    index.members.resize(memberCount);
+    for (auto& m : index.members) {
+        m.name = r.str(r.u32());
+        m.size = r.u64();
+        m.checksum = r.u32();
+        uint32_t refs = r.u32();
+        if (!r.ok || (uint64_t)refs * 4 > r.left) return false;
+        m.chunks.resize(refs);
+        uint64_t total = 0;
+        for (auto& c : m.chunks) {
+            c = r.u32();
+            if (c >= chunkCount) return false;
+            total += index.chunks[c].originalSize;
+        }
+        if (total != m.size) return false;
+    }
+    return r.ok && r.left == 0;
+}
+
+bool is_archive(const uint8_t* data, size_t size)
+{
+    return size >= 4 && get_u32(data) == NZA_MAGIC;
+}
+
+std::string archive_member_name(const std::string& inputPath)
+{
+    namespace fs = std::filesystem;
+    fs::path p = fs::path(inputPath).lexically_normal().relative_path();
+    if (p.empty() || *p.begin() == "..") p = fs::path(inputPath).filename();
+    return p.generic_string();
+}
+
+/// True if 'model' codes chunks the way the archive's were coded: same
+/// weights, inference mode and primed snapshot.
+static bool made_with(const ArchiveIndex& index, const ICompressionModel& model)
+{
+    return index.modelId == model.model_id() && index.modelHash == model.model_hash() &&
+           index.fixedPoint == model.fixed_point() && index.primedState == model.primed_state() &&
+           index.primedStateHash == model.primed_state_hash();
+}
+
+ErrorCode read_archive_index(const std::string& path, ArchiveIndex& outIndex)
+{
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) return ErrorCode::IoError;
+    const uint64_t fileSize = (uint64_t)ifs.tellg();
+    if (fileSize < NZA_HEADER_SIZE + NZA_TRAILER_SIZE) return ErrorCode::InvalidFormat;
+
+    uint8_t header[NZA_HEADER_SIZE];
+    ifs.seekg(0);
+    if (!ifs.read((char*)header, sizeof(header))) return ErrorCode::IoError;
+    if (get_u32(header) != NZA_MAGIC) return ErrorCode::InvalidFormat;
+    if (header[4] != NZA_FORMAT_VERSION) return ErrorCode::UnsupportedVersion;
+
+    uint8_t trailer[NZA_TRAILER_SIZE];
+    ifs.seekg((std::streamoff)(fileSize - NZA_TRAILER_SIZE));
+    if (!ifs.read((char*)trailer, sizeof(trailer))) return ErrorCode::IoError;
+    const uint64_t indexOffset = get_u64(trailer);
+    if (get_u32(trailer + 12) != NZA_MAGIC || indexOffset < NZA_HEADER_SIZE ||
+        indexOffset > fileSize - NZA_TRAILER_SIZE) {
+        return ErrorCode::CorruptData;
+    }
+
+    std::vector<uint8_t> bytes((size_t)(fileSize - NZA_TRAILER_SIZE - indexOffset));
+    ifs.seekg((std::streamoff)indexOffset);
+    if (!ifs.read((char*)bytes.data(), (std::streamsize)bytes.size())) return ErrorCode::IoError;
+    if (crc32(bytes.data(), bytes.size()) != get_u32(trailer + 8)) return ErrorCode::CorruptData;
+
+    ArchiveIndex index;
+    index.fixedPoint = (header[5] & NZA_FLAG_FIXED_POINT) != 0;
+    index.primedState = (uint16_t)(header[6] | (header[7] << 8));
+    index.modelId = get_u32(header + 8);
+    index.modelHash = get_u64(header + 12);
+    index.primedStateHash = get_u32(header + 20);
+    if (!parse_index(bytes.data(), bytes.size(), index)) return ErrorCode::CorruptData;
+    if (!index.chunks.empty() &&
+        index.chunks.back().streamOffset + index.chunks.back().streamSize != indexOffset) {
+        return ErrorCode::CorruptData;
+    }
+    outIndex = std::move(index);
+    return ErrorCode::Ok;
+}
+
+/// Build the whole archive at 'path'; create_archive moves it into place.
+static ErrorCode write_archive(
+    const ICompressionModel& model,
+    WorkerPool& pool,
+    const std::vector<std::string>& inputPaths,
+    const std::string& path,
+    const ArchiveOptions& options,
+    ArchiveStats& outStats
+) {
+    if (model.primed_state() > UINT16_MAX) return ErrorCode::InvalidFormat;
+
+    ArchiveIndex base;
+    std::ifstream baseFile;
+    std::unordered_map<ChunkId, uint32_t, ChunkIdHash> baseChunks;
+    if (!options.basePath.empty()) {
+        ErrorCode ec = read_archive_index(options.basePath, base);
+        if (ec != ErrorCode::Ok) return ec;
+        if (!made_with(base, model)) {
+            return ErrorCode::ModelMismatch;
+        }
+        for (uint32_t i = 0; i < base.chunks.size(); ++i) {
+            const ArchiveChunk& c = base.chunks[i];
+            baseChunks.emplace(ChunkId{ c.hash.lo, c.hash.hi, c.originalSize }, i);
+        }
+        baseFile.open(options.basePath, std::ios::binary);
+        if (!baseFile) return ErrorCode::IoError;
+    }
+
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) return ErrorCode::IoError;
+
+    ArchiveIndex index;
+    index.modelId = model.model_id();
+    index.modelHash = model.model_hash();
+    index.fixedPoint = model.fixed_point();
+    index.primedState = (uint16_t)model.primed_state();
+    index.primedStateHash = model.primed_state_hash();
+
+    std::vector<uint8_t> header;
+    put_u32(header, NZA_MAGIC);
+    header.push_back(NZA_FORMAT_VERSION);
+    header.push_back(index.fixedPoint ? NZA_FLAG_FIXED_POINT : 0);
+    put_u16(header, index.primedState);
+    put_u32(header, index.modelId);
+    put_u64(header, index.modelHash);
+    put_u32(header, index.primedStateHash);
+    ofs.write((const char*)header.data(), (std::streamsize)header.size());
+
+    // New distinct chunks wait here (with their file's data) until enough
+    // are collected to keep the pool busy, then go out in chunk order.
+    struct Pending {
+        uint32_t chunk;
+        std::shared_ptr<const std::vector<uint8_t>> file;
+        size_t offset;
+        size_t length;
+        int64_t baseChunk; // copy the stream from the base archive, or -1
+        std::vector<uint8_t> stream;
+    };
+    std::vector<Pending> pending;
+    size_t pendingBytes = 0;
+    uint64_t streamOffset = NZA_HEADER_SIZE;
+
+    const ChunkParams params = chunk_params(options.chunkSize);
+    const size_t flushBytes = std::max<size_t>((size_t)16 << 20, params.maxSize * pool.size() * 4);
+
+    auto flush = [&]() -> ErrorCode {
+        TraceSpan flushSpan("archive_flush", "dedup", pendingBytes);
+        std::vector<ScheduledTask> tasks;
+        for (auto& pc : pending) {
+            if (pc.baseChunk >= 0) continue;
+            Pending* p = &pc;
+            tasks.push_back({ pc.length, [p, &pool, &model](unsigned worker) {
+                const auto& local = pool.local_model(model, worker);
+                p->stream = compress_buffer(local, p->file->data() + p->offset, p->length);
+            }, {} });
+        }
+        if (!tasks.empty()) run_work_stealing(pool, tasks);
+
+        for (auto& pc : pending) {
+            if (pc.baseChunk >= 0) {
+                const ArchiveChunk& bc = base.chunks[(size_t)pc.baseChunk];
+                pc.stream.resize((size_t)bc.streamSize);
+                baseFile.seekg((std::streamoff)bc.streamOffset);
+                if (!baseFile.read((char*)pc.stream.data(), (std::streamsize)pc.stream.size())) {
+                    return ErrorCode::IoError;
+                }
+            }
+            ArchiveChunk& c = index.chunks[pc.chunk];
+            c.streamSize = pc.stream.size();
+            c.streamOffset = streamOffset;
+            streamOffset += c.streamSize;
+            ofs.write((const char*)pc.stream.data(), (std::streamsize)pc.stream.size());
+        }
+        pending.clear();
+        pendingBytes = 0;
+        return ofs ? ErrorCode::Ok : ErrorCode::IoError;
+    };
+
+    ArchiveStats stats;
+    std::unordered_map<ChunkId, uint32_t, ChunkIdHash> known;
+    std::vector<size_t> lengths;
+    for (const auto& path : inputPaths) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return ErrorCode::IoError;
+        auto file = std::make_shared<const std::vector<uint8_t>>(
+            (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        ArchiveMember member;
+        member.name = archive_member_name(path);
+        member.size = file->size();
+        member.checksum = crc32(file->data(), file->size());
+
+        lengths.clear();
+        content_defined_chunks(file->data(), file->size(), params, lengths);
+        size_t offset = 0;
+        for (size_t len : lengths) {
+            const ContentHash hash = content_hash(file->data() + offset, len);
+            const ChunkId id{ hash.lo, hash.hi, len };
+            auto it = known.find(id);
+            if (it != known.end()) {
+                member.chunks.push_back(it->second);
+            } else {
+                const uint32_t chunk = (uint32_t)index.chunks.size();
+                known.emplace(id, chunk);
+                ArchiveChunk c;
+                c.hash = hash;
+                c.originalSize = len;
+                index.chunks.push_back(c);
+                member.chunks.push_back(chunk);
+
+                auto b = baseChunks.find(id);
+                const int64_t baseChunk = b == baseChunks.end() ? -1 : (int64_t)b->second;
+                pending.push_back({ chunk, file, offset, len, baseChunk, {} });
+                pendingBytes += len;
+                stats.uniqueChunks++;
+                stats.uniqueBytes += len;
+                if (baseChunk < 0) {
+                    stats.codedChunks++;
+                    stats.codedBytes += len;
+                }
+            }
+            stats.chunks++;
+            offset += len;
+        }
+        stats.inputBytes += member.size;
+        index.members.push_back(std::move(member));
+
+        if (pendingBytes >= flushBytes) {
+            ErrorCode ec = flush();
+            if (ec != ErrorCode::Ok) return ec;
+        }
+    }
+    ErrorCode ec = flush();
+    if (ec != ErrorCode::Ok) return ec;
+
+    std::vector<uint8_t> indexBytes;
+    serialize_index(index, indexBytes);
+    std::vector<uint8_t> trailer;
+    put_u64(trailer, streamOffset);
+    put_u32(trailer, crc32(indexBytes.data(), indexBytes.size()));
+    put_u32(trailer, NZA_MAGIC);
+    ofs.write((const char*)indexBytes.data(), (std::streamsize)indexBytes.size());
+    ofs.write((const char*)trailer.data(), (std::streamsize)trailer.size());
+    ofs.close();
+    if (!ofs) return ErrorCode::IoError;
+
+    stats.archiveBytes = streamOffset + indexBytes.size() + trailer.size();
+    outStats = stats;
+    return ErrorCode::Ok;
+}
+
+ErrorCode create_archive(
+    const ICompressionModel& model,
+    WorkerPool& pool,
+    const std::vector<std::string>& inputPaths,
+    const std::string& archivePath,
+    const ArchiveOptions& options,
+    ArchiveStats* outStats
+) {
+    namespace fs = std::filesystem;
+    TraceSpan span("create_archive", "dedup");
+
+    // The base is read while the new archive is written, so it cannot be
+    // the file being replaced.
+    std::error_code fsErr;
+    if (!options.basePath.empty() && fs::equivalent(options.basePath, archivePath, fsErr)) {
+        return ErrorCode::IoError;
+    }
+
+    // Built next to the target and renamed over it, so a failure part way
+    // leaves any archive already at 'archivePath' as it was.
+    const std::string tmpPath = replacement_path(archivePath);
+    ArchiveStats stats;
+    ErrorCode ec = write_archive(model, pool, inputPaths, tmpPath, options, stats);
+    if (ec == ErrorCode::Ok) ec = replace_file(tmpPath, archivePath);
+    if (ec != ErrorCode::Ok) {
+        fs::remove(tmpPath, fsErr);
+        return ec;
+    }
+    if (outStats) *outStats = stats;
+    return ErrorCode::Ok;
+}
+
+/// Names come from the archive: only relative paths that stay inside the
+/// output directory are accepted.
+static bool safe_member_name(const std::string& name)
+{
+    namespace fs = std::filesystem;
+    fs::path p(name);
+    if (name.empty() || p.is_absolute() || p.has_root_name() || p.has_root_directory()) return false;
+    for (const auto& part : p) {
+        if (part == "..") return false;
+    }
+    return true;
+}
+
+ErrorCode extract_archive(
+    const ICompressionModel& model,
+    WorkerPool& pool,
+    const std::string& archivePath,
+    const std::string& outputDir
+) {
+    namespace fs = std::filesystem;
+    TraceSpan span("extract_archive", "dedup");
+
+    ArchiveIndex index;
+    ErrorCode ec = read_archive_index(archivePath, index);
+    if (ec != ErrorCode::Ok) return ec;
+    if (!made_with(index, model)) {
+        return ErrorCode::ModelMismatch;
+    }
+    for (const auto& m : index.members) {
+        if (!safe_member_name(m.name)) return ErrorCode::CorruptData;
+    }
+
+    // Only chunks used more than once are worth keeping decoded.
+    std::vector<uint32_t> uses(index.chunks.size(), 0);
+    for (const auto& m : index.members) {
+        for (uint32_t c : m.chunks) uses[c]++;
+    }
+    ResultCache decoded((size_t)64 << 20);
+    const uint64_t primedTag = primed_state_tag(model);
+
+    std::mutex errorMutex;
+    ErrorCode firstError = ErrorCode::Ok;
+    auto fail = [&](ErrorCode e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (firstError == ErrorCode::Ok) firstError = e;
+    };
+
+    std::vector<ScheduledTask> tasks;
+    for (const auto& member : index.members) {
+        const ArchiveMember* m = &member;
+        tasks.push_back({ m->size, [&, m](unsigned worker) {
+            const auto& local = pool.local_model(model, worker);
+            std::ifstream in(archivePath, std::ios::binary);
+            fs::path outPath = fs::path(outputDir) / fs::path(m->name);
+            std::error_code fsError;
+            if (outPath.has_parent_path()) fs::create_directories(outPath.parent_path(), fsError);
+            std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+            if (!in || !out) return fail(ErrorCode::IoError);
+
+            uint32_t crc = 0;
+            std::vector<uint8_t> stream, data;
+            for (uint32_t c : m->chunks) {
+                const ArchiveChunk& chunk = index.chunks[c];
+                ResultCacheKey key;
+                key.content = chunk.hash;
+                key.size = chunk.originalSize;
+                key.modelHash = index.modelHash;
+                key.modelId = index.modelId;
+                key.fixedPoint = index.fixedPoint;
+                key.primedState = primedTag;
+                key.variant = kDecodedChunkVariant;
+                if (uses[c] < 2 || !decoded.lookup(key, data)) {
+                    stream.resize((size_t)chunk.streamSize);
+                    in.seekg((std::streamoff)chunk.streamOffset);
+                    if (!in.read((char*)stream.data(), (std::streamsize)stream.size())) {
+                        return fail(ErrorCode::IoError);
+                    }
+                    decompress_buffer(local, stream.data(), stream.size(), (size_t)chunk.originalSize, data);
+                    if (uses[c] > 1) decoded.insert(key, data.data(), data.size());
+                }
+                crc = crc32(data.data(), data.size(), crc);
+                out.write((const char*)data.data(), (std::streamsize)data.size());
+            }
+            out.close();
+            if (!out) return fail(ErrorCode::IoError);
+            if (crc != m->checksum) return fail(ErrorCode::CorruptData);
+        }, {} });
+    }
+    run_work_stealing(pool, tasks);
+    return firstError;
+}
+
+} // namespace neurozip
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "file_format.h"
+#include "model_interface.h"
+#include "result_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+class WorkerPool;
+
+/// Deduplicating archive (.nza) of several files. Every input is split
+/// into content-defined chunks (chunking.h); each distinct chunk is coded
+/// once, from a fresh model context, and members list the chunks they are
+/// made of. Little-endian:
+///
+///   u32 magic (NZA_MAGIC), u8 version, u8 flags (NZA_FLAG_*),
+///   u16 primed state id (0 = chunks coded from a cold start)
+///   u32 model id, u64 model hash,
+///   u32 primed state hash (primed_state_hash(), 0 with a cold start)
+///   range coder streams of all chunks, back to back, in chunk order
+///   index:
+///     u32 chunk count
+///     count x { u64 hash lo, u64 hash hi, u64 originalSize, u64 streamSize }
+///     u32 member count
+///     count x { u32 name length, name (UTF-8, '/'-separated, relative),
+///               u64 size, u32 CRC32, u32 chunk count, count x u32 chunk }
+///   u64 index offset, u32 CRC32 of the index, u32 magic
+///
+/// The index comes last so the archive is written in one pass.
+constexpr uint32_t NZA_MAGIC = 0x31415A4E; // "NZA1" little-endian
+constexpr uint8_t  NZA_FORMAT_VERSION = 2;
+constexpr uint8_t  NZA_FLAG_FIXED_POINT = 1u << 0;
+
+constexpr size_t NZA_HEADER_SIZE = 24;
+constexpr size_t NZA_TRAILER_SIZE = 16;
+
+struct ArchiveChunk {
+    ContentHash hash;
+    uint64_t originalSize = 0;
+    uint64_t streamSize = 0;
+    uint64_t streamOffset = 0; // file offset, derived from the sizes
+};
+
+struct ArchiveMember {
+    std::string name;
+    uint64_t size = 0;
+    uint32_t checksum = 0; // CRC32 of the member's data
+    std::vector<uint32_t> chunks;
+};
+
+struct ArchiveIndex {
+    uint32_t modelId = 0;
+    uint64_t modelHash = 0;
+    bool fixedPoint = false;
+    uint16_t primedState = 0;
+    uint32_t primedStateHash = 0;
+    std::vector<ArchiveChunk> chunks;
+    std::vector<ArchiveMember> members;
+};
+
+struct ArchiveOptions {
+    /// Target average chunk size (see chunk_params).
+    size_t chunkSize = 64 * 1024;
+
+    /// An earlier archive made with the same model: chunks found in it are
+    /// copied as coded instead of being coded again, so a new snapshot
+    /// costs in proportion to what changed. The new archive does not
+    /// depend on it.
+    std::string basePath;
+};
+
+struct ArchiveStats {
+    uint64_t inputBytes = 0;
+    uint64_t chunks = 0;       // over all members
+    uint64_t uniqueChunks = 0; // stored in the archive
+    uint64_t uniqueBytes = 0;
+    uint64_t codedChunks = 0;  // unique chunks run through the model
+    uint64_t codedBytes = 0;
+    uint64_t archiveBytes = 0;
+};
+
+/// True if 'data' starts with NZA_MAGIC.
+bool is_archive(const uint8_t* data, size_t size);
+
+/// Name stored for an input path: the normalized relative path, or the
+/// file name if the path leads outside the current directory.
+std::string archive_member_name(const std::string& inputPath);
+
+/// Read and verify the index of an archive file.
+ErrorCode read_archive_index(const std::string& path, ArchiveIndex& outIndex);
+
+/// Chunk, deduplicate and code 'inputPaths' into an archive. Distinct
+/// chunks are coded in parallel on 'pool'. The archive is built in a
+/// temporary file and renamed over 'archivePath' only once complete.
+/// ModelMismatch if the base archive was made with another model or
+/// inference mode; IoError if the base is 'archivePath' itself.
+ErrorCode create_archive(
+    const ICompressionModel& model,
+    WorkerPool& pool,
+    const std::vector<std::string>& inputPaths,
+    const std::string& archivePath,
+    const ArchiveOptions& options = ArchiveOptions(),
+    ArchiveStats* outStats = nullptr
+);
+
+/// Write every member to outputDir/<name>, one member per task on 'pool'.
+/// A chunk shared by several members is decoded once while it stays in a
+/// bounded cache of decoded chunks.
+ErrorCode extract_archive(
+    const ICompressionModel& model,
+    WorkerPool& pool,
+    const std::string& archivePath,
+    const std::string& outputDir
+);
+
+} // namespace neurozip
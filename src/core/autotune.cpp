@@ -0,0 +1,492 @@
+#include "autotune.h"
+
+#include "numa.h"
+#include "range_coder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <queue>
+#include <sstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace neurozip {
+
+namespace {
+
+constexpr const char* kProfileMagic = "neurozip-tune";
+constexpr int kProfileVersion = 1;
+
+// Segment sizes tried for batches; larger ones lose less ratio.
+constexpr uint64_t kMinSegment = 64 * 1024;
+constexpr uint64_t kMaxSegment = 64ull * 1024 * 1024;
+
+// Bytes at the start of a sample counted as model warm-up.
+constexpr size_t kWarmupBytes = 512;
+
+double elapsed_ns(const std::function<void()>& fn)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+/// Fastest of 'runs' timings; the others mostly measure interference.
+double best_ns(int runs, const std::function<void()>& fn)
+{
+    double best = 0.0;
+    for (int r = 0; r < runs; ++r) {
+        double t = elapsed_ns(fn);
+        if (r == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+/// Word-like text, so the model's predictions (and with them the range
+/// coder's renormalization rate) look like real input.
+std::vector<uint8_t> synthetic_text(size_t n)
+{
+    static const char* const words[] = {
+        "the ", "model ", "of ", "and ", "stream ", "byte ", "to ", "in ",
+        "compress ", "state ", "is ", "a ", "range ", "coder\n", "value, ", "for "
+    };
+    std::vector<uint8_t> out;
+    out.reserve(n + 16);
+    uint32_t x = 12345;
+    while (out.size() < n) {
+        x = x * 1103515245u + 12345u;
+        const char* w = words[(x >> 16) & 15];
+        out.insert(out.end(), w, w + std::strlen(w));
+    }
+    out.resize(n);
+    return out;
+}
+
+unsigned host_threads()
+{
+    size_t cpus = 0;
+    for (const auto& node : numa_topology().nodes) cpus += node.cpus.size();
+    if (cpus) return (unsigned)cpus;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+uint64_t last_level_cache()
+{
+    long bytes = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    if (bytes <= 0) bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return bytes > 0 ? (uint64_t)bytes : 0;
+}
+
+/// Aggregate copy bandwidth with every thread copying its own buffers.
+double measure_memory_mbps(unsigned threads)
+{
+    const size_t perThread = std::max<size_t>(1 << 20, (64u << 20) / threads) / 2;
+    std::vector<std::vector<uint8_t>> src(threads), dst(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        src[t].assign(perThread, (uint8_t)t);
+        dst[t].assign(perThread, 0);
+    }
+
+    const int passes = 4;
+    double ns = best_ns(3, [&] {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (int p = 0; p < passes; ++p) {
+                    std::memcpy(dst[t].data(), src[t].data(), perThread);
+                    src[t][p] = dst[t][perThread - 1 - p]; // keep the copies live
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    });
+    // Each copy reads and writes perThread bytes.
+    double bytes = 2.0 * perThread * passes * threads;
+    return ns > 0.0 ? bytes / ns * 1e3 : 0.0;
+}
+
+/// Range coding alone, with a skewed 256-symbol table like a trained model's.
+double measure_code_ns(const std::vector<uint8_t>& data)
+{
+    uint32_t cum[257];
+    cum[0] = 0;
+    for (uint32_t s = 0; s < 256; ++s) {
+        cum[s + 1] = cum[s] + 1 + (s >= 'a' && s <= 'z' ? 1200 : 8);
+    }
+    const uint32_t total = cum[256];
+
+    double ns = best_ns(3, [&] {
+        RangeEncoder encoder;
+        for (uint8_t b : data) encoder.encode_symbol(cum[b], cum[b + 1] - cum[b], total);
+        encoder.finish();
+    });
+    return ns / (double)data.size();
+}
+
+double measure_thread_start_ns()
+{
+    const int count = 16;
+    return best_ns(3, [&] {
+        for (int i = 0; i < count; ++i) std::thread([] {}).join();
+    }) / count;
+}
+
+/// Longest-first assignment of task sizes to 'workers': the largest load.
+uint64_t makespan(std::vector<uint64_t> tasks, unsigned workers)
+{
+    std::sort(tasks.begin(), tasks.end(), std::greater<uint64_t>());
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> loads;
+    for (unsigned w = 0; w < workers; ++w) loads.push(0);
+    uint64_t worst = 0;
+    for (uint64_t t : tasks) {
+        uint64_t load = loads.top() + t;
+        loads.pop();
+        loads.push(load);
+        worst = std::max(worst, load);
+    }
+    return worst;
+}
+
+double bits_of(float p)
+{
+    return -std::log2(std::max(p, 1e-9f));
+}
+
+} // namespace
+
+const char* encoder_kernel_name(EncoderKernel kernel)
+{
+    switch (kernel) {
+        case EncoderKernel::TwoPhase: return "two-phase";
+        case EncoderKernel::Pipelined: return "pipelined";
+        default: return "serial";
+    }
+}
+
+TuneProfile calibrate_host(const ICompressionModel& model, size_t sampleBytes)
+{
+    TuneProfile p;
+    p.hardwareThreads = host_threads();
+    p.numaNodes = (unsigned)numa_topology().node_count();
+    p.cacheBytes = last_level_cache();
+    p.memoryMBps = measure_memory_mbps(p.hardwareThreads);
+    p.threadStartNs = measure_thread_start_ns();
+
+    p.modelHash = model.model_hash();
+    p.fixedPoint = model.fixed_point();
+    p.weightBytes = model.weight_bytes();
+
+    const std::vector<uint8_t> data = synthetic_text(std::max<size_t>(sampleBytes, 256));
+    const double n = (double)data.size();
+
+    p.codeNs = measure_code_ns(data) * (model.nibble_output() ? 2.0 : 1.0);
+    p.serialNs = best_ns(2, [&] { compress_buffer(model, data.data(), data.size()); }) / n;
+
+    const size_t H = model.hidden_size();
+    if (H > 0 && !model.nibble_output()) {
+        CompressOptions options;
+        options.twoPhase = true;
+        options.threads = 1;
+        options.numaAware = false;
+        double twoPhaseNs = best_ns(2, [&] {
+            compress_buffer(model, data.data(), data.size(), options);
+        }) / n;
+
+        std::vector<float> hidden(H);
+        p.advanceNs = best_ns(2, [&] {
+            auto ctx = model.create_context();
+            uint8_t prev = 0;
+            for (uint8_t b : data) {
+                model.advance(*ctx, prev, hidden.data());
+                prev = b;
+            }
+        }) / n;
+        p.outputNs = std::max(0.0, twoPhaseNs - p.advanceNs - p.codeNs);
+    }
+    return p;
+}
+
+TuneProfile profile_for_model(const TuneProfile& profile, const ICompressionModel& model)
+{
+    TuneProfile p = profile;
+    if (model.model_hash() == profile.modelHash && model.fixed_point() == profile.fixedPoint) {
+        return p;
+    }
+    const uint64_t weights = model.weight_bytes();
+    if (weights == 0 || profile.weightBytes == 0) return p;
+
+    // Inference is dominated by reading the weights once per byte.
+    const double scale = (double)weights / (double)profile.weightBytes;
+    const double modelNs = std::max(0.0, profile.serialNs - profile.codeNs);
+    p.serialNs = profile.codeNs + modelNs * scale;
+    p.advanceNs = profile.advanceNs * scale;
+    p.outputNs = profile.outputNs * scale;
+    p.modelHash = model.model_hash();
+    p.fixedPoint = model.fixed_point();
+    p.weightBytes = weights;
+    return p;
+}
+
+CompressibilitySample sample_compressibility(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t maxBytes
+) {
+    CompressibilitySample s;
+    const size_t n = std::min(size, maxBytes);
+    if (n == 0) return s;
+
+    // Bits under the model's own distribution; the coder's quantized
+    // frequencies only add a small, constant overhead to this.
+    auto ctx = model.create_context();
+    std::vector<float> probs(256);
+    std::vector<double> bits(n);
+    uint8_t prev = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t b = data[i];
+        if (model.nibble_output()) {
+            model.predict_high_nibble(*ctx, prev, probs.data());
+            bits[i] = bits_of(probs[b >> 4]);
+            model.predict_low_nibble(*ctx, (uint8_t)(b >> 4), probs.data());
+            bits[i] += bits_of(probs[b & 15]);
+        } else {
+            model.predict_next(*ctx, prev, probs.data(), probs.size());
+            bits[i] = bits_of(probs[b]);
+        }
+        prev = b;
+    }
+
+    // Steady-state rate from the part after warm-up; the warm-up excess
+    // over that rate is what each extra segment pays again.
+    const size_t warmup = std::min(kWarmupBytes, n / 4);
+    double warmBits = 0.0, restBits = 0.0;
+    for (size_t i = 0; i < warmup; ++i) warmBits += bits[i];
+    for (size_t i = warmup; i < n; ++i) restBits += bits[i];
+
+    s.bpb = restBits / (double)(n - warmup);
+    s.restartBits = std::max(0.0, warmBits - s.bpb * (double)warmup);
+    return s;
+}
+
+TunedSettings tune_stream(const TuneProfile& profile, uint64_t inputSize)
+{
+    const double size = (double)inputSize;
+    TunedSettings best;
+    double bestNs = size * profile.serialNs;
+
+    auto consider = [&](EncoderKernel kernel, unsigned threads, double perByte, double overhead) {
+        double ns = size * perByte + overhead;
+        if (ns < bestNs) {
+            bestNs = ns;
+            best.kernel = kernel;
+            best.threads = threads;
+        }
+    };
+
+    if (profile.hardwareThreads >= 2) {
+        const double modelNs = std::max(0.0, profile.serialNs - profile.codeNs);
+        consider(EncoderKernel::Pipelined, 1, std::max(modelNs, profile.codeNs),
+                 profile.threadStartNs);
+    }
+    if (profile.advanceNs > 0.0) {
+        for (unsigned t = 1;; t = std::min(t * 2, profile.hardwareThreads)) {
+            double perByte = profile.advanceNs + profile.codeNs + profile.outputNs / t;
+            consider(EncoderKernel::TwoPhase, t, perByte, t > 1 ? t * profile.threadStartNs : 0.0);
+            if (t >= profile.hardwareThreads) break;
+        }
+    }
+
+    best.predictedMBps = bestNs > 0.0 ? size / bestNs * 1e3 : 0.0;
+    return best;
+}
+
+TunedSettings tune_batch(
+    const TuneProfile& profile,
+    const std::vector<uint64_t>& fileSizes,
+    const CompressibilitySample& sample,
+    const TuneTarget& target,
+    unsigned threads
+) {
+    unsigned workers = threads ? threads : profile.hardwareThreads;
+    workers = std::max(1u, workers);
+
+    uint64_t total = 0, largest = 0;
+    for (uint64_t s : fileSizes) {
+        total += s;
+        largest = std::max(largest, s);
+    }
+
+    // Weights that do not fit in the shared cache are streamed from memory
+    // by every worker, so bandwidth bounds how many workers help.
+    double busyWorkers = workers;
+    if (profile.cacheBytes && profile.weightBytes > profile.cacheBytes && profile.serialNs > 0.0) {
+        double perWorkerMBps = (double)profile.weightBytes / profile.serialNs * 1e3;
+        busyWorkers = std::min(busyWorkers, std::max(1.0, profile.memoryMBps / perWorkerMBps));
+    }
+
+    struct Candidate {
+        uint64_t segment;
+        unsigned workers;
+        double mbps;
+        double loss;
+    };
+    std::vector<Candidate> candidates;
+
+    std::vector<uint64_t> segments;
+    segments.push_back(0);
+    for (uint64_t s = kMaxSegment; s >= kMinSegment; s /= 2) {
+        if (s < largest) segments.push_back(s);
+    }
+
+    for (uint64_t segment : segments) {
+        std::vector<uint64_t> tasks;
+        uint64_t extra = 0;
+        for (uint64_t size : fileSizes) {
+            if (segment == 0 || size <= segment) {
+                tasks.push_back(size);
+                continue;
+            }
+            uint64_t count = (size + segment - 1) / segment;
+            for (uint64_t k = 0; k < count; ++k) tasks.push_back(std::min(segment, size - k * segment));
+            extra += count - 1;
+        }
+
+        Candidate c;
+        c.segment = segment;
+        c.workers = (unsigned)std::min<size_t>(workers, std::max<size_t>(1, tasks.size()));
+        double ns = std::max((double)makespan(tasks, c.workers) * profile.serialNs,
+                             (double)total * profile.serialNs / busyWorkers)
+                    + c.workers * profile.threadStartNs;
+        c.mbps = ns > 0.0 ? (double)total / ns * 1e3 : 0.0;
+        c.loss = total ? (double)extra * sample.restartBits / ((double)total * std::max(sample.bpb, 0.01))
+                       : 0.0;
+        candidates.push_back(c);
+    }
+
+    // Candidates run from no splitting to the smallest segments, so on ties
+    // the earlier (better ratio) one wins.
+    const Candidate* pick = nullptr;
+    const Candidate* fastest = &candidates[0];
+    for (const auto& c : candidates) {
+        if (c.mbps > fastest->mbps * 1.01) fastest = &c;
+    }
+    if (target.minMBps > 0.0) {
+        for (const auto& c : candidates) {
+            if (c.mbps >= target.minMBps && (!pick || c.loss < pick->loss)) pick = &c;
+        }
+        if (!pick) pick = fastest;
+    } else {
+        for (const auto& c : candidates) {
+            if (c.loss <= target.maxRatioLoss && (!pick || c.mbps > pick->mbps * 1.01)) pick = &c;
+        }
+        if (!pick) pick = &candidates[0];
+    }
+
+    TunedSettings out;
+    out.threads = pick->workers;
+    out.segmentSize = pick->segment;
+    out.predictedMBps = pick->mbps;
+    out.predictedRatioLoss = pick->loss;
+    return out;
+}
+
+std::string default_tune_profile_path()
+{
+    if (const char* env = std::getenv("NEUROZIP_TUNE_PROFILE")) {
+        if (*env) return env;
+    }
+    std::filesystem::path dir;
+    if (const char* xdg = std::getenv("XDG_CONFIG_HOME"); xdg && *xdg) {
+        dir = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        dir = std::filesystem::path(home) / ".config";
+    } else {
+        dir = ".";
+    }
+    return (dir / "neurozip" / "tune.profile").string();
+}
+
+bool save_tune_profile(const TuneProfile& p, const std::string& path)
+{
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    std::ofstream ofs(path);
+    if (!ofs) return false;
+    ofs << kProfileMagic << " " << kProfileVersion << "\n"
+        << std::setprecision(9)
+        << "hardware_threads " << p.hardwareThreads << "\n"
+        << "numa_nodes " << p.numaNodes << "\n"
+        << "cache_bytes " << p.cacheBytes << "\n"
+        << "memory_mbps " << p.memoryMBps << "\n"
+        << "model_hash " << std::hex << p.modelHash << std::dec << "\n"
+        << "fixed_point " << (p.fixedPoint ? 1 : 0) << "\n"
+        << "weight_bytes " << p.weightBytes << "\n"
+        << "serial_ns " << p.serialNs << "\n"
+        << "code_ns " << p.codeNs << "\n"
+        << "advance_ns " << p.advanceNs << "\n"
+        << "output_ns " << p.outputNs << "\n"
+        << "thread_start_ns " << p.threadStartNs << "\n";
+    return (bool)ofs;
+}
+
+bool load_tune_profile(const std::string& path, TuneProfile& out)
+{
+    std::ifstream ifs(path);
+    if (!ifs) return false;
+
+    std::string magic;
+    int version = 0;
+    if (!(ifs >> magic >> version) || magic != kProfileMagic || version != kProfileVersion) {
+        return false;
+    }
+
+    TuneProfile p;
+    std::string key;
+    while (ifs >> key) {
+        if (key == "hardware_threads") ifs >> p.hardwareThreads;
+        else if (key == "numa_nodes") ifs >> p.numaNodes;
+        else if (key == "cache_bytes") ifs >> p.cacheBytes;
+        else if (key == "memory_mbps") ifs >> p.memoryMBps;
+        else if (key == "model_hash") ifs >> std::hex >> p.modelHash >> std::dec;
+        else if (key == "fixed_point") {
+            int v = 0;
+            ifs >> v;
+            p.fixedPoint = v != 0;
+        }
+        else if (key == "weight_bytes") ifs >> p.weightBytes;
+        else if (key == "serial_ns") ifs >> p.serialNs;
+        else if (key == "code_ns") ifs >> p.codeNs;
+        else if (key == "advance_ns") ifs >> p.advanceNs;
+        else if (key == "output_ns") ifs >> p.outputNs;
+        else if (key == "thread_start_ns") ifs >> p.threadStartNs;
+        else {
+            std::string ignored;
+            std::getline(ifs, ignored); // newer keys
+        }
+        if (!ifs) return false;
+    }
+    if (p.hardwareThreads == 0 || p.serialNs <= 0.0) return false;
+    out = p;
+    return true;
+}
+
+} // namespace neurozip
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+/// Host calibration written by `neurozip --tune` and read back when
+/// compressing with auto-tuning. All costs are nanoseconds per input byte
+/// on one core, measured with the model named by modelHash.
+struct TuneProfile {
+    unsigned hardwareThreads = 1;
+    unsigned numaNodes = 1;
+    uint64_t cacheBytes = 0;       // last-level cache (0 = unknown)
+    double memoryMBps = 0.0;       // streaming copy, all threads together
+
+    uint64_t modelHash = 0;
+    bool fixedPoint = false;
+    uint64_t weightBytes = 0;      // ICompressionModel::weight_bytes()
+
+    double serialNs = 0.0;         // default encoder (model + coding)
+    double codeNs = 0.0;           // range coding alone
+    double advanceNs = 0.0;        // recurrence alone (0 = no two-phase)
+    double outputNs = 0.0;         // batched output layer
+    double threadStartNs = 0.0;    // start and join one thread
+};
+
+/// How a single stream is encoded; all kernels produce the same bytes.
+enum class EncoderKernel : uint8_t {
+    Serial = 0,
+    TwoPhase = 1,
+    Pipelined = 2
+};
+
+const char* encoder_kernel_name(EncoderKernel kernel);
+
+/// Bits per byte of a prefix of the input, and how many extra bits the
+/// model spends warming up from a fresh state: the cost of one more
+/// independently coded segment.
+struct CompressibilitySample {
+    double bpb = 8.0;
+    double restartBits = 0.0;
+};
+
+/// What to optimize for when parameters trade ratio against speed.
+/// With minMBps set, the best ratio that is predicted to reach it (or the
+/// fastest setting if none does); otherwise the fastest setting whose
+/// estimated ratio loss stays within maxRatioLoss.
+struct TuneTarget {
+    double minMBps = 0.0;
+    double maxRatioLoss = 0.01;
+};
+
+struct TunedSettings {
+    EncoderKernel kernel = EncoderKernel::Serial;
+    unsigned threads = 1;          // output-layer threads or batch workers
+    uint64_t segmentSize = 0;      // batch only; 0 = never split
+    double predictedMBps = 0.0;
+    double predictedRatioLoss = 0.0;
+};
+
+/// Microbenchmark 'model' and the host. 'sampleBytes' of synthetic text
+/// are coded per measurement, so the run takes a few times
+/// sampleBytes * (cost per byte).
+TuneProfile calibrate_host(const ICompressionModel& model, size_t sampleBytes = 64 * 1024);
+
+/// Model-dependent costs rescaled (by weight bytes per step) when 'model'
+/// is not the one the profile was measured with.
+TuneProfile profile_for_model(const TuneProfile& profile, const ICompressionModel& model);
+
+/// Run the model over the first (at most) maxBytes of data.
+CompressibilitySample sample_compressibility(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t maxBytes = 4096
+);
+
+/// Fastest kernel and thread count for one stream of 'inputSize' bytes,
+/// including thread start-up cost.
+TunedSettings tune_stream(const TuneProfile& profile, uint64_t inputSize);
+
+/// Worker count and segment size for a batch with these file sizes.
+/// 'threads' caps the workers (0 = every hardware thread).
+TunedSettings tune_batch(
+    const TuneProfile& profile,
+    const std::vector<uint64_t>& fileSizes,
+    const CompressibilitySample& sample,
+    const TuneTarget& target,
+    unsigned threads = 0
+);
+
+/// $NEUROZIP_TUNE_PROFILE, else $XDG_CONFIG_HOME/neurozip/tune.profile,
+/// else ~/.config/neurozip/tune.profile.
+std::string default_tune_profile_path();
+
+/// Text "key value" lines. save creates missing parent directories.
+bool save_tune_profile(const TuneProfile& profile, const std::string& path);
+bool load_tune_profile(const std::string& path, TuneProfile& out);
+
+} // namespace neurozip
@@ -0,0 +1,261 @@
+#include "checkpoint.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace neurozip {
+
+const StateCheckpoint* CheckpointIndex::nearest(uint64_t pos) const
+{
+    if (!enabled() || entries.empty() || pos < interval) return nullptr;
+    size_t k = (size_t)(pos / interval) - 1;
+    if (k >= entries.size()) k = entries.size() - 1;
+    return &entries[k];
+}
+
+uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = (x >> 16) & 0x8000u;
+    int32_t exp = (int32_t)((x >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mant = x & 0x7FFFFFu;
+
+    if (((x >> 23) & 0xFFu) == 0xFFu) {
+        // Inf / NaN
+        return (uint16_t)(sign | 0x7C00u | (mant ? 0x200u : 0u));
+    }
+    if (exp >= 31) {
+        return (uint16_t)(sign | 0x7C00u); // overflow -> inf
+    }
+    if (exp <= 0) {
+        // Subnormal half (or zero)
+        if (exp < -10) return (uint16_t)sign;
+        mant |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1u);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1u))) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    // Normal: round mantissa to 10 bits, nearest-even
+    uint32_t half = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) half++;
+    return (uint16_t)half;
+}
+
+float half_to_float(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t x;
+
+    if (exp == 0) {
+        if (mant == 0) {
+            x = sign;
+        } else {
+            // Normalize subnormal
+            int32_t e = -1;
+            do {
+                e++;
+                mant <<= 1;
+            } while ((mant & 0x400u) == 0);
+            x = sign | ((uint32_t)(127 - 15 - e) << 23) | ((mant & 0x3FFu) << 13);
+        }
+    } else if (exp == 31) {
+        x = sign | 0x7F800000u | (mant << 13);
+    } else {
+        x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static void quantize_vector(
+    float* v,
+    size_t n,
+    CheckpointPrecision precision,
+    std::vector<uint8_t>& out
+) {
+    if (precision == CheckpointPrecision::Fp16) {
+        for (size_t i = 0; i < n; i++) {
+            uint16_t h = float_to_half(v[i]);
+            out.push_back((uint8_t)(h & 0xFFu));
+            out.push_back((uint8_t)(h >> 8));
+            v[i] = half_to_float(h);
+        }
+        return;
+    }
+
+    float maxAbs = 0.0f;
+    for (size_t i = 0; i < n; i++)
+        maxAbs = std::fmax(maxAbs, std::fabs(v[i]));
+    float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+
+    uint8_t sb[4];
+    std::memcpy(sb, &scale, sizeof(scale));
+    out.insert(out.end(), sb, sb + 4);
+
+    for (size_t i = 0; i < n; i++) {
+        long q = std::lround(v[i] / scale);
+        if (q > 127) q = 127;
+        if (q < -127) q = -127;
+        out.push_back((uint8_t)(int8_t)q);
+        v[i] = (float)q * scale;
+    }
+}
+
+static const uint8_t* dequantize_vector(
+    const uint8_t* p,
+    float* v,
+    size_t n,
+    CheckpointPrecision precision
+) {
+    if (precision == CheckpointPrecision::Fp16) {
+        for (size_t i = 0; i < n; i++, p += 2)
+            v[i] = half_to_float((uint16_t)(p[0] | (p[1] << 8)));
+        return p;
+    }
+
+    float scale;
+    std::memcpy(&scale, p, sizeof(scale));
+    p += 4;
+    for (size_t i = 0; i < n; i++)
+        v[i] = (float)(int8_t)p[i] * scale;
+    return p + n;
+}
+
+static size_t state_bytes(size_t n, CheckpointPrecision precision)
+{
+    size_t perVector = precision == CheckpointPrecision::Fp16 ? 2 * n : 4 + n;
+    return 2 * perVector;
+}
+
+void snapshot_state(
+    ModelContext& ctx,
+    size_t n,
+    CheckpointPrecision precision,
+    std::vector<uint8_t>& out
+) {
+    out.clear();
+    out.reserve(state_bytes(n, precision));
+    quantize_vector(ctx.h.data(), n, precision, out);
+    quantize_vector(ctx.c.data(), n, precision, out);
+}
+
+void restore_state(
+    const std::vector<uint8_t>& state,
+    size_t n,
+    CheckpointPrecision precision,
+    ModelContext& ctx
+) {
+    if (state.size() != state_bytes(n, precision) || n > ctx.h.size()) return;
+    const uint8_t* p = state.data();
+    p = dequantize_vector(p, ctx.h.data(), n, precision);
+    dequantize_vector(p, ctx.c.data(), n, precision);
+}
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// Index layout (little-endian):
+// u32 interval, u8 precision, u32 stateSize, u32 count
+// per entry: u64 bytePos, u64 streamPos, u32 low, u32 high, u8 prevByte,
+//            state bytes (size implied by precision and stateSize)
+// followed by u64 total index length.
+void append_checkpoint_index(
+    const CheckpointIndex& index,
+    std::vector<uint8_t>& payload
+) {
+    size_t start = payload.size();
+
+    put_u32(payload, index.interval);
+    payload.push_back((uint8_t)index.precision);
+    put_u32(payload, index.stateSize);
+    put_u32(payload, (uint32_t)index.entries.size());
+
+    for (const auto& e : index.entries) {
+        put_u64(payload, e.bytePos);
+        put_u64(payload, e.streamPos);
+        put_u32(payload, e.low);
+        put_u32(payload, e.high);
+        payload.push_back(e.prevByte);
+        payload.insert(payload.end(), e.state.begin(), e.state.end());
+    }
+
+    put_u64(payload, (uint64_t)(payload.size() - start));
+}
+
+bool split_checkpoint_index(
+    const uint8_t* payload,
+    size_t payloadSize,
+    size_t& outStreamSize,
+    CheckpointIndex& outIndex,
+    uint64_t payloadOffset
+) {
+    if (payloadSize < 8) return false;
+    uint64_t indexSize = get_u64(payload + payloadSize - 8);
+    if (indexSize < 13 || indexSize > payloadSize - 8) return false;
+
+    size_t start = payloadSize - 8 - (size_t)indexSize;
+    const uint8_t* p = payload + start;
+    const uint8_t* end = p + indexSize;
+
+    outIndex.interval = get_u32(p);
+    uint8_t precision = p[4];
+    if (precision > (uint8_t)CheckpointPrecision::Int8) return false;
+    outIndex.precision = (CheckpointPrecision)precision;
+    outIndex.stateSize = get_u32(p + 5);
+    if (outIndex.stateSize > kMaxHiddenSize) return false;
+    uint32_t count = get_u32(p + 9);
+    p += 13;
+
+    size_t sb = state_bytes(outIndex.stateSize, outIndex.precision);
+    size_t entryBytes = 25 + sb;
+    if ((size_t)(end - p) != (size_t)count * entryBytes) return false;
+
+    outIndex.entries.resize(count);
+    for (auto& e : outIndex.entries) {
+        e.bytePos = get_u64(p);
+        e.streamPos = get_u64(p + 8);
+        e.low = get_u32(p + 16);
+        e.high = get_u32(p + 20);
+        e.prevByte = p[24];
+        e.state.assign(p + 25, p + 25 + sb);
+        if (e.streamPos > payloadOffset + start) return false;
+        p += entryBytes;
+    }
+
+    outStreamSize = (size_t)payloadOffset + start;
+    return true;
+}
+
+} // namespace neurozip
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+/// Storage format of the h/c vectors inside a checkpoint.
+enum class CheckpointPrecision : uint8_t {
+    Fp16 = 0,   // IEEE half per value
+    Int8 = 1    // one float scale per vector + int8 per value
+};
+
+/// Model and range-coder state just before coding byte 'bytePos'.
+///
+/// The encoder replaces its own state with the dequantized snapshot at
+/// each checkpoint, so a reader that starts from the snapshot sees exactly
+/// the state the encoder continued with.
+struct StateCheckpoint {
+    uint64_t bytePos = 0;    // position in the original data
+    uint64_t streamPos = 0;  // range coder output bytes emitted so far
+    uint32_t low = 0;        // range coder interval
+    uint32_t high = 0;
+    uint8_t  prevByte = 0;   // input byte of the next model step
+    std::vector<uint8_t> state; // quantized h then c
+};
+
+/// Side index of checkpoints stored after the range coder stream.
+struct CheckpointIndex {
+    uint32_t interval = 0;   // bytes between checkpoints (0 = none)
+    CheckpointPrecision precision = CheckpointPrecision::Fp16;
+    uint32_t stateSize = 0;  // floats per vector (h and c each)
+    std::vector<StateCheckpoint> entries; // entry k is at (k + 1) * interval
+
+    bool enabled() const { return interval > 0; }
+
+    /// Entry to resume from for byte 'pos', or nullptr to start at 0.
+    const StateCheckpoint* nearest(uint64_t pos) const;
+};
+
+/// Quantize ctx.h / ctx.c (first n values each) into 'out', then write the
+/// dequantized values back into ctx.
+void snapshot_state(
+    ModelContext& ctx,
+    size_t n,
+    CheckpointPrecision precision,
+    std::vector<uint8_t>& out
+);
+
+/// Load a quantized snapshot into ctx.h / ctx.c.
+void restore_state(
+    const std::vector<uint8_t>& state,
+    size_t n,
+    CheckpointPrecision precision,
+    ModelContext& ctx
+);
+
+/// Append the index to 'payload' followed by its u64 length, so it can be
+/// found from the end of the payload.
+void append_checkpoint_index(
+    const CheckpointIndex& index,
+    std::vector<uint8_t>& payload
+);
+
+/// Split a payload written with append_checkpoint_index into the stream
+/// length and the index. Returns false if the trailer is malformed.
+/// 'payload' may be just the tail of a payload that starts 'payloadOffset'
+/// bytes in; outStreamSize is still relative to the whole payload.
+bool split_checkpoint_index(
+    const uint8_t* payload,
+    size_t payloadSize,
+    size_t& outStreamSize,
+    CheckpointIndex& outIndex,
+    uint64_t payloadOffset = 0
+);
+
+/// IEEE half <-> float conversion (bit exact, no hardware support needed).
+uint16_t float_to_half(float f);
+float half_to_float(uint16_t h);
+
+} // namespace neurozip
@@ -0,0 +1,94 @@
+#include "chunking.h"
+
+#include "trace.h"
+
+#include <algorithm>
+
+namespace neurozip {
+
+namespace {
+
+struct GearTable {
+    uint64_t gear[256];
+
+    GearTable()
+    {
+        // splitmix64: fixed, so boundaries are stable across builds.
+        uint64_t x = 0x6E657572307A6970ull;
+        for (auto& g : gear) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            g = z ^ (z >> 31);
+        }
+    }
+};
+
+// Top 'bits' bits set: after the shifts of the gear hash they depend on
+// the last 64 input bytes.
+uint64_t high_mask(unsigned bits)
+{
+    return bits == 0 ? 0 : ~0ull << (64 - bits);
+}
+
+} // namespace
+
+ChunkParams chunk_params(size_t avgSize)
+{
+    size_t avg = 256;
+    while (avg < avgSize && avg < ((size_t)1 << 30)) avg <<= 1;
+    return { avg / 4, avg, avg * 4 };
+}
+
+void content_defined_chunks(
+    const uint8_t* data,
+    size_t size,
+    const ChunkParams& params,
+    std::vector<size_t>& outLengths
+) {
+    TraceSpan span("chunking", "dedup", size);
+    static const GearTable table;
+
+    unsigned bits = 0;
+    while (((size_t)1 << (bits + 1)) <= params.avgSize) ++bits;
+    // Normalized chunking: a stricter mask before the average size and a
+    // looser one after it pull chunk sizes towards the average.
+    const uint64_t maskSmall = high_mask(bits + 1);
+    const uint64_t maskLarge = high_mask(bits - 1);
+
+    size_t pos = 0;
+    while (pos < size) {
+        size_t remaining = size - pos;
+        if (remaining <= params.minSize) {
+            outLengths.push_back(remaining);
+            break;
+        }
+        const size_t normal = std::min(remaining, params.avgSize);
+        const size_t limit = std::min(remaining, params.maxSize);
+        const uint8_t* p = data + pos;
+
+        uint64_t h = 0;
+        size_t i = params.minSize;
+        size_t cut = limit;
+        for (; i < normal; ++i) {
+            h = (h << 1) + table.gear[p[i]];
+            if (!(h & maskSmall)) {
+                cut = i + 1;
+                break;
+            }
+        }
+        if (cut == limit && i == normal) {
+            for (; i < limit; ++i) {
+                h = (h << 1) + table.gear[p[i]];
+                if (!(h & maskLarge)) {
+                    cut = i + 1;
+                    break;
+                }
+            }
+        }
+        outLengths.push_back(cut);
+        pos += cut;
+    }
+}
+
+} // namespace neurozip
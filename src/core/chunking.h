@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+/// Content-defined chunking (FastCDC-style gear hash with normalized
+/// chunk sizes). Boundaries depend only on the 64 bytes before them, so an
+/// insertion or deletion moves the boundaries next to the edit and leaves
+/// the rest of the chunks, and their hashes, unchanged.
+struct ChunkParams {
+    size_t minSize;
+    size_t avgSize;
+    size_t maxSize;
+};
+
+/// Parameters for a target average chunk size (rounded to a power of two,
+/// at least 256): min = avg / 4, max = avg * 4.
+ChunkParams chunk_params(size_t avgSize);
+
+/// Append the lengths of consecutive chunks covering data[0, size) to
+/// 'outLengths'. All but the last chunk are within [min, max].
+void content_defined_chunks(
+    const uint8_t* data,
+    size_t size,
+    const ChunkParams& params,
+    std::vector<size_t>& outLengths
+);
+
+} // namespace neurozip
@@ -0,0 +1,140 @@
+#include "compact_frame.h"
+
+namespace neurozip {
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+static bool get_varint(const uint8_t* p, size_t size, size_t& pos, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) return false;
+        uint8_t b = p[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static void put_u16(std::vector<uint8_t>& out, uint16_t v)
+{
+    out.push_back((uint8_t)v);
+    out.push_back((uint8_t)(v >> 8));
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool is_compact_frame(const uint8_t* data, size_t size)
+{
+    if (size == 0 || (data[0] & 0xF0) != NZC_FRAME_MAGIC) return false;
+    const uint8_t version = data[0] & 0x03;
+    return version == NZC_FRAME_VERSION || version == NZC_FRAME_VERSION_PRIMED;
+}
+
+uint16_t model_tag(const ICompressionModel& model)
+{
+    uint64_t v = model.model_hash() ^ ((uint64_t)model.model_id() << 48);
+    v ^= primed_state_tag(model) * 0x9E3779B97F4A7C15ull;
+    v ^= v >> 32;
+    v ^= v >> 16;
+    return (uint16_t)v;
+}
+
+uint16_t frame_checksum(const uint8_t* data, size_t size)
+{
+    uint32_t crc = crc32(data, size);
+    return (uint16_t)(crc ^ (crc >> 16));
+}
+
+void write_compact_frame(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    bool checksum,
+    std::vector<uint8_t>& out
+) {
+    const uint32_t primed = model.primed_state();
+    uint8_t first = NZC_FRAME_MAGIC | (primed ? NZC_FRAME_VERSION_PRIMED : NZC_FRAME_VERSION);
+    if (checksum) first |= NZC_FRAME_CHECKSUM;
+    if (model.fixed_point()) first |= NZC_FRAME_FIXED_POINT;
+
+    out.push_back(first);
+    put_varint(out, size);
+    put_u16(out, model_tag(model));
+    if (primed) put_varint(out, primed);
+    if (checksum) put_u16(out, frame_checksum(data, size));
+
+    CompressOptions options;
+    options.minimalFlush = true;
+    std::vector<uint8_t> stream = compress_buffer(model, data, size, options);
+    out.insert(out.end(), stream.begin(), stream.end());
+}
+
+ErrorCode parse_compact_frame(
+    const uint8_t* frame,
+    size_t frameSize,
+    CompactFrameInfo& outInfo
+) {
+    if (!is_compact_frame(frame, frameSize)) return ErrorCode::InvalidFormat;
+
+    CompactFrameInfo info;
+    info.fixedPoint = (frame[0] & NZC_FRAME_FIXED_POINT) != 0;
+    info.hasChecksum = (frame[0] & NZC_FRAME_CHECKSUM) != 0;
+
+    size_t pos = 1;
+    if (!get_varint(frame, frameSize, pos, info.originalSize)) return ErrorCode::CorruptData;
+    if (frameSize - pos < 2) return ErrorCode::CorruptData;
+    info.modelTag = get_u16(frame + pos);
+    pos += 2;
+    if ((frame[0] & 0x03) == NZC_FRAME_VERSION_PRIMED) {
+        uint64_t primed = 0;
+        if (!get_varint(frame, frameSize, pos, primed) || primed == 0 || primed > UINT32_MAX) {
+            return ErrorCode::CorruptData;
+        }
+        info.primedState = (uint32_t)primed;
+    }
+    if (info.hasChecksum) {
+        if (frameSize - pos < 2) return ErrorCode::CorruptData;
+        info.checksum = get_u16(frame + pos);
+        pos += 2;
+    }
+    info.streamOffset = pos;
+    outInfo = info;
+    return ErrorCode::Ok;
+}
+
+ErrorCode read_compact_frame(
+    const ICompressionModel& model,
+    const uint8_t* frame,
+    size_t frameSize,
+    std::vector<uint8_t>& outData
+) {
+    CompactFrameInfo info;
+    ErrorCode ec = parse_compact_frame(frame, frameSize, info);
+    if (ec != ErrorCode::Ok) return ec;
+    if (info.modelTag != model_tag(model) || info.fixedPoint != model.fixed_point() ||
+        info.primedState != model.primed_state()) {
+        return ErrorCode::ModelMismatch;
+    }
+
+    if (!decompress_buffer(model, frame + info.streamOffset, frameSize - info.streamOffset,
+                           (size_t)info.originalSize, outData)) {
+        return ErrorCode::CorruptData;
+    }
+    if (info.hasChecksum && frame_checksum(outData.data(), outData.size()) != info.checksum) {
+        return ErrorCode::CorruptData;
+    }
+    return ErrorCode::Ok;
+}
+
+} // namespace neurozip
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "file_format.h"
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+/// Compact frame for short messages, used instead of FileHeader + payload
+/// when the 48-byte header would cost more than compression saves:
+///
+///   u8      magic/version and flags: 0xB1 | NZC_FRAME_* bits
+///   varint  original size (LEB128, 1 byte up to 127)
+///   u16     model tag (model_tag(), little-endian)
+///   [varint primed state id, in NZC_FRAME_VERSION_PRIMED frames]
+///   [u16    frame_checksum() of the original data, if NZC_FRAME_CHECKSUM]
+///   range coder stream with a minimal flush, up to the end of the frame
+///
+/// So a message costs 3 bytes plus 2 for the checksum plus 0-4 flush bytes
+/// over its coded length. There are no checkpoints, segments or append
+/// state; the first byte never matches a .nzp file ('N').
+constexpr uint8_t NZC_FRAME_MAGIC       = 0xB0; // high nibble
+constexpr uint8_t NZC_FRAME_VERSION     = 1;    // low two bits
+constexpr uint8_t NZC_FRAME_VERSION_PRIMED = 2; // coded from a primed state
+constexpr uint8_t NZC_FRAME_CHECKSUM    = 1u << 2;
+constexpr uint8_t NZC_FRAME_FIXED_POINT = 1u << 3;
+
+struct CompactFrameInfo {
+    uint64_t originalSize = 0;
+    uint16_t modelTag = 0;
+    uint32_t primedState = 0;
+    bool fixedPoint = false;
+    bool hasChecksum = false;
+    uint16_t checksum = 0;
+    size_t streamOffset = 0; // the stream runs from here to the end
+};
+
+/// True if 'data' starts like a compact frame (magic and either version).
+bool is_compact_frame(const uint8_t* data, size_t size);
+
+/// 16-bit digest of the model id and hash, and of the primed state if one
+/// is selected; a frame only decodes with a model whose tag matches.
+uint16_t model_tag(const ICompressionModel& model);
+
+/// CRC32 folded to 16 bits.
+uint16_t frame_checksum(const uint8_t* data, size_t size);
+
+/// Compress 'data' into a frame appended to 'out'.
+void write_compact_frame(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    bool checksum,
+    std::vector<uint8_t>& out
+);
+
+/// Parse the frame header.
+ErrorCode parse_compact_frame(
+    const uint8_t* frame,
+    size_t frameSize,
+    CompactFrameInfo& outInfo
+);
+
+/// Decode a whole frame. ModelMismatch if the tag or the inference mode
+/// differ, CorruptData if the checksum does not match.
+ErrorCode read_compact_frame(
+    const ICompressionModel& model,
+    const uint8_t* frame,
+    size_t frameSize,
+    std::vector<uint8_t>& outData
+);
+
+} // namespace neurozip
@@ -0,0 +1,123 @@
+#include "estimate.h"
+#include "file_format.h"
+#include "trace.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neurozip {
+
+// Smallest window when the whole input is split across workers; shorter
+// windows pay too much for their cold start.
+static constexpr size_t kMinWindow = 64 * 1024;
+
+// Bytes RangeEncoder::finish writes.
+static constexpr uint64_t kFlushBytes = 4;
+
+uint64_t SizeEstimate::stream_bytes() const
+{
+    double bits = bits_per_byte() * (double)inputBytes;
+    return (uint64_t)std::ceil(bits / 8.0) + kFlushBytes;
+}
+
+uint64_t SizeEstimate::file_bytes() const
+{
+    return sizeof(FileHeader) + stream_bytes();
+}
+
+struct Window {
+    size_t offset;
+    size_t length;
+};
+
+static std::vector<Window> sample_windows(size_t size, const EstimateOptions& options)
+{
+    std::vector<Window> windows;
+    if (size == 0) return windows;
+
+    if (options.sampleBytes == 0 || options.sampleBytes >= size) {
+        size_t n = options.pool ? options.pool->size() : 1;
+        n = std::max<size_t>(1, std::min(n, size / kMinWindow));
+        for (size_t w = 0; w < n; ++w) {
+            size_t lo = size * w / n;
+            size_t hi = size * (w + 1) / n;
+            windows.push_back({ lo, hi - lo });
+        }
+        return windows;
+    }
+
+    // Evenly spaced windows: the first at the start, the last at the end.
+    size_t n = std::max<size_t>(1, options.windows);
+    size_t length = (size_t)options.sampleBytes / n;
+    if (length < 1024) {
+        length = std::min<size_t>(1024, (size_t)options.sampleBytes);
+        n = std::max<size_t>(1, (size_t)options.sampleBytes / length);
+    }
+    for (size_t w = 0; w < n; ++w) {
+        size_t offset = n == 1 ? 0 : (size - length) * w / (n - 1);
+        windows.push_back({ offset, length });
+    }
+    return windows;
+}
+
+SizeEstimate estimate_size(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    const EstimateOptions& options
+) {
+    TraceSpan span("estimate", "codec", size);
+    SizeEstimate result;
+    result.inputBytes = size;
+
+    const std::vector<Window> windows = sample_windows(size, options);
+    std::vector<double> bits(windows.size(), 0.0);
+
+    auto run = [&](const ICompressionModel& m, size_t w) {
+        bits[w] = code_length_bits(m, data + windows[w].offset, windows[w].length);
+    };
+    if (options.pool && windows.size() > 1) {
+        options.pool->parallel_for(windows.size(), 1, [&](unsigned worker, size_t lo, size_t hi) {
+            const ICompressionModel& local = options.pool->local_model(model, worker);
+            for (size_t w = lo; w < hi; ++w) run(local, w);
+        });
+    } else {
+        for (size_t w = 0; w < windows.size(); ++w) run(model, w);
+    }
+
+    // Summed in window order so the result does not depend on scheduling.
+    for (size_t w = 0; w < windows.size(); ++w) {
+        result.sampledBytes += windows[w].length;
+        result.sampledBits += bits[w];
+    }
+    return result;
+}
+
+std::vector<double> bit_profile(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t regionSize,
+    const std::vector<uint64_t>& streamSizes
+) {
+    std::vector<double> bits;
+    if (regionSize == 0 || size == 0) return bits;
+    bits.assign((size + regionSize - 1) / regionSize, 0.0);
+
+    uint64_t pos = 0;
+    for (uint64_t n : streamSizes) {
+        n = std::min<uint64_t>(n, size - pos);
+        code_length_bits(model, data + pos, (size_t)n, regionSize, &bits, pos);
+        pos += n;
+    }
+    if (pos < size) code_length_bits(model, data + pos, (size_t)(size - pos), regionSize, &bits, pos);
+
+    for (size_t r = 0; r < bits.size(); ++r) {
+        size_t length = std::min(regionSize, size - r * regionSize);
+        bits[r] /= (double)length;
+    }
+    return bits;
+}
+
+} // namespace neurozip
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+class WorkerPool;
+
+/// Fast size estimation: the ideal code length (code_length_bits) of a
+/// sample of the input, extrapolated to all of it, without range coding
+/// or writing output. Used to decide whether data is worth sending
+/// through the model at all.
+struct EstimateOptions {
+    /// Bytes to model; 0 (or >= the input size) models the whole input.
+    uint64_t sampleBytes = 1u << 20;
+
+    /// The sample is taken as this many evenly spaced windows (fewer if
+    /// the sample is small). Each window starts from a fresh model state,
+    /// like a segment of a segmented file.
+    size_t windows = 16;
+
+    /// Windows run in parallel on this pool (nullptr = calling thread).
+    /// The whole input is split into one window per worker.
+    WorkerPool* pool = nullptr;
+};
+
+struct SizeEstimate {
+    uint64_t inputBytes = 0;
+    uint64_t sampledBytes = 0;
+    double sampledBits = 0.0;
+
+    double bits_per_byte() const
+    {
+        return sampledBytes ? sampledBits / (double)sampledBytes : 0.0;
+    }
+
+    /// Expected coded stream size for the whole input.
+    uint64_t stream_bytes() const;
+
+    /// Expected .nzp file size (header + stream).
+    uint64_t file_bytes() const;
+};
+
+SizeEstimate estimate_size(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    const EstimateOptions& options = EstimateOptions()
+);
+
+/// Bits per byte of each regionSize-byte region of 'data' (the last region
+/// may be shorter), coded as consecutive streams of 'streamSizes' bytes,
+/// each from a fresh state (empty = one stream), as in a segmented file.
+std::vector<double> bit_profile(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t regionSize,
+    const std::vector<uint64_t>& streamSizes = {}
+);
+
+} // namespace neurozip
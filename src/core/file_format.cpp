@@ -1,6 +1,12 @@
 #include "file_format.h"
 
+#include "trace.h"
+
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace neurozip {
 
@@ -12,43 +18,105 @@ FileHeader::FileHeader()
       originalSize(0),
       checksum(0),
       modelHash(0),
-      reserved(0) {}
-
-static uint32_t crc32_table[256];
-static bool crc32_initialized = false;
-
-static void init_crc32()
+      primedState(0)
 {
-    if (crc32_initialized) return;
-    uint32_t poly = 0xEDB88320u;
-    for (uint32_t i = 0; i < 256; ++i) {
-        uint32_t c = i;
-        for (int j = 0; j < 8; ++j) {
-            if (c & 1)
-                c = poly ^ (c >> 1);
-            else
-                c >>= 1;
+    // The header is written as a raw struct; clear the padding bytes too
+    // so identical inputs give identical files.
+    uint32_t m = magic;
+    uint8_t v = formatVersion;
+    std::memset(this, 0, sizeof(*this));
+    magic = m;
+    formatVersion = v;
+}
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table()
+    {
+        uint32_t poly = 0xEDB88320u;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; ++j) {
+                if (c & 1)
+                    c = poly ^ (c >> 1);
+                else
+                    c >>= 1;
+            }
+            entries[i] = c;
         }
-        crc32_table[i] = c;
     }
-    crc32_initialized = true;
-}
+};
 
 uint32_t crc32(const uint8_t* data, size_t len, uint32_t seed)
 {
-    init_crc32();
+    TraceSpan span("crc32", "checksum", len);
+
+    // Built once, thread-safe (batch workers checksum concurrently).
+    static const Crc32Table table;
     uint32_t c = ~seed;
     for (size_t i = 0; i < len; ++i) {
-        c = crc32_table[(c ^ data[i]) & 0xFFu] ^ (c >> 8);
+        c = table.entries[(c ^ data[i]) & 0xFFu] ^ (c >> 8);
     }
     return ~c;
 }
 
+static uint32_t gf2_matrix_times(const uint32_t* mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1) sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t* square, const uint32_t* mat)
+{
+    for (int n = 0; n < 32; n++) {
+        square[n] = gf2_matrix_times(mat, mat[n]);
+    }
+}
+
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+    // Same approach as zlib: apply len2 zero bytes to crc1 with repeated
+    // squaring of the CRC shift operator, then xor in crc2.
+    if (len2 == 0) return crc1;
+
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    odd[0] = 0xEDB88320u; // one zero bit
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2_matrix_square(even, odd); // two zero bits
+    gf2_matrix_square(odd, even); // four zero bits
+
+    do {
+        gf2_matrix_square(even, odd);
+        if (len2 & 1) crc1 = gf2_matrix_times(even, crc1);
+        len2 >>= 1;
+        if (len2 == 0) break;
+
+        gf2_matrix_square(odd, even);
+        if (len2 & 1) crc1 = gf2_matrix_times(odd, crc1);
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc1 ^ crc2;
+}
+
 ErrorCode write_nzp_file(
     const std::string& path,
     const FileHeader& header,
     const std::vector<uint8_t>& payload
 ) {
+    TraceSpan span("write_nzp_file", "io", sizeof(FileHeader) + payload.size());
     std::ofstream ofs(path, std::ios::binary);
     if (!ofs) {
         return ErrorCode::IoError;
@@ -62,6 +130,84 @@ ErrorCode write_nzp_file(
         if (!ofs) return ErrorCode::IoError;
     }
 
+    ofs.close(); // the buffered tail can still fail, e.g. on a full disk
+    if (!ofs) return ErrorCode::IoError;
+    return ErrorCode::Ok;
+}
+
+std::string replacement_path(const std::string& target)
+{
+    return target + ".tmp" + std::to_string(getpid());
+}
+
+ErrorCode replace_file(const std::string& tmpPath, const std::string& target)
+{
+    int fd = open(tmpPath.c_str(), O_RDONLY | O_CLOEXEC);
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+
+    std::error_code ec;
+    if (synced) std::filesystem::rename(tmpPath, target, ec);
+    if (!synced || ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return ErrorCode::IoError;
+    }
+    return ErrorCode::Ok;
+}
+
+void serialize_nzp(
+    const FileHeader& header,
+    const std::vector<uint8_t>& payload,
+    std::vector<uint8_t>& out
+) {
+    out.resize(sizeof(FileHeader) + payload.size());
+    std::memcpy(out.data(), &header, sizeof(FileHeader));
+    if (!payload.empty()) {
+        std::memcpy(out.data() + sizeof(FileHeader), payload.data(), payload.size());
+    }
+}
+
+ErrorCode parse_nzp(
+    const uint8_t* data,
+    size_t size,
+    FileHeader& outHeader,
+    std::vector<uint8_t>& outPayload
+) {
+    if (!data || size < sizeof(FileHeader)) {
+        return ErrorCode::InvalidFormat;
+    }
+    std::memcpy(&outHeader, data, sizeof(FileHeader));
+
+    if (outHeader.magic != NZP_MAGIC) {
+        return ErrorCode::InvalidFormat;
+    }
+    if (outHeader.formatVersion != NZP_FORMAT_VERSION) {
+        return ErrorCode::UnsupportedVersion;
+    }
+
+    outPayload.assign(data + sizeof(FileHeader), data + size);
+    return ErrorCode::Ok;
+}
+
+ErrorCode read_nzp_header(
+    const std::string& path,
+    FileHeader& outHeader
+) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        return ErrorCode::IoError;
+    }
+
+    ifs.read(reinterpret_cast<char*>(&outHeader), sizeof(FileHeader));
+    if (!ifs) return ErrorCode::IoError;
+
+    if (outHeader.magic != NZP_MAGIC) {
+        return ErrorCode::InvalidFormat;
+    }
+    if (outHeader.formatVersion != NZP_FORMAT_VERSION) {
+        return ErrorCode::UnsupportedVersion;
+    }
+
     return ErrorCode::Ok;
 }
 
@@ -70,6 +216,7 @@ ErrorCode read_nzp_file(
     FileHeader& outHeader,
     std::vector<uint8_t>& outPayload
 ) {
+    TraceSpan span("read_nzp_file", "io");
     std::ifstream ifs(path, std::ios::binary);
     if (!ifs) {
         return ErrorCode::IoError;
@@ -9,6 +9,13 @@ namespace neurozip {
 constexpr uint32_t NZP_MAGIC = 0x31505A4E; // "NZP1" little-endian
 constexpr uint8_t  NZP_FORMAT_VERSION = 1;
 
+// FileHeader::flags bits
+constexpr uint8_t NZP_FLAG_FIXED_POINT = 1u << 0; // coded with fixed-point inference
+constexpr uint8_t NZP_FLAG_CHECKPOINTS = 1u << 1; // payload ends with a checkpoint index
+constexpr uint8_t NZP_FLAG_SEGMENTED   = 1u << 2; // independently coded segments (segments.h)
+constexpr uint8_t NZP_FLAG_APPENDABLE  = 1u << 3; // payload ends with the encoder state (stream_state.h)
+constexpr uint8_t NZP_FLAG_ALPHABET    = 1u << 4; // stream starts with the used-symbol bitmap (alphabet.h)
+
 enum class ErrorCode {
     Ok = 0,
     IoError,
@@ -27,7 +34,7 @@ struct FileHeader {
     uint64_t originalSize;
     uint32_t checksum;      // CRC32 of original data
     uint64_t modelHash;
-    uint64_t reserved;      // for future use
+    uint64_t primedState;   // primed_state_tag() of the model (0 = cold start)
 
     FileHeader();
 };
@@ -35,6 +42,9 @@ struct FileHeader {
 /// Compute CRC32 of a buffer (simple implementation).
 uint32_t crc32(const uint8_t* data, size_t len, uint32_t seed = 0);
 
+/// CRC32 of A followed by B, from crc32(A), crc32(B) and B's length.
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
 /// Write header and payload to a file.
 ErrorCode write_nzp_file(
     const std::string& path,
@@ -49,4 +59,34 @@ ErrorCode read_nzp_file(
     std::vector<uint8_t>& outPayload
 );
 
+/// Serialize header and payload into an in-memory .nzp image.
+void serialize_nzp(
+    const FileHeader& header,
+    const std::vector<uint8_t>& payload,
+    std::vector<uint8_t>& out
+);
+
+/// Parse an in-memory .nzp image into header and payload.
+ErrorCode parse_nzp(
+    const uint8_t* data,
+    size_t size,
+    FileHeader& outHeader,
+    std::vector<uint8_t>& outPayload
+);
+
+/// Read and validate only the header of a file.
+ErrorCode read_nzp_header(
+    const std::string& path,
+    FileHeader& outHeader
+);
+
+/// Name for a temporary file next to 'target', to be built in full and
+/// then moved over it with replace_file.
+std::string replacement_path(const std::string& target);
+
+/// Flush 'tmpPath' to disk and rename it over 'target', so a crash or a
+/// full disk leaves either the old file or the new one, never a mix. The
+/// temporary is removed if this fails.
+ErrorCode replace_file(const std::string& tmpPath, const std::string& target);
+
 } // namespace neurozip
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace neurozip {
+
+/// An object that writers replace while readers keep using it, so an
+/// embedder can roll out a retrained model without draining traffic.
+///
+/// Readers take a reference with a CAS on the entry's count and no lock.
+/// A reference taken before a publish keeps the old object alive, and
+/// whichever release drops its count to zero destroys it. Entries (count,
+/// key and pointer) are only freed with the HotSwap. A reader that loaded
+/// an entry just as it was retired therefore finds the count at zero and
+/// retries, instead of touching freed memory. Each publish costs one small
+/// entry.
+///
+/// Retired objects can also be kept for lookup by key (the model hash of
+/// old files) until they are dropped.
+template <typename T, typename Deleter = std::default_delete<T>>
+class HotSwap {
+public:
+    struct Entry {
+        std::atomic<uint64_t> refs{ 1 }; // the HotSwap's own, plus one per reader
+        T* object = nullptr;
+        uint64_t key = 0;
+    };
+
+    HotSwap() { kept_.store(keep({}), std::memory_order_release); }
+
+    /// Every reference must have been released.
+    ~HotSwap()
+    {
+        release(current_.load(std::memory_order_acquire));
+        for (Entry* e : *kept_.load(std::memory_order_acquire)) release(e);
+    }
+
+    HotSwap(const HotSwap&) = delete;
+    HotSwap& operator=(const HotSwap&) = delete;
+
+    /// An unpublished entry owning 'object', so the caller can record it
+    /// (e.g. in the object) before readers can see it.
+    Entry* create(T* object, uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        entries_.push_back(std::make_unique<Entry>());
+        Entry* e = entries_.back().get();
+        e->object = object;
+        e->key = key;
+        return e;
+    }
+
+    /// Make 'e' (from create) current. With keepPrevious the replaced
+    /// object stays reachable through acquire_if until drop(); otherwise
+    /// it is destroyed once its last reader lets go.
+    void publish(Entry* e, bool keepPrevious)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        Entry* old = current_.exchange(e, std::memory_order_acq_rel);
+        if (old && keepPrevious) {
+            std::vector<Entry*> kept = *kept_.load(std::memory_order_relaxed);
+            kept.push_back(old);
+            kept_.store(keep(std::move(kept)), std::memory_order_release);
+        } else {
+            release(old);
+        }
+    }
+
+    /// Stop keeping the retired objects with 'key'; each is destroyed once
+    /// its readers let go. Returns how many there were.
+    size_t drop(uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::vector<Entry*> kept, dropped;
+        for (Entry* e : *kept_.load(std::memory_order_relaxed))
+            (e->key == key ? dropped : kept).push_back(e);
+        if (dropped.empty()) return 0;
+        kept_.store(keep(std::move(kept)), std::memory_order_release);
+        for (Entry* e : dropped) release(e);
+        return dropped.size();
+    }
+
+    /// Reference to the current object, or nullptr before the first
+    /// publish. Lock-free.
+    Entry* acquire() const
+    {
+        for (;;) {
+            Entry* e = current_.load(std::memory_order_acquire);
+            if (!e || retain(e)) return e;
+            // Retired and released meanwhile: a newer entry is current.
+        }
+    }
+
+    /// Reference to the current object if match(entry) accepts it, else to
+    /// a kept one it accepts; nullptr if none does. 'match' only sees
+    /// entries it holds a reference to. Lock-free.
+    template <typename Match>
+    Entry* acquire_if(Match match) const
+    {
+        Entry* e = acquire();
+        if (!e || match(*e)) return e;
+        release(e);
+        for (Entry* k : *kept_.load(std::memory_order_acquire)) {
+            if (!retain(k)) continue;
+            if (match(*k)) return k;
+            release(k);
+        }
+        return nullptr;
+    }
+
+    /// Drop a reference from acquire / acquire_if (nullptr is ignored).
+    static void release(Entry* e)
+    {
+        if (e && e->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) Deleter()(e->object);
+    }
+
+    /// Retired objects currently kept.
+    size_t kept() const { return kept_.load(std::memory_order_acquire)->size(); }
+
+private:
+    // A reference, unless the count already reached zero (destroyed).
+    static bool retain(Entry* e)
+    {
+        uint64_t n = e->refs.load(std::memory_order_relaxed);
+        while (n != 0) {
+            if (e->refs.compare_exchange_weak(n, n + 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Kept lists are immutable once stored; like entries they live as
+    // long as the HotSwap, so a reader may still be scanning an old one.
+    const std::vector<Entry*>* keep(std::vector<Entry*> list)
+    {
+        keptLists_.push_back(std::make_unique<const std::vector<Entry*>>(std::move(list)));
+        return keptLists_.back().get();
+    }
+
+    std::atomic<Entry*> current_{ nullptr };
+    std::atomic<const std::vector<Entry*>*> kept_{ nullptr };
+
+    std::mutex writeMutex_; // publish, drop and create only
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<std::unique_ptr<const std::vector<Entry*>>> keptLists_;
+};
+
+} // namespace neurozip
@@ -0,0 +1,105 @@
+#include "io_backend.h"
+
+#include "trace.h"
+
+#include <fstream>
+
+namespace neurozip {
+
+#if defined(NEUROZIP_HAVE_IO_URING)
+// io_uring_backend.cpp; nullptr if the kernel refuses to set up a ring.
+std::unique_ptr<IoBackend> make_io_uring_backend(unsigned queueDepth);
+#endif
+
+namespace {
+
+/// The original behaviour: blocking std::fstream calls on the caller's
+/// thread, returned as ready futures.
+class BlockingIoBackend : public IoBackend {
+public:
+    IoBackendKind kind() const override { return IoBackendKind::Blocking; }
+    const char* name() const override { return "blocking"; }
+
+    std::future<IoReadResult> read(const std::string& path, uint64_t offset, uint64_t size) override
+    {
+        std::promise<IoReadResult> promise;
+        promise.set_value(read_now(path, offset, size));
+        return promise.get_future();
+    }
+
+    std::future<ErrorCode> write(const std::string& path, std::vector<uint8_t> data) override
+    {
+        std::promise<ErrorCode> promise;
+        promise.set_value(write_now(path, data));
+        return promise.get_future();
+    }
+
+private:
+    static IoReadResult read_now(const std::string& path, uint64_t offset, uint64_t size)
+    {
+        TraceSpan span("read", "io", size == kReadWholeFile ? 0 : size);
+        IoReadResult result;
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            result.error = ErrorCode::IoError;
+            return result;
+        }
+
+        if (size == kReadWholeFile) {
+            ifs.seekg(0, std::ios::end);
+            std::streamoff end = ifs.tellg();
+            size = end > (std::streamoff)offset ? (uint64_t)end - offset : 0;
+        }
+
+        ifs.seekg((std::streamoff)offset, std::ios::beg);
+        result.data.resize((size_t)size);
+        if (size > 0) {
+            ifs.read(reinterpret_cast<char*>(result.data.data()), (std::streamsize)size);
+            if (!ifs) {
+                result.error = ErrorCode::IoError;
+                result.data.clear();
+            }
+        }
+        return result;
+    }
+
+    static ErrorCode write_now(const std::string& path, const std::vector<uint8_t>& data)
+    {
+        TraceSpan span("write", "io", data.size());
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs) return ErrorCode::IoError;
+        ofs.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+        return ofs ? ErrorCode::Ok : ErrorCode::IoError;
+    }
+};
+
+} // namespace
+
+bool io_backend_available(IoBackendKind kind)
+{
+    switch (kind) {
+        case IoBackendKind::Blocking:
+            return true;
+        case IoBackendKind::IoUring:
+#if defined(NEUROZIP_HAVE_IO_URING)
+            return make_io_uring_backend(1) != nullptr;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+std::unique_ptr<IoBackend> make_io_backend(IoBackendKind kind)
+{
+#if defined(NEUROZIP_HAVE_IO_URING)
+    if (kind == IoBackendKind::IoUring) {
+        if (auto backend = make_io_uring_backend(64)) return backend;
+    }
+#else
+    (void)kind;
+#endif
+    return std::make_unique<BlockingIoBackend>();
+}
+
+} // namespace neurozip
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "file_format.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+enum class IoBackendKind {
+    Blocking = 0, // std::fstream on the calling thread (portable default)
+    IoUring  = 1, // Linux io_uring, requests complete in the background
+};
+
+/// Pass as 'size' to read a whole file.
+constexpr uint64_t kReadWholeFile = UINT64_MAX;
+
+struct IoReadResult {
+    ErrorCode error = ErrorCode::Ok;
+    std::vector<uint8_t> data;
+};
+
+/// File reads and writes for bulk jobs. Requests return futures so a
+/// caller can start the I/O for its next task and run inference while it
+/// is in flight; backends may complete them synchronously.
+/// Implementations are thread-safe.
+class IoBackend {
+public:
+    virtual ~IoBackend() = default;
+
+    virtual IoBackendKind kind() const = 0;
+    virtual const char* name() const = 0;
+
+    /// Read 'size' bytes at 'offset' (or the whole file with
+    /// kReadWholeFile). A file shorter than a requested range is an error.
+    virtual std::future<IoReadResult> read(
+        const std::string& path,
+        uint64_t offset = 0,
+        uint64_t size = kReadWholeFile
+    ) = 0;
+
+    /// Create or truncate 'path' and write 'data' to it.
+    virtual std::future<ErrorCode> write(
+        const std::string& path,
+        std::vector<uint8_t> data
+    ) = 0;
+};
+
+/// True if 'kind' can be used in this build on this machine (io_uring may
+/// be compiled out, or refused by the kernel or a seccomp policy).
+bool io_backend_available(IoBackendKind kind);
+
+/// Create a backend; falls back to Blocking when 'kind' is unavailable.
+std::unique_ptr<IoBackend> make_io_backend(IoBackendKind kind);
+
+} // namespace neurozip
@@ -0,0 +1,514 @@
+// Linux io_uring implementation of IoBackend, on the raw system calls so
+// the build does not depend on liburing. Only compiled when CMake finds a
+// usable <linux/io_uring.h> (NEUROZIP_HAVE_IO_URING).
+//
+// Every request is a small state machine with at most one SQE in flight:
+//   read:  OPENAT -> [STATX] -> READ... -> CLOSE
+//   write: OPENAT -> WRITE... -> CLOSE
+// A completion thread reaps CQEs, advances the machine and fulfils the
+// promise on CLOSE. A stage the kernel refuses to take fails the request
+// at once, so its future always resolves. At most 'entries' requests are
+// active at once, so the submission ring can never fill and the
+// completion ring never overflows; the rest wait in a pending queue.
+//
+// The completion thread sleeps in poll() on the ring and an eventfd, so
+// shutdown can always wake it, even with nothing in flight.
+
+#include "io_backend.h"
+#include "trace.h"
+
+#include <linux/io_uring.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace neurozip {
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int sys_io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nrArgs)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+// Largest single READ/WRITE; the SQE length field is 32 bits.
+constexpr uint64_t kMaxChunk = 1u << 30;
+
+struct UringOp {
+    enum class Kind { Read, Write } kind;
+    enum class Stage { Open, Stat, Transfer, Close } stage = Stage::Open;
+
+    std::string path;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t done = 0;
+    std::vector<uint8_t> data;
+    int fd = -1;
+    ErrorCode error = ErrorCode::Ok;
+    struct statx stx{};
+
+    std::promise<IoReadResult> readPromise;
+    std::promise<ErrorCode> writePromise;
+
+    uint64_t startNs = 0; // queued at, when tracing
+};
+
+class UringIoBackend : public IoBackend {
+public:
+    ~UringIoBackend() override
+    {
+        if (ringFd_ < 0) return;
+        if (reaper_.joinable()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                idle_.wait(lock, [&] { return active_ == 0 && pending_.empty(); });
+            }
+            stopping_ = true;
+            const uint64_t one = 1;
+            ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+            (void)n; // only fails if the counter would overflow
+            reaper_.join();
+        }
+        if (wakeFd_ >= 0) close(wakeFd_);
+        unmap();
+        close(ringFd_);
+    }
+
+    bool init(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd_ = sys_io_uring_setup(entries, &params);
+        if (ringFd_ < 0) return false;
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+
+        sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ringFd_, IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED) {
+            sqRing_ = nullptr;
+            return false;
+        }
+        if (singleMmap) {
+            cqRing_ = sqRing_;
+        } else {
+            cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ringFd_, IORING_OFF_CQ_RING);
+            if (cqRing_ == MAP_FAILED) {
+                cqRing_ = nullptr;
+                return false;
+            }
+        }
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringFd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<uint8_t*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<uint8_t*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        maxActive_ = params.sq_entries;
+
+        if (!probe_ops()) return false;
+        wakeFd_ = eventfd(0, EFD_CLOEXEC);
+        if (wakeFd_ < 0) return false;
+
+        reaper_ = std::thread([this] {
+            trace_set_thread_name("io_uring");
+            reap();
+        });
+        return true;
+    }
+
+    IoBackendKind kind() const override { return IoBackendKind::IoUring; }
+    const char* name() const override { return "io_uring"; }
+
+    std::future<IoReadResult> read(const std::string& path, uint64_t offset, uint64_t size) override
+    {
+        auto op = std::make_unique<UringOp>();
+        op->kind = UringOp::Kind::Read;
+        op->path = path;
+        op->offset = offset;
+        op->size = size;
+        auto future = op->readPromise.get_future();
+        enqueue(std::move(op));
+        return future;
+    }
+
+    std::future<ErrorCode> write(const std::string& path, std::vector<uint8_t> data) override
+    {
+        auto op = std::make_unique<UringOp>();
+        op->kind = UringOp::Kind::Write;
+        op->path = path;
+        op->size = data.size();
+        op->data = std::move(data);
+        auto future = op->writePromise.get_future();
+        enqueue(std::move(op));
+        return future;
+    }
+
+private:
+    bool probe_ops()
+    {
+        const unsigned nOps = 256;
+        std::vector<uint8_t> buf(sizeof(io_uring_probe) + nOps * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+        if (sys_io_uring_register(ringFd_, IORING_REGISTER_PROBE, probe, nOps) < 0) return false;
+
+        for (unsigned op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                            IORING_OP_WRITE, IORING_OP_CLOSE}) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unmap()
+    {
+        if (sqes_) munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+        if (sqRing_) munmap(sqRing_, sqRingSize_);
+    }
+
+    void enqueue(std::unique_ptr<UringOp> op)
+    {
+        if (trace_enabled()) op->startNs = trace_now_ns();
+        std::vector<UringOp*> failed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (broken_) {
+                op->error = ErrorCode::IoError;
+                failed.push_back(op.release());
+            } else if (active_ < maxActive_) {
+                ++active_;
+                submit_or_fail(op.release(), failed);
+            } else {
+                pending_.push_back(std::move(op));
+            }
+        }
+        finish_all(failed);
+    }
+
+    // Caller holds mutex_. Never full: each active op owns at most one SQE.
+    io_uring_sqe* next_sqe()
+    {
+        unsigned tail = *sqTail_;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        return sqe;
+    }
+
+    // Publish the SQE from next_sqe() and submit it. False if the kernel
+    // refused it; the SQE is then taken back. Caller holds mutex_.
+    bool submit_locked()
+    {
+        const unsigned tail = *sqTail_;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        for (;;) {
+            if (sys_io_uring_enter(ringFd_, 1, 0, 0) >= 0) return true;
+            if (errno != EINTR && errno != EAGAIN) break;
+        }
+        // Only submissions move the kernel's head, and they all hold mutex_.
+        if (__atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == tail) {
+            __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+        return true; // consumed after all: its completion will arrive
+    }
+
+    // The next pending op for a slot that became free, or nullptr (the
+    // slot is then released). Caller holds mutex_.
+    UringOp* next_pending()
+    {
+        if (pending_.empty()) {
+            --active_;
+            return nullptr;
+        }
+        UringOp* op = pending_.front().release();
+        pending_.pop_front();
+        return op;
+    }
+
+    // Submit the op's current stage. If the kernel refuses it the op fails
+    // (closing its file) and goes to 'failed', and its slot passes to the
+    // next pending op. Caller holds mutex_.
+    void submit_or_fail(UringOp* op, std::vector<UringOp*>& failed)
+    {
+        while (op && !submit_stage(op)) {
+            if (op->fd >= 0) close(op->fd);
+            op->fd = -1;
+            op->error = ErrorCode::IoError;
+            failed.push_back(op);
+            op = next_pending();
+        }
+    }
+
+    // Queue the SQE for the op's current stage. Caller holds mutex_.
+    bool submit_stage(UringOp* op)
+    {
+        io_uring_sqe* sqe = next_sqe();
+        sqe->user_data = reinterpret_cast<uint64_t>(op);
+
+        switch (op->stage) {
+            case UringOp::Stage::Open:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(op->path.c_str());
+                if (op->kind == UringOp::Kind::Read) {
+                    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                } else {
+                    sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+                    sqe->len = 0644;
+                }
+                break;
+            case UringOp::Stage::Stat:
+                sqe->opcode = IORING_OP_STATX;
+                sqe->fd = op->fd;
+                sqe->addr = reinterpret_cast<uint64_t>("");
+                sqe->statx_flags = AT_EMPTY_PATH;
+                sqe->len = STATX_SIZE;
+                sqe->off = reinterpret_cast<uint64_t>(&op->stx);
+                break;
+            case UringOp::Stage::Transfer: {
+                uint64_t chunk = std::min(op->size - op->done, kMaxChunk);
+                sqe->opcode = op->kind == UringOp::Kind::Read ? IORING_OP_READ : IORING_OP_WRITE;
+                sqe->fd = op->fd;
+                sqe->addr = reinterpret_cast<uint64_t>(op->data.data() + op->done);
+                sqe->len = (uint32_t)chunk;
+                sqe->off = op->offset + op->done;
+                break;
+            }
+            case UringOp::Stage::Close:
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = op->fd;
+                break;
+        }
+        if (!submit_locked()) return false;
+        inFlight_.insert(op);
+        return true;
+    }
+
+    // Advance 'op' after a completion with result 'res'. Returns false once
+    // the op has finished (its promise is fulfilled by the caller).
+    bool advance(UringOp* op, int res)
+    {
+        using Stage = UringOp::Stage;
+        switch (op->stage) {
+            case Stage::Open:
+                if (res < 0) {
+                    op->error = ErrorCode::IoError;
+                    return false;
+                }
+                op->fd = res;
+                if (op->kind == UringOp::Kind::Read && op->size == kReadWholeFile) {
+                    op->stage = Stage::Stat;
+                    return true;
+                }
+                break;
+            case Stage::Stat:
+                if (res < 0) {
+                    op->error = ErrorCode::IoError;
+                    op->stage = Stage::Close;
+                    return true;
+                }
+                op->size = op->stx.stx_size > op->offset ? op->stx.stx_size - op->offset : 0;
+                break;
+            case Stage::Transfer:
+                // Transient: run the same transfer again.
+                if (res == -EAGAIN || res == -EINTR) return true;
+                // A zero-byte read means the file is shorter than requested.
+                if (res <= 0) {
+                    op->error = ErrorCode::IoError;
+                    op->stage = Stage::Close;
+                    return true;
+                }
+                op->done += (uint64_t)res;
+                if (op->done < op->size) return true;
+                op->stage = Stage::Close;
+                return true;
+            case Stage::Close:
+                if (res < 0) op->error = ErrorCode::IoError;
+                return false;
+        }
+
+        // Open or Stat finished: size the buffer and start transferring.
+        if (op->kind == UringOp::Kind::Read) op->data.resize((size_t)op->size);
+        op->stage = op->size > 0 ? Stage::Transfer : Stage::Close;
+        return true;
+    }
+
+    void finish_all(const std::vector<UringOp*>& ops)
+    {
+        for (UringOp* op : ops) finish(op);
+        if (!ops.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.notify_all();
+        }
+    }
+
+    void finish(UringOp* op)
+    {
+        std::unique_ptr<UringOp> owned(op);
+        if (op->startNs) {
+            trace_record(op->kind == UringOp::Kind::Read ? "uring_read" : "uring_write", "io",
+                         op->startNs, trace_now_ns(), op->size);
+        }
+        if (op->kind == UringOp::Kind::Read) {
+            IoReadResult result;
+            result.error = op->error;
+            if (op->error == ErrorCode::Ok) result.data = std::move(op->data);
+            op->readPromise.set_value(std::move(result));
+        } else {
+            op->writePromise.set_value(op->error);
+        }
+    }
+
+    // Block until a completion arrives or the destructor signals wakeFd_.
+    // False if the ring can no longer be waited on.
+    bool wait_for_completions()
+    {
+        pollfd fds[2] = { { ringFd_, POLLIN, 0 }, { wakeFd_, POLLIN, 0 } };
+        for (;;) {
+            if (poll(fds, 2, -1) >= 0) return !((fds[0].revents | fds[1].revents) & (POLLERR | POLLNVAL));
+            if (errno != EINTR) return false;
+        }
+    }
+
+    // The ring is unusable: fail everything in flight or queued, and every
+    // later request, instead of waiting for completions that never come.
+    void fail_all()
+    {
+        std::vector<UringOp*> failed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            broken_ = true;
+            failed.assign(inFlight_.begin(), inFlight_.end());
+            inFlight_.clear();
+            for (auto& op : pending_) failed.push_back(op.release());
+            pending_.clear();
+            active_ = 0;
+        }
+        for (UringOp* op : failed) {
+            if (op->fd >= 0) close(op->fd);
+            op->fd = -1;
+            op->error = ErrorCode::IoError;
+        }
+        finish_all(failed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.notify_all();
+    }
+
+    void reap()
+    {
+        for (;;) {
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                if (stopping_) return;
+                if (!wait_for_completions()) {
+                    fail_all();
+                    return;
+                }
+                continue;
+            }
+
+            std::vector<UringOp*> finished;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (; head != tail; ++head) {
+                    const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                    auto* op = reinterpret_cast<UringOp*>(cqe.user_data);
+                    inFlight_.erase(op);
+                    if (advance(op, cqe.res)) {
+                        submit_or_fail(op, finished);
+                    } else {
+                        finished.push_back(op);
+                        submit_or_fail(next_pending(), finished);
+                    }
+                }
+                __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            }
+
+            finish_all(finished);
+        }
+    }
+
+    int ringFd_ = -1;
+    int wakeFd_ = -1; // signalled once by the destructor
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::deque<std::unique_ptr<UringOp>> pending_;
+    std::unordered_set<UringOp*> inFlight_; // ops with an SQE in the kernel
+    unsigned active_ = 0;
+    unsigned maxActive_ = 1;
+    bool broken_ = false; // waiting on the ring failed; requests fail at once
+    std::atomic<bool> stopping_{ false };
+    std::thread reaper_;
+};
+
+} // namespace
+
+std::unique_ptr<IoBackend> make_io_uring_backend(unsigned queueDepth)
+{
+    auto backend = std::make_unique<UringIoBackend>();
+    if (!backend->init(queueDepth)) return nullptr;
+    return backend;
+}
+
+} // namespace neurozip
@@ -0,0 +1,67 @@
+#include "job_queue.h"
+
+#include "numa.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <string>
+
+namespace neurozip {
+
+JobQueue::JobQueue(unsigned threads)
+{
+    if (threads == 0) {
+        size_t cpus = 0;
+        for (const auto& node : numa_topology().nodes) cpus += node.cpus.size();
+        threads = cpus ? (unsigned)cpus : std::thread::hardware_concurrency();
+    }
+    threads = std::max(1u, threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i] {
+            trace_set_thread_name("job " + std::to_string(i));
+            worker_main();
+        });
+    }
+}
+
+JobQueue::~JobQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void JobQueue::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+size_t JobQueue::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void JobQueue::worker_main()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return; // stopping and drained
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job();
+    }
+}
+
+} // namespace neurozip
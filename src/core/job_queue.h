@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neurozip {
+
+/// Fixed set of threads running independent jobs in submission order,
+/// for the C API's asynchronous calls. Unlike WorkerPool, which splits one
+/// loop across its workers and blocks the caller, post() returns at once
+/// and any number of jobs may be waiting; each job runs start to finish on
+/// one thread.
+class JobQueue {
+public:
+    /// threads = 0 uses every CPU the process may run on.
+    explicit JobQueue(unsigned threads = 0);
+
+    /// Runs the jobs still queued, then joins the threads.
+    ~JobQueue();
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    unsigned size() const { return (unsigned)workers_.size(); }
+
+    /// Queue 'job'; it runs on one of the threads.
+    void post(std::function<void()> job);
+
+    /// Jobs queued and not yet started.
+    size_t pending() const;
+
+private:
+    void worker_main();
+
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+};
+
+} // namespace neurozip
@@ -1,14 +1,24 @@
 #include "model_interface.h"
+#include "alphabet.h"
+#include "checkpoint.h"
 #include "range_coder.h"
+#include "result_cache.h"
+#include "spsc_ring.h"
+#include "stream_state.h"
+#include "token_vocab.h"
+#include "trace.h"
+#include "worker_pool.h"
 
 #include <algorithm>
 #include <cmath>
+#include <thread>
 
 namespace neurozip {
 
-/// Convert probability distribution (256 floats) to cumulative frequencies.
+/// Convert probability distribution (n floats) to cumulative frequencies.
 static void probs_to_cumfreq(
     const float* probs,
+    uint32_t n,
     uint32_t* cum,
     uint32_t& total
 ) {
@@ -16,98 +26,828 @@ static void probs_to_cumfreq(
     constexpr uint32_t SCALE = 1u << 15; // total around 32768
     total = 0;
     cum[0] = 0;
-    for (uint32_t i = 0; i < 256; ++i) {
+    for (uint32_t i = 0; i < n; ++i) {
         uint32_t f = static_cast<uint32_t>(probs[i] * SCALE);
         if (f == 0) f = 1; // avoid zero frequencies
         cum[i + 1] = cum[i] + f;
     }
-    total = cum[256];
+    total = cum[n];
     if (total == 0) {
         // fallback to uniform
-        for (uint32_t i = 0; i <= 256; ++i) {
+        for (uint32_t i = 0; i <= n; ++i) {
             cum[i] = i;
         }
-        total = 256;
+        total = n;
     }
 }
 
-std::vector<uint8_t> compress_buffer(
+static void probs_to_cumfreq(
+    const float* probs,
+    uint32_t* cum,
+    uint32_t& total
+) {
+    probs_to_cumfreq(probs, 256, cum, total);
+}
+
+/// Find the symbol whose [cum[s], cum[s+1]) interval contains value.
+static uint32_t find_symbol(const uint32_t* cum, uint32_t n, uint32_t value)
+{
+    uint32_t lo = 0, hi = n;
+    while (lo + 1 < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (cum[mid] > value)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return lo;
+}
+
+static uint32_t decode_with(RangeDecoder& decoder, const uint32_t* cum, uint32_t n, uint32_t total)
+{
+    uint32_t sym = find_symbol(cum, n, decoder.get_cum(total));
+    decoder.decode_symbol(cum[sym], cum[sym + 1] - cum[sym], total);
+    return sym;
+}
+
+/// Keep the probabilities of symbols[0, n) of a 256-way distribution,
+/// renormalized to sum to 1.
+static void restrict_probs(const float* probs, const uint8_t* symbols, size_t n, float* out)
+{
+    float sum = 0.0f;
+    for (size_t k = 0; k < n; ++k) {
+        out[k] = probs[symbols[k]];
+        sum += out[k];
+    }
+    if (sum <= 0.0f) {
+        for (size_t k = 0; k < n; ++k) out[k] = 1.0f / (float)n;
+        return;
+    }
+    float invSum = 1.0f / sum;
+    for (size_t k = 0; k < n; ++k) out[k] *= invSum;
+}
+
+void ICompressionModel::output_probs_subset(
+    const float* hidden,
+    size_t count,
+    const uint8_t* symbols,
+    size_t n,
+    float* outProbs
+) const {
+    std::vector<float> probs(count * 256);
+    output_probs(hidden, count, probs.data());
+    for (size_t p = 0; p < count; ++p)
+        restrict_probs(&probs[p * 256], symbols, n, outProbs + p * n);
+}
+
+bool reduces_alphabet(const ICompressionModel& model)
+{
+    return !model.nibble_output() && !model.token_vocab();
+}
+
+/// Distribution over a reduced alphabet (by rank) after 'prev': only the
+/// alphabet's rows of the output layer when the model splits it off, else
+/// the full distribution renormalized.
+static void predict_reduced(
     const ICompressionModel& model,
-    const uint8_t* data,
-    size_t size
+    ModelContext& ctx,
+    uint8_t prev,
+    const ByteAlphabet& alphabet,
+    float* outProbs
 ) {
-    RangeEncoder encoder;
-    auto ctx = model.create_context();
+    const size_t H = model.hidden_size();
+    if (H > 0) {
+        std::vector<float> hidden(H);
+        model.advance(ctx, prev, hidden.data());
+        model.output_probs_subset(hidden.data(), 1, alphabet.symbols, alphabet.size(), outProbs);
+        return;
+    }
+    float probs[256];
+    model.predict_next(ctx, prev, probs, 256);
+    restrict_probs(probs, alphabet.symbols, alphabet.size(), outProbs);
+}
+
+struct SymbolRange {
+    uint32_t cumFreq;
+    uint32_t freq;
+    uint32_t total;
+};
 
+static SymbolRange symbol_range(const uint32_t* cum, uint32_t total, uint32_t sym)
+{
+    return { cum[sym], cum[sym + 1] - cum[sym], total };
+}
+
+/// Model one byte with the model's output factorization: a single
+/// 256-symbol distribution, or high nibble then low nibble (16 + 16), or
+/// with 'alphabet' set, one distribution over its symbols.
+/// Writes the coder interval of each symbol to 'out' and returns how many.
+static size_t model_byte(
+    const ICompressionModel& model,
+    ModelContext& ctx,
+    uint8_t prev,
+    uint8_t sym,
+    const ByteAlphabet* alphabet,
+    SymbolRange* out
+) {
     float probs[256];
     uint32_t cum[257];
     uint32_t total = 0;
 
-    uint8_t prev = 0; // BOS symbol
+    if (alphabet) {
+        predict_reduced(model, ctx, prev, *alphabet, probs);
+        probs_to_cumfreq(probs, alphabet->size(), cum, total);
+        out[0] = symbol_range(cum, total, alphabet->rank[sym]);
+        return 1;
+    }
+
+    if (model.nibble_output()) {
+        uint8_t hi = sym >> 4;
+
+        model.predict_high_nibble(ctx, prev, probs);
+        probs_to_cumfreq(probs, 16, cum, total);
+        out[0] = symbol_range(cum, total, hi);
+
+        model.predict_low_nibble(ctx, hi, probs);
+        probs_to_cumfreq(probs, 16, cum, total);
+        out[1] = symbol_range(cum, total, sym & 15u);
+        return 2;
+    }
+
+    model.predict_next(ctx, prev, probs, 256);
+    probs_to_cumfreq(probs, cum, total);
+    out[0] = symbol_range(cum, total, sym);
+    return 1;
+}
+
+static void encode_byte(
+    const ICompressionModel& model,
+    RangeEncoder& encoder,
+    ModelContext& ctx,
+    uint8_t prev,
+    uint8_t sym,
+    const ByteAlphabet* alphabet
+) {
+    SymbolRange ranges[2];
+    size_t n = model_byte(model, ctx, prev, sym, alphabet, ranges);
+    for (size_t k = 0; k < n; ++k) {
+        encoder.encode_symbol(ranges[k].cumFreq, ranges[k].freq, ranges[k].total);
+    }
+}
+
+static uint8_t decode_byte(
+    const ICompressionModel& model,
+    RangeDecoder& decoder,
+    ModelContext& ctx,
+    uint8_t prev,
+    const ByteAlphabet* alphabet
+) {
+    float probs[256];
+    uint32_t cum[257];
+    uint32_t total = 0;
+
+    if (alphabet) {
+        predict_reduced(model, ctx, prev, *alphabet, probs);
+        probs_to_cumfreq(probs, alphabet->size(), cum, total);
+        return alphabet->symbols[decode_with(decoder, cum, alphabet->size(), total)];
+    }
+
+    if (model.nibble_output()) {
+        model.predict_high_nibble(ctx, prev, probs);
+        probs_to_cumfreq(probs, 16, cum, total);
+        uint32_t hi = decode_with(decoder, cum, 16, total);
+
+        model.predict_low_nibble(ctx, (uint8_t)hi, probs);
+        probs_to_cumfreq(probs, 16, cum, total);
+        uint32_t lo = decode_with(decoder, cum, 16, total);
+
+        return (uint8_t)((hi << 4) | lo);
+    }
+
+    model.predict_next(ctx, prev, probs, 256);
+    probs_to_cumfreq(probs, cum, total);
+    return (uint8_t)decode_with(decoder, cum, 256, total);
+}
+
+/// Token models: interval of token 'sym' after 'prev'. 'probs' and 'cum'
+/// are scratch space of the vocabulary's size (+1 for cum).
+static SymbolRange model_token(
+    const ICompressionModel& model,
+    ModelContext& ctx,
+    uint32_t prev,
+    uint32_t sym,
+    std::vector<float>& probs,
+    std::vector<uint32_t>& cum
+) {
+    uint32_t total = 0;
+    model.predict_next_token(ctx, prev, probs.data());
+    probs_to_cumfreq(probs.data(), (uint32_t)probs.size(), cum.data(), total);
+    return symbol_range(cum.data(), total, sym);
+}
+
+/// Tokenize data[0, size) greedily and code one symbol per token. The
+/// first step sees token 0, like the byte models' BOS byte.
+static void encode_tokens(
+    const ICompressionModel& model,
+    const TokenVocab& vocab,
+    const uint8_t* data,
+    size_t size,
+    RangeEncoder& encoder,
+    ModelContext& ctx
+) {
+    TraceSpan span("tokens", "codec", size);
+    std::vector<float> probs(vocab.size());
+    std::vector<uint32_t> cum(vocab.size() + 1);
+
+    uint32_t prev = 0;
+    for (size_t pos = 0; pos < size;) {
+        size_t len = 0;
+        uint32_t sym = vocab.match(data + pos, size - pos, len);
+        SymbolRange r = model_token(model, ctx, prev, sym, probs, cum);
+        encoder.encode_symbol(r.cumFreq, r.freq, r.total);
+        prev = sym;
+        pos += len;
+    }
+}
+
+/// Decode tokens until outData holds at least 'end' bytes. False if the
+/// last token runs past 'limit' (the stream does not match its size).
+static bool decode_tokens(
+    const ICompressionModel& model,
+    const TokenVocab& vocab,
+    RangeDecoder& decoder,
+    ModelContext& ctx,
+    size_t end,
+    size_t limit,
+    std::vector<uint8_t>& outData
+) {
+    const uint32_t V = (uint32_t)vocab.size();
+    std::vector<float> probs(V);
+    std::vector<uint32_t> cum(V + 1);
+
+    uint32_t prev = 0;
+    while (outData.size() < end) {
+        uint32_t total = 0;
+        model.predict_next_token(ctx, prev, probs.data());
+        probs_to_cumfreq(probs.data(), V, cum.data(), total);
+        uint32_t sym = decode_with(decoder, cum.data(), V, total);
+
+        size_t len = 0;
+        const uint8_t* bytes = vocab.token(sym, len);
+        if (outData.size() + len > limit) return false;
+        outData.insert(outData.end(), bytes, bytes + len);
+        prev = sym;
+    }
+    return true;
+}
+
+/// Floats of h (and of c) a checkpoint has to capture for this model.
+static size_t checkpoint_state_size(const ICompressionModel& model)
+{
+    size_t H = model.hidden_size();
+    return (H == 0 || H > kMaxHiddenSize) ? 256 : H;
+}
+
+// Records checkpoints while encoding. The model state is snapshotted (and
+// replaced by its dequantized copy) before the byte at a checkpoint is
+// modeled; the coder state is captured before that byte is coded. The two
+// happen at different times in the two-phase encoder.
+class CheckpointWriter {
+public:
+    /// 'streamBase': bytes ahead of the coder output (an alphabet bitmap).
+    CheckpointWriter(
+        const ICompressionModel& model,
+        const CompressOptions& options,
+        CheckpointIndex* out,
+        uint64_t streamBase = 0
+    ) : out_(options.checkpointInterval > 0 ? out : nullptr),
+        streamBase_(streamBase)
+    {
+        if (!out_) return;
+        out_->interval = options.checkpointInterval;
+        out_->precision = options.checkpointInt8 ? CheckpointPrecision::Int8
+                                                 : CheckpointPrecision::Fp16;
+        out_->stateSize = (uint32_t)checkpoint_state_size(model);
+        out_->entries.clear();
+    }
+
+    /// Extend an existing index while continuing a stream that already
+    /// holds 'streamBase' coder output bytes.
+    CheckpointWriter(CheckpointIndex* existing, uint64_t streamBase)
+        : out_(existing && existing->enabled() ? existing : nullptr),
+          streamBase_(streamBase)
+    {
+    }
+
+    bool due(size_t pos) const
+    {
+        return out_ && pos > 0 && pos % out_->interval == 0;
+    }
+
+    void snapshot(size_t pos, ModelContext& ctx, uint8_t prev)
+    {
+        StateCheckpoint e;
+        e.bytePos = pos;
+        e.prevByte = prev;
+        snapshot_state(ctx, out_->stateSize, out_->precision, e.state);
+        out_->entries.push_back(std::move(e));
+    }
+
+    void coder_state(size_t pos, const RangeEncoder& encoder)
+    {
+        coder_state(pos, encoder.buffer().size(), encoder.low(), encoder.high());
+    }
+
+    /// Coder state recorded elsewhere ('streamSize' encoder output bytes).
+    void coder_state(size_t pos, uint64_t streamSize, uint32_t low, uint32_t high)
+    {
+        StateCheckpoint& e = out_->entries[pos / out_->interval - 1];
+        e.streamPos = streamBase_ + streamSize;
+        e.low = low;
+        e.high = high;
+    }
+
+private:
+    CheckpointIndex* out_;
+    uint64_t streamBase_ = 0;
+};
+
+/// Decode bytes [pos, end) into outData, keeping only those at or after
+/// 'keepFrom'. Checkpoint states are re-applied exactly where the encoder
+/// applied them.
+static void decode_bytes(
+    const ICompressionModel& model,
+    RangeDecoder& decoder,
+    ModelContext& ctx,
+    uint8_t prev,
+    size_t pos,
+    size_t end,
+    size_t keepFrom,
+    const CheckpointIndex* checkpoints,
+    const ByteAlphabet* alphabet,
+    std::vector<uint8_t>& outData
+) {
+    bool useCheckpoints = checkpoints && checkpoints->enabled();
+
+    for (; pos < end; ++pos) {
+        if (useCheckpoints && pos > 0 && pos % checkpoints->interval == 0) {
+            size_t k = pos / checkpoints->interval - 1;
+            if (k < checkpoints->entries.size()) {
+                restore_state(checkpoints->entries[k].state, checkpoints->stateSize,
+                              checkpoints->precision, ctx);
+            }
+        }
+
+        uint8_t sym = decode_byte(model, decoder, ctx, prev, alphabet);
+        if (pos >= keepFrom) outData.push_back(sym);
+        prev = sym;
+    }
+}
+
+// Positions per two-phase block; the block's hidden states stay in memory
+// between the recurrence pass and the output-layer pass.
+static constexpr size_t kTwoPhaseBlock = 4096;
+
+// Positions handed to output_probs in one call.
+static constexpr size_t kOutputBatch = 64;
+
+// Symbols in flight between the model thread and the coder thread.
+static constexpr size_t kPipelineRing = 4096;
+
+/// Input positions are 'base' + index into 'data' (nonzero when
+/// continuing a stream).
+static void encode_two_phase(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t base,
+    WorkerPool* pool,
+    const ByteAlphabet* alphabet,
+    CheckpointWriter& checkpoints,
+    RangeEncoder& encoder,
+    ModelContext& ctx,
+    uint8_t& prev
+) {
+    const size_t H = model.hidden_size();
+    const uint32_t V = alphabet ? alphabet->size() : 256;
+
+    std::vector<float> hidden(kTwoPhaseBlock * H);
+    std::vector<SymbolRange> ranges(kTwoPhaseBlock);
 
+    for (size_t start = 0; start < size; start += kTwoPhaseBlock) {
+        size_t n = std::min(kTwoPhaseBlock, size - start);
+        const uint8_t* block = data + start;
+        const size_t pos = base + start;
+
+        // Phase 1: the recurrence is the only serial dependency.
+        {
+            TraceSpan span("recurrence", "codec", n);
+            for (size_t i = 0; i < n; ++i) {
+                if (checkpoints.due(pos + i)) checkpoints.snapshot(pos + i, ctx, prev);
+                model.advance(ctx, prev, &hidden[i * H]);
+                prev = block[i];
+            }
+        }
+
+        // Phase 2: output layer, softmax and CDF for all positions.
+        // Each worker reads the weights from its own NUMA node.
+        auto outputLayer = [&](const ICompressionModel& m, size_t lo, size_t hi) {
+            std::vector<float> probs(kOutputBatch * V);
+            uint32_t cum[257];
+            uint32_t total = 0;
+            for (size_t p = lo; p < hi; p += kOutputBatch) {
+                size_t count = std::min(kOutputBatch, hi - p);
+                if (alphabet) {
+                    m.output_probs_subset(&hidden[p * H], count, alphabet->symbols, V, probs.data());
+                } else {
+                    m.output_probs(&hidden[p * H], count, probs.data());
+                }
+                for (size_t k = 0; k < count; ++k) {
+                    uint8_t sym = block[p + k];
+                    probs_to_cumfreq(&probs[k * V], V, cum, total);
+                    ranges[p + k] = symbol_range(cum, total, alphabet ? alphabet->rank[sym] : sym);
+                }
+            }
+        };
+        if (pool) {
+            TraceSpan span("output_layer", "codec", n);
+            pool->parallel_for(n, kOutputBatch, [&](unsigned worker, size_t lo, size_t hi) {
+                outputLayer(pool->local_model(model, worker), lo, hi);
+            });
+        } else {
+            TraceSpan span("output_layer", "codec", n);
+            outputLayer(model, 0, n);
+        }
+
+        // Phase 3: serial range coding.
+        TraceSpan span("range_coder", "codec", n);
+        for (size_t i = 0; i < n; ++i) {
+            if (checkpoints.due(pos + i)) checkpoints.coder_state(pos + i, encoder);
+            encoder.encode_symbol(ranges[i].cumFreq, ranges[i].freq, ranges[i].total);
+        }
+    }
+}
+
+/// The calling thread runs the model and hands each symbol's interval to
+/// a coder thread through an SPSC ring. Same stream as the serial loop.
+static void encode_pipelined(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t base,
+    const ByteAlphabet* alphabet,
+    CheckpointWriter& checkpoints,
+    RangeEncoder& encoder,
+    ModelContext& ctx,
+    uint8_t& prev
+) {
+    const size_t perByte = model.nibble_output() && !alphabet ? 2 : 1;
+    SpscRing<SymbolRange> ring(kPipelineRing);
+
+    // Checkpoint entries belong to the model thread; the coder thread keeps
+    // its half of each checkpoint here until both are done.
+    struct CoderState {
+        size_t pos;
+        uint64_t streamSize;
+        uint32_t low;
+        uint32_t high;
+    };
+    std::vector<CoderState> coderStates;
+
+    std::thread coder([&] {
+        if (trace_enabled()) trace_set_thread_name("coder");
+        TraceSpan span("range_coder", "codec", size);
+        SymbolRange r;
+        for (size_t i = 0; i < size; ++i) {
+            if (checkpoints.due(base + i)) {
+                coderStates.push_back({ base + i, encoder.buffer().size(), encoder.low(), encoder.high() });
+            }
+            for (size_t k = 0; k < perByte; ++k) {
+                ring.pop(r);
+                encoder.encode_symbol(r.cumFreq, r.freq, r.total);
+            }
+        }
+    });
+
+    SymbolRange ranges[2];
     for (size_t i = 0; i < size; ++i) {
-        model.predict_next(*ctx, prev, probs, 256);
-        probs_to_cumfreq(probs, cum, total);
+        if (checkpoints.due(base + i)) checkpoints.snapshot(base + i, ctx, prev);
 
         uint8_t sym = data[i];
+        size_t n = model_byte(model, ctx, prev, sym, alphabet, ranges);
+        for (size_t k = 0; k < n; ++k) ring.push(ranges[k]);
+        prev = sym;
+    }
+
+    coder.join();
+    for (const auto& cs : coderStates) {
+        checkpoints.coder_state(cs.pos, cs.streamSize, cs.low, cs.high);
+    }
+}
+
+/// Code data[0, size) at input positions base.. with the encoder, context
+/// and previous byte left by earlier input; over 'alphabet' if set.
+static void encode_bytes(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t base,
+    const CompressOptions& options,
+    const ByteAlphabet* alphabet,
+    CheckpointWriter& checkpoints,
+    RangeEncoder& encoder,
+    ModelContext& ctx,
+    uint8_t& prev
+) {
+    if (options.twoPhase && model.hidden_size() > 0 && !model.nibble_output()) {
+        WorkerPool* pool = options.pool;
+        std::unique_ptr<WorkerPool> ownPool;
+        if (!pool && options.threads != 1) {
+            ownPool = std::make_unique<WorkerPool>(options.threads, options.numaAware);
+            pool = ownPool.get();
+        }
+        encode_two_phase(model, data, size, base, pool, alphabet, checkpoints, encoder, ctx, prev);
+        return;
+    }
+
+    if (options.pipelined) {
+        encode_pipelined(model, data, size, base, alphabet, checkpoints, encoder, ctx, prev);
+        return;
+    }
 
-        uint32_t cumFreq = cum[sym];
-        uint32_t freq = cum[sym + 1] - cum[sym];
+    for (size_t i = 0; i < size; ++i) {
+        if (checkpoints.due(base + i)) {
+            checkpoints.snapshot(base + i, ctx, prev);
+            checkpoints.coder_state(base + i, encoder);
+        }
 
-        encoder.encode_symbol(cumFreq, freq, total);
+        uint8_t sym = data[i];
+        encode_byte(model, encoder, ctx, prev, sym, alphabet);
         prev = sym;
     }
+}
+
+/// Record where the stream can be continued, just before the flush.
+static void save_stream_state(
+    const ICompressionModel& model,
+    const RangeEncoder& encoder,
+    const ModelContext& ctx,
+    uint8_t prev,
+    uint64_t bytePos,
+    uint64_t streamBase,
+    StreamState& state
+) {
+    state.bytePos = bytePos;
+    state.streamPos = streamBase + encoder.buffer().size();
+    state.low = encoder.low();
+    state.high = encoder.high();
+    state.prevByte = prev;
+    state.capture(ctx, checkpoint_state_size(model));
+}
+
+std::vector<uint8_t> compress_buffer(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size
+) {
+    return compress_buffer(model, data, size, CompressOptions());
+}
+
+std::vector<uint8_t> compress_buffer(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    const CompressOptions& options,
+    CheckpointIndex* outCheckpoints,
+    StreamState* outState
+) {
+    TraceSpan span("compress", "codec", size);
+
+    const bool reduced = options.reducedAlphabet && reduces_alphabet(model) && !outState;
+
+    ResultCacheKey key;
+    const bool cached = options.cache && options.checkpointInterval == 0 && !outState;
+    if (cached) {
+        key = result_cache_key(model, data, size, RESULT_CACHE_STREAM | (options.minimalFlush ? 1 : 0) |
+                                                      (reduced ? 2 : 0));
+        std::vector<uint8_t> hit;
+        if (options.cache->lookup(key, hit)) return hit;
+    }
+
+    // Token streams have no checkpoints (a token may straddle one).
+    CompressOptions opts = options;
+    if (model.token_vocab()) {
+        opts.checkpointInterval = 0;
+        if (outCheckpoints) *outCheckpoints = CheckpointIndex();
+    }
+
+    // The bitmap goes ahead of the coder output; checkpoint stream
+    // positions count it.
+    ByteAlphabet alphabet;
+    uint8_t bitmap[kAlphabetBitmapBytes];
+    const size_t bitmapSize = reduced ? kAlphabetBitmapBytes : 0;
+    if (reduced) {
+        alphabet.scan(data, size);
+        alphabet.write_bitmap(bitmap);
+    }
+    CheckpointWriter checkpoints(model, opts, outCheckpoints, bitmapSize);
+
+    RangeEncoder encoder;
+    auto ctx = model.create_context();
+
+    if (const TokenVocab* vocab = model.token_vocab()) {
+        // One symbol per token; the other paths only change the schedule
+        // of the byte models, so they would code the same stream here.
+        encode_tokens(model, *vocab, data, size, encoder, *ctx);
+    } else {
+        uint8_t prev = 0; // BOS symbol
+
+        encode_bytes(model, data, size, 0, options, reduced ? &alphabet : nullptr, checkpoints,
+                     encoder, *ctx, prev);
+        if (outState) save_stream_state(model, encoder, *ctx, prev, size, 0, *outState);
+    }
 
     // Encode EOF as 256? We just finish; length is known externally.
+    if (options.minimalFlush) {
+        encoder.finish_minimal();
+    } else {
+        encoder.finish();
+    }
+    std::vector<uint8_t> stream(bitmap, bitmap + bitmapSize);
+    stream.insert(stream.end(), encoder.buffer().begin(), encoder.buffer().end());
+    if (cached) options.cache->insert(key, stream.data(), stream.size());
+    return stream;
+}
+
+std::vector<uint8_t> continue_buffer(
+    const ICompressionModel& model,
+    StreamState& state,
+    const uint8_t* data,
+    size_t size,
+    const CompressOptions& options,
+    CheckpointIndex* checkpoints
+) {
+    TraceSpan span("compress_continue", "codec", size);
+    CheckpointWriter writer(checkpoints, state.streamPos);
+
+    RangeEncoder encoder(state.low, state.high);
+    auto ctx = model.create_context();
+    state.restore(*ctx);
+
+    uint8_t prev = state.prevByte;
+
+    encode_bytes(model, data, size, (size_t)state.bytePos, options, nullptr, writer, encoder, *ctx, prev);
+    save_stream_state(model, encoder, *ctx, prev, state.bytePos + size, state.streamPos, state);
+
     encoder.finish();
     return encoder.buffer();
 }
 
+double code_length_bits(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t regionSize,
+    std::vector<double>* outRegionBits,
+    uint64_t base
+) {
+    TraceSpan span("code_length", "codec", size);
+    const bool regions = regionSize > 0 && outRegionBits;
+    if (regions && size > 0) {
+        size_t last = (size_t)((base + size - 1) / regionSize);
+        if (outRegionBits->size() <= last) outRegionBits->resize(last + 1, 0.0);
+    }
+
+    auto ctx = model.create_context();
+    double total = 0.0;
+
+    if (const TokenVocab* vocab = model.token_vocab()) {
+        // A token's bits go to the region of its first byte.
+        std::vector<float> probs(vocab->size());
+        std::vector<uint32_t> cum(vocab->size() + 1);
+        uint32_t prev = 0;
+        for (size_t pos = 0; pos < size;) {
+            size_t len = 0;
+            uint32_t sym = vocab->match(data + pos, size - pos, len);
+            SymbolRange r = model_token(model, *ctx, prev, sym, probs, cum);
+            double bits = -std::log2((double)r.freq / (double)r.total);
+            total += bits;
+            if (regions) (*outRegionBits)[(size_t)((base + pos) / regionSize)] += bits;
+            prev = sym;
+            pos += len;
+        }
+        return total;
+    }
+
+    uint8_t prev = 0; // BOS symbol
+    for (size_t i = 0; i < size; ++i) {
+        SymbolRange ranges[2];
+        size_t n = model_byte(model, *ctx, prev, data[i], nullptr, ranges);
+        double bits = 0.0;
+        for (size_t k = 0; k < n; ++k)
+            bits -= std::log2((double)ranges[k].freq / (double)ranges[k].total);
+        total += bits;
+        if (regions) (*outRegionBits)[(size_t)((base + i) / regionSize)] += bits;
+        prev = data[i];
+    }
+    return total;
+}
+
+/// Read the bitmap at the start of a reduced-alphabet stream. False if the
+/// stream is too short, the model codes no byte alphabet, or the bitmap is
+/// empty for a non-empty input.
+static bool read_alphabet(
+    const ICompressionModel& model,
+    const uint8_t* compressed,
+    size_t compressedSize,
+    size_t originalSize,
+    ByteAlphabet& out
+) {
+    if (!reduces_alphabet(model) || compressedSize < kAlphabetBitmapBytes) return false;
+    out.read_bitmap(compressed);
+    return out.size() > 0 || originalSize == 0;
+}
+
 bool decompress_buffer(
     const ICompressionModel& model,
     const uint8_t* compressed,
     size_t compressedSize,
     size_t originalSize,
-    std::vector<uint8_t>& outData
+    std::vector<uint8_t>& outData,
+    const CheckpointIndex* checkpoints,
+    bool reducedAlphabet
 ) {
+    TraceSpan span("decompress", "codec", originalSize);
     outData.clear();
     outData.reserve(originalSize);
 
-    RangeDecoder decoder(compressed, compressedSize);
-    auto ctx = model.create_context();
+    ByteAlphabet alphabet;
+    size_t bitmapSize = 0;
+    if (reducedAlphabet) {
+        if (!read_alphabet(model, compressed, compressedSize, originalSize, alphabet)) return false;
+        bitmapSize = kAlphabetBitmapBytes;
+    }
 
-    float probs[256];
-    uint32_t cum[257];
-    uint32_t total = 0;
+    RangeDecoder decoder(compressed + bitmapSize, compressedSize - bitmapSize);
+    auto ctx = model.create_context();
 
-    uint8_t prev = 0;
+    if (const TokenVocab* vocab = model.token_vocab()) {
+        return decode_tokens(model, *vocab, decoder, *ctx, originalSize, originalSize, outData);
+    }
 
-    for (size_t i = 0; i < originalSize; ++i) {
-        model.predict_next(*ctx, prev, probs, 256);
-        probs_to_cumfreq(probs, cum, total);
+    decode_bytes(model, decoder, *ctx, 0, 0, originalSize, 0, checkpoints,
+                 reducedAlphabet ? &alphabet : nullptr, outData);
+    return true;
+}
 
-        uint32_t value = decoder.get_cum(total);
+bool decompress_range(
+    const ICompressionModel& model,
+    const uint8_t* compressed,
+    size_t compressedSize,
+    size_t originalSize,
+    const CheckpointIndex& checkpoints,
+    uint64_t offset,
+    size_t length,
+    std::vector<uint8_t>& outData,
+    bool reducedAlphabet
+) {
+    TraceSpan span("decompress_range", "codec", length);
+    outData.clear();
+    if (offset >= originalSize) return length == 0;
+    size_t end = (size_t)std::min<uint64_t>(originalSize, offset + length);
+    outData.reserve(end - (size_t)offset);
 
-        // Find symbol by binary search on cum[]
-        uint32_t lo = 0, hi = 256;
-        while (lo + 1 < hi) {
-            uint32_t mid = (lo + hi) / 2;
-            if (cum[mid] > value)
-                hi = mid;
-            else
-                lo = mid;
-        }
-        uint32_t sym = lo;
+    ByteAlphabet alphabet;
+    size_t bitmapSize = 0;
+    if (reducedAlphabet) {
+        if (!read_alphabet(model, compressed, compressedSize, originalSize, alphabet)) return false;
+        bitmapSize = kAlphabetBitmapBytes;
+    }
+    const ByteAlphabet* reduced = reducedAlphabet ? &alphabet : nullptr;
 
-        uint32_t cumFreq = cum[sym];
-        uint32_t freq = cum[sym + 1] - cum[sym];
+    auto ctx = model.create_context();
 
-        decoder.decode_symbol(cumFreq, freq, total);
+    if (const TokenVocab* vocab = model.token_vocab()) {
+        // No checkpoints: decode the prefix and keep the range.
+        std::vector<uint8_t> prefix;
+        RangeDecoder decoder(compressed, compressedSize);
+        if (!decode_tokens(model, *vocab, decoder, *ctx, end, originalSize, prefix)) return false;
+        outData.assign(prefix.begin() + (size_t)offset, prefix.begin() + end);
+        return true;
+    }
 
-        outData.push_back(static_cast<uint8_t>(sym));
-        prev = static_cast<uint8_t>(sym);
+    const StateCheckpoint* cp = checkpoints.nearest(offset);
+    if (!cp) {
+        RangeDecoder decoder(compressed + bitmapSize, compressedSize - bitmapSize);
+        decode_bytes(model, decoder, *ctx, 0, 0, end, (size_t)offset, &checkpoints, reduced, outData);
+        return true;
     }
 
+    // Checkpoint stream positions include the bitmap.
+    if (cp->streamPos > compressedSize || cp->streamPos < bitmapSize) return false;
+    RangeDecoder decoder(compressed, compressedSize, (size_t)cp->streamPos, cp->low, cp->high);
+    decode_bytes(model, decoder, *ctx, cp->prevByte, (size_t)cp->bytePos, end,
+                 (size_t)offset, &checkpoints, reduced, outData);
     return true;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -7,26 +8,43 @@
 
 namespace neurozip {
 
+// Model ids recorded in FileHeader::modelId
+constexpr uint32_t MODEL_ID_TINY_LSTM        = 1; // LSTM, 256-way softmax
+constexpr uint32_t MODEL_ID_TINY_LSTM_NIBBLE = 2; // LSTM, nibble-factored output
+constexpr uint32_t MODEL_ID_TINY_GRU         = 3; // GRU, 256-way softmax
+constexpr uint32_t MODEL_ID_TINY_MGU         = 4; // minimal gated unit, 256-way softmax
+constexpr uint32_t MODEL_ID_TOKEN_LSTM       = 5; // LSTM over a multi-byte token vocabulary
+
 // ---------------------------
 // FULL definition of ModelContext MUST be here
 // ---------------------------
+// Largest hidden size the models load (the state vectors are sized by the
+// model, so this only bounds what a corrupt file can make us allocate).
+constexpr size_t kMaxHiddenSize = 4096;
+
 struct ModelContext {
-    float h[256];   // hidden state
-    float c[256];   // cell state
-
-    ModelContext() {
-        for (int i = 0; i < 256; i++) {
-            h[i] = 0.0f;
-            c[i] = 0.0f;
-        }
+    std::vector<float> h;   // hidden state
+    std::vector<float> c;   // cell state
+
+    /// Zero state for a model of hidden size 'width' (at least 256 wide).
+    explicit ModelContext(size_t width = 256)
+        : h(std::max<size_t>(width, 256), 0.0f),
+          c(std::max<size_t>(width, 256), 0.0f)
+    {
     }
 };
 
+class TokenVocab;
+
 // ---------------------------
 // Abstract interface for a compression model
 // ---------------------------
 class ICompressionModel {
 public:
+    ICompressionModel() = default;
+    // A copy is a different object: it gets its own lifetime token.
+    ICompressionModel(const ICompressionModel&) {}
+    ICompressionModel& operator=(const ICompressionModel&) { return *this; }
     virtual ~ICompressionModel() = default;
 
     virtual std::unique_ptr<ModelContext> create_context() const = 0;
@@ -40,25 +58,269 @@ public:
         size_t outSize
     ) const = 0;
 
+    /// Width of the hidden vector between the recurrence and the output
+    /// layer, or 0 if the model cannot split the two (then the two-phase
+    /// encoder falls back to predict_next).
+    virtual size_t hidden_size() const { return 0; }
+
+    /// Recurrence only: update context with prevByte and write the hidden
+    /// vector (hidden_size() floats) the output layer will consume.
+    virtual void advance(
+        ModelContext& /*ctx*/,
+        uint8_t /*prevByte*/,
+        float* /*outHidden*/
+    ) const {}
+
+    /// Output layer only: byte distributions for 'count' hidden vectors
+    /// stored back to back; writes count * 256 floats. Must produce exactly
+    /// what predict_next would for the same hidden vector.
+    virtual void output_probs(
+        const float* /*hidden*/,
+        size_t /*count*/,
+        float* /*outProbs*/
+    ) const {}
+
+    /// output_probs over the byte values symbols[0, n) only (ascending,
+    /// for a reduced alphabet; see alphabet.h): the softmax of just their
+    /// logits, n floats per position. The default computes all 256 and
+    /// renormalizes; models with a byte output layer compute only those
+    /// rows.
+    virtual void output_probs_subset(
+        const float* hidden,
+        size_t count,
+        const uint8_t* symbols,
+        size_t n,
+        float* outProbs
+    ) const;
+
+    /// True when the model factors each byte into a high and a low
+    /// nibble; compress_buffer then codes two 16-symbol distributions per
+    /// byte instead of one 256-symbol distribution.
+    virtual bool nibble_output() const { return false; }
+
+    /// Nibble models: update context with prevByte and produce the
+    /// distribution of the next byte's high nibble (16 floats).
+    virtual void predict_high_nibble(
+        ModelContext& /*ctx*/,
+        uint8_t /*prevByte*/,
+        float* /*outProbs*/
+    ) const {}
+
+    /// Nibble models: distribution of the low nibble (16 floats) given the
+    /// high nibble, from the state left by predict_high_nibble.
+    virtual void predict_low_nibble(
+        const ModelContext& /*ctx*/,
+        uint8_t /*highNibble*/,
+        float* /*outProbs*/
+    ) const {}
+
+    /// Vocabulary of a model that codes multi-byte tokens (see
+    /// token_vocab.h), or nullptr for byte models. compress_buffer then
+    /// tokenizes the input and codes one symbol per token.
+    virtual const TokenVocab* token_vocab() const { return nullptr; }
+
+    /// Token models: update context with prevToken and produce the
+    /// distribution of the next token (token_vocab()->size() floats).
+    virtual void predict_next_token(
+        ModelContext& /*ctx*/,
+        uint32_t /*prevToken*/,
+        float* /*outProbs*/
+    ) const {}
+
     virtual uint32_t model_id() const = 0;
     virtual uint64_t model_hash() const = 0;
+
+    /// True when predictions come from the fixed-point path and are
+    /// bit-exact across compilers, CPUs and SIMD widths.
+    virtual bool fixed_point() const { return false; }
+
+    /// Switch between float inference and the fixed-point path; a no-op
+    /// for models without one.
+    virtual void set_fixed_point(bool /*enable*/) {}
+
+    /// Primed initial states carried in the model file (see
+    /// models/primed_state.h), numbered 1..primed_state_count().
+    virtual uint32_t primed_state_count() const { return 0; }
+
+    /// Start new contexts from snapshot 'id' instead of h = c = 0
+    /// (0 = cold start). False if the model has no such snapshot.
+    virtual bool set_primed_state(uint32_t id) { return id == 0; }
+    virtual uint32_t primed_state() const { return 0; }
+
+    /// Digest of the selected snapshot (0 for a cold start), recorded with
+    /// the id so a file only decodes with the snapshot it was coded from.
+    virtual uint32_t primed_state_hash() const { return 0; }
+
+    /// Split each step's matrix-vector products across a team of
+    /// 'threads' pinned threads (see step_team.h; 1 = serial). For large
+    /// models decoding a single stream; predictions are bit-identical, so
+    /// files do not record it. A no-op for models without support.
+    virtual void set_step_threads(unsigned /*threads*/) {}
+    virtual unsigned step_threads() const { return 1; }
+
+    /// Approximate weight bytes read per coded byte (0 = unknown). Used by
+    /// the auto-tuner to tell when parallel streams become memory-bound.
+    virtual size_t weight_bytes() const { return 0; }
+
+    /// Deep copy (weights included) used for per-NUMA-node replicas, or
+    /// nullptr if the model cannot be copied; it is then shared.
+    virtual std::unique_ptr<ICompressionModel> clone() const { return nullptr; }
+
+    /// Expires when this object is destroyed. For caches keyed by model
+    /// object (e.g. WorkerPool replicas): a weak_ptr to it is never equal
+    /// to one taken from a later model at the same address.
+    std::weak_ptr<const void> lifetime() const { return lifetime_; }
+
+private:
+    std::shared_ptr<const void> lifetime_ = std::make_shared<char>(0);
 };
 
+/// primed_state() and primed_state_hash() as stored in
+/// FileHeader::primedState (0 for a cold start).
+inline uint64_t primed_state_tag(const ICompressionModel& model)
+{
+    uint32_t id = model.primed_state();
+    return id ? ((uint64_t)model.primed_state_hash() << 32) | id : 0;
+}
+
 // ---------------------------
 // Compression helpers
 // ---------------------------
+struct CheckpointIndex;
+struct StreamState;
+class WorkerPool;
+class ResultCache;
+
+struct CompressOptions {
+    /// Run the recurrence over a block first, then the output layer as a
+    /// batched product across positions, then range-code serially. The
+    /// output is byte-identical to the one-step-at-a-time path.
+    bool twoPhase = false;
+
+    /// Threads for the batched output layer (0 = all hardware threads).
+    unsigned threads = 1;
+
+    /// Pin the output-layer threads per NUMA node, each reading a
+    /// node-local copy of the weights.
+    bool numaAware = true;
+
+    /// Run the model on the calling thread and range coding on a second
+    /// thread, fed through a lock-free ring, so one stream uses two cores.
+    /// The output is identical. Ignored when twoPhase applies.
+    bool pipelined = false;
+
+    /// Reuse an existing pool (and its weight replicas) instead of
+    /// starting threads for this call; overrides threads / numaAware.
+    WorkerPool* pool = nullptr;
+
+    /// Snapshot the model state every N input bytes (0 = off) so a reader
+    /// can start decoding at the nearest checkpoint. The encoder continues
+    /// from the quantized snapshot, so the context is never reset.
+    uint32_t checkpointInterval = 0;
+
+    /// Store checkpoint states as int8 (with a per-vector scale) instead
+    /// of fp16.
+    bool checkpointInt8 = false;
+
+    /// End the stream with only the bytes that identify the final interval
+    /// (0-4, see RangeEncoder::finish_minimal) instead of always 4. For
+    /// compact frames; the stream can then not be continued with outState.
+    bool minimalFlush = false;
+
+    /// Look the input up here first and store the stream on a miss. Only
+    /// used without checkpoints and outState; a hit costs a content hash
+    /// and a copy.
+    ResultCache* cache = nullptr;
+
+    /// Code over only the byte values that occur in the input: the stream
+    /// starts with their bitmap (kAlphabetBitmapBytes, see alphabet.h) and
+    /// the output layer, softmax and CDF cover just those symbols. Decode
+    /// with reducedAlphabet set. Ignored, writing no bitmap, for nibble and
+    /// token models and when outState is requested (appended bytes could
+    /// fall outside the alphabet); see reduces_alphabet().
+    bool reducedAlphabet = false;
+};
+
+/// True when compress_buffer honours options.reducedAlphabet for this
+/// model (a 256-way byte output).
+bool reduces_alphabet(const ICompressionModel& model);
+
 std::vector<uint8_t> compress_buffer(
     const ICompressionModel& model,
     const uint8_t* data,
     size_t size
 );
 
+/// With options.checkpointInterval set, the checkpoints are written to
+/// 'outCheckpoints' (which must then be non-null). 'outState' (optional)
+/// receives the encoder state before the final flush, for continue_buffer.
+/// Token models (token_vocab() set) write neither: the index comes back
+/// disabled and 'outState' is left untouched.
+std::vector<uint8_t> compress_buffer(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    const CompressOptions& options,
+    CheckpointIndex* outCheckpoints = nullptr,
+    StreamState* outState = nullptr
+);
+
+/// Code more input after a stream saved with 'state', which is updated to
+/// the new end. Returns the bytes that replace the old stream's final
+/// flush: its first state.streamPos bytes followed by these decode as the
+/// old and new input back to back. An enabled 'checkpoints' index is
+/// extended in place (options.checkpointInterval is ignored). Byte models
+/// only.
+std::vector<uint8_t> continue_buffer(
+    const ICompressionModel& model,
+    StreamState& state,
+    const uint8_t* data,
+    size_t size,
+    const CompressOptions& options,
+    CheckpointIndex* checkpoints = nullptr
+);
+
+/// Ideal code length in bits of data[0, size) coded as one stream from a
+/// fresh context: the sum of -log2(freq / total) over the intervals the
+/// range coder would use, so it tracks compress_buffer's output to within
+/// the flush. Runs the model only. With regionSize > 0 the bits of byte
+/// (base + i) are also added to (*outRegionBits)[(base + i) / regionSize],
+/// growing the vector as needed; for token models a token's bits count
+/// in the region of its first byte.
+double code_length_bits(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    size_t regionSize = 0,
+    std::vector<double>* outRegionBits = nullptr,
+    uint64_t base = 0
+);
+
+/// 'checkpoints' must be the index produced alongside the stream, if any;
+/// 'reducedAlphabet' must match the encoder's (the stream then starts with
+/// the bitmap).
 bool decompress_buffer(
     const ICompressionModel& model,
     const uint8_t* compressed,
     size_t compressedSize,
     size_t originalSize,
-    std::vector<uint8_t>& outData
+    std::vector<uint8_t>& outData,
+    const CheckpointIndex* checkpoints = nullptr,
+    bool reducedAlphabet = false
+);
+
+/// Decode only bytes [offset, offset + length), starting from the nearest
+/// checkpoint at or before 'offset' (token models decode from the start).
+bool decompress_range(
+    const ICompressionModel& model,
+    const uint8_t* compressed,
+    size_t compressedSize,
+    size_t originalSize,
+    const CheckpointIndex& checkpoints,
+    uint64_t offset,
+    size_t length,
+    std::vector<uint8_t>& outData,
+    bool reducedAlphabet = false
 );
 
 } // namespace neurozip
@@ -0,0 +1,138 @@
+#include "numa.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(NEUROZIP_HAVE_LIBNUMA)
+#include <numa.h>
+#endif
+
+namespace neurozip {
+
+#if defined(__linux__)
+/// Parse a kernel cpulist such as "0-3,8-11".
+static std::vector<unsigned> parse_cpulist(const std::string& text)
+{
+    std::vector<unsigned> cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        size_t dash = item.find('-');
+        unsigned lo = (unsigned)std::stoul(item.substr(0, dash));
+        unsigned hi = dash == std::string::npos ? lo : (unsigned)std::stoul(item.substr(dash + 1));
+        for (unsigned c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+static std::vector<NumaNode> detect_nodes()
+{
+    std::vector<NumaNode> nodes;
+#if defined(NEUROZIP_HAVE_LIBNUMA)
+    if (numa_available() >= 0) {
+        struct bitmask* mask = numa_allocate_cpumask();
+        for (int id = 0; id <= numa_max_node(); ++id) {
+            if (!numa_bitmask_isbitset(numa_nodes_ptr, (unsigned)id)) continue; // ids may be sparse
+            NumaNode node;
+            node.id = (unsigned)id;
+            if (numa_node_to_cpus(id, mask) == 0) {
+                for (unsigned c = 0; c < mask->size; ++c) {
+                    if (numa_bitmask_isbitset(mask, c)) node.cpus.push_back(c);
+                }
+            }
+            nodes.push_back(std::move(node));
+        }
+        numa_free_cpumask(mask);
+        return nodes;
+    }
+#endif
+    // Node ids may be sparse (e.g. node0 and node2), so list the entries
+    // rather than counting up until one is missing.
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() < 5 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream ifs(entry.path() / "cpulist");
+        if (!ifs) continue;
+        std::string line;
+        std::getline(ifs, line);
+        NumaNode node;
+        node.id = (unsigned)std::stoul(name.substr(4));
+        node.cpus = parse_cpulist(line);
+        nodes.push_back(std::move(node));
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return nodes;
+}
+#endif
+
+static NumaTopology detect_topology()
+{
+    NumaTopology topo;
+
+#if defined(__linux__)
+    // Only keep CPUs we are allowed to run on (taskset, cgroups).
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    for (auto& node : detect_nodes()) {
+        std::vector<unsigned> usable;
+        for (unsigned c : node.cpus) {
+            if (!haveMask || (c < CPU_SETSIZE && CPU_ISSET(c, &allowed))) usable.push_back(c);
+        }
+        if (usable.empty()) continue;
+        node.cpus = std::move(usable);
+        topo.nodes.push_back(std::move(node));
+    }
+#endif
+
+    if (topo.nodes.empty()) {
+        // Single node; an empty CPU list means "do not pin".
+        topo.nodes.emplace_back();
+    }
+    return topo;
+}
+
+const NumaTopology& numa_topology()
+{
+    static const NumaTopology topo = detect_topology();
+    return topo;
+}
+
+bool bind_thread_to_node(const NumaNode& node)
+{
+#if defined(__linux__)
+    if (node.cpus.empty()) return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned c : node.cpus) {
+        if (c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) return false;
+
+#if defined(NEUROZIP_HAVE_LIBNUMA)
+    if (numa_available() >= 0) numa_set_preferred((int)node.id);
+#endif
+    return true;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace neurozip
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace neurozip {
+
+struct NumaNode {
+    unsigned id = 0;            // kernel node number
+    std::vector<unsigned> cpus; // CPUs this process may run on
+};
+
+/// NUMA nodes this process can run on. Nodes without usable CPUs are
+/// dropped; machines without NUMA (or platforms we cannot query) report a
+/// single node with an empty CPU list.
+struct NumaTopology {
+    std::vector<NumaNode> nodes;
+
+    size_t node_count() const { return nodes.size(); }
+};
+
+/// Topology of the current machine, detected once (libnuma when built with
+/// NEUROZIP_HAVE_LIBNUMA, otherwise /sys/devices/system/node on Linux).
+const NumaTopology& numa_topology();
+
+/// Restrict the calling thread to the node's CPUs and, with libnuma, prefer
+/// allocating its memory there. Without libnuma, pages still land on the
+/// node through first touch once the thread runs there. Returns false if
+/// pinning is not supported.
+bool bind_thread_to_node(const NumaNode& node);
+
+} // namespace neurozip
@@ -17,6 +17,13 @@ RangeEncoder::RangeEncoder()
 {
 }
 
+RangeEncoder::RangeEncoder(uint32_t low, uint32_t high)
+    : low_(low),
+      high_(high),
+      out_()
+{
+}
+
 void RangeEncoder::output_byte(uint8_t b)
 {
     out_.push_back(b);
@@ -69,6 +76,21 @@ void RangeEncoder::finish()
     }
 }
 
+void RangeEncoder::finish_minimal()
+{
+    // Round low up to a multiple of 2^(32 - 8k) for the smallest k that
+    // stays within high; the decoder reads the missing low bytes as zero.
+    for (int k = 0; k <= 4; ++k) {
+        const uint64_t unit = 1ull << (32 - 8 * k);
+        const uint64_t value = ((uint64_t)low_ + unit - 1) / unit * unit;
+        if (value > high_) continue;
+        for (int i = 0; i < k; ++i) {
+            output_byte((uint8_t)(value >> (24 - 8 * i)));
+        }
+        return;
+    }
+}
+
 //
 // RangeDecoder
 //
@@ -86,6 +108,27 @@ RangeDecoder::RangeDecoder(const uint8_t* data, size_t size)
     }
 }
 
+RangeDecoder::RangeDecoder(
+    const uint8_t* data,
+    size_t size,
+    size_t streamPos,
+    uint32_t low,
+    uint32_t high
+)
+    : low_(low),
+      high_(high),
+      code_(0),
+      data_(data),
+      size_(size),
+      pos_(streamPos)
+{
+    // Every byte the encoder shifted out was consumed by the decoder's
+    // renormalization too, so the code register is the next 4 bytes.
+    for (int i = 0; i < 4; ++i) {
+        code_ = (code_ << 8) | read_byte();
+    }
+}
+
 uint8_t RangeDecoder::read_byte()
 {
     if (pos_ < size_) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -12,6 +13,10 @@ class RangeEncoder {
 public:
     RangeEncoder();
 
+    /// Continue a stream whose output so far is held elsewhere, from the
+    /// interval recorded by low() / high() before finish().
+    RangeEncoder(uint32_t low, uint32_t high);
+
     // Encode symbol with cumulative frequency 'cumFreq' and width 'freq'
     // where totalFreq = sum of all symbol frequencies.
     void encode_symbol(
@@ -23,8 +28,18 @@ public:
     // Finalize the stream (flush remaining state).
     void finish();
 
+    // Finalize with only the bytes needed to identify the final interval
+    // (0 to 4): the shortest prefix of a value in [low, high] once the
+    // decoder pads it with zeros. Such a stream cannot be continued.
+    void finish_minimal();
+
     const std::vector<uint8_t>& buffer() const { return out_; }
 
+    // Interval state between symbols. Together with buffer().size() this
+    // is enough for a RangeDecoder to resume at the same symbol boundary.
+    uint32_t low() const { return low_; }
+    uint32_t high() const { return high_; }
+
 private:
     uint32_t low_;     // low end of current interval
     uint32_t high_;    // high end of current interval
@@ -37,6 +52,16 @@ class RangeDecoder {
 public:
     RangeDecoder(const uint8_t* data, size_t size);
 
+    /// Resume decoding at a symbol boundary recorded from the encoder:
+    /// 'streamPos' encoder output bytes and interval [low, high].
+    RangeDecoder(
+        const uint8_t* data,
+        size_t size,
+        size_t streamPos,
+        uint32_t low,
+        uint32_t high
+    );
+
     /// Return the cumulative index in [0, totalFreq) corresponding
     /// to the current code position.
     uint32_t get_cum(uint32_t totalFreq) const;
@@ -0,0 +1,168 @@
+#include "result_cache.h"
+
+#include <cstring>
+
+namespace neurozip {
+
+// xxHash64 primes and round; four lanes over 32-byte stripes.
+static constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t P3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input)
+{
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+static inline uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+ContentHash content_hash(const uint8_t* data, size_t size)
+{
+    uint64_t v1 = P1 + P2, v2 = P2, v3 = 0, v4 = 0 - P1;
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+
+    for (; end - p >= 32; p += 32) {
+        v1 = round64(v1, read64(p));
+        v2 = round64(v2, read64(p + 8));
+        v3 = round64(v3, read64(p + 16));
+        v4 = round64(v4, read64(p + 24));
+    }
+
+    // Two different folds of the four lanes give the two halves.
+    uint64_t a = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18) + size;
+    uint64_t b = (v1 ^ rotl(v3, 29)) * P4 + (v2 ^ rotl(v4, 41)) * P5 + (size ^ P3);
+
+    for (; end - p >= 8; p += 8) {
+        uint64_t w = read64(p);
+        a = rotl(a ^ round64(0, w), 27) * P1 + P4;
+        b = rotl(b + w * P5, 29) * P3 ^ a;
+    }
+    for (; p < end; ++p) {
+        a = rotl(a ^ (*p * P5), 11) * P1;
+        b = rotl(b + (*p * P1), 17) * P2;
+    }
+
+    ContentHash h;
+    h.lo = avalanche(a);
+    h.hi = avalanche(b ^ h.lo);
+    return h;
+}
+
+ResultCacheKey result_cache_key(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    uint64_t variant
+) {
+    ResultCacheKey key;
+    key.content = content_hash(data, size);
+    key.size = size;
+    key.modelHash = model.model_hash();
+    key.modelId = model.model_id();
+    key.fixedPoint = model.fixed_point();
+    key.primedState = primed_state_tag(model);
+    key.variant = variant;
+    return key;
+}
+
+ResultCache::ResultCache(size_t capacityBytes)
+    : capacity_(capacityBytes)
+{
+}
+
+bool ResultCache::lookup(const ResultCacheKey& key, std::vector<uint8_t>& out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++counters_.misses;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    out = it->second->value;
+    ++counters_.hits;
+    return true;
+}
+
+void ResultCache::insert(const ResultCacheKey& key, const uint8_t* value, size_t size)
+{
+    const size_t charge = size + kEntryOverhead;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (charge > capacity_) return;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->value.size() + kEntryOverhead;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    evict_to(capacity_ - charge);
+
+    lru_.push_front({ key, std::vector<uint8_t>(value, value + size) });
+    index_[key] = lru_.begin();
+    bytes_ += charge;
+    ++counters_.insertions;
+}
+
+void ResultCache::evict_to(size_t capacity)
+{
+    while (bytes_ > capacity && !lru_.empty()) {
+        const Entry& last = lru_.back();
+        bytes_ -= last.value.size() + kEntryOverhead;
+        index_.erase(last.key);
+        lru_.pop_back();
+        ++counters_.evictions;
+    }
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void ResultCache::set_capacity(size_t capacityBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacityBytes;
+    evict_to(capacity_);
+}
+
+ResultCacheStats ResultCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResultCacheStats s = counters_;
+    s.entries = index_.size();
+    s.bytes = bytes_;
+    s.capacity = capacity_;
+    return s;
+}
+
+} // namespace neurozip
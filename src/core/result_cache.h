@@ -0,0 +1,120 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace neurozip {
+
+/// 128-bit non-cryptographic hash of 'data', at memory speed. Collisions
+/// between unrelated inputs are negligible, but inputs can be crafted to
+/// collide: do not share a ResultCache between mutually untrusted clients.
+struct ContentHash {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+};
+
+ContentHash content_hash(const uint8_t* data, size_t size);
+
+/// What a cached result was computed from. 'variant' tells apart results
+/// of the same input and model that differ in form (a bare stream, a .nzp
+/// image, a compact frame) or in output-changing options; settings that
+/// leave the output unchanged (threads, two-phase, pipelining) do not
+/// belong in it.
+struct ResultCacheKey {
+    ContentHash content;
+    uint64_t size = 0;
+    uint64_t modelHash = 0;
+    uint32_t modelId = 0;
+    bool fixedPoint = false;
+    uint64_t primedState = 0; // primed_state_tag()
+    uint64_t variant = 0;
+
+    bool operator==(const ResultCacheKey& o) const
+    {
+        return content.lo == o.content.lo && content.hi == o.content.hi && size == o.size &&
+               modelHash == o.modelHash && modelId == o.modelId &&
+               fixedPoint == o.fixedPoint && primedState == o.primedState && variant == o.variant;
+    }
+};
+
+/// Key for 'data' compressed with 'model'.
+ResultCacheKey result_cache_key(
+    const ICompressionModel& model,
+    const uint8_t* data,
+    size_t size,
+    uint64_t variant
+);
+
+/// Variant of the bare compress_buffer stream.
+constexpr uint64_t RESULT_CACHE_STREAM = 0;
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;    // charged bytes, values plus per-entry overhead
+    uint64_t capacity = 0; // byte budget
+};
+
+/// Bounded map from ResultCacheKey to compressed bytes with least recently
+/// used eviction. Each entry is charged its value size plus a fixed
+/// overhead against the byte budget; values larger than the whole budget
+/// are not stored. Thread-safe; the hash is computed outside the lock.
+class ResultCache {
+public:
+    /// Bytes charged per entry on top of its value (key, list and map
+    /// nodes).
+    static constexpr size_t kEntryOverhead = 128;
+
+    explicit ResultCache(size_t capacityBytes);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /// Copy the value for 'key' to 'out' and mark it most recently used.
+    bool lookup(const ResultCacheKey& key, std::vector<uint8_t>& out);
+
+    /// Store (or replace) the value for 'key', evicting the least recently
+    /// used entries to stay within the budget.
+    void insert(const ResultCacheKey& key, const uint8_t* value, size_t size);
+
+    /// Drop all entries (counters are kept).
+    void clear();
+
+    /// Change the budget, evicting as needed.
+    void set_capacity(size_t capacityBytes);
+
+    ResultCacheStats stats() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const ResultCacheKey& k) const
+        {
+            return (size_t)(k.content.lo ^ (k.modelHash * 0x9E3779B97F4A7C15ull) ^ k.variant);
+        }
+    };
+    struct Entry {
+        ResultCacheKey key;
+        std::vector<uint8_t> value;
+    };
+    using List = std::list<Entry>;
+
+    void evict_to(size_t capacity);
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    size_t bytes_ = 0;
+    List lru_; // most recently used first
+    std::unordered_map<ResultCacheKey, List::iterator, KeyHash> index_;
+    ResultCacheStats counters_;
+};
+
+} // namespace neurozip
@@ -0,0 +1,100 @@
+#include "segments.h"
+
+namespace neurozip {
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+void build_segmented_payload(
+    const std::vector<std::vector<uint8_t>>& streams,
+    const std::vector<uint64_t>& originalSizes,
+    std::vector<uint8_t>& payload
+) {
+    size_t total = 4 + streams.size() * 16;
+    for (const auto& s : streams) total += s.size();
+
+    payload.clear();
+    payload.reserve(total);
+    put_u32(payload, (uint32_t)streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        put_u64(payload, originalSizes[i]);
+        put_u64(payload, streams[i].size());
+    }
+    for (const auto& s : streams) {
+        payload.insert(payload.end(), s.begin(), s.end());
+    }
+}
+
+bool parse_segment_table(
+    const uint8_t* payload,
+    size_t payloadSize,
+    SegmentTable& outTable
+) {
+    outTable = SegmentTable();
+    if (payloadSize < 4) return false;
+
+    uint32_t count = get_u32(payload);
+    if ((uint64_t)count * 16 > payloadSize - 4) return false;
+
+    uint64_t streamBytes = 0;
+    const uint8_t* p = payload + 4;
+    for (uint32_t i = 0; i < count; ++i, p += 16) {
+        outTable.originalSizes.push_back(get_u64(p));
+        outTable.streamSizes.push_back(get_u64(p + 8));
+        streamBytes += outTable.streamSizes.back();
+    }
+
+    outTable.dataOffset = 4 + (size_t)count * 16;
+    return streamBytes <= payloadSize - outTable.dataOffset;
+}
+
+bool decompress_segments(
+    const ICompressionModel& model,
+    const uint8_t* payload,
+    size_t payloadSize,
+    const SegmentTable& table,
+    std::vector<uint8_t>& outData
+) {
+    uint64_t total = 0;
+    for (uint64_t n : table.originalSizes) total += n;
+
+    outData.clear();
+    outData.reserve((size_t)total);
+
+    size_t offset = table.dataOffset;
+    std::vector<uint8_t> segment;
+    for (size_t i = 0; i < table.count(); ++i) {
+        size_t streamSize = (size_t)table.streamSizes[i];
+        if (offset + streamSize > payloadSize) return false;
+        if (!decompress_buffer(model, payload + offset, streamSize,
+                               (size_t)table.originalSizes[i], segment)) {
+            return false;
+        }
+        outData.insert(outData.end(), segment.begin(), segment.end());
+        offset += streamSize;
+    }
+    return true;
+}
+
+} // namespace neurozip
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+/// Layout of a segmented payload (NZP_FLAG_SEGMENTED): the input was split
+/// into consecutive segments that were coded independently, each starting
+/// from a fresh model context, so they can be coded and decoded in
+/// parallel. Little-endian:
+///
+///   u32 count
+///   count x { u64 originalSize, u64 streamSize }
+///   range coder streams, back to back
+struct SegmentTable {
+    std::vector<uint64_t> originalSizes;
+    std::vector<uint64_t> streamSizes;
+    size_t dataOffset = 0; // payload offset of the first stream
+
+    size_t count() const { return originalSizes.size(); }
+};
+
+/// Build a segmented payload from independently coded streams.
+void build_segmented_payload(
+    const std::vector<std::vector<uint8_t>>& streams,
+    const std::vector<uint64_t>& originalSizes,
+    std::vector<uint8_t>& payload
+);
+
+/// Parse the segment table; checks that the streams fit in the payload.
+bool parse_segment_table(
+    const uint8_t* payload,
+    size_t payloadSize,
+    SegmentTable& outTable
+);
+
+/// Decode all segments in order into 'outData'.
+bool decompress_segments(
+    const ICompressionModel& model,
+    const uint8_t* payload,
+    size_t payloadSize,
+    const SegmentTable& table,
+    std::vector<uint8_t>& outData
+);
+
+} // namespace neurozip
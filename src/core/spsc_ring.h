@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace neurozip {
+
+/// Bounded lock-free queue for exactly one producer thread and one
+/// consumer thread. The capacity is rounded up to a power of two.
+///
+/// Each side keeps a cached copy of the other side's index and only
+/// re-reads the shared atomic when the cache says the ring is full (or
+/// empty), so in steady state a push or pop touches no shared cache line
+/// except its own index.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+    {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    /// Producer: false if the ring is full.
+    bool try_push(const T& value)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == slots_.size()) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == slots_.size()) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Producer: wait (yielding) until there is room.
+    void push(const T& value)
+    {
+        while (!try_push(value)) std::this_thread::yield();
+    }
+
+    /// Consumer: false if the ring is empty.
+    bool try_pop(T& out)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return false;
+        }
+        out = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: wait (yielding) until an item is available.
+    void pop(T& out)
+    {
+        while (!try_pop(out)) std::this_thread::yield();
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    // Consumer side.
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t tailCache_ = 0;
+
+    // Producer side.
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t headCache_ = 0;
+};
+
+} // namespace neurozip
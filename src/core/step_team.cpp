@@ -0,0 +1,135 @@
+#include "step_team.h"
+
+#include "trace.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace neurozip {
+
+// Waiters spin with a pause hint first, then keep polling but yield the
+// CPU between polls (which costs nothing on an idle core and lets the
+// other members run on an oversubscribed one). Helpers go to sleep once
+// the team has been idle for a few thousand polls.
+static constexpr unsigned kSpinIterations = 256;
+static constexpr unsigned kYieldIterations = 4096;
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+StepTeam::StepTeam(unsigned threads, bool pin)
+{
+    threads = std::max(1u, threads);
+
+    // One CPU per member, in node order; member 0 (the caller) is never
+    // pinned, so helpers start at the second CPU. A node with an empty CPU
+    // list leaves the helper unpinned.
+    std::vector<NumaNode> cpus;
+    if (pin) {
+        for (const auto& node : numa_topology().nodes) {
+            for (unsigned c : node.cpus) {
+                NumaNode one;
+                one.id = node.id;
+                one.cpus.push_back(c);
+                cpus.push_back(one);
+            }
+        }
+    }
+    for (unsigned m = 1; m < threads; ++m) {
+        NumaNode cpu = cpus.empty() ? NumaNode() : cpus[m % cpus.size()];
+        helpers_.emplace_back(&StepTeam::helper_main, this, m, cpu);
+    }
+}
+
+StepTeam::~StepTeam()
+{
+    stopping_.store(true);
+    generation_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    wake_.notify_all();
+    for (auto& t : helpers_) t.join();
+}
+
+void StepTeam::share(size_t n, unsigned members, unsigned member, size_t align, size_t& lo, size_t& hi)
+{
+    align = std::max<size_t>(align, 1);
+    size_t per = (n + members - 1) / std::max(members, 1u);
+    per = (per + align - 1) / align * align;
+    lo = std::min(n, (size_t)member * per);
+    hi = std::min(n, lo + per);
+}
+
+void StepTeam::helper_main(unsigned member, NumaNode cpu)
+{
+    bind_thread_to_node(cpu);
+    trace_set_thread_name("step " + std::to_string(member));
+
+    uint64_t seen = 0;
+    for (;;) {
+        seen = wait_for_step(seen);
+        if (stopping_.load(std::memory_order_relaxed)) return;
+        (*job_)(member);
+        pending_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+uint64_t StepTeam::wait_for_step(uint64_t seen)
+{
+    for (unsigned i = 0; i < kSpinIterations + kYieldIterations; ++i) {
+        uint64_t g = generation_.load(std::memory_order_acquire);
+        if (g != seen) return g;
+        if (i < kSpinIterations) cpu_relax();
+        else std::this_thread::yield();
+    }
+
+    // run() checks sleepers_ after bumping the generation; both are
+    // sequentially consistent, so either it sees us here or we see its
+    // step in the predicate.
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleepers_.fetch_add(1);
+    wake_.wait(lock, [&] { return generation_.load() != seen; });
+    sleepers_.fetch_sub(1);
+    return generation_.load(std::memory_order_acquire);
+}
+
+void StepTeam::run(const std::function<void(unsigned member)>& fn)
+{
+    std::unique_lock<std::mutex> turn(runMutex_, std::try_to_lock);
+    if (helpers_.empty() || !turn.owns_lock()) {
+        // Busy with another stream: the shares are independent, so doing
+        // them all here gives the same result.
+        for (unsigned m = 0; m < size(); ++m) fn(m);
+        return;
+    }
+
+    job_ = &fn;
+    pending_.store((unsigned)helpers_.size(), std::memory_order_relaxed);
+    generation_.fetch_add(1);
+    if (sleepers_.load() != 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        wake_.notify_all();
+    }
+
+    fn(0);
+
+    for (unsigned i = 0; pending_.load(std::memory_order_acquire) != 0; ++i) {
+        if (i < kSpinIterations) cpu_relax();
+        else std::this_thread::yield();
+    }
+    job_ = nullptr;
+}
+
+} // namespace neurozip
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "numa.h"
+
+namespace neurozip {
+
+/// Small team of threads that split the work of one inference step, for
+/// decoding a single stream with a large model at low latency.
+///
+/// Unlike WorkerPool, which hands out independent ranges and sleeps in
+/// between, a step is only a few microseconds of work: helpers spin on a
+/// shared generation counter between steps (and only fall back to sleeping
+/// after a while without work), and the caller spins until they are done.
+/// Each helper is pinned to one CPU, so the rows of the weight matrices a
+/// member always works on stay in that core's cache from step to step.
+///
+/// Members must write disjoint outputs. If another thread is already
+/// running a step on the team, run() executes every member's share on the
+/// calling thread instead, so sharing one team between streams is safe.
+class StepTeam {
+public:
+    /// 'threads' members including the calling thread (at least 1).
+    explicit StepTeam(unsigned threads, bool pin = true);
+    ~StepTeam();
+
+    StepTeam(const StepTeam&) = delete;
+    StepTeam& operator=(const StepTeam&) = delete;
+
+    unsigned size() const { return (unsigned)helpers_.size() + 1; }
+
+    /// Run fn(member) for member = 0..size()-1; the caller is member 0.
+    /// Returns once every member is done, with their writes visible.
+    void run(const std::function<void(unsigned member)>& fn);
+
+    /// Contiguous share [lo, hi) of n items for 'member', in multiples of
+    /// 'align' items (the last share takes the remainder; trailing members
+    /// may get an empty share).
+    static void share(size_t n, unsigned members, unsigned member, size_t align, size_t& lo, size_t& hi);
+
+private:
+    void helper_main(unsigned member, NumaNode cpu);
+    uint64_t wait_for_step(uint64_t seen);
+
+    std::vector<std::thread> helpers_;
+    std::mutex runMutex_;                       // one step at a time
+    const std::function<void(unsigned)>* job_ = nullptr;
+
+    static constexpr size_t kCacheLine = 64;
+    alignas(kCacheLine) std::atomic<uint64_t> generation_{ 0 };
+    alignas(kCacheLine) std::atomic<unsigned> pending_{ 0 };
+    alignas(kCacheLine) std::atomic<unsigned> sleepers_{ 0 };
+    std::atomic<bool> stopping_{ false };
+
+    // Idle helpers block here.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+};
+
+} // namespace neurozip
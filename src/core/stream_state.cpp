@@ -0,0 +1,119 @@
+#include "stream_state.h"
+
+#include <cstring>
+
+namespace neurozip {
+
+void StreamState::capture(const ModelContext& ctx, size_t n)
+{
+    stateSize = (uint32_t)n;
+    h.assign(ctx.h.begin(), ctx.h.begin() + n);
+    c.assign(ctx.c.begin(), ctx.c.begin() + n);
+}
+
+void StreamState::restore(ModelContext& ctx) const
+{
+    // A state wider than the model's context came from another model.
+    if (h.size() > ctx.h.size() || c.size() > ctx.c.size()) return;
+    std::copy(h.begin(), h.end(), ctx.h.begin());
+    std::copy(c.begin(), c.end(), ctx.c.begin());
+}
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// Trailer layout (little-endian):
+// u64 bytePos, u64 streamPos, u32 low, u32 high, u8 prevByte,
+// u32 stateSize, stateSize x f32 h, stateSize x f32 c, u64 trailer length
+static constexpr size_t kFixedBytes = 29;
+
+size_t stream_state_bytes(uint32_t stateSize)
+{
+    return kFixedBytes + 8 * (size_t)stateSize + 8;
+}
+
+void append_stream_state(
+    const StreamState& state,
+    std::vector<uint8_t>& payload
+) {
+    size_t start = payload.size();
+
+    put_u64(payload, state.bytePos);
+    put_u64(payload, state.streamPos);
+    put_u32(payload, state.low);
+    put_u32(payload, state.high);
+    payload.push_back(state.prevByte);
+    put_u32(payload, state.stateSize);
+    for (const auto* v : { &state.h, &state.c }) {
+        for (float f : *v) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            put_u32(payload, bits);
+        }
+    }
+
+    put_u64(payload, (uint64_t)(payload.size() - start));
+}
+
+bool split_stream_state(
+    const uint8_t* payload,
+    size_t payloadSize,
+    size_t& outRestSize,
+    StreamState& outState,
+    uint64_t payloadOffset
+) {
+    if (payloadSize < 8) return false;
+    uint64_t size = get_u64(payload + payloadSize - 8);
+    if (size < kFixedBytes || size > payloadSize - 8) return false;
+
+    size_t start = payloadSize - 8 - (size_t)size;
+    const uint8_t* p = payload + start;
+
+    outState.bytePos = get_u64(p);
+    outState.streamPos = get_u64(p + 8);
+    outState.low = get_u32(p + 16);
+    outState.high = get_u32(p + 20);
+    outState.prevByte = p[24];
+    outState.stateSize = get_u32(p + 25);
+    if (outState.stateSize > kMaxHiddenSize || size != kFixedBytes + 8 * (uint64_t)outState.stateSize) {
+        return false;
+    }
+    // The finish() flush (4 bytes) follows the unflushed stream.
+    if (outState.streamPos + 4 > payloadOffset + start) return false;
+    p += kFixedBytes;
+
+    for (auto* v : { &outState.h, &outState.c }) {
+        v->resize(outState.stateSize);
+        for (float& f : *v) {
+            uint32_t bits = get_u32(p);
+            std::memcpy(&f, &bits, sizeof(f));
+            p += 4;
+        }
+    }
+
+    outRestSize = (size_t)payloadOffset + start;
+    return true;
+}
+
+} // namespace neurozip
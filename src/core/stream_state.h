@@ -0,0 +1,56 @@
+#pragma once
+
+#include "model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+
+/// Encoder state after the last coded byte, before the range coder's final
+/// flush: enough to continue the stream as if the appended data had been
+/// part of the original input. The coder never defers bytes (there is no
+/// carry propagation), so the interval and the number of bytes already
+/// emitted are its whole state.
+struct StreamState {
+    uint64_t bytePos = 0;    // input bytes coded so far
+    uint64_t streamPos = 0;  // coder output bytes, excluding the flush
+    uint32_t low = 0;        // range coder interval
+    uint32_t high = 0;
+    uint8_t  prevByte = 0;   // input byte of the next model step
+    uint32_t stateSize = 0;  // floats per vector
+    std::vector<float> h;    // exact model state (bit-for-bit)
+    std::vector<float> c;
+
+    /// Copy the first stateSize values of ctx.h / ctx.c.
+    void capture(const ModelContext& ctx, size_t n);
+
+    /// Write the saved values back into ctx.
+    void restore(ModelContext& ctx) const;
+};
+
+/// Append the state to 'payload' followed by its u64 length, like
+/// append_checkpoint_index; it goes after any checkpoint index.
+void append_stream_state(
+    const StreamState& state,
+    std::vector<uint8_t>& payload
+);
+
+/// Split off a trailer written by append_stream_state. 'outRestSize' is
+/// the payload size without it. Returns false if the trailer is malformed.
+/// As with split_checkpoint_index, 'payload' may be the tail of a payload
+/// starting 'payloadOffset' bytes in.
+bool split_stream_state(
+    const uint8_t* payload,
+    size_t payloadSize,
+    size_t& outRestSize,
+    StreamState& outState,
+    uint64_t payloadOffset = 0
+);
+
+/// Size in bytes of a trailer for 'stateSize' floats per vector (length
+/// field included).
+size_t stream_state_bytes(uint32_t stateSize);
+
+} // namespace neurozip
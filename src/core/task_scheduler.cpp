@@ -0,0 +1,108 @@
+#include "task_scheduler.h"
+
+#include "trace.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <numeric>
+
+namespace neurozip {
+
+namespace {
+
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<size_t> items; // task indices, largest first
+};
+
+} // namespace
+
+void run_work_stealing(WorkerPool& pool, const std::vector<ScheduledTask>& tasks)
+{
+    if (tasks.empty()) return;
+
+    std::vector<size_t> order(tasks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return tasks[a].cost > tasks[b].cost;
+    });
+
+    const size_t workers = pool.size();
+    std::vector<std::unique_ptr<TaskQueue>> queues(workers);
+    for (auto& q : queues) q = std::make_unique<TaskQueue>();
+    for (size_t i = 0; i < order.size(); ++i) {
+        queues[i % workers]->items.push_back(order[i]);
+    }
+
+    auto pop_own = [&](unsigned worker, size_t& task) {
+        TaskQueue& q = *queues[worker];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty()) return false;
+        task = q.items.front();
+        q.items.pop_front();
+        return true;
+    };
+
+    auto steal = [&](unsigned worker, size_t& task) {
+        for (;;) {
+            // Find the victim holding the largest remaining task.
+            size_t victim = workers;
+            uint64_t best = 0;
+            for (size_t v = 0; v < workers; ++v) {
+                if (v == worker) continue;
+                std::lock_guard<std::mutex> lock(queues[v]->mutex);
+                if (queues[v]->items.empty()) continue;
+                uint64_t cost = tasks[queues[v]->items.front()].cost;
+                if (victim == workers || cost > best) {
+                    victim = v;
+                    best = cost;
+                }
+            }
+            if (victim == workers) return false;
+
+            std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+            if (queues[victim]->items.empty()) continue; // lost the race, rescan
+            task = queues[victim]->items.front();
+            queues[victim]->items.pop_front();
+            return true;
+        }
+    };
+
+    // call_once, not a flag: a thief must not run a task while its owner
+    // is still inside that task's prepare().
+    std::unique_ptr<std::once_flag[]> prepared(new std::once_flag[tasks.size()]);
+
+    auto prepare = [&](size_t task) {
+        if (tasks[task].prepare) {
+            std::call_once(prepared[task], [&] {
+                TraceSpan span("prepare", "sched");
+                tasks[task].prepare();
+            });
+        }
+    };
+
+    // The task this worker will pop next, if any (it may still be stolen).
+    auto peek_own = [&](unsigned worker, size_t& task) {
+        TaskQueue& q = *queues[worker];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty()) return false;
+        task = q.items.front();
+        return true;
+    };
+
+    // One range per worker: each runs its own queue, then steals.
+    pool.parallel_for(workers, 1, [&](unsigned worker, size_t, size_t) {
+        size_t task, next;
+        while (pop_own(worker, task) || steal(worker, task)) {
+            prepare(task);
+            if (peek_own(worker, next)) prepare(next);
+            TraceSpan span("task", "sched", tasks[task].cost);
+            tasks[task].run(worker);
+        }
+    });
+}
+
+} // namespace neurozip
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace neurozip {
+
+class WorkerPool;
+
+/// One unit of batch work. 'cost' orders the schedule (e.g. input bytes);
+/// run() receives the index of the pool worker executing it, for
+/// WorkerPool::local_model. The optional prepare() starts work the task
+/// will wait on (such as an asynchronous read): a worker calls it for the
+/// next task in its queue before running the current one, so that I/O
+/// overlaps inference. Each task is prepared exactly once, before run().
+struct ScheduledTask {
+    uint64_t cost = 0;
+    std::function<void(unsigned worker)> run;
+    std::function<void()> prepare;
+};
+
+/// Run every task on the pool's workers, longest first, and return when
+/// all have finished. Tasks are dealt by decreasing cost into per-worker
+/// queues; a worker whose queue runs dry steals the largest task left in
+/// any other queue, so no core idles while work remains.
+void run_work_stealing(WorkerPool& pool, const std::vector<ScheduledTask>& tasks);
+
+} // namespace neurozip
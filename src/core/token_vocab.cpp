@@ -0,0 +1,88 @@
+#include "token_vocab.h"
+
+#include <algorithm>
+
+namespace neurozip {
+
+bool TokenVocab::build(const std::vector<std::string>& tokens)
+{
+    if (256 + tokens.size() > kMaxTokenVocab) return false;
+
+    bytes_.clear();
+    offsets_.assign(1, 0);
+    nodes_.assign(1, Node());
+    std::fill(std::begin(rootNext_), std::end(rootNext_), 0u);
+
+    for (uint32_t b = 0; b < 256; ++b) {
+        bytes_.push_back((uint8_t)b);
+        offsets_.push_back((uint32_t)bytes_.size());
+    }
+
+    for (const auto& t : tokens) {
+        if (t.size() < 2 || t.size() > kMaxTokenBytes) return false;
+        const uint32_t id = (uint32_t)size();
+
+        uint32_t node = 0;
+        for (size_t i = 0; i < t.size(); ++i) {
+            const uint8_t b = (uint8_t)t[i];
+            uint32_t child = 0;
+            if (node == 0) {
+                child = rootNext_[b];
+            } else {
+                auto& next = nodes_[node].next;
+                auto it = std::lower_bound(next.begin(), next.end(), std::make_pair(b, 0u));
+                if (it != next.end() && it->first == b) child = it->second;
+            }
+            if (child == 0) {
+                child = (uint32_t)nodes_.size();
+                nodes_.emplace_back();
+                if (node == 0) {
+                    rootNext_[b] = child;
+                } else {
+                    auto& next = nodes_[node].next;
+                    next.insert(std::lower_bound(next.begin(), next.end(), std::make_pair(b, 0u)),
+                                std::make_pair(b, child));
+                }
+            }
+            node = child;
+        }
+        if (nodes_[node].token != kNoToken) return false; // duplicate
+        nodes_[node].token = id;
+
+        bytes_.insert(bytes_.end(), t.begin(), t.end());
+        offsets_.push_back((uint32_t)bytes_.size());
+    }
+    return true;
+}
+
+uint32_t TokenVocab::match(const uint8_t* data, size_t size, size_t& len) const
+{
+    uint32_t id = data[0];
+    len = 1;
+
+    uint32_t node = rootNext_[data[0]];
+    for (size_t i = 1; node != 0 && i < size;) {
+        const auto& next = nodes_[node].next;
+        auto it = std::lower_bound(next.begin(), next.end(), std::make_pair(data[i], 0u));
+        if (it == next.end() || it->first != data[i]) break;
+        node = it->second;
+        ++i;
+        if (nodes_[node].token != kNoToken) {
+            id = nodes_[node].token;
+            len = i;
+        }
+    }
+    return id;
+}
+
+void TokenVocab::tokenize(const uint8_t* data, size_t size, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    for (size_t pos = 0; pos < size;) {
+        size_t len = 0;
+        out.push_back(match(data + pos, size - pos, len));
+        pos += len;
+    }
+}
+
+} // namespace neurozip
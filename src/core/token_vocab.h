@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace neurozip {
+
+// Multi-byte token vocabularies: ids 0..255 are the single bytes, so any
+// input tokenizes (bytes no longer token covers are coded as themselves),
+// and ids 256.. are the multi-byte tokens stored in the model file.
+constexpr uint32_t kMaxTokenVocab = 8192; // keeps coder totals below 2^16
+constexpr uint32_t kMaxTokenBytes = 32;
+
+class TokenVocab {
+public:
+    /// Byte tokens plus 'tokens' as ids 256.. in order. False if a token
+    /// is shorter than 2 or longer than kMaxTokenBytes bytes, appears
+    /// twice, or the vocabulary would exceed kMaxTokenVocab.
+    bool build(const std::vector<std::string>& tokens);
+
+    /// Number of ids (256 + multi-byte tokens).
+    size_t size() const { return offsets_.size() - 1; }
+
+    /// Bytes of token 'id'.
+    const uint8_t* token(uint32_t id, size_t& len) const
+    {
+        len = offsets_[id + 1] - offsets_[id];
+        return bytes_.data() + offsets_[id];
+    }
+
+    /// Longest token that is a prefix of data[0, size) (size > 0); its
+    /// length goes to 'len'. Greedy and deterministic: the decoder never
+    /// tokenizes, so any choice round-trips, but encoders should agree.
+    uint32_t match(const uint8_t* data, size_t size, size_t& len) const;
+
+    /// Greedy longest-match tokenization of data[0, size).
+    void tokenize(const uint8_t* data, size_t size, std::vector<uint32_t>& out) const;
+
+private:
+    static constexpr uint32_t kNoToken = 0xFFFFFFFFu;
+
+    // Trie over the multi-byte tokens; node 0 is the root, whose children
+    // are looked up through rootNext_. Edges are sorted by byte.
+    struct Node {
+        uint32_t token = kNoToken;
+        std::vector<std::pair<uint8_t, uint32_t>> next;
+    };
+
+    std::vector<uint8_t> bytes_;
+    std::vector<uint32_t> offsets_ = { 0 };
+    std::vector<Node> nodes_;
+    uint32_t rootNext_[256] = {};
+};
+
+} // namespace neurozip
@@ -0,0 +1,216 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace neurozip {
+
+namespace trace_detail {
+std::atomic<bool> enabled{ false };
+}
+
+namespace {
+
+constexpr size_t kRingCapacity = 1u << 15; // spans kept per thread
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t start;
+    uint64_t end;
+    uint64_t bytes;
+};
+
+struct ThreadTrace {
+    std::mutex mutex;             // only contended by the writer
+    uint32_t tid = 0;
+    std::string name;
+    uint64_t session = 0;         // spans belong to this trace_start
+    std::vector<TraceEvent> ring; // allocated on first span
+    uint64_t recorded = 0;        // spans since session start
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTrace>> threads;
+    uint32_t nextTid = 1;
+    std::atomic<uint64_t> session{ 0 };
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+TraceRegistry& registry()
+{
+    static TraceRegistry r;
+    return r;
+}
+
+std::shared_ptr<ThreadTrace>& local_slot()
+{
+    thread_local std::shared_ptr<ThreadTrace> local;
+    return local;
+}
+
+// Name given before the thread's first span.
+std::string& local_name()
+{
+    thread_local std::string name;
+    return name;
+}
+
+// Threads join the registry on their first span, so threads that never
+// trace (every pool worker while tracing is off) cost nothing.
+ThreadTrace& local_trace()
+{
+    std::shared_ptr<ThreadTrace>& local = local_slot();
+    if (!local) {
+        local = std::make_shared<ThreadTrace>();
+        local->name = local_name();
+        TraceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        local->tid = r.nextTid++;
+        r.threads.push_back(local);
+    }
+    return *local;
+}
+
+void append_json_string(std::string& out, const std::string& s)
+{
+    out += '"';
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if ((unsigned char)ch < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)ch);
+            out += buf;
+        } else {
+            out += ch;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+uint64_t trace_now_ns()
+{
+    auto d = std::chrono::steady_clock::now() - registry().epoch;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void trace_start()
+{
+    TraceRegistry& r = registry();
+    {
+        // Drop the buffers of threads that have exited; the rest reset
+        // themselves on their next span.
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::vector<std::shared_ptr<ThreadTrace>> live;
+        for (auto& t : r.threads) {
+            if (t.use_count() > 1) live.push_back(t);
+        }
+        r.threads.swap(live);
+        r.session.fetch_add(1);
+    }
+    trace_detail::enabled.store(true);
+}
+
+void trace_stop()
+{
+    trace_detail::enabled.store(false);
+}
+
+void trace_set_thread_name(const std::string& name)
+{
+    local_name() = name;
+    if (ThreadTrace* t = local_slot().get()) {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->name = name;
+    }
+}
+
+void trace_record(
+    const char* name,
+    const char* category,
+    uint64_t startNs,
+    uint64_t endNs,
+    uint64_t bytes
+) {
+    ThreadTrace& t = local_trace();
+    const uint64_t session = registry().session.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (t.session != session) {
+        t.session = session;
+        t.recorded = 0;
+    }
+    if (t.ring.empty()) t.ring.resize(kRingCapacity);
+    t.ring[t.recorded % kRingCapacity] = { name, category, startNs, endNs, bytes };
+    ++t.recorded;
+}
+
+bool write_chrome_trace(const std::string& path)
+{
+    TraceRegistry& r = registry();
+    std::vector<std::shared_ptr<ThreadTrace>> threads;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        threads = r.threads;
+    }
+    const uint64_t session = r.session.load();
+
+    std::string out = "{\"traceEvents\":[\n";
+    bool first = true;
+    uint64_t dropped = 0;
+    char buf[160];
+
+    for (const auto& tp : threads) {
+        ThreadTrace& t = *tp;
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if (t.session != session || t.recorded == 0) continue;
+
+        std::string name = t.name.empty() ? "thread " + std::to_string(t.tid) : t.name;
+        if (!first) out += ",\n";
+        first = false;
+        std::snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":",
+                      t.tid);
+        out += buf;
+        append_json_string(out, name);
+        out += "}}";
+
+        // Oldest first; a full ring has overwritten the earliest spans.
+        uint64_t count = std::min<uint64_t>(t.recorded, kRingCapacity);
+        dropped += t.recorded - count;
+        for (uint64_t k = t.recorded - count; k < t.recorded; ++k) {
+            const TraceEvent& e = t.ring[k % kRingCapacity];
+            out += ",\n{\"ph\":\"X\",\"pid\":1,";
+            std::snprintf(buf, sizeof(buf), "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                          t.tid, e.start / 1000.0, (e.end - e.start) / 1000.0);
+            out += buf;
+            append_json_string(out, e.name);
+            out += ",\"cat\":";
+            append_json_string(out, e.category);
+            if (e.bytes) {
+                std::snprintf(buf, sizeof(buf), ",\"args\":{\"bytes\":%llu}", (unsigned long long)e.bytes);
+                out += buf;
+            }
+            out += "}";
+        }
+    }
+    std::snprintf(buf, sizeof(buf), "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":%llu}}\n",
+                  (unsigned long long)dropped);
+    out += buf;
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) return false;
+    ofs.write(out.data(), (std::streamsize)out.size());
+    return (bool)ofs;
+}
+
+} // namespace neurozip
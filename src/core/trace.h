@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace neurozip {
+
+/// Timeline tracing of library work, exported as Chrome trace-event JSON
+/// (chrome://tracing, Perfetto).
+///
+/// Each thread records complete spans into its own fixed-size ring buffer
+/// (the oldest spans are overwritten when it fills), so recording never
+/// contends with other threads. While tracing is off, a span costs one
+/// relaxed atomic load. Span names and categories must be string literals
+/// (or otherwise outlive the trace).
+namespace trace_detail {
+extern std::atomic<bool> enabled;
+}
+
+inline bool trace_enabled()
+{
+    return trace_detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Start recording (clears spans from an earlier session).
+void trace_start();
+
+/// Stop recording; recorded spans are kept until trace_start/write.
+void trace_stop();
+
+/// Write everything recorded so far as a Chrome trace-event JSON file.
+/// Call while no thread is recording (e.g. after trace_stop).
+bool write_chrome_trace(const std::string& path);
+
+/// Name shown for the calling thread's track (default "thread <n>").
+void trace_set_thread_name(const std::string& name);
+
+/// Monotonic nanoseconds on the trace clock.
+uint64_t trace_now_ns();
+
+/// Record a span measured elsewhere, e.g. an asynchronous I/O from
+/// submission to completion, on the calling thread's track.
+void trace_record(
+    const char* name,
+    const char* category,
+    uint64_t startNs,
+    uint64_t endNs,
+    uint64_t bytes = 0
+);
+
+/// Records [construction, destruction) as one span if tracing was on at
+/// construction. 'bytes' (optional) is shown as an argument.
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category, uint64_t bytes = 0)
+    {
+        if (trace_enabled()) {
+            name_ = name;
+            category_ = category;
+            bytes_ = bytes;
+            start_ = trace_now_ns();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (name_) trace_record(name_, category_, start_, trace_now_ns(), bytes_);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_ = nullptr;
+    const char* category_ = nullptr;
+    uint64_t bytes_ = 0;
+    uint64_t start_ = 0;
+};
+
+} // namespace neurozip
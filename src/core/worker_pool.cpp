@@ -0,0 +1,160 @@
+#include "worker_pool.h"
+
+#include "model_interface.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace neurozip {
+
+static NumaTopology single_node()
+{
+    NumaTopology topo;
+    topo.nodes.emplace_back();
+    return topo;
+}
+
+WorkerPool::WorkerPool(unsigned threads, bool numaAware)
+    : topology_(numaAware ? numa_topology() : single_node())
+{
+    if (threads == 0) {
+        size_t cpus = 0;
+        for (const auto& node : topology_.nodes) cpus += node.cpus.size();
+        threads = cpus ? (unsigned)cpus : std::thread::hardware_concurrency();
+    }
+    start(threads);
+}
+
+WorkerPool::WorkerPool(unsigned threads, const NumaTopology& topology)
+    : topology_(topology)
+{
+    if (topology_.nodes.empty()) topology_ = single_node();
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    start(threads);
+}
+
+void WorkerPool::start(unsigned threads)
+{
+    threads = std::max(1u, threads);
+
+    // Contiguous groups per node: worker w runs on node w * nodes / threads.
+    size_t nodes = topology_.node_count();
+    workerNode_.resize(threads);
+    for (unsigned w = 0; w < threads; ++w) {
+        workerNode_[w] = (unsigned)((size_t)w * nodes / threads);
+    }
+
+    rangeLo_.assign(threads, 0);
+    rangeHi_.assign(threads, 0);
+    for (unsigned w = 0; w < threads; ++w) {
+        workers_.emplace_back(&WorkerPool::worker_main, this, w);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void WorkerPool::worker_main(unsigned index)
+{
+    bind_thread_to_node(topology_.nodes[workerNode_[index]]);
+    trace_set_thread_name("worker " + std::to_string(index));
+
+    uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(unsigned, size_t, size_t)>* job;
+        size_t lo, hi;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            job = job_;
+            lo = rangeLo_[index];
+            hi = rangeHi_[index];
+        }
+        if (lo == hi) continue;
+
+        {
+            TraceSpan span("parallel_for", "pool", hi - lo);
+            (*job)(index, lo, hi);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--remaining_ == 0) done_.notify_one();
+    }
+}
+
+void WorkerPool::parallel_for(
+    size_t n,
+    size_t grain,
+    const std::function<void(unsigned worker, size_t lo, size_t hi)>& fn
+) {
+    if (n == 0) return;
+    std::lock_guard<std::mutex> submit(submitMutex_);
+
+    size_t threads = workers_.size();
+    size_t ranges = std::min(threads, (n + std::max<size_t>(grain, 1) - 1) / std::max<size_t>(grain, 1));
+    size_t per = (n + ranges - 1) / ranges;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::fill(rangeLo_.begin(), rangeLo_.end(), 0);
+    std::fill(rangeHi_.begin(), rangeHi_.end(), 0);
+    remaining_ = 0;
+    for (size_t r = 0; r < ranges; ++r) {
+        size_t lo = r * per;
+        size_t hi = std::min(n, lo + per);
+        if (lo >= hi) break;
+        // Spread ranges over the whole pool so every node gets its share.
+        size_t w = r * threads / ranges;
+        rangeLo_[w] = lo;
+        rangeHi_[w] = hi;
+        ++remaining_;
+    }
+    job_ = &fn;
+    ++generation_;
+    wake_.notify_all();
+    done_.wait(lock, [&] { return remaining_ == 0; });
+    job_ = nullptr;
+}
+
+const ICompressionModel& WorkerPool::local_model(const ICompressionModel& model, unsigned worker)
+{
+    if (topology_.node_count() <= 1) return model;
+    unsigned node = workerNode_[worker];
+
+    std::lock_guard<std::mutex> lock(replicaMutex_);
+    auto key = model.lifetime();
+    auto it = replicas_.find(key);
+    if (it == replicas_.end()) {
+        for (auto e = replicas_.begin(); e != replicas_.end();) {
+            e = e->first.expired() ? replicas_.erase(e) : std::next(e);
+        }
+        it = replicas_.emplace(std::move(key), Replicas()).first;
+    }
+    Replicas& r = it->second;
+    if (r.perNode.size() != topology_.node_count() ||
+        r.hash != model.model_hash() || r.fixedPoint != model.fixed_point() ||
+        r.primedState != model.primed_state()) {
+        r.perNode.clear();
+        r.perNode.resize(topology_.node_count());
+        r.hash = model.model_hash();
+        r.fixedPoint = model.fixed_point();
+        r.primedState = model.primed_state();
+    }
+    if (!r.perNode[node]) {
+        // Cloned on this (pinned) thread, so the copy's pages are local.
+        r.perNode[node] = model.clone();
+        if (!r.perNode[node]) return model;
+    }
+    return *r.perNode[node];
+}
+
+} // namespace neurozip
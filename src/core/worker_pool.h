@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "numa.h"
+
+namespace neurozip {
+
+class ICompressionModel;
+
+/// Persistent worker threads for the library's data-parallel loops.
+///
+/// When NUMA-aware, workers are split into contiguous groups, one per node,
+/// and each group is pinned to its node's CPUs. local_model() gives every
+/// worker a copy of the model weights that was allocated by a thread on the
+/// same node, so the memory-bound matrix-vector products never read
+/// weights across the interconnect. On single-node machines no copies are
+/// made.
+///
+/// parallel_for calls are serialized; do not call it from a worker.
+class WorkerPool {
+public:
+    /// threads = 0 uses every CPU the process may run on.
+    explicit WorkerPool(unsigned threads = 0, bool numaAware = true);
+
+    /// Use an explicit topology (nodes with an empty CPU list are not
+    /// pinned). Mainly for tests.
+    WorkerPool(unsigned threads, const NumaTopology& topology);
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers_.size(); }
+    size_t node_count() const { return topology_.node_count(); }
+    unsigned worker_node(unsigned worker) const { return workerNode_[worker]; }
+
+    /// Split [0, n) into at most size() contiguous ranges of at least
+    /// 'grain' items and run fn(worker, lo, hi) for each on the workers,
+    /// spread evenly across nodes. Blocks until all ranges are done.
+    void parallel_for(
+        size_t n,
+        size_t grain,
+        const std::function<void(unsigned worker, size_t lo, size_t hi)>& fn
+    );
+
+    /// Copy of 'model' local to the worker's node, created on first use by
+    /// that worker (first-touch). Returns 'model' itself on single-node
+    /// pools or if the model cannot be cloned. Copies are freed once
+    /// 'model' is destroyed and another model is used with the pool.
+    const ICompressionModel& local_model(const ICompressionModel& model, unsigned worker);
+
+private:
+    void start(unsigned threads);
+    void worker_main(unsigned index);
+
+    NumaTopology topology_;
+    std::vector<unsigned> workerNode_;
+    std::vector<std::thread> workers_;
+
+    // Current job, guarded by mutex_
+    std::mutex submitMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(unsigned, size_t, size_t)>* job_ = nullptr;
+    std::vector<size_t> rangeLo_;   // per worker; lo == hi means idle
+    std::vector<size_t> rangeHi_;
+    uint64_t generation_ = 0;
+    size_t remaining_ = 0;
+    bool stopping_ = false;
+
+    // Per-node model replicas, keyed by the source model's lifetime token
+    // (an address could be reused by a later model); entries of destroyed
+    // models are dropped when a new model is added.
+    struct Replicas {
+        uint64_t hash = 0;
+        bool fixedPoint = false;
+        uint32_t primedState = 0;
+        std::vector<std::unique_ptr<ICompressionModel>> perNode;
+    };
+    std::mutex replicaMutex_;
+    std::map<std::weak_ptr<const void>, Replicas, std::owner_less<std::weak_ptr<const void>>> replicas_;
+};
+
+} // namespace neurozip
@@ -0,0 +1,85 @@
+#include "daemon_client.h"
+
+#include "protocol.h"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace neurozip {
+namespace daemon {
+
+DaemonClient::~DaemonClient()
+{
+    close();
+}
+
+bool DaemonClient::connect(const std::string& socketPath)
+{
+    close();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) return false;
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void DaemonClient::close()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+nzp_error_t DaemonClient::call(
+    uint8_t op,
+    uint8_t flags,
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out
+) {
+    out.clear();
+    if (fd_ < 0) return NZP_ERR_IO;
+
+    Frame response;
+    if (!write_frame(fd_, op, flags, input.data(), input.size()) || !read_frame(fd_, response)) {
+        close();
+        return NZP_ERR_IO;
+    }
+
+    out = std::move(response.payload);
+    return (nzp_error_t)response.code;
+}
+
+nzp_error_t DaemonClient::ping()
+{
+    std::vector<uint8_t> out;
+    return call(DAEMON_OP_PING, 0, {}, out);
+}
+
+nzp_error_t DaemonClient::compress(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out,
+    bool fixedPoint
+) {
+    return call(DAEMON_OP_COMPRESS, fixedPoint ? DAEMON_FLAG_FIXED_POINT : 0, input, out);
+}
+
+nzp_error_t DaemonClient::decompress(
+    const std::vector<uint8_t>& input,
+    std::vector<uint8_t>& out
+) {
+    return call(DAEMON_OP_DECOMPRESS, 0, input, out);
+}
+
+} // namespace daemon
+} // namespace neurozip
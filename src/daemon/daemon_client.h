@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../api/neurozip_c.h"
+
+namespace neurozip {
+namespace daemon {
+
+/// Minimal blocking client for neurozipd. One connection, one request at
+/// a time; reuse the object across requests to avoid reconnecting.
+/// Transport failures are reported as NZP_ERR_IO and close the connection.
+class DaemonClient {
+public:
+    DaemonClient() = default;
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    bool connect(const std::string& socketPath);
+    void close();
+    bool connected() const { return fd_ >= 0; }
+
+    nzp_error_t ping();
+
+    /// Compress raw bytes into a complete .nzp image.
+    nzp_error_t compress(
+        const std::vector<uint8_t>& input,
+        std::vector<uint8_t>& out,
+        bool fixedPoint = false
+    );
+
+    /// Decompress a .nzp image.
+    nzp_error_t decompress(
+        const std::vector<uint8_t>& input,
+        std::vector<uint8_t>& out
+    );
+
+private:
+    nzp_error_t call(
+        uint8_t op,
+        uint8_t flags,
+        const std::vector<uint8_t>& input,
+        std::vector<uint8_t>& out
+    );
+
+    int fd_ = -1;
+};
+
+} // namespace daemon
+} // namespace neurozip
@@ -0,0 +1,306 @@
+#include "daemon_server.h"
+
+#include "../api/neurozip_cpp.h"
+#include "../core/compact_frame.h"
+#include "../core/file_format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace neurozip {
+namespace daemon {
+
+// Float and fixed-point inference need separate model objects because the
+// mode is a property of the model. Fixed-point requests are the exception,
+// so that copy is only loaded by the first one.
+struct DaemonServer::Models {
+    Model floatModel;
+
+    std::string path;
+    uint32_t primedState = 0;
+    const Cache* cache = nullptr;
+
+    mutable std::once_flag fixedOnce;
+    mutable Model fixedModel;
+    mutable bool fixedOk = false;
+
+    /// nullptr if it cannot be loaded, or the file changed on disk since
+    /// floatModel was (it would code with other weights).
+    const Model* fixed() const
+    {
+        std::call_once(fixedOnce, [this] {
+            if (!fixedModel.load(path)) return;
+            fixedModel.set_fixed_point(true);
+            fixedModel.set_cache(cache);
+            fixedOk = fixedModel.set_primed_state(primedState) &&
+                      nzp_model_hash(fixedModel.raw()) == nzp_model_hash(floatModel.raw());
+        });
+        return fixedOk ? &fixedModel : nullptr;
+    }
+};
+
+DaemonServer::DaemonServer(DaemonConfig config)
+    : config_(std::move(config))
+{
+    if (config_.cacheBytes) cache_ = std::make_unique<Cache>(config_.cacheBytes);
+}
+
+DaemonServer::~DaemonServer()
+{
+    stop();
+}
+
+std::shared_ptr<const DaemonServer::Models> DaemonServer::load_models() const
+{
+    auto models = std::make_shared<Models>();
+    if (!models->floatModel.load(config_.modelPath) ||
+        !models->floatModel.set_primed_state(config_.primedState)) {
+        return nullptr;
+    }
+    models->floatModel.set_cache(cache_.get());
+    models->path = config_.modelPath;
+    models->primedState = config_.primedState;
+    models->cache = cache_.get();
+    return models;
+}
+
+std::shared_ptr<const DaemonServer::Models> DaemonServer::current_models() const
+{
+    return std::atomic_load(&models_);
+}
+
+bool DaemonServer::start(std::string* error)
+{
+    auto fail = [&](const std::string& msg) {
+        if (error) *error = msg;
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+        }
+        return false;
+    };
+
+    auto models = load_models();
+    if (!models) return fail("failed to load model: " + config_.modelPath);
+    std::atomic_store(&models_, models);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (config_.socketPath.empty() || config_.socketPath.size() >= sizeof(addr.sun_path)) {
+        return fail("invalid socket path: " + config_.socketPath);
+    }
+    std::memcpy(addr.sun_path, config_.socketPath.c_str(), config_.socketPath.size() + 1);
+
+    // Remove a stale socket left by a previous run, but never a regular file.
+    struct stat st;
+    if (::lstat(config_.socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        ::unlink(config_.socketPath.c_str());
+    }
+
+    // Non-blocking, so a client that gives up between poll() and accept()
+    // cannot stall the poll thread.
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listenFd_ < 0) return fail(std::string("socket: ") + std::strerror(errno));
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        return fail(std::string("bind: ") + std::strerror(errno));
+    }
+    if (::listen(listenFd_, 64) < 0) {
+        return fail(std::string("listen: ") + std::strerror(errno));
+    }
+    if (::pipe2(wakePipe_, O_CLOEXEC | O_NONBLOCK) < 0) {
+        return fail(std::string("pipe: ") + std::strerror(errno));
+    }
+
+    unsigned n = config_.workers ? config_.workers : std::thread::hardware_concurrency();
+    if (n == 0) n = 1;
+
+    stopping_ = false;
+    for (unsigned i = 0; i < n; ++i) {
+        workers_.emplace_back(&DaemonServer::worker_loop, this);
+    }
+    pollThread_ = std::thread(&DaemonServer::poll_loop, this);
+    return true;
+}
+
+bool DaemonServer::reload()
+{
+    auto models = load_models();
+    if (!models) return false;
+    std::atomic_store(&models_, models);
+    return true;
+}
+
+void DaemonServer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || listenFd_ < 0) return;
+        stopping_ = true;
+
+        // Unblock any worker waiting on a client.
+        for (int fd : active_) ::shutdown(fd, SHUT_RDWR);
+    }
+    cv_.notify_all();
+    wake_poller();
+
+    if (pollThread_.joinable()) pollThread_.join();
+    for (auto& t : workers_) t.join();
+    workers_.clear();
+
+    for (int fd : pending_) ::close(fd);
+    pending_.clear();
+    for (int fd : idle_) ::close(fd);
+    idle_.clear();
+
+    ::close(wakePipe_[0]);
+    ::close(wakePipe_[1]);
+    wakePipe_[0] = wakePipe_[1] = -1;
+    ::close(listenFd_);
+    listenFd_ = -1;
+    ::unlink(config_.socketPath.c_str());
+}
+
+void DaemonServer::wake_poller()
+{
+    const uint8_t byte = 0;
+    ssize_t n = ::write(wakePipe_[1], &byte, 1);
+    (void)n; // a full pipe already has a wakeup pending
+}
+
+void DaemonServer::poll_loop()
+{
+    std::vector<pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({ listenFd_, POLLIN, 0 });
+        fds.push_back({ wakePipe_[0], POLLIN, 0 });
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            for (int fd : idle_) fds.push_back({ fd, POLLIN, 0 });
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) continue; // EINTR
+
+        if (fds[1].revents) {
+            uint8_t buf[64];
+            while (::read(wakePipe_[0], buf, sizeof(buf)) > 0) {}
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+
+        // A request (or a hangup, seen by the worker's read) is waiting.
+        bool ready = false;
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (!fds[i].revents) continue;
+            idle_.erase(std::find(idle_.begin(), idle_.end(), fds[i].fd));
+            pending_.push_back(fds[i].fd);
+            ready = true;
+        }
+
+        if (fds[0].revents) {
+            for (;;) {
+                int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) break;
+                idle_.push_back(fd);
+            }
+        }
+        if (ready) cv_.notify_all();
+    }
+}
+
+void DaemonServer::worker_loop()
+{
+    for (;;) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+            if (stopping_) return;
+            fd = pending_.front();
+            pending_.pop_front();
+            active_.insert(fd);
+        }
+
+        bool open = serve_one(fd);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_.erase(fd);
+            if (open && !stopping_) {
+                // Back to the poll thread until the next request.
+                idle_.push_back(fd);
+                wake_poller();
+                continue;
+            }
+        }
+        ::close(fd);
+    }
+}
+
+bool DaemonServer::serve_one(int fd)
+{
+    Frame request;
+    Frame response;
+    if (!read_frame(fd, request)) return false;
+    handle(request, response);
+    requestsServed_.fetch_add(1);
+    return write_frame(fd, response);
+}
+
+void DaemonServer::handle(const Frame& request, Frame& response)
+{
+    // Take a reference per request so a reload never pulls the model out
+    // from under a running call.
+    auto models = current_models();
+
+    response.flags = 0;
+    response.payload.clear();
+
+    nzp_error_t err;
+    switch (request.code) {
+        case DAEMON_OP_PING:
+            err = NZP_OK;
+            break;
+        case DAEMON_OP_COMPRESS: {
+            bool fixedPoint = (request.flags & DAEMON_FLAG_FIXED_POINT) != 0;
+            const Model* model = fixedPoint ? models->fixed() : &models->floatModel;
+            err = model ? compress_memory(request.payload, response.payload, *model) : NZP_ERR_MODEL_MISMATCH;
+            break;
+        }
+        case DAEMON_OP_DECOMPRESS: {
+            // The inference mode is recorded in the frame or file header.
+            const uint8_t* data = request.payload.data();
+            size_t size = request.payload.size();
+            bool fixedPoint = false;
+            if (is_compact_frame(data, size)) {
+                CompactFrameInfo info;
+                if (parse_compact_frame(data, size, info) == ErrorCode::Ok) fixedPoint = info.fixedPoint;
+            } else if (size >= sizeof(FileHeader)) {
+                FileHeader header;
+                std::memcpy(&header, data, sizeof(FileHeader));
+                fixedPoint = (header.flags & NZP_FLAG_FIXED_POINT) != 0;
+            }
+            const Model* model = fixedPoint ? models->fixed() : &models->floatModel;
+            err = model ? decompress_memory(request.payload, response.payload, *model) : NZP_ERR_MODEL_MISMATCH;
+            break;
+        }
+        default:
+            err = NZP_ERR_INVALID_FORMAT;
+            break;
+    }
+
+    response.code = (uint8_t)err;
+    if (err != NZP_OK) response.payload.clear();
+}
+
+} // namespace daemon
+} // namespace neurozip
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../api/neurozip_cpp.h"
+#include "protocol.h"
+
+namespace neurozip {
+namespace daemon {
+
+struct DaemonConfig {
+    std::string socketPath;
+    std::string modelPath;
+    unsigned workers = 0; // 0 = hardware threads
+    uint64_t cacheBytes = 0; // result cache budget for compress requests (0 = off)
+    uint32_t primedState = 0; // primed state compress requests start from (0 = cold)
+};
+
+/// neurozipd: keeps a model loaded and serves compress/decompress frames
+/// (see protocol.h) on a Unix domain socket. Idle connections are watched
+/// by one poll thread; a connection with a request waiting is handed to a
+/// worker of a fixed pool for that request only, so any number of clients
+/// can keep connections open across requests.
+class DaemonServer {
+public:
+    explicit DaemonServer(DaemonConfig config);
+    ~DaemonServer();
+
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    /// Load the model, bind the socket and start the worker pool.
+    bool start(std::string* error = nullptr);
+
+    /// Reload the model from disk. Requests already running finish on the
+    /// previous model; the old model is kept if loading fails.
+    bool reload();
+
+    /// Close the socket, drop open connections and join all threads.
+    void stop();
+
+    uint64_t requests_served() const { return requestsServed_.load(); }
+
+    /// Result cache counters (all zero without config.cacheBytes).
+    nzp_cache_stats_t cache_stats() const { return cache_ ? cache_->stats() : nzp_cache_stats_t{}; }
+
+private:
+    struct Models;
+
+    std::shared_ptr<const Models> load_models() const;
+    std::shared_ptr<const Models> current_models() const;
+
+    void poll_loop();
+    void worker_loop();
+    bool serve_one(int fd);
+    void handle(const Frame& request, Frame& response);
+    void wake_poller();
+
+    DaemonConfig config_;
+    int listenFd_ = -1;
+
+    std::shared_ptr<const Models> models_; // std::atomic_load / atomic_store
+
+    // Shared by all model generations; entries of a replaced model are
+    // keyed by its hash and age out.
+    std::unique_ptr<Cache> cache_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<int> idle_;   // open, watched by the poll thread
+    std::deque<int> pending_; // a request is waiting for a worker
+    std::set<int> active_;    // being served
+    bool stopping_ = false;
+    int wakePipe_[2] = { -1, -1 }; // interrupts poll() when idle_ grows or on stop
+
+    std::thread pollThread_;
+    std::vector<std::thread> workers_;
+    std::atomic<uint64_t> requestsServed_{0};
+};
+
+} // namespace daemon
+} // namespace neurozip
@@ -0,0 +1,73 @@
+#include "protocol.h"
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace neurozip {
+namespace daemon {
+
+static bool write_all(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::recv(fd, data, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false; // peer closed
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+bool write_frame(int fd, uint8_t code, uint8_t flags, const uint8_t* payload, size_t size)
+{
+    if (size > DAEMON_MAX_FRAME - 4) return false;
+    uint32_t length = (uint32_t)size + 4;
+
+    uint8_t header[8] = {
+        (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16), (uint8_t)(length >> 24),
+        code, flags, 0, 0
+    };
+    if (!write_all(fd, header, sizeof(header))) return false;
+    return write_all(fd, payload, size);
+}
+
+bool write_frame(int fd, const Frame& frame)
+{
+    return write_frame(fd, frame.code, frame.flags, frame.payload.data(), frame.payload.size());
+}
+
+bool read_frame(int fd, Frame& frame)
+{
+    uint8_t header[8];
+    if (!read_all(fd, header, sizeof(header))) return false;
+
+    uint32_t length = (uint32_t)header[0] | ((uint32_t)header[1] << 8) |
+                      ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+    if (length < 4 || length > DAEMON_MAX_FRAME) return false;
+
+    frame.code = header[4];
+    frame.flags = header[5];
+    frame.payload.resize(length - 4);
+    return read_all(fd, frame.payload.data(), frame.payload.size());
+}
+
+} // namespace daemon
+} // namespace neurozip
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neurozip {
+namespace daemon {
+
+// Wire format between neurozipd and its clients (Unix stream socket).
+// Every message is one length-prefixed binary frame, little-endian:
+//
+//   u32 length           bytes that follow (4-byte frame header + payload)
+//   u8  code             request: DaemonOp, response: nzp_error_t
+//   u8  flags            request: DAEMON_FLAG_*, response: 0
+//   u16 reserved         0
+//   u8  payload[length - 4]
+//
+// A connection carries any number of request/response pairs in order.
+
+enum DaemonOp : uint8_t {
+    DAEMON_OP_PING       = 0, // empty payload, empty reply
+    DAEMON_OP_COMPRESS   = 1, // raw bytes -> .nzp image
+    DAEMON_OP_DECOMPRESS = 2, // .nzp image -> raw bytes
+};
+
+// Request flags
+constexpr uint8_t DAEMON_FLAG_FIXED_POINT = 1u << 0; // compress with fixed-point inference
+
+// Upper bound on a frame; larger lengths are treated as a protocol error.
+constexpr uint32_t DAEMON_MAX_FRAME = 1u << 30;
+
+struct Frame {
+    uint8_t code = 0;
+    uint8_t flags = 0;
+    std::vector<uint8_t> payload;
+};
+
+/// Write one frame. Returns false on any socket error.
+bool write_frame(int fd, const Frame& frame);
+bool write_frame(int fd, uint8_t code, uint8_t flags, const uint8_t* payload, size_t size);
+
+/// Read one frame. Returns false on EOF, socket error or a malformed length.
+bool read_frame(int fd, Frame& frame);
+
+} // namespace daemon
+} // namespace neurozip
@@ -0,0 +1,111 @@
+#include "block_sparse.h"
+#include "fixed_point.h"
+
+namespace neurozip {
+
+static constexpr uint32_t kMaxBlock = 64;
+
+double BlockSparseMatrix::density() const
+{
+    if (empty()) return 0.0;
+    double tiles = (double)(rows / block) * (double)(cols / block);
+    return (double)stored_blocks() / tiles;
+}
+
+bool read_block_sparse(std::istream& in, uint32_t rows, uint32_t cols, BlockSparseMatrix& out)
+{
+    auto read_u32s = [&](std::vector<uint32_t>& v, size_t n) {
+        v.resize(n);
+        in.read((char*)v.data(), (std::streamsize)(n * sizeof(uint32_t)));
+        return (bool)in;
+    };
+
+    uint32_t header[2];
+    in.read((char*)header, sizeof(header));
+    if (!in) return false;
+
+    BlockSparseMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.block = header[0];
+    const uint32_t stored = header[1];
+    if (m.block == 0 || m.block > kMaxBlock || rows % m.block || cols % m.block) return false;
+
+    const uint32_t blockRows = rows / m.block;
+    const uint32_t blockCols = cols / m.block;
+    if ((uint64_t)stored > (uint64_t)blockRows * blockCols) return false;
+
+    if (!read_u32s(m.rowPtr, (size_t)blockRows + 1)) return false;
+    if (!read_u32s(m.colIdx, stored)) return false;
+    if (m.rowPtr[0] != 0 || m.rowPtr[blockRows] != stored) return false;
+    for (uint32_t br = 0; br < blockRows; ++br) {
+        if (m.rowPtr[br] > m.rowPtr[br + 1]) return false;
+        for (uint32_t t = m.rowPtr[br]; t < m.rowPtr[br + 1]; ++t) {
+            if (m.colIdx[t] >= blockCols) return false;
+            if (t > m.rowPtr[br] && m.colIdx[t] <= m.colIdx[t - 1]) return false;
+        }
+    }
+
+    m.values.resize((size_t)stored * m.block * m.block);
+    in.read((char*)m.values.data(), (std::streamsize)(m.values.size() * sizeof(float)));
+    if (!in) return false;
+
+    out = std::move(m);
+    return true;
+}
+
+void quantize_block_sparse(BlockSparseMatrix& m)
+{
+    m.valuesQ.resize(m.values.size());
+    for (size_t i = 0; i < m.values.size(); i++)
+        m.valuesQ[i] = fixed::quantize_weight(m.values[i]);
+}
+
+void bsr_matvec_add(const BlockSparseMatrix& m, const float* x, float* y)
+{
+    const uint32_t B = m.block;
+    const size_t tile = (size_t)B * B;
+    float acc[kMaxBlock];
+
+    for (uint32_t br = 0; br < m.rows / B; ++br) {
+        for (uint32_t i = 0; i < B; ++i) acc[i] = 0.0f;
+
+        for (uint32_t t = m.rowPtr[br]; t < m.rowPtr[br + 1]; ++t) {
+            const float* w = &m.values[t * tile];
+            const float* xs = x + (size_t)m.colIdx[t] * B;
+            for (uint32_t i = 0; i < B; ++i) {
+                const float* wr = w + (size_t)i * B;
+                float s = 0.0f;
+                for (uint32_t j = 0; j < B; ++j)
+                    s += wr[j] * xs[j];
+                acc[i] += s;
+            }
+        }
+
+        float* ys = y + (size_t)br * B;
+        for (uint32_t i = 0; i < B; ++i) ys[i] += acc[i];
+    }
+}
+
+void bsr_matvec_add_q(const BlockSparseMatrix& m, const int16_t* x, int64_t* y)
+{
+    const uint32_t B = m.block;
+    const size_t tile = (size_t)B * B;
+
+    for (uint32_t br = 0; br < m.rows / B; ++br) {
+        int64_t* ys = y + (size_t)br * B;
+        for (uint32_t t = m.rowPtr[br]; t < m.rowPtr[br + 1]; ++t) {
+            const int16_t* w = &m.valuesQ[t * tile];
+            const int16_t* xs = x + (size_t)m.colIdx[t] * B;
+            for (uint32_t i = 0; i < B; ++i) {
+                const int16_t* wr = w + (size_t)i * B;
+                int64_t s = 0;
+                for (uint32_t j = 0; j < B; ++j)
+                    s += (int32_t)wr[j] * (int32_t)xs[j];
+                ys[i] += s;
+            }
+        }
+    }
+}
+
+} // namespace neurozip
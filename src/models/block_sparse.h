@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+namespace neurozip {
+
+/// Block-compressed sparse row (BSR) matrix for pruned weights: the
+/// [rows, cols] matrix is tiled into block x block tiles and only the
+/// nonzero tiles are kept. File layout (little-endian), in place of the
+/// dense float32 array:
+///
+///   u32 block                       (divides rows and cols, <= 64)
+///   u32 stored tiles
+///   u32 rowPtr[rows / block + 1]    (tiles of block row r: [rowPtr[r], rowPtr[r+1]))
+///   u32 colIdx[stored]              (block column, increasing within a row)
+///   f32 values[stored * block * block] (each tile row-major)
+struct BlockSparseMatrix {
+    uint32_t rows = 0;
+    uint32_t cols = 0;
+    uint32_t block = 0;
+    std::vector<uint32_t> rowPtr;
+    std::vector<uint32_t> colIdx;
+    std::vector<float> values;
+    std::vector<int16_t> valuesQ; // Q12 copy for fixed-point inference
+
+    bool empty() const { return rows == 0; }
+    size_t stored_blocks() const { return colIdx.size(); }
+
+    /// Fraction of tiles that are stored.
+    double density() const;
+};
+
+/// Read a matrix of the given shape; false if truncated or inconsistent.
+bool read_block_sparse(std::istream& in, uint32_t rows, uint32_t cols, BlockSparseMatrix& out);
+
+/// Fill valuesQ from values.
+void quantize_block_sparse(BlockSparseMatrix& m);
+
+/// y[r] += sum_j A[r][j] * x[j] over the stored tiles. Each row sums its
+/// tiles in column order, so the result does not depend on the caller.
+void bsr_matvec_add(const BlockSparseMatrix& m, const float* x, float* y);
+
+/// Fixed-point version on valuesQ (exact integer sums).
+void bsr_matvec_add_q(const BlockSparseMatrix& m, const int16_t* x, int64_t* y);
+
+} // namespace neurozip
@@ -0,0 +1,85 @@
+#include "fixed_point.h"
+
+#include <cmath>
+
+namespace neurozip {
+namespace fixed {
+
+int16_t quantize_weight(float w)
+{
+    // Scaling by a power of two is exact, and lround is fully specified,
+    // so the quantized weights are identical on every platform.
+    long q = std::lround(w * (float)(1 << kWeightFrac));
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (int16_t)q;
+}
+
+// exp(-k / 256) in Q30, computed with integer arithmetic only so the LUTs
+// never depend on the platform's libm.
+static int64_t exp_neg_q30(uint32_t k)
+{
+    constexpr int64_t ONE = int64_t(1) << 30;
+    constexpr int64_t E_NEG_1 = 395007542; // exp(-1) * 2^30
+
+    // exp(-f) for the fractional part f in [0, 1) via Taylor series.
+    int64_t f = (int64_t)(k & 255u) << 22; // Q30
+    int64_t term = ONE;
+    int64_t sum = ONE;
+    for (int n = 1; n < 16; n++) {
+        term = -((term * f) >> 30) / n;
+        sum += term;
+    }
+
+    // Multiply by exp(-1) for every whole unit.
+    for (uint32_t n = k >> 8; n > 0 && sum > 0; n--)
+        sum = (sum * E_NEG_1) >> 30;
+
+    return sum;
+}
+
+namespace {
+
+struct Luts {
+    int32_t sigmoid[kLutSize];
+    int32_t tanh[kLutSize];
+    int32_t expNeg[kLutSize];
+
+    Luts()
+    {
+        constexpr int64_t ONE = int64_t(1) << 30;
+        constexpr int64_t OUT = int64_t(1) << kActFrac;
+
+        for (int i = 0; i < kLutSize; i++) {
+            int32_t x = i - kLutHalf;
+            uint32_t ax = (uint32_t)(x < 0 ? -x : x);
+
+            // sigmoid(|x|) = 1 / (1 + e^-|x|)
+            int64_t e = exp_neg_q30(ax);
+            int64_t s = (ONE * OUT + (ONE + e) / 2) / (ONE + e);
+            sigmoid[i] = (int32_t)(x < 0 ? OUT - s : s);
+
+            // tanh(|x|) = (1 - e^-2|x|) / (1 + e^-2|x|)
+            int64_t e2 = exp_neg_q30(2 * ax);
+            int64_t t = ((ONE - e2) * OUT + (ONE + e2) / 2) / (ONE + e2);
+            tanh[i] = (int32_t)(x < 0 ? -t : t);
+
+            expNeg[i] = (int32_t)(exp_neg_q30((uint32_t)i) >> (30 - kExpFrac));
+        }
+    }
+};
+
+const Luts& luts()
+{
+    static const Luts tables;
+    return tables;
+}
+
+} // namespace
+
+const int32_t* sigmoid_lut() { return luts().sigmoid; }
+const int32_t* tanh_lut() { return luts().tanh; }
+const int32_t* exp_neg_lut() { return luts().expNeg; }
+
+} // namespace fixed
+} // namespace neurozip
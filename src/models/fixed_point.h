@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+namespace neurozip {
+namespace fixed {
+
+// Fixed-point formats used by the deterministic inference path.
+//
+// Everything here is integer arithmetic, so results do not depend on the
+// compiler's FMA contraction, libm's exp/tanh or the order in which a
+// vectorized reduction adds its lanes (integer addition is associative).
+constexpr int kWeightFrac = 12;  // weights/biases: Q12 in int16
+constexpr int kActFrac    = 14;  // h, c and gate activations: Q14
+constexpr int kLutFrac    = 8;   // LUT input step is 1/256
+constexpr int kLutSize    = 4096;
+constexpr int kLutHalf    = kLutSize / 2;  // sigmoid/tanh cover [-8, 8)
+constexpr int kExpFrac    = 16;  // exp LUT output: Q16
+
+// Accumulator format of W * h (+ bias << kActFrac).
+constexpr int kAccFrac = kWeightFrac + kActFrac;
+
+// Clamp for the cell state so it can never overflow over long inputs.
+constexpr int32_t kCellLimit = 64 << kActFrac;
+
+/// Round-to-nearest arithmetic right shift.
+inline int64_t rshift_round(int64_t v, int s)
+{
+    return (v + (int64_t(1) << (s - 1))) >> s;
+}
+
+/// Quantize a float weight to Q12 int16 (saturating, round to nearest).
+int16_t quantize_weight(float w);
+
+/// sigmoid(x) in Q14 for x = (i - kLutHalf) / 256.
+const int32_t* sigmoid_lut();
+
+/// tanh(x) in Q14 for x = (i - kLutHalf) / 256.
+const int32_t* tanh_lut();
+
+/// exp(-d) in Q16 for d = i / 256.
+const int32_t* exp_neg_lut();
+
+/// LUT index for a signed value with 'frac' fractional bits.
+inline int32_t lut_index(int64_t v, int frac)
+{
+    int64_t i = rshift_round(v, frac - kLutFrac) + kLutHalf;
+    if (i < 0) i = 0;
+    if (i >= kLutSize) i = kLutSize - 1;
+    return (int32_t)i;
+}
+
+} // namespace fixed
+} // namespace neurozip
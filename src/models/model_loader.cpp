@@ -0,0 +1,80 @@
+#include "model_loader.h"
+#include "tiny_lstm.h"
+#include "token_lstm.h"
+#include "tiny_rnn.h"
+
+#include "../core/trace.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace neurozip {
+
+std::unique_ptr<ICompressionModel> load_model(const std::string& path)
+{
+    uint32_t first = 0;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.read((char*)&first, sizeof(first))) return nullptr;
+    }
+
+    if (first == RNN_MAGIC_GRU || first == RNN_MAGIC_MGU) {
+        auto model = std::make_unique<TinyRnnModel>();
+        if (!model->load_from_file(path)) return nullptr;
+        return model;
+    }
+
+    if (first == TOKEN_MAGIC) {
+        auto model = std::make_unique<TokenLstmModel>();
+        if (!model->load_from_file(path)) return nullptr;
+        return model;
+    }
+
+    auto model = std::make_unique<TinyLstmModel>();
+    if (!model->load_from_file(path)) return nullptr;
+    return model;
+}
+
+bool write_primed_model(
+    const std::string& modelPath,
+    const std::string& outPath,
+    const std::vector<std::vector<uint8_t>>& prefixes
+) {
+    TraceSpan span("prime_model", "model");
+    auto model = load_model(modelPath);
+    if (!model) return false;
+    model->set_fixed_point(false);
+
+    const PrimedStates* existing = nullptr;
+    if (auto* lstm = dynamic_cast<const TinyLstmModel*>(model.get()))
+        existing = &lstm->primed_states();
+    else if (auto* rnn = dynamic_cast<const TinyRnnModel*>(model.get()))
+        existing = &rnn->primed_states();
+    if (!existing) return false;
+
+    std::vector<ModelContext> states;
+    for (uint32_t id = 1; id <= existing->count(); ++id) {
+        PrimedStates s = *existing;
+        s.select(id);
+        ModelContext ctx(existing->width);
+        s.apply(ctx);
+        states.push_back(ctx);
+    }
+    for (const auto& prefix : prefixes) {
+        states.push_back(prime_state(*model, prefix.data(), prefix.size()));
+    }
+
+    std::vector<uint8_t> file;
+    {
+        std::ifstream ifs(modelPath, std::ios::binary);
+        file.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    file.resize((size_t)existing->fileOffset);
+    append_primed_states(states, existing->width, existing->vectors, file);
+
+    std::ofstream ofs(outPath, std::ios::binary | std::ios::trunc);
+    ofs.write((const char*)file.data(), (std::streamsize)file.size());
+    return (bool)ofs;
+}
+
+} // namespace neurozip
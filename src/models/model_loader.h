@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/model_interface.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+/// Load any model file: an LSTM file starts with its input size (256), a
+/// GRU / MGU file with RNN_MAGIC_GRU / RNN_MAGIC_MGU and a token model
+/// with TOKEN_MAGIC. nullptr if the file cannot be read or is not a valid
+/// model.
+std::unique_ptr<ICompressionModel> load_model(const std::string& path);
+
+/// Write a copy of the model file at 'modelPath' to 'outPath' with one
+/// primed state per prefix (prime_state, float inference) added after its
+/// existing ones, so ids already in use keep their meaning. False if the
+/// model cannot be loaded or the output written.
+bool write_primed_model(
+    const std::string& modelPath,
+    const std::string& outPath,
+    const std::vector<std::vector<uint8_t>>& prefixes
+);
+
+} // namespace neurozip
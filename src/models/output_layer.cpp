@@ -0,0 +1,271 @@
+#include "output_layer.h"
+#include "fixed_point.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace neurozip {
+
+// Positions per tile in the batched output layer. Each W row is loaded
+// once per tile instead of once per position.
+static constexpr size_t kOutputTile = 8;
+
+void softmax(const float* logits, size_t n, float* outProbs)
+{
+    float maxLogit = logits[0];
+    for (size_t i = 1; i < n; i++)
+        if (logits[i] > maxLogit) maxLogit = logits[i];
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float e = std::exp(logits[i] - maxLogit);
+        outProbs[i] = e;
+        sum += e;
+    }
+
+    if (sum <= 0.0f) {
+        float p = 1.0f / (float)n;
+        for (size_t i = 0; i < n; i++)
+            outProbs[i] = p;
+        return;
+    }
+
+    float invSum = 1.0f / sum;
+    for (size_t i = 0; i < n; i++)
+        outProbs[i] *= invSum;
+}
+
+// Softmax through the exp LUT (distance from the max, Q8 steps).
+void softmax_fixed(const int64_t* logits, size_t n, float* outProbs)
+{
+    using namespace fixed;
+
+    const int32_t* ex = exp_neg_lut();
+
+    int64_t maxLogit = logits[0];
+    for (size_t i = 1; i < n; i++)
+        if (logits[i] > maxLogit) maxLogit = logits[i];
+
+    uint32_t e[256];
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t d = rshift_round(maxLogit - logits[i], kAccFrac - kLutFrac);
+        if (d >= kLutSize) d = kLutSize - 1;
+        e[i] = (uint32_t)ex[d];
+        sum += e[i];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t f = ((uint64_t)e[i] << 15) / sum;
+        outProbs[i] = (float)f * (1.0f / 32768.0f);
+    }
+}
+
+void byte_output_logits(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    size_t lo,
+    size_t hi,
+    float* logits
+) {
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t n = std::min(kOutputTile, count - p0);
+        const float* hTile = hidden + p0 * H;
+
+        for (size_t i = lo; i < hi; i++) {
+            const float* row = W + i * H;
+            for (size_t p = 0; p < n; p++) {
+                const float* h = hTile + p * H;
+                float acc = b[i];
+                for (size_t j = 0; j < H; j++)
+                    acc += row[j] * h[j];
+                logits[(p0 + p) * 256 + i] = acc;
+            }
+        }
+    }
+}
+
+void byte_output_logits_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const int16_t* hq,
+    size_t count,
+    size_t lo,
+    size_t hi,
+    int64_t* logits
+) {
+    using namespace fixed;
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t n = std::min(kOutputTile, count - p0);
+        const int16_t* hTile = hq + p0 * H;
+
+        for (size_t i = lo; i < hi; i++) {
+            const int16_t* row = Wq + i * H;
+            int64_t bias = (int64_t)bq[i] << kActFrac;
+            for (size_t p = 0; p < n; p++) {
+                const int16_t* h = hTile + p * H;
+                int64_t acc = 0;
+                for (size_t j = 0; j < H; j++)
+                    acc += (int32_t)row[j] * (int32_t)h[j];
+                logits[(p0 + p) * 256 + i] = acc + bias;
+            }
+        }
+    }
+}
+
+void byte_output_logits_rows(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    size_t lo,
+    size_t hi,
+    float* logits
+) {
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t m = std::min(kOutputTile, count - p0);
+        const float* hTile = hidden + p0 * H;
+
+        for (size_t k = lo; k < hi; k++) {
+            const float* row = W + rows[k] * H;
+            for (size_t p = 0; p < m; p++) {
+                const float* h = hTile + p * H;
+                float acc = b[rows[k]];
+                for (size_t j = 0; j < H; j++)
+                    acc += row[j] * h[j];
+                logits[(p0 + p) * n + k] = acc;
+            }
+        }
+    }
+}
+
+void byte_output_logits_rows_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const int16_t* hq,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    size_t lo,
+    size_t hi,
+    int64_t* logits
+) {
+    using namespace fixed;
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t m = std::min(kOutputTile, count - p0);
+        const int16_t* hTile = hq + p0 * H;
+
+        for (size_t k = lo; k < hi; k++) {
+            const int16_t* row = Wq + rows[k] * H;
+            int64_t bias = (int64_t)bq[rows[k]] << kActFrac;
+            for (size_t p = 0; p < m; p++) {
+                const int16_t* h = hTile + p * H;
+                int64_t acc = 0;
+                for (size_t j = 0; j < H; j++)
+                    acc += (int32_t)row[j] * (int32_t)h[j];
+                logits[(p0 + p) * n + k] = acc + bias;
+            }
+        }
+    }
+}
+
+void byte_output_probs(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    float* outProbs
+) {
+    float logits[kOutputTile * 256];
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t n = std::min(kOutputTile, count - p0);
+        byte_output_logits(W, b, H, hidden + p0 * H, n, 0, 256, logits);
+        for (size_t p = 0; p < n; p++)
+            softmax(logits + p * 256, 256, outProbs + (p0 + p) * 256);
+    }
+}
+
+void byte_output_probs_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    float* outProbs
+) {
+    using namespace fixed;
+
+    std::vector<int16_t> hq(kOutputTile * H);
+    int64_t logits[kOutputTile * 256];
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t n = std::min(kOutputTile, count - p0);
+        for (size_t k = 0; k < n * H; k++)
+            hq[k] = (int16_t)(int32_t)(hidden[p0 * H + k] * kActScale);
+
+        byte_output_logits_fixed(Wq, bq, H, hq.data(), n, 0, 256, logits);
+        for (size_t p = 0; p < n; p++)
+            softmax_fixed(logits + p * 256, 256, outProbs + (p0 + p) * 256);
+    }
+}
+
+void byte_output_probs_rows(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    float* outProbs
+) {
+    float logits[kOutputTile * 256];
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t m = std::min(kOutputTile, count - p0);
+        byte_output_logits_rows(W, b, H, hidden + p0 * H, m, rows, n, 0, n, logits);
+        for (size_t p = 0; p < m; p++)
+            softmax(logits + p * n, n, outProbs + (p0 + p) * n);
+    }
+}
+
+void byte_output_probs_rows_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    float* outProbs
+) {
+    using namespace fixed;
+
+    std::vector<int16_t> hq(kOutputTile * H);
+    int64_t logits[kOutputTile * 256];
+
+    for (size_t p0 = 0; p0 < count; p0 += kOutputTile) {
+        size_t m = std::min(kOutputTile, count - p0);
+        for (size_t k = 0; k < m * H; k++)
+            hq[k] = (int16_t)(int32_t)(hidden[p0 * H + k] * kActScale);
+
+        byte_output_logits_rows_fixed(Wq, bq, H, hq.data(), m, rows, n, 0, n, logits);
+        for (size_t p = 0; p < m; p++)
+            softmax_fixed(logits + p * n, n, outProbs + (p0 + p) * n);
+    }
+}
+
+} // namespace neurozip
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace neurozip {
+
+// Byte output layer shared by the recurrent models: logits = W * h + b
+// over 256 rows, then softmax.
+
+// In fixed-point mode the hidden vectors hold Q14 values stored as
+// q / 2^14, so these conversions are exact.
+constexpr float kActScale = 16384.0f;
+constexpr float kActInvScale = 1.0f / kActScale;
+
+void softmax(const float* logits, size_t n, float* outProbs);
+
+/// Softmax over Q26 logits through the exp LUT. Probabilities are exact
+/// multiples of 2^-15, so the range coder reproduces them bit for bit.
+void softmax_fixed(const int64_t* logits, size_t n, float* outProbs);
+
+/// 256-way distributions for 'count' hidden vectors of width H stored
+/// back to back (W: [256, H], b: [256]). Positions are processed in tiles
+/// so each row of W is loaded once per tile; every logit accumulates in
+/// the same order as a single-position call.
+void byte_output_probs(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    float* outProbs
+);
+
+/// Fixed-point version on Q12 weights and biases.
+void byte_output_probs_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    float* outProbs
+);
+
+/// Logit rows [lo, hi) only, for 'count' hidden vectors:
+/// logits[p * 256 + i]. Each logit accumulates exactly as in
+/// byte_output_probs, so the rows can be split across threads (see
+/// StepTeam) without changing the distribution.
+void byte_output_logits(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    size_t lo,
+    size_t hi,
+    float* logits
+);
+
+/// Fixed-point version on Q14 hidden vectors (hq: count * H), Q26 logits.
+void byte_output_logits_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const int16_t* hq,
+    size_t count,
+    size_t lo,
+    size_t hi,
+    int64_t* logits
+);
+
+/// Logits of the rows listed in rows[lo, hi) only (rows holds n indices),
+/// for 'count' hidden vectors: logits[p * n + k] is row rows[k]. Each
+/// logit accumulates as in byte_output_logits.
+void byte_output_logits_rows(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    size_t lo,
+    size_t hi,
+    float* logits
+);
+
+/// Fixed-point version on Q14 hidden vectors (hq: count * H), Q26 logits.
+void byte_output_logits_rows_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const int16_t* hq,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    size_t lo,
+    size_t hi,
+    int64_t* logits
+);
+
+/// byte_output_probs over rows[0, n) only, for a reduced alphabet (see
+/// core/alphabet.h): the softmax of just those logits, n floats per
+/// position.
+void byte_output_probs_rows(
+    const float* W,
+    const float* b,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    float* outProbs
+);
+
+/// Fixed-point version on Q12 weights and biases.
+void byte_output_probs_rows_fixed(
+    const int16_t* Wq,
+    const int32_t* bq,
+    size_t H,
+    const float* hidden,
+    size_t count,
+    const uint8_t* rows,
+    size_t n,
+    float* outProbs
+);
+
+} // namespace neurozip
@@ -0,0 +1,95 @@
+#include "primed_state.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace neurozip {
+
+bool PrimedStates::select(uint32_t id)
+{
+    if (id > count()) return false;
+    selected = id;
+    selectedHash = 0;
+    if (id == 0) return true;
+
+    // FNV-1a over the snapshot, folded to 32 bits and never 0.
+    const size_t n = (size_t)width * vectors;
+    const uint8_t* bytes = (const uint8_t*)(values.data() + (id - 1) * n);
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < n * sizeof(float); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    selectedHash = (uint32_t)(hash ^ (hash >> 32));
+    if (selectedHash == 0) selectedHash = 1;
+    return true;
+}
+
+void PrimedStates::apply(ModelContext& ctx) const
+{
+    if (selected == 0) return;
+    const float* s = values.data() + (size_t)(selected - 1) * width * vectors;
+    std::memcpy(ctx.h.data(), s, width * sizeof(float));
+    if (vectors > 1) std::memcpy(ctx.c.data(), s + width, width * sizeof(float));
+}
+
+bool read_primed_states(std::istream& in, uint32_t width, uint32_t vectors, PrimedStates& out)
+{
+    out = PrimedStates();
+    out.width = width;
+    out.vectors = vectors;
+    out.fileOffset = (uint64_t)in.tellg();
+
+    uint32_t header[3];
+    in.read((char*)header, sizeof(header));
+    if (in.gcount() == 0) return true; // no section
+    if (!in || header[0] != PRIMED_MAGIC || header[2] != vectors || width > kMaxHiddenSize) return false;
+
+    const uint64_t n = (uint64_t)header[1] * vectors * width;
+    if (n > (1u << 26)) return false;
+    out.values.resize((size_t)n);
+    in.read((char*)out.values.data(), (std::streamsize)(n * sizeof(float)));
+    if (!in) return false;
+    return in.peek() == std::char_traits<char>::eof();
+}
+
+void append_primed_states(
+    const std::vector<ModelContext>& states,
+    uint32_t width,
+    uint32_t vectors,
+    std::vector<uint8_t>& out
+) {
+    auto put = [&](const void* p, size_t n) {
+        out.insert(out.end(), (const uint8_t*)p, (const uint8_t*)p + n);
+    };
+    const uint32_t header[3] = { PRIMED_MAGIC, (uint32_t)states.size(), vectors };
+    put(header, sizeof(header));
+    for (const ModelContext& s : states) {
+        put(s.h.data(), width * sizeof(float));
+        if (vectors > 1) put(s.c.data(), width * sizeof(float));
+    }
+}
+
+ModelContext prime_state(const ICompressionModel& model, const uint8_t* prefix, size_t size)
+{
+    ModelContext ctx(model.hidden_size());
+    std::vector<float> out(std::max<size_t>(256, model.hidden_size()));
+    auto step = [&](uint8_t x) {
+        if (model.nibble_output())
+            model.predict_high_nibble(ctx, x, out.data());
+        else if (model.hidden_size())
+            model.advance(ctx, x, out.data());
+        else
+            model.predict_next(ctx, x, out.data(), 256);
+    };
+
+    uint8_t prev = 0; // BOS symbol
+    for (size_t i = 0; i < size; ++i) {
+        step(prev);
+        prev = prefix[i];
+    }
+    if (size) step(prev);
+    return ctx;
+}
+
+} // namespace neurozip
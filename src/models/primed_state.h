@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/model_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+namespace neurozip {
+
+constexpr uint32_t PRIMED_MAGIC = 0x31535A4E; // "NZS1" little-endian
+
+/// Primed initial states: ModelContext snapshots taken after running the
+/// model over a representative prefix (prime_state), stored after the
+/// weights so short messages are coded from a warm state instead of
+/// h = c = 0, without coding the prefix itself. File layout, directly after
+/// the last weight array (older readers stop before it):
+///
+///   u32 magic (PRIMED_MAGIC)
+///   u32 count
+///   u32 vectors per state: 1 (h) or 2 (h, then c)
+///   f32 values[count * vectors * hiddenSize]
+///
+/// Snapshots are numbered 1..count in file order; 0 is the cold start.
+/// They are not part of model_hash(), so adding snapshots to a model keeps
+/// its existing files decodable.
+struct PrimedStates {
+    uint32_t width = 0;         // hidden size
+    uint32_t vectors = 0;       // 1 or 2
+    std::vector<float> values;
+    uint64_t fileOffset = 0;    // start of the section (end of the weights)
+    uint32_t selected = 0;      // snapshot new contexts start from
+    uint32_t selectedHash = 0;  // its digest (0 when cold)
+
+    uint32_t count() const
+    {
+        return width && vectors ? (uint32_t)(values.size() / ((size_t)width * vectors)) : 0;
+    }
+
+    /// Select snapshot 'id' (0 = cold start); false if there is none.
+    bool select(uint32_t id);
+
+    /// Overwrite the context with the selected snapshot (no-op when cold).
+    void apply(ModelContext& ctx) const;
+};
+
+/// Read the section at the current position of 'in', which must be just
+/// past the weights: an empty rest of file means no snapshots. False if
+/// anything else follows the weights.
+bool read_primed_states(std::istream& in, uint32_t width, uint32_t vectors, PrimedStates& out);
+
+/// Serialize 'states' (vectors * width floats of each context) as a
+/// section appended to 'out'.
+void append_primed_states(
+    const std::vector<ModelContext>& states,
+    uint32_t width,
+    uint32_t vectors,
+    std::vector<uint8_t>& out
+);
+
+/// Context after running 'model' over 'prefix' from a cold start and then
+/// stepping once more on its last byte. Coding from it continues as from
+/// a cold start (the first step takes the BOS byte 0), so the model sees
+/// the prefix, a 0 separator and then the message.
+ModelContext prime_state(const ICompressionModel& model, const uint8_t* prefix, size_t size);
+
+} // namespace neurozip
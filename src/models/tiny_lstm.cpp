@@ -1,5 +1,9 @@
 #include "tiny_lstm.h"
+#include "fixed_point.h"
+#include "output_layer.h"
+#include "../core/trace.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <fstream>
@@ -9,7 +13,8 @@ namespace neurozip {
 
 TinyLstmModel::TinyLstmModel()
     : modelId_(1),
-      modelHash_(0)
+      modelHash_(0),
+      fixedPoint_(false)
 {
 }
 
@@ -17,28 +22,41 @@ TinyLstmModel::TinyLstmModel()
 // uint32 inputSize
 // uint32 hiddenSize
 // uint32 numLayers (must be 1)
-// uint32 reserved
+// uint32 outputHead (LSTM_HEAD_BYTE or LSTM_HEAD_NIBBLE, plus LSTM_SPARSE_* flags)
 // Then float32 weights in order:
 // w_ih (4H*I), w_hh (4H*H),
 // b_ih (4H), b_hh (4H),
-// w_out (256*H), b_out (256)
+// LSTM_HEAD_BYTE:   w_out (256*H), b_out (256)
+// LSTM_HEAD_NIBBLE: w_hi (16*H), b_hi (16), w_lo (256*H), b_lo (256)
+// With LSTM_SPARSE_HH / LSTM_SPARSE_OUT, w_hh / w_out is a block-sparse
+// record (block_sparse.h) instead of the dense array.
+// Optional primed states (primed_state.h, h and c) follow the weights.
 bool TinyLstmModel::load_from_file(const std::string& path)
 {
+    TraceSpan span("model_load", "model");
     std::ifstream ifs(path, std::ios::binary);
     if (!ifs) return false;
 
-    uint32_t inputSize = 0, hiddenSize = 0, numLayers = 0, reserved = 0;
+    uint32_t inputSize = 0, hiddenSize = 0, numLayers = 0, outputHead = 0;
     ifs.read((char*)&inputSize, sizeof(uint32_t));
     ifs.read((char*)&hiddenSize, sizeof(uint32_t));
     ifs.read((char*)&numLayers, sizeof(uint32_t));
-    ifs.read((char*)&reserved, sizeof(uint32_t));
+    ifs.read((char*)&outputHead, sizeof(uint32_t));
 
     if (!ifs) return false;
     if (inputSize != 256 || numLayers != 1) return false;
+    if (hiddenSize == 0 || hiddenSize > kMaxHiddenSize) return false;
+
+    const uint32_t flags = outputHead & ~LSTM_HEAD_MASK;
+    outputHead &= LSTM_HEAD_MASK;
+    if (outputHead != LSTM_HEAD_BYTE && outputHead != LSTM_HEAD_NIBBLE) return false;
+    if (flags & ~(LSTM_SPARSE_HH | LSTM_SPARSE_OUT)) return false;
+    if ((flags & LSTM_SPARSE_OUT) && outputHead != LSTM_HEAD_BYTE) return false;
 
     weights_.inputSize = inputSize;
     weights_.hiddenSize = hiddenSize;
     weights_.numLayers = numLayers;
+    weights_.outputHead = outputHead;
 
     size_t H = hiddenSize;
     size_t I = inputSize;
@@ -50,22 +68,60 @@ bool TinyLstmModel::load_from_file(const std::string& path)
     };
 
     if (!read_vec(weights_.w_ih, 4 * H * I)) return false;
-    if (!read_vec(weights_.w_hh, 4 * H * H)) return false;
+    weights_.w_hh.clear();
+    weights_.w_hh_sparse = BlockSparseMatrix();
+    if (flags & LSTM_SPARSE_HH) {
+        if (!read_block_sparse(ifs, (uint32_t)(4 * H), (uint32_t)H, weights_.w_hh_sparse)) return false;
+    } else {
+        if (!read_vec(weights_.w_hh, 4 * H * H)) return false;
+    }
     if (!read_vec(weights_.b_ih, 4 * H)) return false;
     if (!read_vec(weights_.b_hh, 4 * H)) return false;
-    if (!read_vec(weights_.w_out, 256 * H)) return false;
-    if (!read_vec(weights_.b_out, 256)) return false;
+    if (outputHead == LSTM_HEAD_NIBBLE) {
+        if (!read_vec(weights_.w_hi, 16 * H)) return false;
+        if (!read_vec(weights_.b_hi, 16)) return false;
+        if (!read_vec(weights_.w_lo, 256 * H)) return false;
+        if (!read_vec(weights_.b_lo, 256)) return false;
+        weights_.w_out.clear();
+        weights_.b_out.clear();
+        weights_.w_out_sparse = BlockSparseMatrix();
+    } else {
+        weights_.w_out.clear();
+        weights_.w_out_sparse = BlockSparseMatrix();
+        if (flags & LSTM_SPARSE_OUT) {
+            if (!read_block_sparse(ifs, 256, (uint32_t)H, weights_.w_out_sparse)) return false;
+        } else {
+            if (!read_vec(weights_.w_out, 256 * H)) return false;
+        }
+        if (!read_vec(weights_.b_out, 256)) return false;
+        weights_.w_hi.clear();
+        weights_.b_hi.clear();
+        weights_.w_lo.clear();
+        weights_.b_lo.clear();
+    }
+    if (!read_primed_states(ifs, hiddenSize, 2, primed_)) return false;
 
     // Hash all weights (FNV-1a)
+    const uint64_t hashStart = trace_enabled() ? trace_now_ns() : 0;
     uint64_t hash = 1469598103934665603ull;
-    auto hash_floats = [&](const std::vector<float>& v) {
-        const uint8_t* bytes = (const uint8_t*)v.data();
-        size_t n = v.size() * sizeof(float);
+    auto hash_bytes = [&](const void* data, size_t n) {
+        const uint8_t* bytes = (const uint8_t*)data;
         for (size_t i = 0; i < n; i++) {
             hash ^= bytes[i];
             hash *= 1099511628211ull;
         }
     };
+    auto hash_floats = [&](const std::vector<float>& v) {
+        hash_bytes(v.data(), v.size() * sizeof(float));
+    };
+    // Dense models hash exactly as before; a sparse matrix adds its layout.
+    auto hash_sparse = [&](const BlockSparseMatrix& m) {
+        if (m.empty()) return;
+        hash_bytes(&m.block, sizeof(m.block));
+        hash_bytes(m.rowPtr.data(), m.rowPtr.size() * sizeof(uint32_t));
+        hash_bytes(m.colIdx.data(), m.colIdx.size() * sizeof(uint32_t));
+        hash_floats(m.values);
+    };
 
     hash_floats(weights_.w_ih);
     hash_floats(weights_.w_hh);
@@ -73,92 +129,320 @@ bool TinyLstmModel::load_from_file(const std::string& path)
     hash_floats(weights_.b_hh);
     hash_floats(weights_.w_out);
     hash_floats(weights_.b_out);
+    hash_floats(weights_.w_hi);
+    hash_floats(weights_.b_hi);
+    hash_floats(weights_.w_lo);
+    hash_floats(weights_.b_lo);
+    hash_sparse(weights_.w_hh_sparse);
+    hash_sparse(weights_.w_out_sparse);
 
     modelHash_ = hash;
-    modelId_ = 1;
+    if (hashStart) trace_record("model_hash", "model", hashStart, trace_now_ns());
+    modelId_ = outputHead == LSTM_HEAD_NIBBLE ? MODEL_ID_TINY_LSTM_NIBBLE
+                                             : MODEL_ID_TINY_LSTM;
+
+    quantize_weights();
 
     return true;
 }
 
-std::unique_ptr<ModelContext> TinyLstmModel::create_context() const
+void TinyLstmModel::quantize_weights()
 {
-    auto ctx = std::make_unique<ModelContext>();
+    TraceSpan span("quantize", "model");
+    auto quantize = [](const std::vector<float>& v, std::vector<int16_t>& out) {
+        out.resize(v.size());
+        for (size_t i = 0; i < v.size(); i++)
+            out[i] = fixed::quantize_weight(v[i]);
+    };
 
-    // Initialize arrays to 0
-    for (size_t i = 0; i < 256; i++) {
-        ctx->h[i] = 0.0f;
-        ctx->c[i] = 0.0f;
+    quantize(weights_.w_ih, weightsQ_.w_ih);
+    quantize(weights_.w_hh, weightsQ_.w_hh);
+    quantize(weights_.w_out, weightsQ_.w_out);
+    quantize(weights_.w_hi, weightsQ_.w_hi);
+    quantize(weights_.w_lo, weightsQ_.w_lo);
+    quantize_block_sparse(weights_.w_hh_sparse);
+    quantize_block_sparse(weights_.w_out_sparse);
+
+    // b_ih and b_hh are folded into one Q12 gate bias.
+    size_t G = weights_.b_ih.size();
+    weightsQ_.b_gates.resize(G);
+    for (size_t i = 0; i < G; i++) {
+        int32_t b = (int32_t)fixed::quantize_weight(weights_.b_ih[i]) +
+                    (int32_t)fixed::quantize_weight(weights_.b_hh[i]);
+        weightsQ_.b_gates[i] = b;
     }
 
+    auto quantize_bias = [](const std::vector<float>& v, std::vector<int32_t>& out) {
+        out.resize(v.size());
+        for (size_t i = 0; i < v.size(); i++)
+            out[i] = fixed::quantize_weight(v[i]);
+    };
+
+    quantize_bias(weights_.b_out, weightsQ_.b_out);
+    quantize_bias(weights_.b_hi, weightsQ_.b_hi);
+    quantize_bias(weights_.b_lo, weightsQ_.b_lo);
+}
+
+std::unique_ptr<ModelContext> TinyLstmModel::create_context() const
+{
+    auto ctx = std::make_unique<ModelContext>(weights_.hiddenSize);
+    primed_.apply(*ctx);
+
     return ctx;
 }
 
+size_t TinyLstmModel::weight_bytes() const
+{
+    // Per byte: one column of W_ih, all of W_hh, and the output head (the
+    // nibble head reads W_hi and one 16-row block of W_lo). Block-sparse
+    // matrices count their stored tiles plus the u32 tile indices.
+    const size_t H = weights_.hiddenSize;
+    const size_t valueSize = fixedPoint_ ? sizeof(int16_t) : sizeof(float);
+    auto matrix_bytes = [&](const BlockSparseMatrix& m, size_t denseValues) {
+        if (m.empty()) return denseValues * valueSize;
+        return m.values.size() * valueSize +
+               (m.rowPtr.size() + m.colIdx.size()) * sizeof(uint32_t);
+    };
+
+    size_t bytes = 4 * H * valueSize + matrix_bytes(weights_.w_hh_sparse, 4 * H * H);
+    if (nibble_output()) {
+        bytes += (16 * H + 16 * H) * valueSize;
+    } else {
+        bytes += matrix_bytes(weights_.w_out_sparse, 256 * H);
+    }
+    return bytes;
+}
+
 static inline float sigmoid(float x)
 {
     return 1.0f / (1.0f + std::exp(-x));
 }
 
-void TinyLstmModel::step(
+// Step-team shares are multiples of 16 units (one cache line of floats),
+// so members never write the same line of c or the hidden vector.
+static constexpr size_t kStepAlign = 16;
+
+void TinyLstmModel::set_step_threads(unsigned threads)
+{
+    if (threads <= 1) {
+        team_.reset();
+    } else if (!team_ || team_->size() != threads) {
+        team_ = std::make_shared<StepTeam>(threads);
+    }
+}
+
+void TinyLstmModel::split_rows(size_t n, const std::function<void(size_t lo, size_t hi)>& fn) const
+{
+    if (!team_) {
+        fn(0, n);
+        return;
+    }
+    const unsigned members = team_->size();
+    team_->run([&](unsigned m) {
+        size_t lo, hi;
+        StepTeam::share(n, members, m, kStepAlign, lo, hi);
+        if (lo < hi) fn(lo, hi);
+    });
+}
+
+// c = f * c + i * g; h = o * tanh(c) for one unit.
+static inline float lstm_update(const float gate[4], float& c)
+{
+    float i_t = sigmoid(gate[0]);
+    float f_t = sigmoid(gate[1]);
+    float g_t = std::tanh(gate[2]);
+    float o_t = sigmoid(gate[3]);
+
+    c = f_t * c + i_t * g_t;
+    return o_t * std::tanh(c);
+}
+
+void TinyLstmModel::step_units(
     ModelContext& ctx,
     uint8_t xByte,
-    std::vector<float>& outHidden
+    size_t lo,
+    size_t hi,
+    float* outHidden
 ) const
 {
     size_t H = weights_.hiddenSize;
     size_t I = weights_.inputSize;
 
-    if (outHidden.size() != H)
-        outHidden.assign(H, 0.0f);
-
-    const float* hPrev = ctx.h;
-    float* cPrev = ctx.c;
-
+    const float* hPrev = ctx.h.data();
     const auto& w_ih = weights_.w_ih;
     const auto& w_hh = weights_.w_hh;
     const auto& b_ih = weights_.b_ih;
     const auto& b_hh = weights_.b_hh;
 
-    std::vector<float> gates(4 * H);
+    // gates = (bi + bh) + W_ih * x (one-hot) + W_hh * hPrev, summed in
+    // the same order for every row however the units are split.
+    for (size_t i = lo; i < hi; i++) {
+        float gate[4];
+        for (size_t k = 0; k < 4; k++) {
+            size_t row = k * H + i;
+            float acc = 0.0f;
+            const float* Wrow = &w_hh[row * H];
+            for (size_t j = 0; j < H; j++)
+                acc += Wrow[j] * hPrev[j];
+            gate[k] = (b_ih[row] + b_hh[row] + w_ih[row * I + xByte]) + acc;
+        }
+        outHidden[i] = lstm_update(gate, ctx.c[i]);
+    }
+}
 
-    // gates = bi + bh
-    for (size_t i = 0; i < 4 * H; i++)
-        gates[i] = b_ih[i] + b_hh[i];
+void TinyLstmModel::step(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    size_t H = weights_.hiddenSize;
+    size_t I = weights_.inputSize;
 
-    // W_ih * x  (one-hot input)
-    for (size_t row = 0; row < 4 * H; row++) {
-        gates[row] += w_ih[row * I + xByte];
+    if (weights_.w_hh_sparse.empty()) {
+        split_rows(H, [&](size_t lo, size_t hi) { step_units(ctx, xByte, lo, hi, outHidden); });
+    } else {
+        const auto& w_ih = weights_.w_ih;
+        const auto& b_ih = weights_.b_ih;
+        const auto& b_hh = weights_.b_hh;
+
+        // gates = bi + bh + W_ih * x, then the sparse W_hh * hPrev
+        std::vector<float> gates(4 * H);
+        for (size_t row = 0; row < 4 * H; row++)
+            gates[row] = b_ih[row] + b_hh[row] + w_ih[row * I + xByte];
+        bsr_matvec_add(weights_.w_hh_sparse, ctx.h.data(), gates.data());
+
+        for (size_t i = 0; i < H; i++) {
+            float gate[4] = { gates[i], gates[H + i], gates[2 * H + i], gates[3 * H + i] };
+            outHidden[i] = lstm_update(gate, ctx.c[i]);
+        }
     }
 
-    // W_hh * hPrev
-    for (size_t row = 0; row < 4 * H; row++) {
-        float acc = 0.0f;
-        const float* Wrow = &w_hh[row * H];
-        for (size_t j = 0; j < H; j++)
-            acc += Wrow[j] * hPrev[j];
-        gates[row] += acc;
+    // Copy back hidden state to ModelContext (only now: every unit reads
+    // the previous h).
+    std::copy(outHidden, outHidden + H, ctx.h.begin());
+}
+
+void TinyLstmModel::advance(
+    ModelContext& ctx,
+    uint8_t prevByte,
+    float* outHidden
+) const
+{
+    if (fixedPoint_)
+        step_fixed(ctx, prevByte, outHidden);
+    else
+        step(ctx, prevByte, outHidden);
+}
+
+void TinyLstmModel::output_probs(
+    const float* hidden,
+    size_t count,
+    float* outProbs
+) const
+{
+    size_t H = weights_.hiddenSize;
+
+    if (nibble_output()) {
+        // Full byte distribution p(hi) * p(lo | hi); the coder itself uses
+        // the cheaper two-symbol path.
+        float hiProbs[16];
+        float loProbs[16];
+        for (size_t p = 0; p < count; p++) {
+            const float* h = hidden + p * H;
+            high_nibble_probs(h, hiProbs);
+            for (uint32_t hi = 0; hi < 16; hi++) {
+                low_nibble_probs(h, (uint8_t)hi, loProbs);
+                for (uint32_t lo = 0; lo < 16; lo++)
+                    outProbs[p * 256 + hi * 16 + lo] = hiProbs[hi] * loProbs[lo];
+            }
+        }
+        return;
     }
 
-    // Split gates
-    float* iGate = gates.data();
-    float* fGate = gates.data() + H;
-    float* gGate = gates.data() + 2 * H;
-    float* oGate = gates.data() + 3 * H;
+    if (fixedPoint_) {
+        output_probs_fixed(hidden, count, outProbs);
+        return;
+    }
 
-    // LSTM update
-    for (size_t i = 0; i < H; i++) {
-        float i_t = sigmoid(iGate[i]);
-        float f_t = sigmoid(fGate[i]);
-        float g_t = std::tanh(gGate[i]);
-        float o_t = sigmoid(oGate[i]);
+    const auto& b_out = weights_.b_out;
+    const BlockSparseMatrix& w_sparse = weights_.w_out_sparse;
+
+    if (!w_sparse.empty()) {
+        // One sparse mat-vec per position; logits = b + W_out*h.
+        float logits[256];
+        for (size_t p = 0; p < count; p++) {
+            float acc[256] = {};
+            bsr_matvec_add(w_sparse, hidden + p * H, acc);
+            for (size_t i = 0; i < 256; i++)
+                logits[i] = b_out[i] + acc[i];
+            softmax(logits, 256, outProbs + p * 256);
+        }
+        return;
+    }
 
-        cPrev[i] = f_t * cPrev[i] + i_t * g_t;
-        outHidden[i] = o_t * std::tanh(cPrev[i]);
+    if (team_) {
+        std::vector<float> logits(count * 256);
+        split_rows(256, [&](size_t lo, size_t hi) {
+            byte_output_logits(weights_.w_out.data(), b_out.data(), H, hidden, count, lo, hi, logits.data());
+        });
+        for (size_t p = 0; p < count; p++)
+            softmax(&logits[p * 256], 256, outProbs + p * 256);
+        return;
     }
 
-    // Copy back hidden state to ModelContext
-    for (size_t i = 0; i < H; i++) {
-        ctx.h[i] = outHidden[i];
+    byte_output_probs(weights_.w_out.data(), b_out.data(), H, hidden, count, outProbs);
+}
+
+void TinyLstmModel::output_probs_subset(
+    const float* hidden,
+    size_t count,
+    const uint8_t* symbols,
+    size_t n,
+    float* outProbs
+) const
+{
+    // The nibble head and a sparse W_out produce every row anyway.
+    if (nibble_output() || !weights_.w_out_sparse.empty()) {
+        ICompressionModel::output_probs_subset(hidden, count, symbols, n, outProbs);
+        return;
+    }
+
+    size_t H = weights_.hiddenSize;
+
+    if (fixedPoint_) {
+        const auto& w_out = weightsQ_.w_out;
+        const auto& b_out = weightsQ_.b_out;
+        if (!team_) {
+            byte_output_probs_rows_fixed(w_out.data(), b_out.data(), H, hidden, count, symbols, n, outProbs);
+            return;
+        }
+        std::vector<int16_t> hq(count * H);
+        for (size_t k = 0; k < count * H; k++)
+            hq[k] = (int16_t)(int32_t)(hidden[k] * kActScale);
+        std::vector<int64_t> logits(count * n);
+        split_rows(n, [&](size_t lo, size_t hi) {
+            byte_output_logits_rows_fixed(w_out.data(), b_out.data(), H, hq.data(), count, symbols, n,
+                                          lo, hi, logits.data());
+        });
+        for (size_t p = 0; p < count; p++)
+            softmax_fixed(&logits[p * n], n, outProbs + p * n);
+        return;
     }
+
+    const auto& w_out = weights_.w_out;
+    const auto& b_out = weights_.b_out;
+    if (!team_) {
+        byte_output_probs_rows(w_out.data(), b_out.data(), H, hidden, count, symbols, n, outProbs);
+        return;
+    }
+    std::vector<float> logits(count * n);
+    split_rows(n, [&](size_t lo, size_t hi) {
+        byte_output_logits_rows(w_out.data(), b_out.data(), H, hidden, count, symbols, n, lo, hi,
+                                logits.data());
+    });
+    for (size_t p = 0; p < count; p++)
+        softmax(&logits[p * n], n, outProbs + p * n);
 }
 
 void TinyLstmModel::predict_next(
@@ -170,47 +454,228 @@ void TinyLstmModel::predict_next(
 {
     if (outSize < 256) return;
 
+    std::vector<float> hNew(weights_.hiddenSize);
+    advance(ctx, prevByte, hNew.data());
+    output_probs(hNew.data(), 1, outProbs);
+}
+
+// Fixed-point update of one unit from its Q26 gates; c and h are stored
+// as Q14 floats. Returns the new h.
+static inline float lstm_update_fixed(const int64_t gate[4], float& cState, float& hState)
+{
+    using namespace fixed;
+
+    const int32_t* sig = sigmoid_lut();
+    const int32_t* th = tanh_lut();
+
+    int64_t i_t = sig[lut_index(gate[0], kAccFrac)];
+    int64_t f_t = sig[lut_index(gate[1], kAccFrac)];
+    int64_t g_t = th[lut_index(gate[2], kAccFrac)];
+    int64_t o_t = sig[lut_index(gate[3], kAccFrac)];
+
+    int64_t cPrev = (int64_t)(cState * kActScale);
+    int64_t c = rshift_round(f_t * cPrev + i_t * g_t, kActFrac);
+    if (c > kCellLimit) c = kCellLimit;
+    if (c < -kCellLimit) c = -kCellLimit;
+
+    int64_t h = rshift_round(o_t * th[lut_index(c, kActFrac)], kActFrac);
+
+    cState = (float)c * kActInvScale;
+    hState = (float)h * kActInvScale;
+    return hState;
+}
+
+void TinyLstmModel::step_fixed(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    using namespace fixed;
+
     size_t H = weights_.hiddenSize;
-    std::vector<float> hNew(H);
+    size_t I = weights_.inputSize;
 
-    step(ctx, prevByte, hNew);
+    std::vector<int16_t> hPrev(H);
+    for (size_t j = 0; j < H; j++)
+        hPrev[j] = (int16_t)(int32_t)(ctx.h[j] * kActScale);
 
-    const auto& w_out = weights_.w_out;
-    const auto& b_out = weights_.b_out;
+    // Units read hPrev, not ctx.h, so they may update ctx.h in place.
+    if (weights_.w_hh_sparse.empty()) {
+        split_rows(H, [&](size_t lo, size_t hi) {
+            step_units_fixed(ctx, hPrev.data(), xByte, lo, hi, outHidden);
+        });
+        return;
+    }
 
-    float logits[256];
+    const auto& w_ih = weightsQ_.w_ih;
+    const auto& b_gates = weightsQ_.b_gates;
 
-    // logits = W_out*h + b
-    for (size_t i = 0; i < 256; i++) {
-        float acc = b_out[i];
-        const float* row = &w_out[i * H];
-        for (size_t j = 0; j < H; j++)
-            acc += row[j] * hNew[j];
-        logits[i] = acc;
+    // gates = b + W_ih * x (one-hot) + W_hh * hPrev, all in Q26.
+    // Integer sums are exact, so a block-sparse W_hh matches its dense form.
+    std::vector<int64_t> gates(4 * H);
+    bsr_matvec_add_q(weights_.w_hh_sparse, hPrev.data(), gates.data());
+    for (size_t row = 0; row < 4 * H; row++) {
+        int64_t bias = (int64_t)b_gates[row] + w_ih[row * I + xByte];
+        gates[row] += bias << kActFrac;
+    }
+
+    for (size_t i = 0; i < H; i++) {
+        int64_t gate[4] = { gates[i], gates[H + i], gates[2 * H + i], gates[3 * H + i] };
+        outHidden[i] = lstm_update_fixed(gate, ctx.c[i], ctx.h[i]);
+    }
+}
+
+void TinyLstmModel::step_units_fixed(
+    ModelContext& ctx,
+    const int16_t* hPrev,
+    uint8_t xByte,
+    size_t lo,
+    size_t hi,
+    float* outHidden
+) const
+{
+    using namespace fixed;
+
+    size_t H = weights_.hiddenSize;
+    size_t I = weights_.inputSize;
+
+    const auto& w_ih = weightsQ_.w_ih;
+    const auto& w_hh = weightsQ_.w_hh;
+    const auto& b_gates = weightsQ_.b_gates;
+
+    // Integer sums are exact, so any vectorized reduction order (or split
+    // of the units) gives the same result.
+    for (size_t i = lo; i < hi; i++) {
+        int64_t gate[4];
+        for (size_t k = 0; k < 4; k++) {
+            size_t row = k * H + i;
+            int64_t acc = 0;
+            const int16_t* Wrow = &w_hh[row * H];
+            for (size_t j = 0; j < H; j++)
+                acc += (int32_t)Wrow[j] * (int32_t)hPrev[j];
+            int64_t bias = (int64_t)b_gates[row] + w_ih[row * I + xByte];
+            gate[k] = acc + (bias << kActFrac);
+        }
+        outHidden[i] = lstm_update_fixed(gate, ctx.c[i], ctx.h[i]);
     }
+}
 
-    // Softmax
-    float maxLogit = logits[0];
-    for (size_t i = 1; i < 256; i++)
-        if (logits[i] > maxLogit) maxLogit = logits[i];
+void TinyLstmModel::output_probs_fixed(
+    const float* hidden,
+    size_t count,
+    float* outProbs
+) const
+{
+    using namespace fixed;
 
-    float sum = 0.0f;
-    for (size_t i = 0; i < 256; i++) {
-        float e = std::exp(logits[i] - maxLogit);
-        outProbs[i] = e;
-        sum += e;
+    size_t H = weights_.hiddenSize;
+    const auto& b_out = weightsQ_.b_out;
+
+    if (weights_.w_out_sparse.empty() && team_) {
+        std::vector<int16_t> hq(count * H);
+        for (size_t k = 0; k < count * H; k++)
+            hq[k] = (int16_t)(int32_t)(hidden[k] * kActScale);
+        std::vector<int64_t> logits(count * 256);
+        split_rows(256, [&](size_t lo, size_t hi) {
+            byte_output_logits_fixed(weightsQ_.w_out.data(), b_out.data(), H, hq.data(), count, lo, hi,
+                                     logits.data());
+        });
+        for (size_t p = 0; p < count; p++)
+            softmax_fixed(&logits[p * 256], 256, outProbs + p * 256);
+        return;
+    }
+    if (weights_.w_out_sparse.empty()) {
+        byte_output_probs_fixed(weightsQ_.w_out.data(), b_out.data(), H, hidden, count, outProbs);
+        return;
     }
 
-    if (sum <= 0.0f) {
-        float p = 1.0f / 256.0f;
+    std::vector<int16_t> hq(H);
+    int64_t logits[256];
+    for (size_t p = 0; p < count; p++) {
+        for (size_t j = 0; j < H; j++)
+            hq[j] = (int16_t)(int32_t)(hidden[p * H + j] * kActScale);
+        for (size_t i = 0; i < 256; i++) logits[i] = 0;
+        bsr_matvec_add_q(weights_.w_out_sparse, hq.data(), logits);
         for (size_t i = 0; i < 256; i++)
-            outProbs[i] = p;
+            logits[i] += (int64_t)b_out[i] << kActFrac;
+        softmax_fixed(logits, 256, outProbs + p * 256);
+    }
+}
+
+void TinyLstmModel::head_probs(
+    const float* h,
+    const std::vector<float>& W,
+    const std::vector<float>& b,
+    const std::vector<int16_t>& Wq,
+    const std::vector<int32_t>& bq,
+    size_t firstRow,
+    size_t rows,
+    float* outProbs
+) const
+{
+    size_t H = weights_.hiddenSize;
+
+    if (fixedPoint_) {
+        using namespace fixed;
+        std::vector<int16_t> hq(H);
+        for (size_t j = 0; j < H; j++)
+            hq[j] = (int16_t)(int32_t)(h[j] * kActScale);
+
+        int64_t logits[16] = {};
+        for (size_t i = 0; i < rows; i++) {
+            const int16_t* row = &Wq[(firstRow + i) * H];
+            int64_t acc = 0;
+            for (size_t j = 0; j < H; j++)
+                acc += (int32_t)row[j] * (int32_t)hq[j];
+            logits[i] = acc + ((int64_t)bq[firstRow + i] << kActFrac);
+        }
+        softmax_fixed(logits, rows, outProbs);
         return;
     }
 
-    float invSum = 1.0f / sum;
-    for (size_t i = 0; i < 256; i++)
-        outProbs[i] *= invSum;
+    float logits[16];
+    for (size_t i = 0; i < rows; i++) {
+        const float* row = &W[(firstRow + i) * H];
+        float acc = b[firstRow + i];
+        for (size_t j = 0; j < H; j++)
+            acc += row[j] * h[j];
+        logits[i] = acc;
+    }
+    softmax(logits, rows, outProbs);
+}
+
+void TinyLstmModel::high_nibble_probs(const float* h, float* outProbs) const
+{
+    head_probs(h, weights_.w_hi, weights_.b_hi, weightsQ_.w_hi, weightsQ_.b_hi,
+               0, 16, outProbs);
+}
+
+void TinyLstmModel::low_nibble_probs(const float* h, uint8_t highNibble, float* outProbs) const
+{
+    head_probs(h, weights_.w_lo, weights_.b_lo, weightsQ_.w_lo, weightsQ_.b_lo,
+               (size_t)(highNibble & 15u) * 16, 16, outProbs);
+}
+
+void TinyLstmModel::predict_high_nibble(
+    ModelContext& ctx,
+    uint8_t prevByte,
+    float* outProbs
+) const
+{
+    std::vector<float> hNew(weights_.hiddenSize);
+    advance(ctx, prevByte, hNew.data());
+    high_nibble_probs(hNew.data(), outProbs);
+}
+
+void TinyLstmModel::predict_low_nibble(
+    const ModelContext& ctx,
+    uint8_t highNibble,
+    float* outProbs
+) const
+{
+    // advance() leaves the new hidden vector in ctx.h.
+    low_nibble_probs(ctx.h.data(), highNibble, outProbs);
 }
 
 } // namespace neurozip
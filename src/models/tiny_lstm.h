@@ -1,14 +1,28 @@
 #pragma once
 
 #include "core/model_interface.h"
+#include "core/step_team.h"
+#include "block_sparse.h"
+#include "primed_state.h"
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace neurozip {
 
+// Output head layouts (4th word of the model file header)
+constexpr uint32_t LSTM_HEAD_BYTE   = 0; // W_out: 256-way softmax
+constexpr uint32_t LSTM_HEAD_NIBBLE = 1; // W_hi: 16-way, then W_lo[hi]: 16-way
+constexpr uint32_t LSTM_HEAD_MASK   = 0xFF;
+
+// Layout flags (also in the 4th header word): the matrix is stored block
+// sparse (see block_sparse.h) instead of as a dense float32 array.
+constexpr uint32_t LSTM_SPARSE_HH  = 1u << 8;  // W_hh
+constexpr uint32_t LSTM_SPARSE_OUT = 1u << 9;  // W_out (byte head only)
+
 struct LstmWeights {
     uint32_t inputSize;   // should be 256
     uint32_t hiddenSize;
@@ -29,8 +43,35 @@ struct LstmWeights {
     // b_out: [256]
     std::vector<float> w_out;
     std::vector<float> b_out;
+
+    // Nibble-factored head (LSTM_HEAD_NIBBLE) instead of W_out:
+    // W_hi: [16, H], b_hi: [16]         -> high nibble
+    // W_lo: [16*16, H], b_lo: [16*16]   -> low nibble, 16 rows per high nibble
+    uint32_t outputHead = LSTM_HEAD_BYTE;
+    std::vector<float> w_hi;
+    std::vector<float> b_hi;
+    std::vector<float> w_lo;
+    std::vector<float> b_lo;
+
+    // Pruned models: with LSTM_SPARSE_HH / LSTM_SPARSE_OUT the matrix lives
+    // here and the dense w_hh / w_out is empty.
+    BlockSparseMatrix w_hh_sparse;
+    BlockSparseMatrix w_out_sparse;
 };
 
+// Quantized copy of LstmWeights for fixed-point inference (Q12, see
+// fixed_point.h). b_ih and b_hh are folded into a single gate bias.
+struct LstmWeightsQ {
+    std::vector<int16_t> w_ih;
+    std::vector<int16_t> w_hh;
+    std::vector<int32_t> b_gates;
+    std::vector<int16_t> w_out;
+    std::vector<int32_t> b_out;
+    std::vector<int16_t> w_hi;
+    std::vector<int32_t> b_hi;
+    std::vector<int16_t> w_lo;
+    std::vector<int32_t> b_lo;
+};
 
 
 class TinyLstmModel : public ICompressionModel {
@@ -49,19 +90,128 @@ public:
         size_t outSize
     ) const override;
 
+    size_t hidden_size() const override { return weights_.hiddenSize; }
+
+    void advance(
+        ModelContext& ctx,
+        uint8_t prevByte,
+        float* outHidden
+    ) const override;
+
+    void output_probs(
+        const float* hidden,
+        size_t count,
+        float* outProbs
+    ) const override;
+
+    void output_probs_subset(
+        const float* hidden,
+        size_t count,
+        const uint8_t* symbols,
+        size_t n,
+        float* outProbs
+    ) const override;
+
+    bool nibble_output() const override { return weights_.outputHead == LSTM_HEAD_NIBBLE; }
+
+    void predict_high_nibble(
+        ModelContext& ctx,
+        uint8_t prevByte,
+        float* outProbs
+    ) const override;
+
+    void predict_low_nibble(
+        const ModelContext& ctx,
+        uint8_t highNibble,
+        float* outProbs
+    ) const override;
+
     uint32_t model_id() const override { return modelId_; }
     uint64_t model_hash() const override { return modelHash_; }
 
+    /// Switch between float inference and the deterministic fixed-point
+    /// path. Quantized weights are prepared at load time, so this is cheap.
+    void set_fixed_point(bool enable) override { fixedPoint_ = enable; }
+    bool fixed_point() const override { return fixedPoint_; }
+
+    uint32_t primed_state_count() const override { return primed_.count(); }
+    bool set_primed_state(uint32_t id) override { return primed_.select(id); }
+    uint32_t primed_state() const override { return primed_.selected; }
+    uint32_t primed_state_hash() const override { return primed_.selectedHash; }
+    const PrimedStates& primed_states() const { return primed_; }
+
+    /// Dense W_hh is split by hidden unit (the four gate rows of each) and
+    /// the byte head's W_out by row; sparse matrices and the nibble head
+    /// stay on the calling thread. Clones share the team.
+    void set_step_threads(unsigned threads) override;
+    unsigned step_threads() const override { return team_ ? team_->size() : 1; }
+
+    size_t weight_bytes() const override;
+
+    std::unique_ptr<ICompressionModel> clone() const override {
+        return std::make_unique<TinyLstmModel>(*this);
+    }
+
 private:
     LstmWeights weights_;
+    LstmWeightsQ weightsQ_;
     uint32_t modelId_;
     uint64_t modelHash_;
+    bool fixedPoint_;
+    PrimedStates primed_;
+    std::shared_ptr<StepTeam> team_;
+
+    void quantize_weights();
+
+    // fn(lo, hi) over [0, n): one call, or one share per team member
+    // (always the same rows for the same member).
+    void split_rows(size_t n, const std::function<void(size_t lo, size_t hi)>& fn) const;
+
+    // Dense-W_hh step for hidden units [lo, hi): reads ctx.h (float) or
+    // hPrev (Q14), writes ctx.c and outHidden for those units only.
+    void step_units(ModelContext& ctx, uint8_t xByte, size_t lo, size_t hi, float* outHidden) const;
+    void step_units_fixed(
+        ModelContext& ctx,
+        const int16_t* hPrev,
+        uint8_t xByte,
+        size_t lo,
+        size_t hi,
+        float* outHidden
+    ) const;
 
     void step(
         ModelContext& ctx,
         uint8_t xByte,
-        std::vector<float>& outHidden
+        float* outHidden
+    ) const;
+
+    void step_fixed(
+        ModelContext& ctx,
+        uint8_t xByte,
+        float* outHidden
     ) const;
+
+    void output_probs_fixed(
+        const float* hidden,
+        size_t count,
+        float* outProbs
+    ) const;
+
+    // Softmax over rows [firstRow, firstRow + rows) of a dense head
+    // W * h + b (rows <= 16); uses Wq / bq in fixed-point mode.
+    void head_probs(
+        const float* h,
+        const std::vector<float>& W,
+        const std::vector<float>& b,
+        const std::vector<int16_t>& Wq,
+        const std::vector<int32_t>& bq,
+        size_t firstRow,
+        size_t rows,
+        float* outProbs
+    ) const;
+
+    void high_nibble_probs(const float* h, float* outProbs) const;
+    void low_nibble_probs(const float* h, uint8_t highNibble, float* outProbs) const;
 };
 
 } // namespace neurozip
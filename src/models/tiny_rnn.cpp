@@ -0,0 +1,366 @@
+#include "tiny_rnn.h"
+#include "fixed_point.h"
+#include "output_layer.h"
+#include "../core/trace.h"
+
+#include <cmath>
+#include <fstream>
+
+namespace neurozip {
+
+bool TinyRnnModel::load_from_file(const std::string& path)
+{
+    TraceSpan span("model_load", "model");
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+
+    uint32_t magic = 0, inputSize = 0, hiddenSize = 0, outputHead = 0;
+    ifs.read((char*)&magic, sizeof(uint32_t));
+    ifs.read((char*)&inputSize, sizeof(uint32_t));
+    ifs.read((char*)&hiddenSize, sizeof(uint32_t));
+    ifs.read((char*)&outputHead, sizeof(uint32_t));
+
+    if (!ifs) return false;
+    if (magic != RNN_MAGIC_GRU && magic != RNN_MAGIC_MGU) return false;
+    if (inputSize != 256 || outputHead != 0) return false;
+    // The state lives in ModelContext::h.
+    if (hiddenSize == 0 || hiddenSize > kMaxHiddenSize) return false;
+
+    RnnWeights w;
+    w.cell = magic == RNN_MAGIC_GRU ? RnnCell::Gru : RnnCell::Mgu;
+    w.inputSize = inputSize;
+    w.hiddenSize = hiddenSize;
+
+    const size_t H = hiddenSize;
+    const size_t G = (w.cell == RnnCell::Gru ? 3 : 2) * H;
+
+    auto read_vec = [&](std::vector<float>& v, size_t n) {
+        v.resize(n);
+        ifs.read((char*)v.data(), (std::streamsize)(n * sizeof(float)));
+        return (bool)ifs;
+    };
+
+    if (!read_vec(w.w_ih, G * inputSize)) return false;
+    if (!read_vec(w.w_hh, G * H)) return false;
+    if (!read_vec(w.b_ih, G)) return false;
+    if (!read_vec(w.b_hh, G)) return false;
+    if (!read_vec(w.w_out, 256 * H)) return false;
+    if (!read_vec(w.b_out, 256)) return false;
+    PrimedStates primed;
+    if (!read_primed_states(ifs, hiddenSize, 1, primed)) return false;
+
+    // Hash the magic and all weights (FNV-1a)
+    uint64_t hash = 1469598103934665603ull;
+    auto hash_bytes = [&](const void* data, size_t n) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < n; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    hash_bytes(&magic, sizeof(magic));
+    for (const auto* v : { &w.w_ih, &w.w_hh, &w.b_ih, &w.b_hh, &w.w_out, &w.b_out })
+        hash_bytes(v->data(), v->size() * sizeof(float));
+
+    weights_ = std::move(w);
+    primed_ = std::move(primed);
+    modelHash_ = hash;
+    quantize_weights();
+    return true;
+}
+
+void TinyRnnModel::quantize_weights()
+{
+    TraceSpan span("quantize", "model");
+    auto quantize = [](const std::vector<float>& v, std::vector<int16_t>& out) {
+        out.resize(v.size());
+        for (size_t i = 0; i < v.size(); i++)
+            out[i] = fixed::quantize_weight(v[i]);
+    };
+    auto quantize_bias = [](const std::vector<float>& v, std::vector<int32_t>& out) {
+        out.resize(v.size());
+        for (size_t i = 0; i < v.size(); i++)
+            out[i] = fixed::quantize_weight(v[i]);
+    };
+
+    quantize(weights_.w_ih, weightsQ_.w_ih);
+    quantize(weights_.w_hh, weightsQ_.w_hh);
+    quantize(weights_.w_out, weightsQ_.w_out);
+    quantize_bias(weights_.b_ih, weightsQ_.b_ih);
+    quantize_bias(weights_.b_hh, weightsQ_.b_hh);
+    quantize_bias(weights_.b_out, weightsQ_.b_out);
+}
+
+uint32_t TinyRnnModel::model_id() const
+{
+    return weights_.cell == RnnCell::Gru ? MODEL_ID_TINY_GRU : MODEL_ID_TINY_MGU;
+}
+
+std::unique_ptr<ModelContext> TinyRnnModel::create_context() const
+{
+    auto ctx = std::make_unique<ModelContext>(weights_.hiddenSize);
+    primed_.apply(*ctx);
+    return ctx;
+}
+
+size_t TinyRnnModel::weight_bytes() const
+{
+    // Per byte: one column of W_ih, all of W_hh and W_out.
+    const size_t H = weights_.hiddenSize;
+    const size_t G = gate_blocks() * H;
+    size_t values = G + G * H + 256 * H;
+    return values * (fixedPoint_ ? sizeof(int16_t) : sizeof(float));
+}
+
+static inline float sigmoid(float x)
+{
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+void TinyRnnModel::advance(
+    ModelContext& ctx,
+    uint8_t prevByte,
+    float* outHidden
+) const
+{
+    if (weights_.cell == RnnCell::Gru) {
+        if (fixedPoint_) step_gru_fixed(ctx, prevByte, outHidden);
+        else step_gru(ctx, prevByte, outHidden);
+    } else {
+        if (fixedPoint_) step_mgu_fixed(ctx, prevByte, outHidden);
+        else step_mgu(ctx, prevByte, outHidden);
+    }
+}
+
+void TinyRnnModel::output_probs(
+    const float* hidden,
+    size_t count,
+    float* outProbs
+) const
+{
+    const size_t H = weights_.hiddenSize;
+    if (fixedPoint_) {
+        byte_output_probs_fixed(weightsQ_.w_out.data(), weightsQ_.b_out.data(), H,
+                                hidden, count, outProbs);
+    } else {
+        byte_output_probs(weights_.w_out.data(), weights_.b_out.data(), H,
+                          hidden, count, outProbs);
+    }
+}
+
+void TinyRnnModel::output_probs_subset(
+    const float* hidden,
+    size_t count,
+    const uint8_t* symbols,
+    size_t n,
+    float* outProbs
+) const
+{
+    const size_t H = weights_.hiddenSize;
+    if (fixedPoint_) {
+        byte_output_probs_rows_fixed(weightsQ_.w_out.data(), weightsQ_.b_out.data(), H,
+                                     hidden, count, symbols, n, outProbs);
+    } else {
+        byte_output_probs_rows(weights_.w_out.data(), weights_.b_out.data(), H,
+                               hidden, count, symbols, n, outProbs);
+    }
+}
+
+void TinyRnnModel::predict_next(
+    ModelContext& ctx,
+    uint8_t prevByte,
+    float* outProbs,
+    size_t outSize
+) const
+{
+    if (outSize < 256) return;
+
+    std::vector<float> hNew(weights_.hiddenSize);
+    advance(ctx, prevByte, hNew.data());
+    output_probs(hNew.data(), 1, outProbs);
+}
+
+// GRU:
+//   r = sigmoid(W_ir x + b_ir + W_hr h + b_hr)
+//   z = sigmoid(W_iz x + b_iz + W_hz h + b_hz)
+//   n = tanh(W_in x + b_in + r * (W_hn h + b_hn))
+//   h' = (1 - z) * n + z * h
+void TinyRnnModel::step_gru(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    const size_t H = weights_.hiddenSize;
+    const size_t I = weights_.inputSize;
+    const auto& w_ih = weights_.w_ih;
+    const auto& w_hh = weights_.w_hh;
+    const auto& b_ih = weights_.b_ih;
+    const auto& b_hh = weights_.b_hh;
+    const float* hPrev = ctx.h.data();
+
+    // hh = W_hh * hPrev + b_hh; the input part is one column of W_ih.
+    std::vector<float> hh(3 * H);
+    for (size_t row = 0; row < 3 * H; row++) {
+        float acc = b_hh[row];
+        const float* Wrow = &w_hh[row * H];
+        for (size_t j = 0; j < H; j++)
+            acc += Wrow[j] * hPrev[j];
+        hh[row] = acc;
+    }
+
+    for (size_t i = 0; i < H; i++) {
+        float xr = w_ih[i * I + xByte] + b_ih[i];
+        float xz = w_ih[(H + i) * I + xByte] + b_ih[H + i];
+        float xn = w_ih[(2 * H + i) * I + xByte] + b_ih[2 * H + i];
+
+        float r = sigmoid(xr + hh[i]);
+        float z = sigmoid(xz + hh[H + i]);
+        float n = std::tanh(xn + r * hh[2 * H + i]);
+        outHidden[i] = (1.0f - z) * n + z * hPrev[i];
+    }
+
+    for (size_t i = 0; i < H; i++)
+        ctx.h[i] = outHidden[i];
+}
+
+// Minimal gated unit:
+//   f = sigmoid(W_if x + b_if + W_hf h + b_hf)
+//   n = tanh(W_in x + b_in + W_hn (f * h) + b_hn)
+//   h' = (1 - f) * h + f * n
+void TinyRnnModel::step_mgu(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    const size_t H = weights_.hiddenSize;
+    const size_t I = weights_.inputSize;
+    const auto& w_ih = weights_.w_ih;
+    const auto& w_hh = weights_.w_hh;
+    const auto& b_ih = weights_.b_ih;
+    const auto& b_hh = weights_.b_hh;
+    const float* hPrev = ctx.h.data();
+
+    std::vector<float> f(H), fh(H);
+    for (size_t i = 0; i < H; i++) {
+        float acc = w_ih[i * I + xByte] + b_ih[i] + b_hh[i];
+        const float* Wrow = &w_hh[i * H];
+        for (size_t j = 0; j < H; j++)
+            acc += Wrow[j] * hPrev[j];
+        f[i] = sigmoid(acc);
+        fh[i] = f[i] * hPrev[i];
+    }
+
+    for (size_t i = 0; i < H; i++) {
+        float acc = w_ih[(H + i) * I + xByte] + b_ih[H + i] + b_hh[H + i];
+        const float* Wrow = &w_hh[(H + i) * H];
+        for (size_t j = 0; j < H; j++)
+            acc += Wrow[j] * fh[j];
+        float n = std::tanh(acc);
+        outHidden[i] = (1.0f - f[i]) * hPrev[i] + f[i] * n;
+    }
+
+    for (size_t i = 0; i < H; i++)
+        ctx.h[i] = outHidden[i];
+}
+
+// Fixed-point steps: h is Q14 (stored in ctx.h as q / 2^14), gate
+// pre-activations Q26, gates Q14 from the LUTs; see fixed_point.h.
+void TinyRnnModel::step_gru_fixed(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    using namespace fixed;
+
+    const size_t H = weights_.hiddenSize;
+    const size_t I = weights_.inputSize;
+    const auto& w_ih = weightsQ_.w_ih;
+    const auto& w_hh = weightsQ_.w_hh;
+    const auto& b_ih = weightsQ_.b_ih;
+    const auto& b_hh = weightsQ_.b_hh;
+
+    std::vector<int16_t> hPrev(H);
+    for (size_t j = 0; j < H; j++)
+        hPrev[j] = (int16_t)(int32_t)(ctx.h[j] * kActScale);
+
+    std::vector<int64_t> hh(3 * H);
+    for (size_t row = 0; row < 3 * H; row++) {
+        int64_t acc = 0;
+        const int16_t* Wrow = &w_hh[row * H];
+        for (size_t j = 0; j < H; j++)
+            acc += (int32_t)Wrow[j] * (int32_t)hPrev[j];
+        hh[row] = acc + ((int64_t)b_hh[row] << kActFrac);
+    }
+
+    const int32_t* sig = sigmoid_lut();
+    const int32_t* th = tanh_lut();
+    const int64_t one = int64_t(1) << kActFrac;
+    auto x_part = [&](size_t row) {
+        return ((int64_t)w_ih[row * I + xByte] + b_ih[row]) << kActFrac;
+    };
+
+    for (size_t i = 0; i < H; i++) {
+        int64_t r = sig[lut_index(x_part(i) + hh[i], kAccFrac)];
+        int64_t z = sig[lut_index(x_part(H + i) + hh[H + i], kAccFrac)];
+        int64_t nPre = x_part(2 * H + i) + rshift_round(r * hh[2 * H + i], kActFrac);
+        int64_t n = th[lut_index(nPre, kAccFrac)];
+        int64_t h = rshift_round((one - z) * n + z * hPrev[i], kActFrac);
+
+        ctx.h[i] = (float)h * kActInvScale;
+        outHidden[i] = ctx.h[i];
+    }
+}
+
+void TinyRnnModel::step_mgu_fixed(
+    ModelContext& ctx,
+    uint8_t xByte,
+    float* outHidden
+) const
+{
+    using namespace fixed;
+
+    const size_t H = weights_.hiddenSize;
+    const size_t I = weights_.inputSize;
+    const auto& w_ih = weightsQ_.w_ih;
+    const auto& w_hh = weightsQ_.w_hh;
+    const auto& b_ih = weightsQ_.b_ih;
+    const auto& b_hh = weightsQ_.b_hh;
+
+    std::vector<int16_t> hPrev(H);
+    for (size_t j = 0; j < H; j++)
+        hPrev[j] = (int16_t)(int32_t)(ctx.h[j] * kActScale);
+
+    const int32_t* sig = sigmoid_lut();
+    const int32_t* th = tanh_lut();
+    const int64_t one = int64_t(1) << kActFrac;
+
+    std::vector<int64_t> f(H);
+    std::vector<int16_t> fh(H);
+    for (size_t i = 0; i < H; i++) {
+        int64_t acc = 0;
+        const int16_t* Wrow = &w_hh[i * H];
+        for (size_t j = 0; j < H; j++)
+            acc += (int32_t)Wrow[j] * (int32_t)hPrev[j];
+        int64_t bias = (int64_t)w_ih[i * I + xByte] + b_ih[i] + b_hh[i];
+        f[i] = sig[lut_index(acc + (bias << kActFrac), kAccFrac)];
+        fh[i] = (int16_t)rshift_round(f[i] * hPrev[i], kActFrac);
+    }
+
+    for (size_t i = 0; i < H; i++) {
+        int64_t acc = 0;
+        const int16_t* Wrow = &w_hh[(H + i) * H];
+        for (size_t j = 0; j < H; j++)
+            acc += (int32_t)Wrow[j] * (int32_t)fh[j];
+        int64_t bias = (int64_t)w_ih[(H + i) * I + xByte] + b_ih[H + i] + b_hh[H + i];
+        int64_t n = th[lut_index(acc + (bias << kActFrac), kAccFrac)];
+        int64_t h = rshift_round((one - f[i]) * hPrev[i] + f[i] * n, kActFrac);
+
+        ctx.h[i] = (float)h * kActInvScale;
+        outHidden[i] = ctx.h[i];
+    }
+}
+
+} // namespace neurozip
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "core/model_interface.h"
+#include "primed_state.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+// Cheaper recurrent cells than the LSTM: no cell state and fewer gate
+// blocks per step (W_hh has 3H rows for the GRU, 2H for the MGU against
+// 4H for the LSTM). Both use the byte output head.
+enum class RnnCell : uint32_t {
+    Gru, // r, z, n gates (PyTorch nn.GRU)
+    Mgu  // minimal gated unit: forget gate f and candidate n
+};
+
+// First word of the model file ("NZG1" / "NZM1" little-endian); never
+// 256, so the loader tells these files from LSTM ones.
+constexpr uint32_t RNN_MAGIC_GRU = 0x31475A4E;
+constexpr uint32_t RNN_MAGIC_MGU = 0x314D5A4E;
+
+struct RnnWeights {
+    RnnCell cell = RnnCell::Gru;
+    uint32_t inputSize = 256;
+    uint32_t hiddenSize = 0;
+
+    // G gate blocks of H rows each (G = 3 for the GRU, 2 for the MGU):
+    // W_ih: [G*H, I], W_hh: [G*H, H], b_ih: [G*H], b_hh: [G*H]
+    std::vector<float> w_ih;
+    std::vector<float> w_hh;
+    std::vector<float> b_ih;
+    std::vector<float> b_hh;
+
+    // W_out: [256, H], b_out: [256]
+    std::vector<float> w_out;
+    std::vector<float> b_out;
+};
+
+// Q12 copy for fixed-point inference. The biases stay separate because
+// the GRU applies b_hn inside the reset gate.
+struct RnnWeightsQ {
+    std::vector<int16_t> w_ih;
+    std::vector<int16_t> w_hh;
+    std::vector<int32_t> b_ih;
+    std::vector<int32_t> b_hh;
+    std::vector<int16_t> w_out;
+    std::vector<int32_t> b_out;
+};
+
+class TinyRnnModel : public ICompressionModel {
+public:
+    TinyRnnModel() = default;
+    ~TinyRnnModel() override = default;
+
+    // File layout (little-endian):
+    //   u32 magic (RNN_MAGIC_GRU or RNN_MAGIC_MGU)
+    //   u32 inputSize (256), u32 hiddenSize (1..kMaxHiddenSize), u32 outputHead (0)
+    //   float32 w_ih, w_hh, b_ih, b_hh, w_out, b_out
+    //   optional primed states (primed_state.h, h only)
+    bool load_from_file(const std::string& path);
+
+    RnnCell cell() const { return weights_.cell; }
+
+    std::unique_ptr<ModelContext> create_context() const override;
+
+    void predict_next(
+        ModelContext& ctx,
+        uint8_t prevByte,
+        float* outProbs,
+        size_t outSize
+    ) const override;
+
+    size_t hidden_size() const override { return weights_.hiddenSize; }
+
+    void advance(
+        ModelContext& ctx,
+        uint8_t prevByte,
+        float* outHidden
+    ) const override;
+
+    void output_probs(
+        const float* hidden,
+        size_t count,
+        float* outProbs
+    ) const override;
+
+    void output_probs_subset(
+        const float* hidden,
+        size_t count,
+        const uint8_t* symbols,
+        size_t n,
+        float* outProbs
+    ) const override;
+
+    uint32_t model_id() const override;
+    uint64_t model_hash() const override { return modelHash_; }
+
+    void set_fixed_point(bool enable) override { fixedPoint_ = enable; }
+    bool fixed_point() const override { return fixedPoint_; }
+
+    uint32_t primed_state_count() const override { return primed_.count(); }
+    bool set_primed_state(uint32_t id) override { return primed_.select(id); }
+    uint32_t primed_state() const override { return primed_.selected; }
+    uint32_t primed_state_hash() const override { return primed_.selectedHash; }
+    const PrimedStates& primed_states() const { return primed_; }
+
+    size_t weight_bytes() const override;
+
+    std::unique_ptr<ICompressionModel> clone() const override {
+        return std::make_unique<TinyRnnModel>(*this);
+    }
+
+private:
+    RnnWeights weights_;
+    RnnWeightsQ weightsQ_;
+    uint64_t modelHash_ = 0;
+    bool fixedPoint_ = false;
+    PrimedStates primed_;
+
+    size_t gate_blocks() const { return weights_.cell == RnnCell::Gru ? 3 : 2; }
+
+    void quantize_weights();
+
+    void step_gru(ModelContext& ctx, uint8_t xByte, float* outHidden) const;
+    void step_gru_fixed(ModelContext& ctx, uint8_t xByte, float* outHidden) const;
+    void step_mgu(ModelContext& ctx, uint8_t xByte, float* outHidden) const;
+    void step_mgu_fixed(ModelContext& ctx, uint8_t xByte, float* outHidden) const;
+};
+
+} // namespace neurozip
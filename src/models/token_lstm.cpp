@@ -0,0 +1,177 @@
+#include "token_lstm.h"
+#include "output_layer.h"
+#include "../core/trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace neurozip {
+
+bool TokenLstmModel::load_from_file(const std::string& path)
+{
+    TraceSpan span("model_load", "model");
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+
+    uint32_t magic = 0, vocabSize = 0, hiddenSize = 0, reserved = 0;
+    ifs.read((char*)&magic, sizeof(uint32_t));
+    ifs.read((char*)&vocabSize, sizeof(uint32_t));
+    ifs.read((char*)&hiddenSize, sizeof(uint32_t));
+    ifs.read((char*)&reserved, sizeof(uint32_t));
+
+    if (!ifs) return false;
+    if (magic != TOKEN_MAGIC || reserved != 0) return false;
+    if (vocabSize <= 256 || vocabSize > kMaxTokenVocab) return false;
+    if (hiddenSize == 0 || hiddenSize > kMaxHiddenSize) return false;
+
+    std::vector<std::string> tokens(vocabSize - 256);
+    for (auto& t : tokens) {
+        uint8_t len = 0;
+        if (!ifs.read((char*)&len, 1)) return false;
+        t.resize(len);
+        if (!ifs.read(&t[0], len)) return false;
+    }
+    TokenVocab vocab;
+    if (!vocab.build(tokens)) return false;
+
+    TokenLstmWeights w;
+    w.vocabSize = vocabSize;
+    w.hiddenSize = hiddenSize;
+
+    const size_t H = hiddenSize;
+    const size_t V = vocabSize;
+
+    auto read_vec = [&](std::vector<float>& v, size_t n) {
+        v.resize(n);
+        ifs.read((char*)v.data(), (std::streamsize)(n * sizeof(float)));
+        return (bool)ifs;
+    };
+
+    if (!read_vec(w.w_ih, 4 * H * V)) return false;
+    if (!read_vec(w.w_hh, 4 * H * H)) return false;
+    if (!read_vec(w.b_ih, 4 * H)) return false;
+    if (!read_vec(w.b_hh, 4 * H)) return false;
+    if (!read_vec(w.w_out, V * H)) return false;
+    if (!read_vec(w.b_out, V)) return false;
+    if (ifs.peek() != std::ifstream::traits_type::eof()) return false;
+
+    // Hash the magic, the vocabulary and all weights (FNV-1a)
+    uint64_t hash = 1469598103934665603ull;
+    auto hash_bytes = [&](const void* data, size_t n) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < n; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    hash_bytes(&magic, sizeof(magic));
+    for (const auto& t : tokens) {
+        const uint8_t len = (uint8_t)t.size();
+        hash_bytes(&len, 1);
+        hash_bytes(t.data(), t.size());
+    }
+    for (const auto* v : { &w.w_ih, &w.w_hh, &w.b_ih, &w.b_hh, &w.w_out, &w.b_out })
+        hash_bytes(v->data(), v->size() * sizeof(float));
+
+    weights_ = std::move(w);
+    vocab_ = std::move(vocab);
+    modelHash_ = hash;
+    return true;
+}
+
+std::unique_ptr<ModelContext> TokenLstmModel::create_context() const
+{
+    return std::make_unique<ModelContext>(weights_.hiddenSize);
+}
+
+size_t TokenLstmModel::weight_bytes() const
+{
+    // Per step (one token): one column of W_ih, all of W_hh and W_out.
+    const size_t H = weights_.hiddenSize;
+    const size_t V = weights_.vocabSize;
+    return (4 * H + 4 * H * H + V * H) * sizeof(float);
+}
+
+static inline float sigmoid(float x)
+{
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+void TokenLstmModel::step(ModelContext& ctx, uint32_t token) const
+{
+    const size_t H = weights_.hiddenSize;
+    const size_t V = weights_.vocabSize;
+    const auto& w_ih = weights_.w_ih;
+    const auto& w_hh = weights_.w_hh;
+    const auto& b_ih = weights_.b_ih;
+    const auto& b_hh = weights_.b_hh;
+    const float* hPrev = ctx.h.data();
+
+    // gates = b_ih + b_hh + W_ih * x (one-hot token) + W_hh * hPrev
+    std::vector<float> hNew(H);
+    for (size_t i = 0; i < H; i++) {
+        float gate[4];
+        for (size_t k = 0; k < 4; k++) {
+            size_t row = k * H + i;
+            float acc = 0.0f;
+            const float* Wrow = &w_hh[row * H];
+            for (size_t j = 0; j < H; j++)
+                acc += Wrow[j] * hPrev[j];
+            gate[k] = (b_ih[row] + b_hh[row] + w_ih[row * V + token]) + acc;
+        }
+
+        float i_t = sigmoid(gate[0]);
+        float f_t = sigmoid(gate[1]);
+        float g_t = std::tanh(gate[2]);
+        float o_t = sigmoid(gate[3]);
+        ctx.c[i] = f_t * ctx.c[i] + i_t * g_t;
+        hNew[i] = o_t * std::tanh(ctx.c[i]);
+    }
+    std::copy(hNew.begin(), hNew.end(), ctx.h.begin());
+}
+
+void TokenLstmModel::predict_next_token(
+    ModelContext& ctx,
+    uint32_t prevToken,
+    float* outProbs
+) const
+{
+    const size_t H = weights_.hiddenSize;
+    const size_t V = weights_.vocabSize;
+    if (prevToken >= V) prevToken = 0;
+
+    step(ctx, prevToken);
+
+    // logits = W_out * h + b_out, written to outProbs and softmaxed there
+    const float* h = ctx.h.data();
+    for (size_t t = 0; t < V; t++) {
+        float acc = weights_.b_out[t];
+        const float* Wrow = &weights_.w_out[t * H];
+        for (size_t j = 0; j < H; j++)
+            acc += Wrow[j] * h[j];
+        outProbs[t] = acc;
+    }
+    softmax(outProbs, V, outProbs);
+}
+
+void TokenLstmModel::predict_next(
+    ModelContext& ctx,
+    uint8_t prevByte,
+    float* outProbs,
+    size_t outSize
+) const
+{
+    if (outSize < 256) return;
+
+    std::vector<float> probs(weights_.vocabSize);
+    predict_next_token(ctx, prevByte, probs.data());
+
+    std::fill(outProbs, outProbs + 256, 0.0f);
+    for (uint32_t t = 0; t < weights_.vocabSize; t++) {
+        size_t len = 0;
+        outProbs[vocab_.token(t, len)[0]] += probs[t];
+    }
+}
+
+} // namespace neurozip
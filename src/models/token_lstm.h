@@ -0,0 +1,83 @@
+#pragma once
+
+#include "core/model_interface.h"
+#include "core/token_vocab.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neurozip {
+
+// First word of the model file ("NZT1" little-endian).
+constexpr uint32_t TOKEN_MAGIC = 0x31545A4E;
+
+// LSTM over a multi-byte token vocabulary: one recurrent step per token
+// instead of per byte. Input and output are token ids (W_ih has one
+// column and W_out one row per token).
+struct TokenLstmWeights {
+    uint32_t vocabSize = 0;
+    uint32_t hiddenSize = 0;
+
+    // W_ih: [4*H, V], W_hh: [4*H, H], b_ih: [4*H], b_hh: [4*H]
+    std::vector<float> w_ih;
+    std::vector<float> w_hh;
+    std::vector<float> b_ih;
+    std::vector<float> b_hh;
+
+    // W_out: [V, H], b_out: [V]
+    std::vector<float> w_out;
+    std::vector<float> b_out;
+};
+
+class TokenLstmModel : public ICompressionModel {
+public:
+    TokenLstmModel() = default;
+    ~TokenLstmModel() override = default;
+
+    // File layout (little-endian):
+    //   u32 magic (TOKEN_MAGIC)
+    //   u32 vocabSize (257..kMaxTokenVocab), u32 hiddenSize (1..kMaxHiddenSize), u32 reserved (0)
+    //   tokens 256..vocabSize-1: u8 length (2..kMaxTokenBytes), then the bytes
+    //   float32 w_ih, w_hh, b_ih, b_hh, w_out, b_out
+    // Nothing may follow the weights.
+    bool load_from_file(const std::string& path);
+
+    std::unique_ptr<ModelContext> create_context() const override;
+
+    /// Byte interface: feeds prevByte as its single-byte token and returns
+    /// the distribution of the first byte of the next token.
+    void predict_next(
+        ModelContext& ctx,
+        uint8_t prevByte,
+        float* outProbs,
+        size_t outSize
+    ) const override;
+
+    const TokenVocab* token_vocab() const override { return &vocab_; }
+
+    void predict_next_token(
+        ModelContext& ctx,
+        uint32_t prevToken,
+        float* outProbs
+    ) const override;
+
+    uint32_t model_id() const override { return MODEL_ID_TOKEN_LSTM; }
+    uint64_t model_hash() const override { return modelHash_; }
+
+    size_t weight_bytes() const override;
+
+    std::unique_ptr<ICompressionModel> clone() const override {
+        return std::make_unique<TokenLstmModel>(*this);
+    }
+
+private:
+    TokenLstmWeights weights_;
+    TokenVocab vocab_;
+    uint64_t modelHash_ = 0;
+
+    void step(ModelContext& ctx, uint32_t token) const;
+};
+
+} // namespace neurozip
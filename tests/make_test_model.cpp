@@ -0,0 +1,191 @@
+// Writes a small Tiny LSTM model file with deterministic pseudo-random
+// weights, so tests that need a real model can run without a trained
+// checkpoint. Layout matches TinyLstmModel::load_from_file ('gru' / 'mgu':
+// TinyRnnModel::load_from_file, 'token': TokenLstmModel::load_from_file).
+//
+// Usage: make_test_model <output.bin> [hiddenSize] [byte|nibble|gru|mgu|token] [dense|pruned|sparse]
+//
+// 'pruned' zeroes 3 of every 4 8x8 tiles of W_hh (and W_out for the byte
+// head) but stores them densely; 'sparse' writes the same weights in the
+// block-sparse layout, so both files describe the same network.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static uint32_t lcg_state = 12345u;
+
+static float next_weight(float scale)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    float u = (float)(lcg_state >> 8) / (float)(1u << 24); // [0, 1)
+    return (u * 2.0f - 1.0f) * scale;
+}
+
+static void write_u32(std::ofstream& ofs, uint32_t v)
+{
+    ofs.write((const char*)&v, sizeof(uint32_t));
+}
+
+static void write_random(std::ofstream& ofs, size_t n, float scale)
+{
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; i++) v[i] = next_weight(scale);
+    ofs.write((const char*)v.data(), (std::streamsize)(n * sizeof(float)));
+}
+
+enum class Layout { Dense, Pruned, Sparse };
+
+static constexpr uint32_t kBlock = 8;
+
+static bool keep_tile(uint32_t br, uint32_t bc)
+{
+    return (br + bc) % 4 == 0;
+}
+
+// [rows, cols] random matrix; with Pruned / Sparse only kept tiles are
+// nonzero. The same random numbers are drawn for every layout.
+static void write_matrix(std::ofstream& ofs, uint32_t rows, uint32_t cols, float scale, Layout layout)
+{
+    std::vector<float> v((size_t)rows * cols);
+    for (auto& w : v) w = next_weight(scale);
+
+    if (layout == Layout::Dense || rows % kBlock || cols % kBlock) {
+        ofs.write((const char*)v.data(), (std::streamsize)(v.size() * sizeof(float)));
+        return;
+    }
+
+    if (layout == Layout::Pruned) {
+        for (uint32_t r = 0; r < rows; r++)
+            for (uint32_t c = 0; c < cols; c++)
+                if (!keep_tile(r / kBlock, c / kBlock)) v[(size_t)r * cols + c] = 0.0f;
+        ofs.write((const char*)v.data(), (std::streamsize)(v.size() * sizeof(float)));
+        return;
+    }
+
+    std::vector<uint32_t> rowPtr(1, 0), colIdx;
+    std::vector<float> values;
+    for (uint32_t br = 0; br < rows / kBlock; br++) {
+        for (uint32_t bc = 0; bc < cols / kBlock; bc++) {
+            if (!keep_tile(br, bc)) continue;
+            colIdx.push_back(bc);
+            for (uint32_t i = 0; i < kBlock; i++)
+                for (uint32_t j = 0; j < kBlock; j++)
+                    values.push_back(v[(size_t)(br * kBlock + i) * cols + bc * kBlock + j]);
+        }
+        rowPtr.push_back((uint32_t)colIdx.size());
+    }
+    write_u32(ofs, kBlock);
+    write_u32(ofs, (uint32_t)colIdx.size());
+    ofs.write((const char*)rowPtr.data(), (std::streamsize)(rowPtr.size() * sizeof(uint32_t)));
+    ofs.write((const char*)colIdx.data(), (std::streamsize)(colIdx.size() * sizeof(uint32_t)));
+    ofs.write((const char*)values.data(), (std::streamsize)(values.size() * sizeof(float)));
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: make_test_model <output.bin> [hiddenSize] [byte|nibble|gru|mgu|token] [dense|pruned|sparse]\n";
+        return 1;
+    }
+
+    uint32_t H = argc > 2 ? (uint32_t)std::atoi(argv[2]) : 32;
+    uint32_t I = 256;
+    std::string kind = argc > 3 ? argv[3] : "byte";
+    bool nibble = kind == "nibble";
+    std::string layoutName = argc > 4 ? argv[4] : "dense";
+    Layout layout = layoutName == "sparse" ? Layout::Sparse
+                  : layoutName == "pruned" ? Layout::Pruned
+                                           : Layout::Dense;
+    bool blocked = H % kBlock == 0;
+
+    // outputHead word: head | LSTM_SPARSE_HH (1 << 8) | LSTM_SPARSE_OUT (1 << 9)
+    uint32_t head = nibble ? 1 : 0;
+    if (layout == Layout::Sparse && blocked) head |= nibble ? (1u << 8) : (3u << 8);
+
+    std::ofstream ofs(argv[1], std::ios::binary);
+    if (!ofs) return 1;
+
+    if (kind == "token") {
+        // Common English fragments as multi-byte tokens.
+        static const char* const tokens[] = {
+            "the ", "The ", " the ", "and ", " and ", "of ", " of ", "to ", " to ",
+            "in ", " in ", "ing ", "ing", "ed ", "er", "re", "th", "he", "an", "on",
+            "at", "en", "nd", "es", "is ", " is ", "it", "or", "ou", "ion", "tion",
+            ", ", ". ", "  ", "\n\n", "quick ", "brown ", "fox ", "jumps ", "over ",
+            "lazy ", "dog", "dog. ", "neural ", "compression ", "model ", "stream ",
+        };
+        const uint32_t V = 256 + (uint32_t)(sizeof(tokens) / sizeof(tokens[0]));
+        write_u32(ofs, 0x31545A4Eu); // "NZT1"
+        write_u32(ofs, V);
+        write_u32(ofs, H);
+        write_u32(ofs, 0);
+        for (const char* t : tokens) {
+            std::string tok(t);
+            uint8_t len = (uint8_t)tok.size();
+            ofs.write((const char*)&len, 1);
+            ofs.write(tok.data(), len);
+        }
+
+        write_random(ofs, (size_t)4 * H * V, 0.5f); // w_ih
+        write_random(ofs, (size_t)4 * H * H, 0.3f); // w_hh
+        write_random(ofs, 4 * H, 0.1f);             // b_ih
+        write_random(ofs, 4 * H, 0.1f);             // b_hh
+        write_random(ofs, (size_t)V * H, 1.0f);     // w_out
+
+        // Favor the multi-byte tokens, then printable ASCII.
+        std::vector<float> b_out(V);
+        for (uint32_t i = 0; i < V; i++)
+            b_out[i] = i >= 256 ? 3.0f : (i >= 32 && i < 127) ? 1.0f : -2.0f;
+        ofs.write((const char*)b_out.data(), (std::streamsize)(V * sizeof(float)));
+        return ofs ? 0 : 1;
+    }
+
+    if (kind == "gru" || kind == "mgu") {
+        uint32_t G = (kind == "gru" ? 3 : 2) * H;
+        write_u32(ofs, kind == "gru" ? 0x31475A4Eu : 0x314D5A4Eu); // "NZG1" / "NZM1"
+        write_u32(ofs, I);
+        write_u32(ofs, H);
+        write_u32(ofs, 0);
+
+        write_random(ofs, (size_t)G * I, 0.5f); // w_ih
+        write_random(ofs, (size_t)G * H, 0.3f); // w_hh
+        write_random(ofs, G, 0.1f);             // b_ih
+        write_random(ofs, G, 0.1f);             // b_hh
+    } else {
+        write_u32(ofs, I);
+        write_u32(ofs, H);
+        write_u32(ofs, 1);
+        write_u32(ofs, head);
+
+        write_random(ofs, 4 * H * I, 0.5f);  // w_ih
+        write_matrix(ofs, 4 * H, H, 0.3f, layout); // w_hh
+        write_random(ofs, 4 * H, 0.1f);      // b_ih
+        write_random(ofs, 4 * H, 0.1f);      // b_hh
+    }
+
+    if (nibble) {
+        // Favor the high nibbles of printable ASCII (2..7).
+        write_random(ofs, 16 * H, 1.0f);  // w_hi
+        std::vector<float> b_hi(16);
+        for (uint32_t i = 0; i < 16; i++)
+            b_hi[i] = (i >= 2 && i < 8) ? 2.0f : -2.0f;
+        ofs.write((const char*)b_hi.data(), (std::streamsize)(16 * sizeof(float)));
+        write_random(ofs, 256 * H, 1.0f); // w_lo
+        write_random(ofs, 256, 0.5f);     // b_lo
+        return ofs ? 0 : 1;
+    }
+
+    write_matrix(ofs, 256, H, 1.0f, layout);   // w_out
+
+    // Favor printable ASCII so text actually compresses.
+    std::vector<float> b_out(256);
+    for (uint32_t i = 0; i < 256; i++)
+        b_out[i] = (i >= 32 && i < 127) ? 2.0f : -2.0f;
+    ofs.write((const char*)b_out.data(), (std::streamsize)(256 * sizeof(float)));
+
+    return ofs ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Inputs and file helpers shared by the unit tests.
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../src/core/model_interface.h"
+
+namespace neurozip {
+namespace test {
+
+/// 'n' bytes taken from 'words': byte i is words[i * step + i / drift +
+/// offset] (no drift term when drift is 0), so the text repeats without
+/// being strictly periodic.
+inline std::vector<uint8_t> make_text(
+    const std::string& words, size_t n, size_t step, size_t drift = 0, size_t offset = 0)
+{
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; i++) {
+        size_t k = i * step + (drift ? i / drift : 0) + offset;
+        v[i] = (uint8_t)words[k % words.size()];
+    }
+    return v;
+}
+
+inline std::vector<uint8_t> read_all(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+inline void write_all(const std::string& path, const std::vector<uint8_t>& data)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+}
+
+/// True if encoding 'input' with 'options' gives the serial encoder's
+/// stream byte for byte.
+inline bool encodes_like_serial(
+    const ICompressionModel& model, const std::vector<uint8_t>& input, const CompressOptions& options)
+{
+    return compress_buffer(model, input.data(), input.size(), options) ==
+           compress_buffer(model, input.data(), input.size());
+}
+
+} // namespace test
+} // namespace neurozip
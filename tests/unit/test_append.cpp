@@ -0,0 +1,145 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/core/file_format.h"
+#include "../test_util.h"
+
+using neurozip::test::read_all;
+using neurozip::test::write_all;
+
+static std::vector<uint8_t> make_text(size_t n, size_t seed) {
+    return neurozip::test::make_text("log line: request served in 12 ms, status ok. ", n, seed, 7);
+}
+
+/// Compress 'first', append each of 'more', and check the result against a
+/// one-shot compression of the concatenation (it must be byte-identical).
+static void check_appends(
+    const neurozip::Model& model,
+    const nzp_compress_options_t& options,
+    const std::vector<uint8_t>& first,
+    const std::vector<std::vector<uint8_t>>& more
+) {
+    const std::string input = "test_append_input.txt";
+    const std::string path = "test_append.nzp";
+    const std::string oneShot = "test_append_oneshot.nzp";
+
+    write_all(input, first);
+    nzp_error_t err = neurozip::compress_file(input, path, model, options);
+    assert(err == NZP_OK);
+
+    std::vector<uint8_t> all = first;
+    for (const auto& chunk : more) {
+        err = neurozip::append_memory(path, chunk, model, &options);
+        assert(err == NZP_OK);
+        all.insert(all.end(), chunk.begin(), chunk.end());
+    }
+
+    write_all(input, all);
+    err = neurozip::compress_file(input, oneShot, model, options);
+    assert(err == NZP_OK);
+    assert(read_all(path) == read_all(oneShot));
+
+    std::vector<uint8_t> restored;
+    err = neurozip::decompress_memory(read_all(path), restored, model);
+    assert(err == NZP_OK);
+    assert(restored == all);
+
+    std::remove(input.c_str());
+    std::remove(path.c_str());
+    std::remove(oneShot.c_str());
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_append] Running...\n";
+    assert(argc > 1);
+
+    neurozip::Model model(argv[1]);
+    assert(model.valid());
+
+    nzp_compress_options_t options;
+    nzp_compress_options_init(&options);
+    options.appendable = 1;
+
+    auto a = make_text(700, 3), b = make_text(450, 5), c = make_text(1, 2);
+
+    // Several appends, including empty ones and appends to an empty file.
+    check_appends(model, options, a, {b, {}, c});
+    check_appends(model, options, {}, {a, b});
+
+    // Checkpoints are extended across appends; two-phase gives the same bytes.
+    options.checkpoint_interval = 128;
+    check_appends(model, options, a, {b, c});
+    options.two_phase = 1;
+    options.threads = 2;
+    check_appends(model, options, b, {a});
+    options.two_phase = 0;
+    options.threads = 1;
+
+    // Random access into the appended part.
+    write_all("test_append_input.txt", a);
+    nzp_error_t err = neurozip::compress_file("test_append_input.txt", "test_append.nzp", model, options);
+    assert(err == NZP_OK);
+    err = neurozip::append_memory("test_append.nzp", b, model, &options);
+    assert(err == NZP_OK);
+    std::vector<uint8_t> part;
+    err = neurozip::decompress_range("test_append.nzp", model, 800, 200, part);
+    assert(err == NZP_OK);
+    assert(part == std::vector<uint8_t>(b.begin() + 100, b.begin() + 300));
+    options.checkpoint_interval = 0;
+
+    // Fixed-point files are continued in fixed-point mode.
+    model.set_fixed_point(true);
+    check_appends(model, options, a, {b});
+    model.set_fixed_point(false);
+
+    // A file without saved state is rewritten as appendable once.
+    nzp_compress_options_t plain;
+    nzp_compress_options_init(&plain);
+    write_all("test_append_input.txt", a);
+    err = neurozip::compress_file("test_append_input.txt", "test_append.nzp", model, plain);
+    assert(err == NZP_OK);
+    err = neurozip::append_file("test_append.nzp", "test_append_input.txt", model);
+    assert(err == NZP_OK);
+    neurozip::FileHeader header;
+    auto ec = neurozip::read_nzp_header("test_append.nzp", header);
+    assert(ec == neurozip::ErrorCode::Ok);
+    assert(header.flags & neurozip::NZP_FLAG_APPENDABLE);
+    assert(header.originalSize == 2 * a.size());
+    std::vector<uint8_t> twice = a;
+    twice.insert(twice.end(), a.begin(), a.end());
+    std::vector<uint8_t> restored;
+    err = neurozip::decompress_memory(read_all("test_append.nzp"), restored, model);
+    assert(err == NZP_OK);
+    assert(restored == twice);
+
+    // A damaged trailer is reported, not coded against.
+    auto image = read_all("test_append.nzp");
+    image[image.size() - 3] ^= 0x40;
+    write_all("test_append.nzp", image);
+    err = neurozip::append_memory("test_append.nzp", b, model, &options);
+    assert(err == NZP_ERR_CORRUPT);
+
+    // A failed append leaves the old file as it was.
+    err = neurozip::compress_file("test_append_input.txt", "test_append.nzp", model, options);
+    assert(err == NZP_OK);
+    const auto before = read_all("test_append.nzp");
+    const std::string blocked = neurozip::replacement_path("test_append.nzp");
+    std::filesystem::create_directory(blocked);
+    err = neurozip::append_memory("test_append.nzp", b, model, &options);
+    assert(err == NZP_ERR_IO);
+    assert(read_all("test_append.nzp") == before);
+    std::filesystem::remove(blocked);
+    err = neurozip::append_memory("test_append.nzp", b, model, &options);
+    assert(err == NZP_OK);
+    assert(!std::filesystem::exists(blocked));
+
+    std::remove("test_append_input.txt");
+    std::remove("test_append.nzp");
+
+    std::cout << "[test_append] OK\n";
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#include "../../src/core/archive.h"
+#include "../../src/core/chunking.h"
+#include "../../src/core/worker_pool.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::string text(size_t n, uint32_t seed) {
+    static const char* words[] = { "alpha ", "beta ", "gamma ", "delta\n", "port=8080 ", "ok " };
+    std::string s;
+    uint32_t x = seed;
+    while (s.size() < n) {
+        x = x * 1664525u + 1013904223u;
+        s += words[(x >> 24) % 6];
+    }
+    s.resize(n);
+    return s;
+}
+
+static std::set<uint64_t> chunk_hashes(const std::string& s, const ChunkParams& params) {
+    std::vector<size_t> lengths;
+    content_defined_chunks((const uint8_t*)s.data(), s.size(), params, lengths);
+    std::set<uint64_t> out;
+    size_t pos = 0;
+    for (size_t len : lengths) {
+        out.insert(content_hash((const uint8_t*)s.data() + pos, len).lo);
+        pos += len;
+    }
+    return out;
+}
+
+static void write_file(const fs::path& p, const std::string& s) {
+    fs::create_directories(p.parent_path());
+    std::ofstream(p, std::ios::binary) << s;
+}
+
+static std::string read_file(const fs::path& p) {
+    std::ifstream ifs(p, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_archive] Running...\n";
+    assert(argc > 1);
+
+    // Chunking: covers the input, sizes within bounds, edits stay local.
+    const ChunkParams params = chunk_params(1000);
+    assert(params.avgSize == 1024 && params.minSize == 256 && params.maxSize == 4096);
+    const std::string big = text(200000, 7);
+    std::vector<size_t> lengths;
+    content_defined_chunks((const uint8_t*)big.data(), big.size(), params, lengths);
+    size_t total = 0;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        total += lengths[i];
+        if (i + 1 < lengths.size()) assert(lengths[i] >= params.minSize && lengths[i] <= params.maxSize);
+    }
+    assert(total == big.size());
+    assert(lengths.size() > big.size() / params.maxSize && lengths.size() < big.size() / params.minSize);
+
+    std::string edited = big;
+    edited.insert(100000, "an inserted line\n");
+    auto before = chunk_hashes(big, params);
+    auto after = chunk_hashes(edited, params);
+    size_t kept = 0;
+    for (uint64_t h : after) kept += before.count(h);
+    assert(kept + 3 >= before.size());
+
+    // Member names stay inside the output directory.
+    assert(archive_member_name("logs/./a.log") == "logs/a.log");
+    assert(archive_member_name("/var/log/a.log") == "var/log/a.log");
+    assert(archive_member_name("../x/a.log") == "a.log");
+
+    // Archive: duplicates and near-duplicates are stored once.
+    TinyLstmModel model;
+    bool ok = model.load_from_file(argv[1]);
+    assert(ok);
+    WorkerPool pool(2, false);
+
+    const fs::path dir = fs::temp_directory_path() / "neurozip_test_archive";
+    fs::remove_all(dir);
+    const std::string a = text(6000, 1);
+    std::string b = a;
+    b.insert(3000, "changed\n");
+    write_file(dir / "in/a.log", a);
+    write_file(dir / "in/b.log", b);
+    write_file(dir / "in/copy/a.log", a);
+    write_file(dir / "in/empty", "");
+
+    std::vector<std::string> inputs;
+    for (const char* n : { "a.log", "b.log", "copy/a.log", "empty" }) {
+        inputs.push_back((dir / "in" / n).string());
+    }
+    ArchiveOptions options;
+    options.chunkSize = 512;
+    const std::string first = (dir / "first.nza").string();
+    ArchiveStats stats;
+    ErrorCode ec = create_archive(model, pool, inputs, first, options, &stats);
+    assert(ec == ErrorCode::Ok);
+    assert(stats.inputBytes == 3 * a.size() + 8);
+    assert(stats.uniqueBytes < a.size() + 2 * params.maxSize);
+    assert(stats.codedBytes == stats.uniqueBytes);
+
+    ArchiveIndex index;
+    ec = read_archive_index(first, index);
+    assert(ec == ErrorCode::Ok);
+    assert(index.members.size() == 4 && index.chunks.size() == stats.uniqueChunks);
+    assert(index.members[0].chunks == index.members[2].chunks);
+
+    // A later snapshot only codes what changed.
+    write_file(dir / "in/b.log", b + "one more line\n");
+    options.basePath = first;
+    const std::string second = (dir / "second.nza").string();
+    ec = create_archive(model, pool, inputs, second, options, &stats);
+    assert(ec == ErrorCode::Ok);
+    assert(stats.codedBytes > 0 && stats.codedBytes <= 2 * 512 * 4);
+
+    fs::remove(first); // independent of the base
+    ec = extract_archive(model, pool, second, (dir / "out").string());
+    assert(ec == ErrorCode::Ok);
+    for (const auto& in : inputs) {
+        assert(read_file(dir / "out" / archive_member_name(in)) == read_file(in));
+    }
+
+    // An archive cannot be its own base; an existing one is replaced whole.
+    const std::string snapshot = read_file(second);
+    options.basePath = second;
+    ec = create_archive(model, pool, inputs, second, options);
+    assert(ec == ErrorCode::IoError);
+    assert(read_file(second) == snapshot);
+    const std::string third = (dir / "third.nza").string();
+    write_file(third, snapshot + snapshot);
+    ec = create_archive(model, pool, inputs, third, options, &stats);
+    assert(ec == ErrorCode::Ok);
+    assert(stats.codedBytes == 0 && fs::file_size(third) == stats.archiveBytes);
+    assert(!fs::exists(replacement_path(third)));
+
+    // Other inference mode, missing base, corrupt index.
+    model.set_fixed_point(true);
+    ec = extract_archive(model, pool, second, (dir / "out").string());
+    assert(ec == ErrorCode::ModelMismatch);
+    model.set_fixed_point(false);
+    options.basePath = first;
+    ec = create_archive(model, pool, inputs, second + ".x", options);
+    assert(ec == ErrorCode::IoError);
+
+    std::string bytes = read_file(second);
+    bytes[bytes.size() - NZA_TRAILER_SIZE - 3] ^= 1;
+    write_file(second, bytes);
+    ec = read_archive_index(second, index);
+    assert(ec == ErrorCode::CorruptData);
+
+    fs::remove_all(dir);
+    std::cout << "[test_archive] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/core/job_queue.h"
+
+namespace fs = std::filesystem;
+
+static void check_queue()
+{
+    std::atomic<int> ran{ 0 };
+    {
+        neurozip::JobQueue queue(3);
+        assert(queue.size() == 3);
+        for (int i = 0; i < 200; ++i) queue.post([&] { ran.fetch_add(1); });
+    } // the destructor runs what is still queued
+    assert(ran.load() == 200);
+}
+
+struct Completion {
+    std::atomic<int> calls{ 0 };
+    std::atomic<int> result{ -1 };
+};
+
+static void on_done(nzp_job_t* job, nzp_error_t result, void* user_data)
+{
+    auto* c = static_cast<Completion*>(user_data);
+    assert(nzp_job_poll(job) == (result == NZP_ERR_CANCELLED ? NZP_JOB_CANCELLED : NZP_JOB_DONE));
+    c->result.store(result);
+    c->calls.fetch_add(1);
+}
+
+static std::vector<uint8_t> message(int i)
+{
+    std::string s = "job " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog. ";
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+// Many jobs in flight give the blocking calls' results.
+static void check_memory_jobs(nzp_model_t* model)
+{
+    constexpr int kJobs = 24;
+    std::vector<std::vector<uint8_t>> inputs;
+    for (int i = 0; i < kJobs; ++i) inputs.push_back(message(i));
+
+    std::vector<Completion> done(kJobs);
+    std::vector<nzp_job_t*> jobs;
+    for (int i = 0; i < kJobs; ++i) {
+        jobs.push_back(nzp_submit_compress(inputs[i].data(), inputs[i].size(), model, nullptr,
+                                           on_done, &done[i]));
+        assert(jobs.back());
+    }
+
+    std::vector<std::vector<uint8_t>> images(kJobs);
+    for (int i = 0; i < kJobs; ++i) {
+        int finished = nzp_job_wait(jobs[i], -1);
+        assert(finished == 1);
+        assert(done[i].calls.load() == 1 && done[i].result.load() == NZP_OK);
+        assert(nzp_job_poll(jobs[i]) == NZP_JOB_DONE && nzp_job_result(jobs[i]) == NZP_OK);
+
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        nzp_error_t err = nzp_job_take_output(jobs[i], &data, &size);
+        assert(err == NZP_OK);
+        images[i].assign(data, data + size);
+        nzp_buffer_free(data);
+        err = nzp_job_take_output(jobs[i], &data, &size);
+        assert(err == NZP_ERR_INTERNAL);
+        nzp_job_free(jobs[i]);
+
+        uint8_t* ref = nullptr;
+        uint64_t refSize = 0;
+        err = nzp_compress_memory(inputs[i].data(), inputs[i].size(), model, nullptr, &ref, &refSize);
+        assert(err == NZP_OK);
+        assert(std::vector<uint8_t>(ref, ref + refSize) == images[i]);
+        nzp_buffer_free(ref);
+    }
+
+    // Decompress through the C++ wrapper.
+    for (int i = 0; i < kJobs; ++i) {
+        neurozip::Job job(nzp_submit_decompress(images[i].data(), images[i].size(), model, nullptr, nullptr));
+        assert(job.valid());
+        bool finished = job.wait();
+        assert(finished);
+        std::vector<uint8_t> out;
+        nzp_error_t err = job.take_output(out);
+        assert(err == NZP_OK && out == inputs[i]);
+    }
+
+    // Failures are reported through the job.
+    const uint8_t junk[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    Completion failed;
+    nzp_job_t* bad = nzp_submit_decompress(junk, sizeof(junk), model, on_done, &failed);
+    int finished = nzp_job_wait(bad, -1);
+    assert(finished == 1);
+    assert(failed.result.load() != NZP_OK && nzp_job_result(bad) == failed.result.load());
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_job_take_output(bad, &data, &size);
+    assert(err == nzp_job_result(bad));
+    nzp_job_free(bad);
+
+    nzp_job_t* none = nzp_submit_compress(nullptr, 4, model, nullptr, nullptr, nullptr);
+    assert(!none);
+}
+
+// One executor thread held by a callback: later jobs stay queued, so
+// they can be cancelled or freed before they start.
+static void check_cancel(nzp_model_t* model)
+{
+    nzp_model_set_job_threads(model, 1);
+
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    struct Blocker {
+        std::shared_future<void> gate;
+        std::atomic<bool> entered{ false };
+    } blocker{ gate };
+    auto block = [](nzp_job_t*, nzp_error_t, void* user_data) {
+        auto* b = static_cast<Blocker*>(user_data);
+        b->entered.store(true);
+        b->gate.wait();
+    };
+
+    const auto input = message(0);
+    nzp_job_t* first = nzp_submit_compress(input.data(), input.size(), model, nullptr, block, &blocker);
+    Completion cancelled, dropped;
+    nzp_job_t* second = nzp_submit_compress(input.data(), input.size(), model, nullptr, on_done, &cancelled);
+    nzp_job_t* third = nzp_submit_compress(input.data(), input.size(), model, nullptr, on_done, &dropped);
+    while (!blocker.entered.load()) std::this_thread::yield();
+
+    // The first job is done but still calling back.
+    assert(nzp_job_poll(first) == NZP_JOB_DONE);
+    int finished = nzp_job_wait(first, 10);
+    assert(finished == 0);
+    int stopped = nzp_job_cancel(first);
+    assert(stopped == 0);
+    assert(nzp_job_poll(second) == NZP_JOB_QUEUED);
+
+    stopped = nzp_job_cancel(second);
+    assert(stopped == 1);
+    assert(cancelled.calls.load() == 1 && cancelled.result.load() == NZP_ERR_CANCELLED);
+    assert(nzp_job_poll(second) == NZP_JOB_CANCELLED && nzp_job_result(second) == NZP_ERR_CANCELLED);
+    finished = nzp_job_wait(second, 0);
+    assert(finished == 1);
+    stopped = nzp_job_cancel(second);
+    assert(stopped == 0);
+    nzp_job_free(second);
+
+    nzp_job_free(third); // queued: cancelled without a callback
+
+    release.set_value();
+    finished = nzp_job_wait(first, -1);
+    assert(finished == 1 && nzp_job_result(first) == NZP_OK);
+    nzp_job_free(first);
+
+    // The executor skips both; a job submitted after them still runs.
+    neurozip::Job last(nzp_submit_compress(input.data(), input.size(), model, nullptr, nullptr, nullptr));
+    bool lastFinished = last.wait();
+    assert(lastFinished && last.result() == NZP_OK);
+    assert(dropped.calls.load() == 0);
+
+    nzp_model_set_job_threads(model, 0);
+}
+
+static void free_in_callback(nzp_job_t* job, nzp_error_t, void* user_data)
+{
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_job_take_output(job, &data, &size);
+    assert(err == NZP_OK && size > 0);
+    nzp_buffer_free(data);
+    nzp_job_free(job);
+    static_cast<std::atomic<int>*>(user_data)->fetch_add(1);
+}
+
+static void check_file_jobs(nzp_model_t* model)
+{
+    const fs::path dir = fs::temp_directory_path() / "neurozip_test_async_jobs";
+    fs::create_directories(dir);
+    const auto input = message(7);
+    {
+        std::ofstream ofs(dir / "in.txt", std::ios::binary);
+        ofs.write((const char*)input.data(), (std::streamsize)input.size());
+    }
+
+    nzp_job_t* c = nzp_submit_compress_file((dir / "in.txt").string().c_str(),
+                                            (dir / "in.nzp").string().c_str(), model, nullptr, nullptr, nullptr);
+    int finished = nzp_job_wait(c, -1);
+    assert(finished == 1 && nzp_job_result(c) == NZP_OK);
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_job_take_output(c, &data, &size);
+    assert(err == NZP_ERR_INTERNAL);
+    nzp_job_free(c);
+
+    nzp_job_t* d = nzp_submit_decompress_file((dir / "in.nzp").string().c_str(),
+                                              (dir / "out.txt").string().c_str(), model, nullptr, nullptr);
+    finished = nzp_job_wait(d, -1);
+    assert(finished == 1 && nzp_job_result(d) == NZP_OK);
+    nzp_job_free(d);
+
+    std::ifstream ifs(dir / "out.txt", std::ios::binary);
+    std::vector<uint8_t> out((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    assert(out == input);
+
+    nzp_job_t* missing = nzp_submit_compress_file((dir / "missing").string().c_str(),
+                                                  (dir / "x.nzp").string().c_str(), model, nullptr, nullptr, nullptr);
+    finished = nzp_job_wait(missing, -1);
+    assert(finished == 1 && nzp_job_result(missing) == NZP_ERR_IO);
+    nzp_job_free(missing);
+
+    fs::remove_all(dir);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "[test_async_jobs] Running...\n";
+    assert(argc > 1);
+
+    check_queue();
+
+    nzp_model_t* model = nzp_model_load(argv[1]);
+    assert(model);
+    nzp_model_set_job_threads(model, 4);
+
+    check_memory_jobs(model);
+    check_cancel(model);
+    check_file_jobs(model);
+
+    // Handles freed by their own callback; freeing the model runs (and
+    // waits for) whatever is still queued.
+    std::atomic<int> freed{ 0 };
+    const auto input = message(3);
+    for (int i = 0; i < 16; ++i) {
+        nzp_job_t* job = nzp_submit_compress(input.data(), input.size(), model, nullptr, free_in_callback, &freed);
+        assert(job);
+    }
+    nzp_model_free(model);
+    assert(freed.load() == 16);
+
+    assert(std::strcmp(nzp_strerror(NZP_ERR_CANCELLED), "cancelled") == 0);
+
+    std::cout << "[test_async_jobs] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/core/autotune.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+static TuneProfile synthetic_profile(unsigned threads) {
+    TuneProfile p;
+    p.hardwareThreads = threads;
+    p.serialNs = 1000.0;   // 1 MB/s per stream
+    p.codeNs = 100.0;
+    p.advanceNs = 300.0;
+    p.outputNs = 600.0;
+    p.threadStartNs = 20000.0;
+    return p;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_autotune] Running...\n";
+    assert(argc > 1);
+
+    TinyLstmModel model;
+    bool ok = model.load_from_file(argv[1]);
+    assert(ok);
+    assert(model.weight_bytes() > 0);
+
+    // Calibration measures every cost the tuner uses.
+    TuneProfile measured = calibrate_host(model, 512);
+    assert(measured.hardwareThreads >= 1);
+    assert(measured.serialNs > 0.0 && measured.codeNs > 0.0 && measured.advanceNs > 0.0);
+    assert(measured.memoryMBps > 0.0);
+    assert(measured.modelHash == model.model_hash());
+
+    // Save / load round trip.
+    const std::string path = "test_autotune.profile";
+    ok = save_tune_profile(measured, path);
+    assert(ok);
+    TuneProfile loaded;
+    ok = load_tune_profile(path, loaded);
+    assert(ok);
+    assert(loaded.hardwareThreads == measured.hardwareThreads);
+    assert(loaded.modelHash == measured.modelHash);
+    assert(loaded.weightBytes == measured.weightBytes);
+    assert(loaded.serialNs > measured.serialNs * 0.999 && loaded.serialNs < measured.serialNs * 1.001);
+    {
+        FILE* f = std::fopen(path.c_str(), "w");
+        std::fputs("not a profile\n", f);
+        std::fclose(f);
+    }
+    ok = load_tune_profile(path, loaded);
+    assert(!ok);
+    std::remove(path.c_str());
+
+    // Single stream: tiny inputs are not worth starting threads for; large
+    // ones take the batched output layer on every core.
+    TuneProfile p = synthetic_profile(8);
+    TunedSettings small = tune_stream(p, 10);
+    assert(small.kernel == EncoderKernel::Serial);
+    TunedSettings big = tune_stream(p, 10u << 20);
+    assert(big.kernel == EncoderKernel::TwoPhase && big.threads == 8);
+
+    p.advanceNs = 0.0; // model without two-phase support
+    big = tune_stream(p, 10u << 20);
+    assert(big.kernel == EncoderKernel::Pipelined);
+    p.hardwareThreads = 1;
+    big = tune_stream(p, 10u << 20);
+    assert(big.kernel == EncoderKernel::Serial);
+
+    // Batch: one 64 MiB file on 8 cores.
+    p = synthetic_profile(8);
+    const std::vector<uint64_t> sizes = { 64ull << 20 };
+    CompressibilitySample sample;
+    sample.bpb = 2.0;
+    sample.restartBits = 2000.0;
+
+    TuneTarget target;
+    target.maxRatioLoss = 0.0; // ratio only: never split
+    TunedSettings t = tune_batch(p, sizes, sample, target);
+    assert(t.segmentSize == 0 && t.predictedRatioLoss == 0.0);
+
+    target.maxRatioLoss = 0.01; // fastest within 1%: one segment per core
+    t = tune_batch(p, sizes, sample, target);
+    assert(t.segmentSize == (8ull << 20) && t.threads == 8);
+    assert(t.predictedRatioLoss > 0.0 && t.predictedRatioLoss <= 0.01);
+
+    // Best ratio for a speed target: the largest segments that reach it.
+    target.minMBps = 3.0;
+    t = tune_batch(p, sizes, sample, target);
+    assert(t.segmentSize == (16ull << 20) && t.predictedMBps >= 3.0);
+    target.minMBps = 7.0;
+    t = tune_batch(p, sizes, sample, target);
+    assert(t.segmentSize == (8ull << 20));
+    target.minMBps = 1000.0; // unreachable: fastest
+    TunedSettings fastest = tune_batch(p, sizes, sample, target);
+    assert(fastest.predictedMBps >= t.predictedMBps * 0.99);
+
+    // Weights larger than the cache: memory bandwidth caps the speedup.
+    p.cacheBytes = 1000;
+    p.weightBytes = 4000;    // 4000 MB/s per stream
+    p.memoryMBps = 8000.0;   // enough for two
+    target = TuneTarget();
+    target.maxRatioLoss = 1.0;
+    t = tune_batch(p, sizes, sample, target);
+    assert(t.predictedMBps < 2.1);
+
+    // A model with half the weights is predicted to step twice as fast.
+    TuneProfile other = measured;
+    other.modelHash ^= 1;
+    other.weightBytes = model.weight_bytes() * 2;
+    TuneProfile scaled = profile_for_model(other, model);
+    double modelNs = other.serialNs - other.codeNs;
+    assert(scaled.serialNs < other.serialNs);
+    assert(scaled.serialNs > other.codeNs + modelNs * 0.49 && scaled.serialNs < other.codeNs + modelNs * 0.51);
+
+    // The compressibility sample sees the model warm up on repetitive text.
+    std::string text;
+    while (text.size() < 4096) text += "warm up once, then predict the rest. ";
+    CompressibilitySample s = sample_compressibility(
+        model, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    assert(s.bpb > 0.0 && s.bpb < 16.0 && s.restartBits >= 0.0);
+
+    std::cout << "[test_autotune] All tests passed.\n";
+    return 0;
+}
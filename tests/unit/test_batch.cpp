@@ -0,0 +1,100 @@
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/core/file_format.h"
+#include "../test_util.h"
+
+using neurozip::test::read_all;
+using neurozip::test::write_all;
+
+int main(int argc, char** argv) {
+    std::cout << "[test_batch] Running...\n";
+    assert(argc > 1);
+
+    // CRC of concatenated buffers from the parts.
+    const uint8_t a[] = "uneven ", b[] = "file sizes";
+    uint32_t whole = neurozip::crc32((const uint8_t*)"uneven file sizes", 17);
+    assert(neurozip::crc32_combine(neurozip::crc32(a, 7), neurozip::crc32(b, 10), 10) == whole);
+
+    neurozip::Model model(argv[1]);
+    assert(model.valid());
+
+    // Uneven sizes: one file is split into several segments.
+    const std::string text = "batch scheduler keeps every core busy until the end. ";
+    std::vector<size_t> sizes = {0, 90, 700, 5000, 1300};
+    std::vector<std::string> inputs, compressed, restored;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::vector<uint8_t> data(sizes[i]);
+        for (size_t k = 0; k < data.size(); ++k) data[k] = (uint8_t)text[(k * (i + 1)) % text.size()];
+        std::string path = "test_batch_" + std::to_string(i) + ".txt";
+        write_all(path, data);
+        inputs.push_back(path);
+        compressed.push_back(path + ".nzp");
+        restored.push_back(path + ".out");
+    }
+
+    nzp_batch_options_t options;
+    nzp_batch_options_init(&options);
+    options.threads = 3;
+    options.segment_size = 1024;
+
+    std::vector<nzp_error_t> errors;
+    nzp_error_t err = neurozip::compress_batch(inputs, compressed, model, options, errors);
+    assert(err == NZP_OK);
+
+    // Unsplit files match the single-file path byte for byte.
+    err = neurozip::compress_file(inputs[2], "test_batch_single.nzp", model);
+    assert(err == NZP_OK);
+    assert(read_all("test_batch_single.nzp") == read_all(compressed[2]));
+
+    neurozip::FileHeader header;
+    auto ec = neurozip::read_nzp_header(compressed[3], header);
+    assert(ec == neurozip::ErrorCode::Ok);
+    assert(header.flags & neurozip::NZP_FLAG_SEGMENTED);
+    assert(header.originalSize == 5000);
+
+    err = neurozip::decompress_batch(compressed, restored, model, options, errors);
+    assert(err == NZP_OK);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        assert(read_all(restored[i]) == read_all(inputs[i]));
+    }
+
+    // Segmented files also decode through the single-file and range paths.
+    err = neurozip::decompress_file(compressed[3], "test_batch_single.out", model);
+    assert(err == NZP_OK);
+    assert(read_all("test_batch_single.out") == read_all(inputs[3]));
+    std::vector<uint8_t> part;
+    err = neurozip::decompress_range(compressed[3], model, 1000, 1100, part);
+    assert(err == NZP_OK);
+    auto original = read_all(inputs[3]);
+    assert(part == std::vector<uint8_t>(original.begin() + 1000, original.begin() + 2100));
+
+    // Fixed-point files decode with a float model in batch mode.
+    model.set_fixed_point(true);
+    err = neurozip::compress_batch({inputs[4]}, {compressed[4]}, model, options, errors);
+    assert(err == NZP_OK);
+    model.set_fixed_point(false);
+    err = neurozip::decompress_batch({compressed[4]}, {restored[4]}, model, options, errors);
+    assert(err == NZP_OK);
+    assert(read_all(restored[4]) == read_all(inputs[4]));
+
+    // Per-file errors
+    err = neurozip::compress_batch({inputs[1], "does_not_exist.txt"}, {compressed[1], "x.nzp"},
+                                   model, options, errors);
+    assert(err == NZP_ERR_IO);
+    assert(errors[0] == NZP_OK && errors[1] == NZP_ERR_IO);
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::remove(inputs[i].c_str());
+        std::remove(compressed[i].c_str());
+        std::remove(restored[i].c_str());
+    }
+    std::remove("test_batch_single.nzp");
+    std::remove("test_batch_single.out");
+
+    std::cout << "[test_batch] OK\n";
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../src/models/block_sparse.h"
+#include "../../src/models/fixed_point.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static void put_u32(std::string& s, uint32_t v) {
+    s.append((const char*)&v, sizeof(v));
+}
+
+// 16x12 matrix in 4x4 tiles with tiles (0,0) (0,2) (2,1) (3,0) (3,2).
+static std::string sparse_record(std::vector<float>& dense) {
+    const uint32_t rows = 16, cols = 12, B = 4;
+    const std::vector<uint32_t> rowPtr = { 0, 2, 2, 3, 5 };
+    const std::vector<uint32_t> colIdx = { 0, 2, 1, 0, 2 };
+
+    dense.assign(rows * cols, 0.0f);
+    std::string s;
+    put_u32(s, B);
+    put_u32(s, (uint32_t)colIdx.size());
+    for (uint32_t v : rowPtr) put_u32(s, v);
+    for (uint32_t v : colIdx) put_u32(s, v);
+
+    uint32_t x = 7;
+    for (uint32_t br = 0; br < rows / B; ++br) {
+        for (uint32_t t = rowPtr[br]; t < rowPtr[br + 1]; ++t) {
+            for (uint32_t i = 0; i < B; ++i) {
+                for (uint32_t j = 0; j < B; ++j) {
+                    x = x * 1664525u + 1013904223u;
+                    float w = (float)(int32_t)(x >> 20) / 2048.0f - 1.0f;
+                    dense[(br * B + i) * cols + colIdx[t] * B + j] = w;
+                    s.append((const char*)&w, sizeof(w));
+                }
+            }
+        }
+    }
+    return s;
+}
+
+static bool parse(const std::string& s, BlockSparseMatrix& m) {
+    std::istringstream in(s);
+    return read_block_sparse(in, 16, 12, m);
+}
+
+static void check_kernels() {
+    std::vector<float> dense;
+    const std::string rec = sparse_record(dense);
+    BlockSparseMatrix m;
+    bool ok = parse(rec, m);
+    assert(ok);
+    assert(m.stored_blocks() == 5 && m.block == 4);
+    assert(std::fabs(m.density() - 5.0 / 12.0) < 1e-9);
+    quantize_block_sparse(m);
+
+    float x[12];
+    int16_t xq[12];
+    for (int j = 0; j < 12; ++j) {
+        x[j] = 0.1f * (float)(j - 5);
+        xq[j] = (int16_t)(j * 300 - 1700);
+    }
+
+    // y += A*x against the dense reference.
+    float y[16];
+    int64_t yq[16];
+    for (int i = 0; i < 16; ++i) {
+        y[i] = 1.0f;
+        yq[i] = 3;
+    }
+    bsr_matvec_add(m, x, y);
+    bsr_matvec_add_q(m, xq, yq);
+    for (int i = 0; i < 16; ++i) {
+        float ref = 1.0f;
+        int64_t refq = 3;
+        for (int j = 0; j < 12; ++j) {
+            ref += dense[i * 12 + j] * x[j];
+            refq += (int64_t)fixed::quantize_weight(dense[i * 12 + j]) * xq[j];
+        }
+        assert(std::fabs(y[i] - ref) < 1e-5f);
+        assert(yq[i] == refq);
+    }
+
+    // Malformed records are rejected.
+    BlockSparseMatrix bad;
+    ok = parse(rec.substr(0, rec.size() - 1), bad);
+    assert(!ok);
+    std::string s = rec;
+    uint32_t five = 5;
+    std::memcpy(&s[0], &five, 4);               // block does not divide the shape
+    ok = parse(s, bad);
+    assert(!ok);
+    s = rec;
+    uint32_t one = 1;
+    std::memcpy(&s[8 + 4 * 2], &one, 4);        // rowPtr goes backwards
+    ok = parse(s, bad);
+    assert(!ok);
+    s = rec;
+    uint32_t three = 3;
+    std::memcpy(&s[8 + 4 * 5 + 4 * 1], &three, 4); // column past the end
+    ok = parse(s, bad);
+    assert(!ok);
+    s = rec;
+    uint32_t zero = 0;
+    std::memcpy(&s[8 + 4 * 5 + 4 * 4], &zero, 4);  // repeated column within a row
+    ok = parse(s, bad);
+    assert(!ok);
+}
+
+static std::vector<uint8_t> text_bytes() {
+    std::string text;
+    for (int i = 0; i < 40; ++i)
+        text += "block sparse recurrent weights skip the pruned tiles; ";
+    text += "\x01\xfe done.";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+static void check_header_flags(const std::string& densePath) {
+    std::ifstream ifs(densePath, std::ios::binary);
+    std::string file((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const fs::path path = fs::temp_directory_path() / "neurozip_test_block_sparse.bin";
+
+    auto loads_with_head = [&](uint32_t head) {
+        std::string f = file;
+        std::memcpy(&f[12], &head, 4);
+        std::ofstream(path, std::ios::binary).write(f.data(), (std::streamsize)f.size());
+        TinyLstmModel m;
+        return m.load_from_file(path.string());
+    };
+    bool ok = loads_with_head(LSTM_HEAD_BYTE);
+    assert(ok);
+    ok = loads_with_head(LSTM_HEAD_BYTE | (1u << 10));        // unknown flag
+    assert(!ok);
+    ok = loads_with_head(LSTM_HEAD_NIBBLE | LSTM_SPARSE_OUT); // nibble has no W_out
+    assert(!ok);
+    ok = loads_with_head(LSTM_HEAD_BYTE | LSTM_SPARSE_HH);    // dense data is no BSR record
+    assert(!ok);
+    fs::remove(path);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_block_sparse] Running...\n";
+    assert(argc > 3);
+
+    check_kernels();
+    check_header_flags(argv[1]);
+
+    TinyLstmModel dense, pruned, sparse;
+    bool ok = dense.load_from_file(argv[1]);
+    assert(ok);
+    ok = pruned.load_from_file(argv[2]);
+    assert(ok);
+    ok = sparse.load_from_file(argv[3]);
+    assert(ok);
+    assert(sparse.model_hash() != pruned.model_hash());
+
+    // 75% of the tiles are gone: weights read per byte drop ~3.7x.
+    assert(sparse.weight_bytes() * 3 < dense.weight_bytes());
+    assert(pruned.weight_bytes() == dense.weight_bytes());
+
+    const auto input = text_bytes();
+    for (bool fixedPoint : { false, true }) {
+        pruned.set_fixed_point(fixedPoint);
+        sparse.set_fixed_point(fixedPoint);
+
+        auto a = compress_buffer(pruned, input.data(), input.size());
+        auto b = compress_buffer(sparse, input.data(), input.size());
+
+        std::vector<uint8_t> out;
+        ok = decompress_buffer(sparse, b.data(), b.size(), input.size(), out);
+        assert(ok);
+        assert(out == input);
+
+        // Integer sums are exact, so the sparse kernels reproduce the
+        // dense model with zero tiles bit for bit.
+        if (fixedPoint) {
+            assert(a == b);
+        } else {
+            double ratio = (double)b.size() / (double)a.size();
+            assert(ratio > 0.99 && ratio < 1.01);
+        }
+
+        // Same per-step distribution as the dense form.
+        auto ca = pruned.create_context();
+        auto cb = sparse.create_context();
+        float pa[256], pb[256];
+        for (uint8_t c : { 'x', 'y', 'z' }) {
+            pruned.predict_next(*ca, c, pa, 256);
+            sparse.predict_next(*cb, c, pb, 256);
+        }
+        for (int i = 0; i < 256; ++i) {
+            if (fixedPoint) assert(pa[i] == pb[i]);
+            else assert(std::fabs(pa[i] - pb[i]) < 1e-5f);
+        }
+    }
+
+    std::cout << "[test_block_sparse] All tests passed.\n";
+    return 0;
+}
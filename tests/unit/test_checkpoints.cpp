@@ -0,0 +1,80 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/core/checkpoint.h"
+#include "../../src/models/tiny_lstm.h"
+#include "../test_util.h"
+
+using namespace neurozip;
+
+static void check_model(const TinyLstmModel& model, bool int8, bool twoPhase) {
+    auto input = test::make_text("2024-01-01 INFO request served in 12ms path=/api/v1/items ", 1500, 5, 17);
+
+    CompressOptions opts;
+    opts.checkpointInterval = 200;
+    opts.checkpointInt8 = int8;
+    opts.twoPhase = twoPhase;
+
+    CheckpointIndex index;
+    auto stream = compress_buffer(model, input.data(), input.size(), opts, &index);
+    assert(index.entries.size() == 7);
+
+    // Serialized index survives a round trip through the payload trailer.
+    std::vector<uint8_t> payload = stream;
+    append_checkpoint_index(index, payload);
+    size_t streamSize = 0;
+    CheckpointIndex parsed;
+    bool ok = split_checkpoint_index(payload.data(), payload.size(), streamSize, parsed);
+    assert(ok);
+    assert(streamSize == stream.size());
+    assert(parsed.entries.size() == index.entries.size());
+
+    // Full decode re-applies the checkpoints.
+    std::vector<uint8_t> out;
+    ok = decompress_buffer(model, payload.data(), streamSize, input.size(), out, &parsed);
+    assert(ok);
+    assert(out == input);
+
+    // Random access from the nearest checkpoint.
+    for (size_t offset : {0u, 150u, 200u, 777u, 1400u, 1499u}) {
+        size_t length = 90;
+        ok = decompress_range(model, payload.data(), streamSize, input.size(), parsed,
+                              offset, length, out);
+        assert(ok);
+        size_t end = std::min(input.size(), offset + length);
+        assert(out == std::vector<uint8_t>(input.begin() + offset, input.begin() + end));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_checkpoints] Running...\n";
+    assert(argc > 2);
+
+    // Half conversion
+    assert(float_to_half(1.0f) == 0x3C00);
+    assert(float_to_half(-2.0f) == 0xC000);
+    assert(half_to_float(0x3555) == half_to_float(float_to_half(half_to_float(0x3555))));
+    assert(half_to_float(0x0001) == 5.9604645e-08f);
+    assert(float_to_half(1e6f) == 0x7C00);
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+
+    check_model(model, false, false);
+    check_model(model, true, false);
+    check_model(model, false, true);
+
+    model.set_fixed_point(true);
+    check_model(model, false, false);
+    check_model(model, true, true);
+
+    TinyLstmModel nibble;
+    loaded = nibble.load_from_file(argv[2]);
+    assert(loaded);
+    check_model(nibble, false, false);
+
+    std::cout << "[test_checkpoints] OK\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/core/compact_frame.h"
+#include "../../src/core/range_coder.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+// Skewed table so intervals end up anywhere in the 32-bit range.
+static void check_minimal_flush(uint32_t seed, size_t count) {
+    uint32_t cum[9] = { 0, 1, 3, 7, 100, 2000, 2001, 30000, 32768 };
+    std::vector<uint32_t> symbols(count);
+    uint32_t x = seed;
+    for (auto& s : symbols) {
+        x = x * 1664525u + 1013904223u;
+        s = (x >> 24) & 7;
+    }
+
+    RangeEncoder full, minimal;
+    for (uint32_t s : symbols) {
+        full.encode_symbol(cum[s], cum[s + 1] - cum[s], 32768);
+        minimal.encode_symbol(cum[s], cum[s + 1] - cum[s], 32768);
+    }
+    full.finish();
+    minimal.finish_minimal();
+    assert(minimal.buffer().size() <= full.buffer().size());
+    assert(full.buffer().size() - minimal.buffer().size() <= 4);
+
+    RangeDecoder dec(minimal.buffer().data(), minimal.buffer().size());
+    for (uint32_t s : symbols) {
+        uint32_t v = dec.get_cum(32768);
+        uint32_t sym = 0;
+        while (cum[sym + 1] <= v) sym++;
+        assert(sym == s);
+        dec.decode_symbol(cum[sym], cum[sym + 1] - cum[sym], 32768);
+    }
+}
+
+static std::vector<uint8_t> bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_compact_frame] Running...\n";
+    assert(argc > 1);
+
+    // Minimal flush decodes like the 4-byte flush.
+    for (uint32_t seed = 0; seed < 300; ++seed) check_minimal_flush(seed, seed % 40);
+    {
+        RangeEncoder empty;
+        empty.finish_minimal();
+        assert(empty.buffer().empty());
+    }
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+
+    const std::vector<std::string> messages = {
+        "", "a", "ok", "user joined the channel",
+        "{\"event\":\"click\",\"id\":42,\"ts\":1700000000}",
+        std::string(300, 'z')
+    };
+    for (const auto& m : messages) {
+        const auto input = bytes(m);
+        for (bool checksum : { true, false }) {
+            std::vector<uint8_t> frame;
+            write_compact_frame(model, input.data(), input.size(), checksum, frame);
+            assert(is_compact_frame(frame.data(), frame.size()));
+
+            // Framing: 1 + varint + 2 (+ 2) bytes; the coded part is never
+            // longer than the regular stream.
+            CompactFrameInfo info;
+            ErrorCode ec = parse_compact_frame(frame.data(), frame.size(), info);
+            assert(ec == ErrorCode::Ok);
+            assert(info.originalSize == input.size() && info.hasChecksum == checksum);
+            assert(info.streamOffset == (input.size() < 128 ? 4u : 5u) + (checksum ? 2u : 0u));
+            auto stream = compress_buffer(model, input.data(), input.size());
+            assert(frame.size() - info.streamOffset <= stream.size());
+
+            std::vector<uint8_t> out;
+            ec = read_compact_frame(model, frame.data(), frame.size(), out);
+            assert(ec == ErrorCode::Ok);
+            assert(out == input);
+        }
+    }
+
+    // Errors: other model tag, other inference mode, bad checksum, truncation.
+    const auto input = bytes("the quick brown fox jumps over the lazy dog");
+    std::vector<uint8_t> frame, out;
+    write_compact_frame(model, input.data(), input.size(), true, frame);
+
+    auto wrongTag = frame;
+    wrongTag[2] ^= 1;
+    ErrorCode ec = read_compact_frame(model, wrongTag.data(), wrongTag.size(), out);
+    assert(ec == ErrorCode::ModelMismatch);
+
+    model.set_fixed_point(true);
+    ec = read_compact_frame(model, frame.data(), frame.size(), out);
+    assert(ec == ErrorCode::ModelMismatch);
+    model.set_fixed_point(false);
+
+    auto wrongSum = frame;
+    wrongSum[4] ^= 0x5a;
+    ec = read_compact_frame(model, wrongSum.data(), wrongSum.size(), out);
+    assert(ec == ErrorCode::CorruptData);
+
+    ec = read_compact_frame(model, frame.data(), 3, out);
+    assert(ec == ErrorCode::CorruptData);
+
+    // A .nzp image is not a frame.
+    const uint8_t nzp[4] = { 'N', 'Z', 'P', '1' };
+    assert(!is_compact_frame(nzp, sizeof(nzp)));
+
+    std::cout << "[test_compact_frame] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/daemon/daemon_client.h"
+#include "../../src/daemon/daemon_server.h"
+#include "../test_util.h"
+
+using namespace neurozip;
+
+static std::vector<uint8_t> make_input(size_t n, unsigned seed) {
+    return test::make_text("the daemon keeps the model warm between requests; ", n, 3, 0, seed);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_daemon] Running...\n";
+    assert(argc > 1);
+
+    daemon::DaemonConfig config;
+    config.modelPath = argv[1];
+    config.socketPath = "/tmp/neurozipd_test_" + std::to_string(getpid()) + ".sock";
+    config.workers = 3;
+
+    daemon::DaemonServer server(config);
+    std::string error;
+    bool started = server.start(&error);
+    assert(started);
+
+    // Same result as compressing in-process
+    Model model(config.modelPath);
+    assert(model.valid());
+    auto input = make_input(700, 0);
+    std::vector<uint8_t> expected;
+    nzp_error_t err = compress_memory(input, expected, model);
+    assert(err == NZP_OK);
+
+    daemon::DaemonClient client;
+    bool ok = client.connect(config.socketPath);
+    assert(ok);
+    err = client.ping();
+    assert(err == NZP_OK);
+
+    std::vector<uint8_t> comp, out;
+    err = client.compress(input, comp);
+    assert(err == NZP_OK);
+    assert(comp == expected);
+    err = client.decompress(comp, out);
+    assert(err == NZP_OK);
+    assert(out == input);
+
+    // Fixed-point requests are detected again on decompression
+    err = client.compress(input, comp, true);
+    assert(err == NZP_OK);
+    err = client.decompress(comp, out);
+    assert(err == NZP_OK);
+    assert(out == input);
+
+    // Compact frames are routed by their own mode bit
+    for (bool fixedPoint : { false, true }) {
+        model.set_fixed_point(fixedPoint);
+        std::vector<uint8_t> frame;
+        err = compress_frame(input, frame, model);
+        assert(err == NZP_OK);
+        err = client.decompress(frame, out);
+        assert(err == NZP_OK);
+        assert(out == input);
+    }
+    model.set_fixed_point(false);
+
+    // Errors are reported in-band and keep the connection usable
+    comp[60] ^= 0x55;
+    err = client.decompress(comp, out);
+    assert(err == NZP_ERR_CORRUPT);
+    err = client.decompress(std::vector<uint8_t>(8, 0), out);
+    assert(err == NZP_ERR_INVALID_FORMAT);
+    err = client.ping();
+    assert(err == NZP_OK);
+
+    // Idle connections do not hold a worker: with more of them open than
+    // there are workers, a new client is still served.
+    std::vector<daemon::DaemonClient> idle(config.workers + 2);
+    for (auto& c : idle) {
+        ok = c.connect(config.socketPath) && c.ping() == NZP_OK;
+        assert(ok);
+    }
+    daemon::DaemonClient late;
+    ok = late.connect(config.socketPath);
+    assert(ok);
+    err = late.compress(input, comp);
+    assert(err == NZP_OK);
+    assert(comp == expected);
+    late.close();
+    for (auto& c : idle) {
+        err = c.ping();
+        assert(err == NZP_OK);
+        c.close();
+    }
+
+    // Concurrent clients, more than there are workers
+    std::vector<std::thread> threads;
+    std::vector<int> results(5, 0);
+    for (unsigned t = 0; t < results.size(); t++) {
+        threads.emplace_back([&, t] {
+            daemon::DaemonClient c;
+            if (!c.connect(config.socketPath)) return;
+            for (unsigned r = 0; r < 3; r++) {
+                auto data = make_input(200 + 50 * t, t + r);
+                std::vector<uint8_t> z, y;
+                if (c.compress(data, z) != NZP_OK) return;
+                if (c.decompress(z, y) != NZP_OK || y != data) return;
+            }
+            c.close();
+            results[t] = 1;
+        });
+    }
+    for (auto& th : threads) th.join();
+    for (int r : results) assert(r == 1);
+
+    // Hot reload keeps serving
+    ok = server.reload();
+    assert(ok);
+    err = client.compress(input, comp);
+    assert(err == NZP_OK);
+    assert(comp == expected);
+    client.close();
+
+    server.stop();
+    bool removed = access(config.socketPath.c_str(), F_OK) != 0;
+    assert(removed);
+    assert(server.requests_served() >= 30);
+
+    std::cout << "[test_daemon] OK\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/estimate.h"
+#include "../../src/core/worker_pool.h"
+#include "../../src/models/model_loader.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> text_bytes(size_t size) {
+    const std::string line = "the estimate models a sample of the input without coding it. ";
+    std::vector<uint8_t> out;
+    while (out.size() < size) out.insert(out.end(), line.begin(), line.end());
+    out.resize(size);
+    return out;
+}
+
+static std::vector<uint8_t> random_bytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> out(size);
+    for (auto& b : out) {
+        seed = seed * 1664525u + 1013904223u;
+        b = (uint8_t)(seed >> 24);
+    }
+    return out;
+}
+
+static bool near(double a, double b, double rel, double abs) {
+    return std::fabs(a - b) <= rel * std::fabs(b) + abs;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_estimate] Running...\n";
+    assert(argc > 1);
+    auto model = load_model(argv[1]);
+    assert(model);
+
+    // Text followed by noise: the profile shows where the bits go.
+    std::vector<uint8_t> input = text_bytes(6000);
+    const std::vector<uint8_t> noise = random_bytes(2000, 11);
+    input.insert(input.end(), noise.begin(), noise.end());
+
+    for (bool fixedPoint : { false, true }) {
+        model->set_fixed_point(fixedPoint);
+
+        // The code length is what the range coder spends, up to its flush.
+        const double bits = code_length_bits(*model, input.data(), input.size());
+        const auto stream = compress_buffer(*model, input.data(), input.size());
+        assert(near(bits / 8.0 + 4.0, (double)stream.size(), 0.002, 8.0));
+
+        // Whole-input estimate: one window, the same code length.
+        EstimateOptions whole;
+        whole.sampleBytes = 0;
+        SizeEstimate e = estimate_size(*model, input.data(), input.size(), whole);
+        assert(e.inputBytes == input.size() && e.sampledBytes == input.size());
+        assert(e.sampledBits == bits);
+        assert(near((double)e.stream_bytes(), (double)stream.size(), 0.002, 8.0));
+
+        // Per-region costs add up to the total; noise costs more than text.
+        const size_t region = 1000;
+        std::vector<double> bpb = bit_profile(*model, input.data(), input.size(), region);
+        assert(bpb.size() == 8);
+        double sum = 0.0;
+        for (double b : bpb) sum += b * (double)region;
+        assert(near(sum, bits, 1e-9, 1e-6));
+        assert(bpb[7] > 7.5 && bpb[7] > bpb[1]);
+
+        // Streams restart from a fresh state, as segments do.
+        std::vector<double> split = bit_profile(*model, input.data(), input.size(), region, { 3500 });
+        double first = code_length_bits(*model, input.data(), 3500);
+        double second = code_length_bits(*model, input.data() + 3500, input.size() - 3500);
+        sum = 0.0;
+        for (double b : split) sum += b * (double)region;
+        assert(near(sum, first + second, 1e-9, 1e-6));
+    }
+    model->set_fixed_point(false);
+
+    // Sampled windows on a pool: deterministic and independent of the
+    // thread count; a uniform input extrapolates to about its real size.
+    const std::vector<uint8_t> big = text_bytes(300000);
+    EstimateOptions sampled;
+    sampled.sampleBytes = 32768;
+    sampled.windows = 8;
+    SizeEstimate serial = estimate_size(*model, big.data(), big.size(), sampled);
+    assert(serial.sampledBytes == 32768);
+    WorkerPool pool(3, false);
+    sampled.pool = &pool;
+    SizeEstimate parallel = estimate_size(*model, big.data(), big.size(), sampled);
+    assert(parallel.sampledBits == serial.sampledBits);
+
+    EstimateOptions all;
+    all.sampleBytes = 0;
+    all.pool = &pool;
+    SizeEstimate full = estimate_size(*model, big.data(), big.size(), all);
+    assert(full.sampledBytes == big.size());
+    assert(near(serial.bits_per_byte(), full.bits_per_byte(), 0.05, 0.0));
+
+    // C API: estimate and profile a file.
+    nzp_model_t* cmodel = nzp_model_load(argv[1]);
+    assert(cmodel);
+    nzp_estimate_options_t eo;
+    nzp_estimate_options_init(&eo);
+    eo.sample_bytes = 0;
+    nzp_estimate_t est;
+    nzp_error_t err = nzp_estimate_memory(input.data(), input.size(), cmodel, &eo, &est);
+    assert(err == NZP_OK);
+
+    uint8_t* image = nullptr;
+    uint64_t imageSize = 0;
+    err = nzp_compress_memory(input.data(), input.size(), cmodel, nullptr, &image, &imageSize);
+    assert(err == NZP_OK);
+    assert(near((double)est.estimated_bytes, (double)imageSize, 0.002, 8.0));
+
+    const fs::path path = fs::temp_directory_path() / "neurozip_test_estimate.nzp";
+    std::ofstream(path, std::ios::binary).write((const char*)image, (std::streamsize)imageSize);
+    nzp_buffer_free(image);
+
+    // The file was coded in float mode; a fixed-point handle still
+    // profiles it in the mode it was coded in.
+    nzp_model_set_fixed_point(cmodel, 1);
+    double* profile = nullptr;
+    uint64_t regions = 0;
+    err = nzp_profile_file(path.string().c_str(), cmodel, 3000, &profile, &regions);
+    assert(err == NZP_OK);
+    assert(regions == 3);
+    std::vector<double> ref = bit_profile(*model, input.data(), input.size(), 3000);
+    for (uint64_t r = 0; r < regions; ++r) assert(profile[r] == ref[r]);
+    nzp_profile_free(profile);
+    err = nzp_profile_file(path.string().c_str(), cmodel, 0, &profile, &regions);
+    assert(err == NZP_ERR_INTERNAL);
+
+    fs::remove(path);
+    nzp_model_free(cmodel);
+
+    std::cout << "[test_estimate] All tests passed.\n";
+    return 0;
+}
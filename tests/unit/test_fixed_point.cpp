@@ -0,0 +1,47 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/core/file_format.h"
+#include "../../src/models/fixed_point.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+int main(int argc, char** argv) {
+    std::cout << "[test_fixed_point] Running...\n";
+    assert(argc > 1);
+
+    // LUT anchors
+    assert(fixed::sigmoid_lut()[fixed::kLutHalf] == 1 << (fixed::kActFrac - 1));
+    assert(fixed::tanh_lut()[fixed::kLutHalf] == 0);
+    assert(fixed::exp_neg_lut()[0] == 1 << fixed::kExpFrac);
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+    model.set_fixed_point(true);
+    assert(model.fixed_point());
+
+    const char* text = "The quick brown fox jumps over the lazy dog. 0123456789";
+    size_t n = strlen(text);
+
+    auto comp = compress_buffer(model, (const uint8_t*)text, n);
+    auto comp2 = compress_buffer(model, (const uint8_t*)text, n);
+    assert(comp == comp2);
+
+    std::vector<uint8_t> out;
+    bool ok = decompress_buffer(model, comp.data(), comp.size(), n, out);
+    assert(ok);
+    assert(std::string(out.begin(), out.end()) == text);
+
+    // The fixed-point stream must be identical on every compiler and CPU.
+    uint32_t crc = crc32(comp.data(), comp.size());
+    std::cout << "[test_fixed_point] stream crc 0x" << std::hex << crc << std::dec
+              << " (" << comp.size() << " bytes)\n";
+    assert(crc == 0x9c8ecba9u);
+
+    std::cout << "[test_fixed_point] OK\n";
+    return 0;
+}
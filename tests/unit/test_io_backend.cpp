@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/core/io_backend.h"
+#include "../test_util.h"
+
+using neurozip::test::read_all;
+
+static void check_backend(neurozip::IoBackend& io) {
+    std::cout << "  backend: " << io.name() << "\n";
+    const std::string path = std::string("test_io_") + io.name() + ".bin";
+
+    std::vector<uint8_t> data(100000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 31 + (i >> 8));
+
+    // Several requests in flight at once.
+    auto written = io.write(path, data);
+    auto empty = io.write(path + ".empty", {});
+    neurozip::ErrorCode ec = written.get();
+    assert(ec == neurozip::ErrorCode::Ok);
+    ec = empty.get();
+    assert(ec == neurozip::ErrorCode::Ok);
+    assert(read_all(path) == data);
+
+    auto whole = io.read(path);
+    auto range = io.read(path, 4000, 5000);
+    auto tail = io.read(path, 99990);
+    auto none = io.read(path + ".empty");
+    neurozip::IoReadResult r = whole.get();
+    assert(r.error == neurozip::ErrorCode::Ok && r.data == data);
+    r = range.get();
+    assert(r.error == neurozip::ErrorCode::Ok);
+    assert(r.data == std::vector<uint8_t>(data.begin() + 4000, data.begin() + 9000));
+    r = tail.get();
+    assert(r.error == neurozip::ErrorCode::Ok && r.data.size() == 10);
+    r = none.get();
+    assert(r.error == neurozip::ErrorCode::Ok && r.data.empty());
+
+    // Missing files and short ranges are errors.
+    r = io.read("test_io_missing.bin").get();
+    assert(r.error == neurozip::ErrorCode::IoError);
+    r = io.read(path, 99000, 2000).get();
+    assert(r.error == neurozip::ErrorCode::IoError);
+    ec = io.write("test_io_no_such_dir/out.bin", data).get();
+    assert(ec == neurozip::ErrorCode::IoError);
+
+    // More requests than the queue holds.
+    std::vector<std::future<neurozip::IoReadResult>> many;
+    for (int i = 0; i < 200; ++i) many.push_back(io.read(path, (uint64_t)i * 100, 100));
+    for (int i = 0; i < 200; ++i) {
+        r = many[i].get();
+        assert(r.error == neurozip::ErrorCode::Ok);
+        assert(std::equal(r.data.begin(), r.data.end(), data.begin() + i * 100));
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".empty").c_str());
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_io_backend] Running...\n";
+    assert(argc > 1);
+
+    auto blocking = neurozip::make_io_backend(neurozip::IoBackendKind::Blocking);
+    assert(blocking->kind() == neurozip::IoBackendKind::Blocking);
+    check_backend(*blocking);
+
+    // io_uring may be compiled out or refused by the kernel; the factory
+    // then falls back to blocking I/O.
+    auto uring = neurozip::make_io_backend(neurozip::IoBackendKind::IoUring);
+    bool haveUring = neurozip::io_backend_available(neurozip::IoBackendKind::IoUring);
+    assert(haveUring == (uring->kind() == neurozip::IoBackendKind::IoUring));
+    assert((nzp_io_backend_available(NZP_IO_URING) != 0) == haveUring);
+    check_backend(*uring);
+    if (!haveUring) std::cout << "  io_uring unavailable, tested the fallback\n";
+
+    // A batch round trip through the io_uring backend matches the blocking one.
+    neurozip::Model model(argv[1]);
+    assert(model.valid());
+
+    const std::string text = "reads for the next task are queued while this one runs. ";
+    std::vector<std::string> inputs, compressed, expected, restored;
+    for (size_t i = 0; i < 4; ++i) {
+        std::string path = "test_io_batch_" + std::to_string(i) + ".txt";
+        std::ofstream ofs(path, std::ios::binary);
+        for (size_t k = 0; k < 600 * (i + 1); ++k) ofs.put(text[(k * (i + 2)) % text.size()]);
+        ofs.close();
+        inputs.push_back(path);
+        compressed.push_back(path + ".nzp");
+        expected.push_back(path + ".ref.nzp");
+        restored.push_back(path + ".out");
+    }
+
+    nzp_batch_options_t options;
+    nzp_batch_options_init(&options);
+    options.threads = 2;
+    options.segment_size = 1000;
+
+    std::vector<nzp_error_t> errors;
+    nzp_error_t err = neurozip::compress_batch(inputs, expected, model, options, errors);
+    assert(err == NZP_OK);
+
+    options.io_backend = NZP_IO_URING;
+    err = neurozip::compress_batch(inputs, compressed, model, options, errors);
+    assert(err == NZP_OK);
+    err = neurozip::decompress_batch(compressed, restored, model, options, errors);
+    assert(err == NZP_OK);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        assert(read_all(compressed[i]) == read_all(expected[i]));
+        assert(read_all(restored[i]) == read_all(inputs[i]));
+    }
+
+    // Per-file errors still surface through the asynchronous path.
+    std::vector<std::string> badIn = {inputs[0], "test_io_missing.txt"};
+    std::vector<std::string> badOut = {compressed[0], "test_io_missing.txt.nzp"};
+    err = neurozip::compress_batch(badIn, badOut, model, options, errors);
+    assert(err == NZP_ERR_IO);
+    assert(errors[0] == NZP_OK && errors[1] == NZP_ERR_IO);
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::remove(inputs[i].c_str());
+        std::remove(compressed[i].c_str());
+        std::remove(expected[i].c_str());
+        std::remove(restored[i].c_str());
+    }
+
+    std::cout << "[test_io_backend] OK\n";
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/api/neurozip_cpp.h"
+#include "../../src/core/hot_swap.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> sample_text(int seed)
+{
+    std::string s;
+    for (int i = 0; i < 6; ++i)
+        s += "event " + std::to_string(seed * 100 + i) + ": cache refreshed in 12 ms\n";
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+struct Counted {
+    static std::atomic<int> live;
+    int value;
+    explicit Counted(int v) : value(v) { ++live; }
+    ~Counted() { --live; }
+};
+std::atomic<int> Counted::live{ 0 };
+
+static void check_hot_swap()
+{
+    {
+        HotSwap<Counted> swap;
+        assert(swap.acquire() == nullptr);
+        swap.publish(swap.create(new Counted(1), 1), false);
+
+        // A lease keeps a replaced object until it is released.
+        auto* lease = swap.acquire();
+        assert(lease && lease->object->value == 1);
+        swap.publish(swap.create(new Counted(2), 2), false);
+        assert(Counted::live == 2);
+        auto* current = swap.acquire();
+        assert(current->object->value == 2);
+        HotSwap<Counted>::release(current);
+        HotSwap<Counted>::release(lease);
+        assert(Counted::live == 1);
+
+        // Kept objects are found by key until dropped.
+        swap.publish(swap.create(new Counted(3), 3), true);
+        assert(swap.kept() == 1 && Counted::live == 2);
+        auto* old = swap.acquire_if([](const HotSwap<Counted>::Entry& e) { return e.key == 2; });
+        assert(old && old->object->value == 2);
+        auto* missing = swap.acquire_if([](const HotSwap<Counted>::Entry& e) { return e.key == 7; });
+        assert(!missing);
+        size_t dropped = swap.drop(2);
+        assert(dropped == 1 && swap.kept() == 0);
+        assert(Counted::live == 2);
+        HotSwap<Counted>::release(old);
+        assert(Counted::live == 1);
+        dropped = swap.drop(2);
+        assert(dropped == 0);
+    }
+    assert(Counted::live == 0);
+
+    // Readers racing with writers always see a live object.
+    {
+        HotSwap<Counted> swap;
+        swap.publish(swap.create(new Counted(0), 0), false);
+        std::atomic<bool> stop{ false };
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&] {
+                while (!stop) {
+                    auto* e = swap.acquire();
+                    assert(e && e->object->value == (int)e->key);
+                    HotSwap<Counted>::release(e);
+                }
+            });
+        }
+        for (int i = 1; i <= 2000; ++i) swap.publish(swap.create(new Counted(i), i), (i % 100) == 0);
+        stop = true;
+        for (auto& t : readers) t.join();
+        assert(swap.kept() == 20);
+    }
+    assert(Counted::live == 0);
+}
+
+static std::vector<uint8_t> roundtrip(nzp_model_t* model, const std::vector<uint8_t>& text)
+{
+    uint8_t* image = nullptr;
+    uint64_t imageSize = 0;
+    nzp_error_t err = nzp_compress_memory(text.data(), text.size(), model, nullptr, &image, &imageSize);
+    assert(err == NZP_OK);
+    uint8_t* out = nullptr;
+    uint64_t outSize = 0;
+    err = nzp_decompress_memory(image, imageSize, model, &out, &outSize);
+    assert(err == NZP_OK);
+    std::vector<uint8_t> result(out, out + outSize);
+    nzp_buffer_free(out);
+    nzp_buffer_free(image);
+    return result;
+}
+
+static std::vector<uint8_t> compress(nzp_model_t* model, const std::vector<uint8_t>& text, bool frame)
+{
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = frame ? nzp_compress_frame(text.data(), text.size(), model, 1, &data, &size)
+                            : nzp_compress_memory(text.data(), text.size(), model, nullptr, &data, &size);
+    assert(err == NZP_OK);
+    std::vector<uint8_t> result(data, data + size);
+    nzp_buffer_free(data);
+    return result;
+}
+
+static nzp_error_t decompress(nzp_model_t* model, const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    uint8_t* buf = nullptr;
+    uint64_t size = 0;
+    nzp_error_t err = nzp_decompress_memory(data.data(), data.size(), model, &buf, &size);
+    if (err == NZP_OK) out.assign(buf, buf + size);
+    nzp_buffer_free(buf);
+    return err;
+}
+
+static void check_c_api(const char* pathA, const char* pathB)
+{
+    const auto text = sample_text(1);
+    nzp_model_t* a = nzp_model_load(pathA);
+    nzp_model_t* b = nzp_model_load(pathB);
+    assert(a && b && nzp_model_hash(a) != nzp_model_hash(b));
+    const uint64_t hashA = nzp_model_hash(a);
+
+    nzp_model_slot_t* slot = nzp_model_slot_create(a);
+    assert(slot);
+    nzp_model_slot_t* again = nzp_model_slot_create(a);
+    assert(!again);                           // a model belongs to one slot
+    nzp_model_free(a);                        // ignored: the slot owns it
+
+    const auto image = compress(a, text, false);
+    const auto frame = compress(a, text, true);
+    const fs::path file = fs::temp_directory_path() / "neurozip_test_model_slot.nzp";
+    std::ofstream(file, std::ios::binary).write((const char*)image.data(), (std::streamsize)image.size());
+
+    // In-flight work keeps the old model across a swap.
+    nzp_model_t* lease = nzp_model_slot_acquire(slot);
+    assert(lease == a);
+    nzp_error_t err = nzp_model_slot_swap(slot, b, 1);
+    assert(err == NZP_OK);
+    err = nzp_model_slot_swap(slot, b, 1);
+    assert(err == NZP_ERR_INTERNAL);
+    nzp_model_t* current = nzp_model_slot_acquire(slot);
+    assert(current == b);
+    auto decoded = roundtrip(lease, text);
+    assert(decoded == text);
+    decoded = roundtrip(current, text);
+    assert(decoded == text);
+    nzp_model_slot_release(current);
+    nzp_model_slot_release(lease);
+
+    // Old files and frames find the kept model by hash / tag.
+    std::vector<uint8_t> out;
+    for (const auto* data : { &image, &frame }) {
+        nzp_model_t* m = nzp_model_slot_acquire_for_memory(slot, data->data(), data->size());
+        assert(m == a);
+        err = decompress(m, *data, out);
+        assert(err == NZP_OK && out == text);
+        nzp_model_slot_release(m);
+    }
+    nzp_model_t* m = nzp_model_slot_acquire_for_file(slot, file.string().c_str());
+    assert(m == a);
+    nzp_model_slot_release(m);
+    const auto imageB = compress(b, text, false);
+    m = nzp_model_slot_acquire_for_memory(slot, imageB.data(), imageB.size());
+    assert(m == b);
+    nzp_model_slot_release(m);
+
+    // Forgotten models are freed by their last lease; their files then
+    // fall back to the current model and no longer decode.
+    lease = nzp_model_slot_acquire_for_memory(slot, image.data(), image.size());
+    assert(lease == a);
+    size_t forgotten = nzp_model_slot_forget(slot, hashA);
+    assert(forgotten == 1);
+    forgotten = nzp_model_slot_forget(slot, hashA);
+    assert(forgotten == 0);
+    err = decompress(lease, image, out);
+    assert(err == NZP_OK && out == text);
+    nzp_model_slot_release(lease);
+    m = nzp_model_slot_acquire_for_memory(slot, image.data(), image.size());
+    assert(m == b);
+    err = decompress(m, image, out);
+    assert(err == NZP_ERR_MODEL_MISMATCH);
+    nzp_model_slot_release(m);
+
+    fs::remove(file);
+    nzp_model_slot_free(slot);
+
+    nzp_model_slot_t* empty = nzp_model_slot_create(nullptr);
+    assert(empty);
+    m = nzp_model_slot_acquire(empty);
+    assert(!m);
+    m = nzp_model_slot_acquire_for_memory(empty, image.data(), image.size());
+    assert(!m);
+    nzp_model_slot_free(empty);
+}
+
+// Readers never stall or fail while models are rolled out underneath.
+static void check_live_swaps(const char* pathA, const char* pathB)
+{
+    ModelSlot slot{ Model(pathA) };
+    std::atomic<bool> stop{ false };
+    std::atomic<int> calls{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t] {
+            const auto text = sample_text(t);
+            while (!stop || calls < 12) {
+                ModelLease lease = slot.acquire();
+                assert(lease.valid());
+                auto decoded = roundtrip(lease.raw(), text);
+                assert(decoded == text);
+                ++calls;
+            }
+        });
+    }
+    for (int i = 0; i < 8; ++i) {
+        Model next(i % 2 ? pathA : pathB);
+        assert(next.valid());
+        nzp_error_t err = slot.swap(std::move(next));
+        assert(err == NZP_OK && !next.valid());
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "[test_model_slot] Running...\n";
+    assert(argc > 2);
+
+    check_hot_swap();
+    check_c_api(argv[1], argv[2]);
+    check_live_swaps(argv[1], argv[2]);
+
+    std::cout << "[test_model_slot] All tests passed.\n";
+    return 0;
+}
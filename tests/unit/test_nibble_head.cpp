@@ -0,0 +1,45 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+static void check_roundtrip(const TinyLstmModel& model, const std::string& text) {
+    auto comp = compress_buffer(model, (const uint8_t*)text.data(), text.size());
+
+    std::vector<uint8_t> out;
+    bool ok = decompress_buffer(model, comp.data(), comp.size(), text.size(), out);
+    assert(ok);
+    assert(std::string(out.begin(), out.end()) == text);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_nibble_head] Running...\n";
+    assert(argc > 1);
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+    assert(model.nibble_output());
+    assert(model.model_id() == MODEL_ID_TINY_LSTM_NIBBLE);
+
+    // The full byte distribution p(hi) * p(lo | hi) must still sum to 1.
+    auto ctx = model.create_context();
+    float probs[256];
+    model.predict_next(*ctx, 'a', probs, 256);
+    float sum = 0.0f;
+    for (float p : probs) sum += p;
+    assert(std::fabs(sum - 1.0f) < 1e-3f);
+
+    std::string text = "Nibble heads code every byte as two 16-way symbols. \x01\xff\x80 done.";
+    check_roundtrip(model, text);
+
+    model.set_fixed_point(true);
+    check_roundtrip(model, text);
+
+    std::cout << "[test_nibble_head] OK\n";
+    return 0;
+}
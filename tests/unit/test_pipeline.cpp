@@ -0,0 +1,78 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/core/checkpoint.h"
+#include "../../src/core/spsc_ring.h"
+#include "../../src/models/tiny_lstm.h"
+#include "../test_util.h"
+
+using namespace neurozip;
+
+static std::vector<uint8_t> make_input(size_t n) {
+    return test::make_text("the coder thread drains what the model thread produced. ", n, 5, 11);
+}
+
+static void check_identical(const TinyLstmModel& model, const std::vector<uint8_t>& input) {
+    CompressOptions opts;
+    opts.pipelined = true;
+    bool same = test::encodes_like_serial(model, input, opts);
+    assert(same);
+
+    // Checkpoints are split across the two threads.
+    CompressOptions cpOpts;
+    cpOpts.checkpointInterval = 300;
+    CheckpointIndex serialIndex, pipelinedIndex;
+    auto serialCp = compress_buffer(model, input.data(), input.size(), cpOpts, &serialIndex);
+    cpOpts.pipelined = true;
+    auto pipelinedCp = compress_buffer(model, input.data(), input.size(), cpOpts, &pipelinedIndex);
+    assert(pipelinedCp == serialCp);
+    assert(pipelinedIndex.entries.size() == serialIndex.entries.size());
+    for (size_t k = 0; k < serialIndex.entries.size(); ++k) {
+        const auto& a = serialIndex.entries[k];
+        const auto& b = pipelinedIndex.entries[k];
+        assert(a.bytePos == b.bytePos && a.streamPos == b.streamPos);
+        assert(a.low == b.low && a.high == b.high && a.state == b.state);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_pipeline] Running...\n";
+    assert(argc > 2);
+
+    // Ring: order and contents survive a producer racing a consumer,
+    // including wrap-around and full/empty transitions.
+    SpscRing<uint32_t> ring(100);
+    assert(ring.capacity() == 128);
+    const uint32_t count = 200000;
+    std::thread consumer([&] {
+        uint32_t v = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            ring.pop(v);
+            assert(v == i * 2654435761u);
+        }
+    });
+    for (uint32_t i = 0; i < count; ++i) ring.push(i * 2654435761u);
+    consumer.join();
+    uint32_t leftover;
+    bool popped = ring.try_pop(leftover);
+    assert(!popped);
+
+    for (int m = 1; m <= 2; ++m) {
+        TinyLstmModel model;
+        bool loaded = model.load_from_file(argv[m]);
+        assert(loaded);
+
+        auto input = make_input(3000);
+        check_identical(model, input);
+        check_identical(model, make_input(1));
+        check_identical(model, {});
+
+        model.set_fixed_point(true);
+        check_identical(model, input);
+    }
+
+    std::cout << "[test_pipeline] OK\n";
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/archive.h"
+#include "../../src/core/compact_frame.h"
+#include "../../src/core/file_format.h"
+#include "../../src/core/worker_pool.h"
+#include "../../src/models/model_loader.h"
+#include "../../src/models/primed_state.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static const std::string kPrefix =
+    "{\"user\": \"alice\", \"action\": \"login\", \"status\": \"ok\"}\n"
+    "{\"user\": \"bob\", \"action\": \"logout\", \"status\": \"ok\"}\n";
+static const std::string kMessage = "{\"user\": \"carol\", \"action\": \"login\", \"status\": \"denied\"}";
+
+// A primed context continues exactly where a cold one would after the
+// prefix and a 0 separator.
+static void check_snapshot(ICompressionModel& model) {
+    const auto prefix = bytes(kPrefix);
+    bool ok = model.set_primed_state(1);
+    assert(ok);
+
+    for (bool fixedPoint : { false, true }) {
+        model.set_fixed_point(fixedPoint);
+        auto cold = std::make_unique<ModelContext>();
+        float a[256], b[256];
+        uint8_t prev = 0;
+        for (uint8_t x : prefix) {
+            model.predict_next(*cold, prev, a, 256);
+            prev = x;
+        }
+        model.predict_next(*cold, prev, a, 256);
+        model.predict_next(*cold, 0, a, 256);
+
+        auto warm = model.create_context();
+        model.predict_next(*warm, 0, b, 256);
+        if (!fixedPoint) assert(std::memcmp(a, b, sizeof(a)) == 0);
+
+        // Round trip from the snapshot; a cold start codes differently.
+        const auto msg = bytes(kMessage);
+        auto primed = compress_buffer(model, msg.data(), msg.size());
+        std::vector<uint8_t> out;
+        ok = decompress_buffer(model, primed.data(), primed.size(), msg.size(), out);
+        assert(ok);
+        assert(out == msg);
+        model.set_primed_state(0);
+        auto coldStream = compress_buffer(model, msg.data(), msg.size());
+        assert(coldStream != primed);
+        model.set_primed_state(1);
+    }
+    model.set_fixed_point(false);
+    model.set_primed_state(0);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_primed_state] Running...\n";
+    assert(argc > 2);
+
+    const fs::path dir = fs::temp_directory_path();
+    const std::string prefixPath = (dir / "neurozip_test_primed_prefix.txt").string();
+    const std::string lstmPath = (dir / "neurozip_test_primed_lstm.bin").string();
+    const std::string gruPath = (dir / "neurozip_test_primed_gru.bin").string();
+    std::ofstream(prefixPath, std::ios::binary) << kPrefix;
+
+    // Snapshots follow the weights and leave the model hash alone.
+    const auto prefix = bytes(kPrefix);
+    bool ok = write_primed_model(argv[1], lstmPath, { prefix });
+    assert(ok);
+    ok = write_primed_model(argv[2], gruPath, { prefix });
+    assert(ok);
+    auto base = load_model(argv[1]);
+    auto lstm = load_model(lstmPath);
+    auto gru = load_model(gruPath);
+    assert(base && lstm && gru);
+    assert(base->primed_state_count() == 0 && lstm->primed_state_count() == 1);
+    assert(lstm->model_hash() == base->model_hash());
+    ok = lstm->set_primed_state(2);
+    assert(!ok && lstm->primed_state() == 0);
+    ok = lstm->set_primed_state(1);
+    assert(ok && lstm->primed_state_hash() != 0);
+    assert(primed_state_tag(*lstm) == (((uint64_t)lstm->primed_state_hash() << 32) | 1));
+    lstm->set_primed_state(0);
+
+    check_snapshot(*lstm);
+    check_snapshot(*gru);
+
+    // Priming again appends: id 1 keeps its snapshot.
+    const std::string twicePath = (dir / "neurozip_test_primed_twice.bin").string();
+    ok = write_primed_model(lstmPath, twicePath, { bytes("second prefix") });
+    assert(ok);
+    auto twice = load_model(twicePath);
+    assert(twice && twice->primed_state_count() == 2);
+    lstm->set_primed_state(1);
+    twice->set_primed_state(1);
+    assert(twice->primed_state_hash() == lstm->primed_state_hash());
+    twice->set_primed_state(2);
+    assert(twice->primed_state_hash() != lstm->primed_state_hash());
+    lstm->set_primed_state(0);
+
+    // Archives record the snapshot, not just its id: another model's
+    // state 1 is refused as the base and when extracting.
+    {
+        const std::string otherPath = (dir / "neurozip_test_primed_other.bin").string();
+        const std::string archivePath = (dir / "neurozip_test_primed.nza").string();
+        const std::string outDir = (dir / "neurozip_test_primed_out").string();
+        ok = write_primed_model(argv[1], otherPath, { bytes("second prefix") });
+        assert(ok);
+        auto other = load_model(otherPath);
+        assert(other);
+        lstm->set_primed_state(1);
+        other->set_primed_state(1);
+        assert(other->primed_state_hash() != lstm->primed_state_hash());
+
+        WorkerPool pool(2, false);
+        ErrorCode ec = create_archive(*lstm, pool, { prefixPath }, archivePath);
+        assert(ec == ErrorCode::Ok);
+        ArchiveIndex index;
+        ec = read_archive_index(archivePath, index);
+        assert(ec == ErrorCode::Ok && index.primedState == 1);
+        assert(index.primedStateHash == lstm->primed_state_hash());
+
+        ec = extract_archive(*other, pool, archivePath, outDir);
+        assert(ec == ErrorCode::ModelMismatch);
+        ArchiveOptions options;
+        options.basePath = archivePath;
+        ec = create_archive(*other, pool, { prefixPath }, archivePath + ".2", options);
+        assert(ec == ErrorCode::ModelMismatch);
+        ec = extract_archive(*lstm, pool, archivePath, outDir);
+        assert(ec == ErrorCode::Ok);
+        lstm->set_primed_state(0);
+
+        fs::remove(otherPath);
+        fs::remove(archivePath);
+        fs::remove_all(outDir);
+    }
+
+    // Anything else after the weights is rejected.
+    {
+        std::ofstream(twicePath, std::ios::binary | std::ios::app).write("x", 1);
+        auto rejected = load_model(twicePath);
+        assert(!rejected);
+    }
+
+    // C API: the id goes into the header, frame and archive and is picked
+    // up again when decoding.
+    nzp_error_t err = nzp_prime_model(argv[1], twicePath.c_str(), nullptr, 0);
+    assert(err == NZP_OK);
+    const char* prefixes[] = { prefixPath.c_str() };
+    err = nzp_prime_model(argv[1], twicePath.c_str(), prefixes, 1);
+    assert(err == NZP_OK);
+    nzp_model_t* model = nzp_model_load(twicePath.c_str());
+    nzp_model_t* cold = nzp_model_load(twicePath.c_str());
+    assert(model && cold && nzp_model_primed_state_count(model) == 1);
+    err = nzp_model_set_primed_state(model, 3);
+    assert(err == NZP_ERR_MODEL_MISMATCH);
+    err = nzp_model_set_primed_state(model, 1);
+    assert(err == NZP_OK && nzp_model_primed_state(model) == 1);
+
+    const auto msg = bytes(kMessage);
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    err = nzp_compress_memory(msg.data(), msg.size(), model, nullptr, &data, &size);
+    assert(err == NZP_OK);
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    assert((uint32_t)header.primedState == 1);
+
+    uint8_t* out = nullptr;
+    uint64_t outSize = 0;
+    err = nzp_decompress_memory(data, size, cold, &out, &outSize);
+    assert(err == NZP_ERR_MODEL_MISMATCH);
+    err = nzp_decompress_memory(data, size, model, &out, &outSize);
+    assert(err == NZP_OK);
+    assert(std::vector<uint8_t>(out, out + outSize) == msg);
+    nzp_buffer_free(out);
+
+    const std::string nzpPath = (dir / "neurozip_test_primed.nzp").string();
+    const std::string outPath = (dir / "neurozip_test_primed.out").string();
+    std::ofstream(nzpPath, std::ios::binary).write((const char*)data, (std::streamsize)size);
+    nzp_buffer_free(data);
+    uint32_t id = 0;
+    err = nzp_file_primed_state(nzpPath.c_str(), &id);
+    assert(err == NZP_OK && id == 1);
+
+    // Batch decoding selects the snapshot from the header.
+    const char* ins[] = { nzpPath.c_str() };
+    const char* outs[] = { outPath.c_str() };
+    err = nzp_decompress_batch(ins, outs, 1, cold, nullptr, nullptr);
+    assert(err == NZP_OK);
+    {
+        std::ifstream ifs(outPath, std::ios::binary);
+        std::vector<uint8_t> got((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        assert(got == msg);
+    }
+
+    // Frames carry the id in a version 2 header.
+    err = nzp_compress_frame(msg.data(), msg.size(), model, 1, &data, &size);
+    assert(err == NZP_OK);
+    assert((data[0] & 0x03) == NZC_FRAME_VERSION_PRIMED);
+    CompactFrameInfo info;
+    ErrorCode ec = parse_compact_frame(data, (size_t)size, info);
+    assert(ec == ErrorCode::Ok && info.primedState == 1);
+    err = nzp_decompress_frame(data, size, cold, &out, &outSize);
+    assert(err == NZP_ERR_MODEL_MISMATCH);
+    err = nzp_decompress_frame(data, size, model, &out, &outSize);
+    assert(err == NZP_OK);
+    assert(std::vector<uint8_t>(out, out + outSize) == msg);
+    nzp_buffer_free(out);
+    nzp_buffer_free(data);
+
+    nzp_model_free(model);
+    nzp_model_free(cold);
+    for (const auto& p : { prefixPath, lstmPath, gruPath, twicePath, nzpPath, outPath }) fs::remove(p);
+
+    std::cout << "[test_primed_state] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/alphabet.h"
+#include "../../src/core/checkpoint.h"
+#include "../../src/core/file_format.h"
+#include "../../src/core/worker_pool.h"
+#include "../../src/models/model_loader.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> sample_text()
+{
+    std::string s;
+    for (int i = 0; i < 12; ++i)
+        s += "{\"id\": " + std::to_string(i * 37) + ", \"level\": \"info\", \"msg\": \"request done\"}\n";
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static void check_alphabet()
+{
+    const uint8_t data[] = { 'b', 'a', 0, 255, 'a', 'b' };
+    ByteAlphabet a;
+    a.scan(data, sizeof(data));
+    assert(a.size() == 4);
+    assert(a.symbols[0] == 0 && a.symbols[1] == 'a' && a.symbols[2] == 'b' && a.symbols[3] == 255);
+    assert(a.rank['b'] == 2 && a.rank[255] == 3);
+
+    uint8_t bitmap[kAlphabetBitmapBytes];
+    a.write_bitmap(bitmap);
+    assert(bitmap[0] == 1 && bitmap[31] == 0x80);
+    ByteAlphabet b;
+    b.read_bitmap(bitmap);
+    assert(b.size() == a.size() && std::memcmp(b.symbols, a.symbols, a.size()) == 0);
+}
+
+// The model's own subset kernel matches renormalizing the full softmax.
+static void check_subset(const ICompressionModel& model)
+{
+    const auto text = sample_text();
+    ByteAlphabet a;
+    a.scan(text.data(), text.size());
+
+    const size_t H = model.hidden_size();
+    auto ctx = model.create_context();
+    std::vector<float> hidden(3 * H);
+    for (size_t p = 0; p < 3; ++p) model.advance(*ctx, text[p], &hidden[p * H]);
+
+    std::vector<float> full(3 * 256), subset(3 * a.size()), fallback(3 * a.size());
+    model.output_probs(hidden.data(), 3, full.data());
+    model.output_probs_subset(hidden.data(), 3, a.symbols, a.size(), subset.data());
+    model.ICompressionModel::output_probs_subset(hidden.data(), 3, a.symbols, a.size(), fallback.data());
+    for (size_t p = 0; p < 3; ++p) {
+        float total = 0.0f;
+        for (size_t k = 0; k < a.size(); ++k) {
+            float v = subset[p * a.size() + k];
+            assert(std::fabs(v - fallback[p * a.size() + k]) < 1e-3f);
+            assert(v + 1e-4f >= full[p * 256 + a.symbols[k]]);
+            total += v;
+        }
+        assert(std::fabs(total - 1.0f) < 1e-3f);
+    }
+}
+
+static void check_codec(const ICompressionModel& model)
+{
+    const auto text = sample_text();
+    CompressOptions reduced;
+    reduced.reducedAlphabet = true;
+
+    const auto full = compress_buffer(model, text.data(), text.size());
+    const auto stream = compress_buffer(model, text.data(), text.size(), reduced);
+
+    // The stream starts with the bitmap, and no bits go to absent bytes.
+    ByteAlphabet a;
+    a.read_bitmap(stream.data());
+    assert(a.size() < 40 && a.rank['{'] < a.size() && a.symbols[a.rank['{']] == '{');
+    assert(stream.size() - kAlphabetBitmapBytes < full.size());
+
+    std::vector<uint8_t> out;
+    bool ok = decompress_buffer(model, stream.data(), stream.size(), text.size(), out, nullptr, true);
+    assert(ok);
+    assert(out == text);
+
+    // Every encoder schedule codes the same stream.
+    CompressOptions twoPhase = reduced;
+    twoPhase.twoPhase = true;
+    auto other = compress_buffer(model, text.data(), text.size(), twoPhase);
+    assert(other == stream);
+    WorkerPool pool(2, false);
+    twoPhase.pool = &pool;
+    other = compress_buffer(model, text.data(), text.size(), twoPhase);
+    assert(other == stream);
+    CompressOptions pipelined = reduced;
+    pipelined.pipelined = true;
+    other = compress_buffer(model, text.data(), text.size(), pipelined);
+    assert(other == stream);
+
+    // Checkpoint positions include the bitmap.
+    CompressOptions withCheckpoints = reduced;
+    withCheckpoints.checkpointInterval = 128;
+    CheckpointIndex index;
+    const auto cpStream = compress_buffer(model, text.data(), text.size(), withCheckpoints, &index);
+    assert(index.enabled() && !index.entries.empty());
+    assert(index.entries[0].streamPos >= kAlphabetBitmapBytes);
+    std::vector<uint8_t> range;
+    ok = decompress_range(model, cpStream.data(), cpStream.size(), text.size(), index, 300, 200, range, true);
+    assert(ok);
+    assert(range == std::vector<uint8_t>(text.begin() + 300, text.begin() + 500));
+    ok = decompress_buffer(model, cpStream.data(), cpStream.size(), text.size(), out, &index, true);
+    assert(ok);
+    assert(out == text);
+
+    // One symbol costs (almost) nothing; empty input is the bitmap alone.
+    const std::vector<uint8_t> same(500, 'z');
+    const auto one = compress_buffer(model, same.data(), same.size(), reduced);
+    assert(one.size() <= kAlphabetBitmapBytes + 4);
+    ok = decompress_buffer(model, one.data(), one.size(), same.size(), out, nullptr, true);
+    assert(ok && out == same);
+    const auto empty = compress_buffer(model, text.data(), 0, reduced);
+    assert(empty.size() == kAlphabetBitmapBytes + 4);
+    ok = decompress_buffer(model, empty.data(), empty.size(), 0, out, nullptr, true);
+    assert(ok && out.empty());
+
+    // An empty bitmap cannot code any byte; a short stream has none.
+    ok = decompress_buffer(model, empty.data(), empty.size(), 1, out, nullptr, true);
+    assert(!ok);
+    ok = decompress_buffer(model, stream.data(), 16, text.size(), out, nullptr, true);
+    assert(!ok);
+}
+
+static void check_c_api(const char* path, const char* nibblePath)
+{
+    nzp_model_t* model = nzp_model_load(path);
+    assert(model);
+    const auto text = sample_text();
+
+    nzp_compress_options_t options;
+    nzp_compress_options_init(&options);
+    assert(options.reduced_alphabet == 0);
+    options.reduced_alphabet = 1;
+
+    uint8_t* image = nullptr;
+    uint64_t imageSize = 0;
+    nzp_error_t err = nzp_compress_memory(text.data(), text.size(), model, &options, &image, &imageSize);
+    assert(err == NZP_OK);
+    FileHeader header;
+    std::vector<uint8_t> payload;
+    ErrorCode ec = parse_nzp(image, imageSize, header, payload);
+    assert(ec == ErrorCode::Ok);
+    assert(header.flags & NZP_FLAG_ALPHABET);
+
+    const fs::path nzp = fs::temp_directory_path() / "neurozip_test_reduced_alphabet.nzp";
+    std::ofstream(nzp, std::ios::binary).write((const char*)image, (std::streamsize)imageSize);
+
+    uint8_t* out = nullptr;
+    uint64_t outSize = 0;
+    err = nzp_decompress_memory(image, imageSize, model, &out, &outSize);
+    assert(err == NZP_OK);
+    assert(std::vector<uint8_t>(out, out + outSize) == text);
+    nzp_buffer_free(out);
+    nzp_buffer_free(image);
+
+    std::vector<uint8_t> range(100);
+    uint64_t rangeSize = 0;
+    err = nzp_decompress_range(nzp.string().c_str(), model, 50, 100, range.data(), &rangeSize);
+    assert(err == NZP_OK);
+    assert(rangeSize == 100 && std::equal(range.begin(), range.end(), text.begin() + 50));
+
+    // Appendable files keep the full alphabet, so later bytes can differ.
+    options.appendable = 1;
+    err = nzp_compress_memory(text.data(), text.size(), model, &options, &image, &imageSize);
+    assert(err == NZP_OK);
+    ec = parse_nzp(image, imageSize, header, payload);
+    assert(ec == ErrorCode::Ok);
+    assert(!(header.flags & NZP_FLAG_ALPHABET));
+    nzp_buffer_free(image);
+
+    fs::remove(nzp);
+    nzp_model_free(model);
+
+    // Nibble heads code two 16-way symbols per byte and ignore the option.
+    nzp_model_t* nibble = nzp_model_load(nibblePath);
+    assert(nibble);
+    options.appendable = 0;
+    err = nzp_compress_memory(text.data(), text.size(), nibble, &options, &image, &imageSize);
+    assert(err == NZP_OK);
+    ec = parse_nzp(image, imageSize, header, payload);
+    assert(ec == ErrorCode::Ok);
+    assert(!(header.flags & NZP_FLAG_ALPHABET));
+    err = nzp_decompress_memory(image, imageSize, nibble, &out, &outSize);
+    assert(err == NZP_OK);
+    assert(std::vector<uint8_t>(out, out + outSize) == text);
+    nzp_buffer_free(out);
+    nzp_buffer_free(image);
+    nzp_model_free(nibble);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "[test_reduced_alphabet] Running...\n";
+    assert(argc > 3);
+
+    check_alphabet();
+
+    for (int i : { 1, 3 }) {
+        auto model = load_model(argv[i]);
+        assert(model && reduces_alphabet(*model));
+        check_subset(*model);
+        check_codec(*model);
+
+        // Fixed-point logits over the subset are exact as well.
+        model->set_fixed_point(true);
+        check_subset(*model);
+        check_codec(*model);
+    }
+
+    // Rows split across a step team give the same stream.
+    auto model = load_model(argv[1]);
+    const auto text = sample_text();
+    CompressOptions reduced;
+    reduced.reducedAlphabet = true;
+    const auto serial = compress_buffer(*model, text.data(), text.size(), reduced);
+    model->set_step_threads(2);
+    auto teamed = compress_buffer(*model, text.data(), text.size(), reduced);
+    assert(teamed == serial);
+
+    check_c_api(argv[1], argv[2]);
+
+    std::cout << "[test_reduced_alphabet] All tests passed.\n";
+    return 0;
+}
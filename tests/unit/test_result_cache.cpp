@@ -0,0 +1,151 @@
+#include <cassert>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/result_cache.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+static ResultCacheKey key_for(const std::string& s, uint64_t variant = 0) {
+    ResultCacheKey key;
+    key.content = content_hash((const uint8_t*)s.data(), s.size());
+    key.size = s.size();
+    key.variant = variant;
+    return key;
+}
+
+static std::vector<uint8_t> bytes(size_t n, uint8_t fill) {
+    return std::vector<uint8_t>(n, fill);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_result_cache] Running...\n";
+    assert(argc > 1);
+
+    // Hash: deterministic, sensitive to every byte and to the length.
+    std::string text(1000, 'a');
+    ContentHash h0 = content_hash((const uint8_t*)text.data(), text.size());
+    for (size_t i : { (size_t)0, (size_t)7, (size_t)31, (size_t)500, (size_t)999 }) {
+        std::string t = text;
+        t[i] = 'b';
+        ContentHash h = content_hash((const uint8_t*)t.data(), t.size());
+        assert(h.lo != h0.lo && h.hi != h0.hi);
+    }
+    ContentHash shorter = content_hash((const uint8_t*)text.data(), text.size() - 1);
+    assert(shorter.lo != h0.lo);
+    ContentHash again = content_hash((const uint8_t*)text.data(), text.size());
+    assert(again.lo == h0.lo && again.hi == h0.hi);
+
+    // LRU under a byte budget: room for three 100-byte values.
+    const size_t entry = 100 + ResultCache::kEntryOverhead;
+    ResultCache cache(3 * entry);
+    std::vector<uint8_t> out;
+    bool hit = cache.lookup(key_for("a"), out);
+    assert(!hit);
+    cache.insert(key_for("a"), bytes(100, 1).data(), 100);
+    cache.insert(key_for("b"), bytes(100, 2).data(), 100);
+    cache.insert(key_for("c"), bytes(100, 3).data(), 100);
+    hit = cache.lookup(key_for("a"), out); // a is now newest
+    assert(hit && out == bytes(100, 1));
+    cache.insert(key_for("d"), bytes(100, 4).data(), 100); // evicts b
+    hit = cache.lookup(key_for("b"), out);
+    assert(!hit);
+    hit = cache.lookup(key_for("c"), out);
+    assert(hit && out == bytes(100, 3));
+    hit = cache.lookup(key_for("a", 1), out); // other variant
+    assert(!hit);
+
+    ResultCacheStats s = cache.stats();
+    assert(s.hits == 2 && s.misses == 3 && s.insertions == 4 && s.evictions == 1);
+    assert(s.entries == 3 && s.bytes == 3 * entry && s.capacity == 3 * entry);
+
+    // Too large for the budget: not stored. Shrinking evicts.
+    cache.insert(key_for("big"), bytes(4 * entry, 5).data(), 4 * entry);
+    hit = cache.lookup(key_for("big"), out);
+    assert(!hit);
+    cache.set_capacity(entry);
+    hit = cache.lookup(key_for("c"), out);
+    assert(cache.stats().entries == 1 && hit);
+    cache.clear();
+    assert(cache.stats().entries == 0 && cache.stats().bytes == 0);
+
+    // compress_buffer: a hit returns the same stream; the model mode and
+    // minimal flush are part of the key.
+    TinyLstmModel model;
+    bool ok = model.load_from_file(argv[1]);
+    assert(ok);
+    ResultCache streams(1 << 20);
+    CompressOptions options;
+    options.cache = &streams;
+    const std::string msg = "templated notification: your order has shipped";
+    const uint8_t* data = (const uint8_t*)msg.data();
+    auto plain = compress_buffer(model, data, msg.size());
+    auto cached = compress_buffer(model, data, msg.size(), options);
+    assert(cached == plain);
+    cached = compress_buffer(model, data, msg.size(), options);
+    assert(cached == plain);
+    assert(streams.stats().hits == 1 && streams.stats().misses == 1);
+
+    options.minimalFlush = true;
+    auto minimal = compress_buffer(model, data, msg.size(), options);
+    assert(streams.stats().misses == 2 && minimal.size() <= plain.size());
+
+    options.minimalFlush = false;
+    model.set_fixed_point(true);
+    auto fixed = compress_buffer(model, data, msg.size(), options);
+    CompressOptions uncached;
+    auto direct = compress_buffer(model, data, msg.size(), uncached);
+    assert(fixed == direct);
+    assert(streams.stats().misses == 3);
+    model.set_fixed_point(false);
+
+    // C API: images and frames, shared cache, detach.
+    nzp_model_t* m = nzp_model_load(argv[1]);
+    assert(m);
+    nzp_cache_t* c = nzp_cache_create(1 << 20);
+    uint8_t* first = nullptr;
+    uint64_t firstSize = 0;
+    nzp_error_t err = nzp_compress_memory(data, msg.size(), m, nullptr, &first, &firstSize);
+    assert(err == NZP_OK);
+    nzp_model_set_cache(m, c);
+    for (int i = 0; i < 3; ++i) {
+        uint8_t* img = nullptr;
+        uint64_t imgSize = 0;
+        err = nzp_compress_memory(data, msg.size(), m, nullptr, &img, &imgSize);
+        assert(err == NZP_OK);
+        assert(imgSize == firstSize && std::equal(img, img + imgSize, first));
+        nzp_buffer_free(img);
+    }
+    uint8_t* frame = nullptr;
+    uint64_t frameSize = 0;
+    err = nzp_compress_frame(data, msg.size(), m, 1, &frame, &frameSize);
+    assert(err == NZP_OK);
+    nzp_buffer_free(frame);
+
+    nzp_cache_stats_t cs;
+    nzp_cache_get_stats(c, &cs);
+    assert(cs.hits == 2 && cs.misses == 2 && cs.entries == 2);
+
+    nzp_cache_free(c); // the model keeps it alive
+    uint8_t* img = nullptr;
+    uint64_t imgSize = 0;
+    err = nzp_compress_memory(data, msg.size(), m, nullptr, &img, &imgSize);
+    assert(err == NZP_OK);
+    nzp_buffer_free(img);
+    nzp_model_set_cache(m, nullptr);
+
+    uint8_t* back = nullptr;
+    uint64_t backSize = 0;
+    err = nzp_decompress_memory(first, firstSize, m, &back, &backSize);
+    assert(err == NZP_OK);
+    assert(std::string((const char*)back, (size_t)backSize) == msg);
+    nzp_buffer_free(back);
+    nzp_buffer_free(first);
+    nzp_model_free(m);
+
+    std::cout << "[test_result_cache] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/models/model_loader.h"
+#include "../../src/models/tiny_lstm.h"
+#include "../../src/models/tiny_rnn.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> sample_text() {
+    std::string text;
+    for (int i = 0; i < 30; ++i)
+        text += "gated recurrent units keep one state vector per step. ";
+    text += "\x02\xff\x80 end";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+static void check_model(ICompressionModel& model) {
+    const auto input = sample_text();
+
+    for (bool fixedPoint : { false, true }) {
+        model.set_fixed_point(fixedPoint);
+        assert(model.fixed_point() == fixedPoint);
+
+        auto ctx = model.create_context();
+        float probs[256];
+        for (uint8_t c : { 'a', 'b', 'c' }) {
+            model.predict_next(*ctx, c, probs, 256);
+            float sum = 0.0f;
+            for (float p : probs) sum += p;
+            // Fixed-point probabilities are floored to multiples of 2^-15.
+            assert(std::fabs(sum - 1.0f) < (fixedPoint ? 256.0f / 32768.0f : 1e-3f));
+        }
+
+        auto serial = compress_buffer(model, input.data(), input.size());
+        std::vector<uint8_t> out;
+        bool ok = decompress_buffer(model, serial.data(), serial.size(), input.size(), out);
+        assert(ok);
+        assert(out == input);
+
+        // The two-phase and pipelined encoders give the same stream.
+        CompressOptions twoPhase;
+        twoPhase.twoPhase = true;
+        twoPhase.threads = 2;
+        auto stream = compress_buffer(model, input.data(), input.size(), twoPhase);
+        assert(stream == serial);
+        CompressOptions pipelined;
+        pipelined.pipelined = true;
+        stream = compress_buffer(model, input.data(), input.size(), pipelined);
+        assert(stream == serial);
+
+        auto copy = model.clone();
+        assert(copy && copy->fixed_point() == fixedPoint);
+        stream = compress_buffer(*copy, input.data(), input.size());
+        assert(stream == serial);
+    }
+    model.set_fixed_point(false);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_rnn_cells] Running...\n";
+    assert(argc > 3);
+
+    auto lstm = load_model(argv[1]);
+    auto gru = load_model(argv[2]);
+    auto mgu = load_model(argv[3]);
+    assert(lstm && gru && mgu);
+    assert(lstm->model_id() == MODEL_ID_TINY_LSTM);
+    assert(gru->model_id() == MODEL_ID_TINY_GRU);
+    assert(mgu->model_id() == MODEL_ID_TINY_MGU);
+    assert(dynamic_cast<TinyRnnModel&>(*gru).cell() == RnnCell::Gru);
+    assert(dynamic_cast<TinyRnnModel&>(*mgu).cell() == RnnCell::Mgu);
+    assert(gru->model_hash() != mgu->model_hash());
+    assert(gru->hidden_size() == 32 && !gru->nibble_output());
+
+    check_model(*gru);
+    check_model(*mgu);
+
+    // Per byte the recurrence reads 3H (GRU) or 2H (MGU) rows of W_hh
+    // instead of 4H; the output layer is the same.
+    const size_t H = 32;
+    const size_t head = (256 * H) * sizeof(float);
+    assert(lstm->weight_bytes() - head == (4 * H + 4 * H * H) * sizeof(float));
+    assert(gru->weight_bytes() - head == (3 * H + 3 * H * H) * sizeof(float));
+    assert(mgu->weight_bytes() - head == (2 * H + 2 * H * H) * sizeof(float));
+
+    // Each loader only takes its own layout; truncated files fail.
+    TinyLstmModel lstmOnly;
+    bool loaded = lstmOnly.load_from_file(argv[2]);
+    assert(!loaded);
+    TinyRnnModel rnnOnly;
+    loaded = rnnOnly.load_from_file(argv[1]);
+    assert(!loaded);
+
+    const fs::path truncated = fs::temp_directory_path() / "neurozip_test_rnn_cells.bin";
+    {
+        std::ifstream ifs(argv[2], std::ios::binary);
+        std::string file((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        std::ofstream(truncated, std::ios::binary).write(file.data(), (std::streamsize)file.size() - 4);
+    }
+    auto broken = load_model(truncated.string());
+    assert(!broken);
+    fs::remove(truncated);
+
+    // The C API picks the model type from the file.
+    nzp_model_t* model = nzp_model_load(argv[3]);
+    assert(model);
+    nzp_model_set_fixed_point(model, 1);
+    assert(nzp_model_fixed_point(model) == 1);
+    nzp_model_free(model);
+
+    std::cout << "[test_rnn_cells] All tests passed.\n";
+    return 0;
+}
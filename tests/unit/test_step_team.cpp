@@ -0,0 +1,166 @@
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/step_team.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static void check_team()
+{
+    // Shares tile [0, n) in order, in multiples of the alignment.
+    for (unsigned members : { 1u, 3u, 4u, 7u }) {
+        for (size_t n : { (size_t)0, (size_t)5, (size_t)256, (size_t)1000 }) {
+            size_t next = 0;
+            for (unsigned m = 0; m < members; ++m) {
+                size_t lo, hi;
+                StepTeam::share(n, members, m, 16, lo, hi);
+                assert(lo == next && lo <= hi && hi <= n);
+                if (hi < n) assert((hi - lo) % 16 == 0);
+                next = hi;
+            }
+            assert(next == n);
+        }
+    }
+
+    StepTeam team(4);
+    assert(team.size() == 4);
+    std::vector<int> hits(team.size());
+    for (int step = 0; step < 1000; ++step) {
+        team.run([&](unsigned m) { hits[m]++; });
+    }
+    for (int h : hits) assert(h == 1000);
+
+    // Two threads stepping at once: one of them runs all shares itself.
+    std::atomic<int> total{ 0 };
+    auto stepper = [&] {
+        for (int step = 0; step < 500; ++step)
+            team.run([&](unsigned) { total.fetch_add(1); });
+    };
+    std::thread other(stepper);
+    stepper();
+    other.join();
+    assert(total.load() == 2 * 500 * 4);
+}
+
+// Random single-layer LSTM with a byte head and hidden size H.
+static void write_model(const fs::path& path, uint32_t H)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    const uint32_t header[4] = { 256, H, 1, LSTM_HEAD_BYTE };
+    ofs.write((const char*)header, sizeof(header));
+
+    uint32_t x = 12345;
+    auto put = [&](size_t n) {
+        std::vector<float> v(n);
+        for (auto& w : v) {
+            x = x * 1664525u + 1013904223u;
+            w = ((float)(x >> 8) / 16777216.0f - 0.5f) * 0.2f;
+        }
+        ofs.write((const char*)v.data(), (std::streamsize)(n * sizeof(float)));
+    };
+    put(4 * H * 256); // w_ih
+    put(4 * H * H);   // w_hh
+    put(4 * H);       // b_ih
+    put(4 * H);       // b_hh
+    put(256 * H);     // w_out
+    put(256);         // b_out
+}
+
+static std::vector<uint8_t> text_bytes()
+{
+    std::string text;
+    for (int i = 0; i < 3; ++i)
+        text += "one stream, one step at a time, on four cores. ";
+    text += "\x03\xfd";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+// Every step threading gives the serial stream and distributions.
+static void check_model(TinyLstmModel& model)
+{
+    const auto input = text_bytes();
+    for (bool fixedPoint : { false, true }) {
+        model.set_fixed_point(fixedPoint);
+        model.set_step_threads(1);
+        const auto serial = compress_buffer(model, input.data(), input.size());
+
+        auto ref = model.create_context();
+        float refProbs[256];
+        model.predict_next(*ref, 'q', refProbs, 256);
+
+        for (unsigned threads : { 2u, 4u }) {
+            model.set_step_threads(threads);
+            assert(model.step_threads() == threads);
+
+            auto ctx = model.create_context();
+            float probs[256];
+            model.predict_next(*ctx, 'q', probs, 256);
+            for (int i = 0; i < 256; ++i) assert(probs[i] == refProbs[i]);
+            for (size_t i = 0; i < model.hidden_size(); ++i) {
+                assert(ctx->h[i] == ref->h[i] && ctx->c[i] == ref->c[i]);
+            }
+
+            auto stream = compress_buffer(model, input.data(), input.size());
+            assert(stream == serial);
+            CompressOptions twoPhase;
+            twoPhase.twoPhase = true;
+            stream = compress_buffer(model, input.data(), input.size(), twoPhase);
+            assert(stream == serial);
+        }
+
+        std::vector<uint8_t> out;
+        bool ok = decompress_buffer(model, serial.data(), serial.size(), input.size(), out);
+        assert(ok);
+        assert(out == input);
+
+        auto copy = model.clone();
+        assert(copy->step_threads() == model.step_threads());
+        auto copied = compress_buffer(*copy, input.data(), input.size());
+        assert(copied == serial);
+    }
+    model.set_step_threads(1);
+    model.set_fixed_point(false);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "[test_step_team] Running...\n";
+    assert(argc > 1);
+
+    check_team();
+
+    TinyLstmModel tiny;
+    bool ok = tiny.load_from_file(argv[1]);
+    assert(ok);
+    check_model(tiny);
+
+    // Hidden sizes past 256 get a context of their own width.
+    const fs::path path = fs::temp_directory_path() / "neurozip_test_step_team.bin";
+    write_model(path, 272);
+    TinyLstmModel wide;
+    ok = wide.load_from_file(path.string());
+    assert(ok);
+    assert(wide.hidden_size() == 272);
+    assert(wide.create_context()->h.size() == 272);
+    check_model(wide);
+
+    nzp_model_t* model = nzp_model_load(path.string().c_str());
+    assert(model && nzp_model_step_threads(model) == 1);
+    nzp_model_set_step_threads(model, 3);
+    assert(nzp_model_step_threads(model) == 3);
+    nzp_model_set_step_threads(model, 0);
+    assert(nzp_model_step_threads(model) == 1);
+    nzp_model_free(model);
+    fs::remove(path);
+
+    std::cout << "[test_step_team] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../src/api/neurozip_c.h"
+#include "../../src/core/checkpoint.h"
+#include "../../src/core/token_vocab.h"
+#include "../../src/models/model_loader.h"
+#include "../../src/models/token_lstm.h"
+
+using namespace neurozip;
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> bytes_of(const std::string& s)
+{
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static void check_vocab()
+{
+    TokenVocab vocab;
+    bool ok = vocab.build({ "th", "the", "the ", "he", "ab" });
+    assert(ok);
+    assert(vocab.size() == 261);
+
+    size_t len = 0;
+    const uint8_t* t = vocab.token('x', len);
+    assert(len == 1 && t[0] == 'x');
+    t = vocab.token(258, len);
+    assert(len == 4 && std::string((const char*)t, len) == "the ");
+
+    // Greedy longest match, falling back to single bytes.
+    const auto text = bytes_of("the then thx a");
+    std::vector<uint32_t> ids;
+    vocab.tokenize(text.data(), text.size(), ids);
+    const std::vector<uint32_t> expected = { 258, 257, 'n', ' ', 256, 'x', ' ', 'a' };
+    assert(ids == expected);
+
+    // A prefix that is not itself a token backs off to the last match.
+    const auto tail = bytes_of("ab");
+    vocab.tokenize(tail.data(), 1, ids);
+    assert(ids.size() == 1 && ids[0] == 'a');
+
+    ok = vocab.build({ "a" }); // too short
+    assert(!ok);
+    ok = vocab.build({ "ab", "ab" }); // duplicate
+    assert(!ok);
+    ok = vocab.build({ std::string(kMaxTokenBytes + 1, 'x') }); // too long
+    assert(!ok);
+    ok = vocab.build(std::vector<std::string>(kMaxTokenVocab, "ab"));
+    assert(!ok);
+}
+
+static void check_codec(const TokenLstmModel& model)
+{
+    const TokenVocab* vocab = model.token_vocab();
+    assert(vocab && vocab->size() > 256);
+    assert(model.model_id() == MODEL_ID_TOKEN_LSTM);
+
+    std::string text;
+    for (int i = 0; i < 4; ++i)
+        text += "The quick brown fox jumps over the lazy dog. ";
+    text += "Neural compression of the stream, and the model in it.\n\n";
+    text += std::string("\x00\xff\x80 binary\x01", 12);
+    const auto input = bytes_of(text);
+
+    // Far fewer steps than bytes on text.
+    std::vector<uint32_t> ids;
+    vocab->tokenize(input.data(), input.size(), ids);
+    assert(ids.size() * 2 < input.size());
+
+    const auto stream = compress_buffer(model, input.data(), input.size());
+    std::vector<uint8_t> out;
+    bool ok = decompress_buffer(model, stream.data(), stream.size(), input.size(), out);
+    assert(ok);
+    assert(out == input);
+
+    // The other encoder schedules code the same stream, without checkpoints.
+    CompressOptions twoPhase;
+    twoPhase.twoPhase = true;
+    auto other = compress_buffer(model, input.data(), input.size(), twoPhase);
+    assert(other == stream);
+    CompressOptions pipelined;
+    pipelined.pipelined = true;
+    other = compress_buffer(model, input.data(), input.size(), pipelined);
+    assert(other == stream);
+    CompressOptions withCheckpoints;
+    withCheckpoints.checkpointInterval = 16;
+    CheckpointIndex index;
+    other = compress_buffer(model, input.data(), input.size(), withCheckpoints, &index);
+    assert(other == stream);
+    assert(!index.enabled());
+
+    // A size that ends inside a token is rejected.
+    ok = decompress_buffer(model, stream.data(), stream.size(), 2, out);
+    assert(!ok);
+
+    std::vector<uint8_t> range;
+    ok = decompress_range(model, stream.data(), stream.size(), input.size(), index, 50, 30, range);
+    assert(ok);
+    assert(range == std::vector<uint8_t>(input.begin() + 50, input.begin() + 80));
+
+    // Code length tracks the stream and splits across regions.
+    std::vector<double> regions;
+    double bits = code_length_bits(model, input.data(), input.size(), 64, &regions);
+    assert(std::fabs(bits - 8.0 * stream.size()) < 64.0);
+    double sum = 0.0;
+    for (double r : regions) sum += r;
+    assert(regions.size() == (input.size() + 63) / 64);
+    assert(std::fabs(sum - bits) < 1e-6);
+
+    // Empty input.
+    const auto empty = compress_buffer(model, input.data(), 0);
+    ok = decompress_buffer(model, empty.data(), empty.size(), 0, out);
+    assert(ok && out.empty());
+
+    // Byte interface: first-byte marginals.
+    auto ctx = model.create_context();
+    float probs[256];
+    model.predict_next(*ctx, 't', probs, 256);
+    float total = 0.0f;
+    for (float p : probs) total += p;
+    assert(std::fabs(total - 1.0f) < 1e-3f);
+}
+
+static void check_c_api(const char* path)
+{
+    nzp_model_t* model = nzp_model_load(path);
+    assert(model);
+
+    const auto input = bytes_of("the model and the stream, over and over and over. ");
+    nzp_compress_options_t options;
+    nzp_compress_options_init(&options);
+    options.appendable = 1;
+
+    uint8_t* image = nullptr;
+    uint64_t imageSize = 0;
+    nzp_error_t err = nzp_compress_memory(input.data(), input.size(), model, &options, &image, &imageSize);
+    assert(err == NZP_OK);
+
+    const fs::path nzp = fs::temp_directory_path() / "neurozip_test_token_model.nzp";
+    {
+        std::ofstream ofs(nzp, std::ios::binary);
+        ofs.write((const char*)image, (std::streamsize)imageSize);
+    }
+    nzp_buffer_free(image);
+
+    // Token files are rewritten on append.
+    const auto more = bytes_of("And then the dog. ");
+    for (int i = 0; i < 2; ++i) {
+        err = nzp_append_memory(nzp.string().c_str(), more.data(), more.size(), model, &options);
+        assert(err == NZP_OK);
+    }
+
+    std::vector<uint8_t> file;
+    {
+        std::ifstream ifs(nzp, std::ios::binary);
+        file.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    uint8_t* out = nullptr;
+    uint64_t outSize = 0;
+    err = nzp_decompress_memory(file.data(), file.size(), model, &out, &outSize);
+    assert(err == NZP_OK);
+    std::vector<uint8_t> expected = input;
+    expected.insert(expected.end(), more.begin(), more.end());
+    expected.insert(expected.end(), more.begin(), more.end());
+    assert(std::vector<uint8_t>(out, out + outSize) == expected);
+    nzp_buffer_free(out);
+
+    // Compact frames use the minimal flush.
+    err = nzp_compress_frame(input.data(), input.size(), model, 1, &image, &imageSize);
+    assert(err == NZP_OK);
+    err = nzp_decompress_frame(image, imageSize, model, &out, &outSize);
+    assert(err == NZP_OK);
+    assert(std::vector<uint8_t>(out, out + outSize) == input);
+    nzp_buffer_free(image);
+    nzp_buffer_free(out);
+
+    fs::remove(nzp);
+    nzp_model_free(model);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "[test_token_model] Running...\n";
+    assert(argc > 1);
+
+    check_vocab();
+
+    auto loaded = load_model(argv[1]);
+    assert(loaded && loaded->token_vocab());
+    TokenLstmModel model;
+    bool ok = model.load_from_file(argv[1]);
+    assert(ok);
+    assert(model.model_hash() == loaded->model_hash());
+    check_codec(model);
+
+    auto copy = model.clone();
+    const auto text = bytes_of("the end of the stream");
+    auto fromCopy = compress_buffer(*copy, text.data(), text.size());
+    auto fromModel = compress_buffer(model, text.data(), text.size());
+    assert(fromCopy == fromModel);
+
+    check_c_api(argv[1]);
+
+    // Truncated files and trailing bytes are rejected.
+    std::vector<uint8_t> file;
+    {
+        std::ifstream ifs(argv[1], std::ios::binary);
+        file.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    const fs::path bad = fs::temp_directory_path() / "neurozip_test_token_model.bin";
+    for (size_t size : { file.size() - 1, (size_t)40, file.size() + 1 }) {
+        std::vector<uint8_t> b = file;
+        b.resize(size, 0);
+        std::ofstream(bad, std::ios::binary).write((const char*)b.data(), (std::streamsize)b.size());
+        TokenLstmModel m;
+        ok = m.load_from_file(bad.string());
+        assert(!ok);
+    }
+    fs::remove(bad);
+
+    std::cout << "[test_token_model] All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/core/trace.h"
+#include "../../src/core/model_interface.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+static std::string read_text(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+static size_t count(const std::string& text, const std::string& what) {
+    size_t n = 0;
+    for (size_t p = text.find(what); p != std::string::npos; p = text.find(what, p + 1)) ++n;
+    return n;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_trace] Running...\n";
+    assert(argc > 1);
+    const std::string path = "test_trace.json";
+
+    // Off: nothing is recorded.
+    assert(!trace_enabled());
+    { TraceSpan span("ignored", "test"); }
+
+    // Spans from several threads, each on its own named track. A name set
+    // while tracing is off is kept for the thread's first span.
+    std::atomic<bool> started{ false };
+    std::thread early([&] {
+        trace_set_thread_name("early");
+        while (!started) std::this_thread::yield();
+        TraceSpan span("early_span", "test");
+    });
+    trace_start();
+    started = true;
+    early.join();
+    { TraceSpan span("outer", "test", 123); }
+    std::thread worker([] {
+        trace_set_thread_name("helper \"1\"");
+        for (int i = 0; i < 3; ++i) TraceSpan span("inner", "test");
+    });
+    worker.join();
+    trace_record("async", "io", 1000, 3500, 4096);
+    trace_stop();
+    { TraceSpan span("after_stop", "test"); }
+
+    bool ok = write_chrome_trace(path);
+    assert(ok);
+    std::string json = read_text(path);
+    assert(json.find("\"traceEvents\"") != std::string::npos);
+    assert(count(json, "\"name\":\"outer\"") == 1);
+    assert(count(json, "\"name\":\"inner\"") == 3);
+    assert(json.find("\"bytes\":123") != std::string::npos);
+    assert(json.find("\"ts\":1.000,\"dur\":2.500,\"name\":\"async\"") != std::string::npos);
+    assert(json.find("helper \\\"1\\\"") != std::string::npos);
+    assert(json.find("\"name\":\"early\"") != std::string::npos);
+    assert(json.find("ignored") == std::string::npos);
+    assert(json.find("after_stop") == std::string::npos);
+    assert(json.find("\"dropped_spans\":0") != std::string::npos);
+
+    // A new session starts empty; a full ring keeps the newest spans.
+    trace_start();
+    for (int i = 0; i < (1 << 15) + 10; ++i) trace_record("tick", "test", i, i + 1);
+    trace_stop();
+    ok = write_chrome_trace(path);
+    assert(ok);
+    json = read_text(path);
+    assert(json.find("\"name\":\"outer\"") == std::string::npos);
+    assert(json.find("\"dropped_spans\":10") != std::string::npos);
+    assert(count(json, "\"name\":\"tick\"") == (1u << 15));
+
+    // Library work shows up.
+    trace_start();
+    TinyLstmModel model;
+    ok = model.load_from_file(argv[1]);
+    assert(ok);
+    const std::string text = "trace me, trace me";
+    auto stream = compress_buffer(model, (const uint8_t*)text.data(), text.size());
+    std::vector<uint8_t> out;
+    ok = decompress_buffer(model, stream.data(), stream.size(), text.size(), out);
+    assert(ok);
+    trace_stop();
+    ok = write_chrome_trace(path);
+    assert(ok);
+    json = read_text(path);
+    assert(json.find("\"name\":\"model_load\"") != std::string::npos);
+    assert(json.find("\"name\":\"model_hash\"") != std::string::npos);
+    assert(json.find("\"name\":\"compress\"") != std::string::npos);
+    assert(json.find("\"name\":\"decompress\"") != std::string::npos);
+
+    std::remove(path.c_str());
+    std::cout << "[test_trace] All tests passed.\n";
+    return 0;
+}
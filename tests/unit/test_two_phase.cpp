@@ -0,0 +1,49 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../src/models/tiny_lstm.h"
+#include "../test_util.h"
+
+using namespace neurozip;
+
+static void check_identical(const TinyLstmModel& model, const std::vector<uint8_t>& input) {
+    for (unsigned threads : {1u, 3u, 0u}) {
+        CompressOptions opts;
+        opts.twoPhase = true;
+        opts.threads = threads;
+        bool same = test::encodes_like_serial(model, input, opts);
+        assert(same);
+    }
+
+    auto reference = compress_buffer(model, input.data(), input.size());
+    std::vector<uint8_t> out;
+    bool ok = decompress_buffer(model, reference.data(), reference.size(), input.size(), out);
+    assert(ok);
+    assert(out == input);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "[test_two_phase] Running...\n";
+    assert(argc > 1);
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+
+    // Enough bytes to span several two-phase blocks plus a partial one.
+    auto input = test::make_text("lorem ipsum dolor sit amet, consectetur adipiscing elit. ", 9000, 7, 13);
+
+    check_identical(model, input);
+
+    model.set_fixed_point(true);
+    check_identical(model, input);
+
+    // Empty input
+    CompressOptions opts;
+    opts.twoPhase = true;
+    assert(compress_buffer(model, nullptr, 0, opts) == compress_buffer(model, nullptr, 0));
+
+    std::cout << "[test_two_phase] OK\n";
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "../../src/core/worker_pool.h"
+#include "../../src/models/tiny_lstm.h"
+
+using namespace neurozip;
+
+int main(int argc, char** argv) {
+    std::cout << "[test_worker_pool] Running...\n";
+    assert(argc > 1);
+
+    // Detected topology always has at least one node.
+    assert(numa_topology().node_count() >= 1);
+
+    // Two fake nodes without CPUs: no pinning, but replicas per node.
+    NumaTopology topo;
+    topo.nodes.resize(2);
+    topo.nodes[1].id = 1;
+
+    WorkerPool pool(4, topo);
+    assert(pool.size() == 4);
+    assert(pool.node_count() == 2);
+    assert(pool.worker_node(0) == 0 && pool.worker_node(1) == 0);
+    assert(pool.worker_node(2) == 1 && pool.worker_node(3) == 1);
+
+    // Every index is visited exactly once, over several jobs.
+    for (size_t n : {1u, 7u, 64u, 1000u}) {
+        std::vector<std::atomic<int>> hits(n);
+        for (auto& h : hits) h = 0;
+        pool.parallel_for(n, 16, [&](unsigned worker, size_t lo, size_t hi) {
+            assert(worker < 4);
+            for (size_t i = lo; i < hi; ++i) hits[i]++;
+        });
+        for (auto& h : hits) assert(h == 1);
+    }
+
+    TinyLstmModel model;
+    bool loaded = model.load_from_file(argv[1]);
+    assert(loaded);
+
+    // Workers on different nodes get different copies of the same weights.
+    const ICompressionModel& a = pool.local_model(model, 0);
+    const ICompressionModel& b = pool.local_model(model, 3);
+    assert(&a != &model && &b != &model && &a != &b);
+    const ICompressionModel& a1 = pool.local_model(model, 1);
+    assert(&a1 == &a);
+    assert(a.model_hash() == model.model_hash());
+
+    // Replicas are keyed by object lifetime, not address: a copy has its
+    // own, and a destroyed model's token expires (its replicas are then
+    // dropped instead of being handed to a later model at that address).
+    auto copy = model.clone();
+    const ICompressionModel& c = pool.local_model(*copy, 0);
+    assert(&c != &a);
+    std::weak_ptr<const void> token = copy->lifetime();
+    assert(!token.expired());
+    copy.reset();
+    assert(token.expired());
+
+    std::vector<uint8_t> input(6000);
+    for (size_t i = 0; i < input.size(); ++i) input[i] = (uint8_t)("numa-local weights "[i % 19]);
+
+    CompressOptions seq;
+    auto expected = compress_buffer(model, input.data(), input.size(), seq);
+
+    CompressOptions twoPhase;
+    twoPhase.twoPhase = true;
+    twoPhase.pool = &pool;
+    auto pooled = compress_buffer(model, input.data(), input.size(), twoPhase);
+    assert(pooled == expected);
+
+    // Replicas follow the inference mode.
+    model.set_fixed_point(true);
+    auto expectedFixed = compress_buffer(model, input.data(), input.size(), seq);
+    pooled = compress_buffer(model, input.data(), input.size(), twoPhase);
+    assert(pooled == expectedFixed);
+    const ICompressionModel& b3 = pool.local_model(model, 3);
+    assert(b3.fixed_point());
+
+    // Pool created per call from the real topology.
+    twoPhase.pool = nullptr;
+    twoPhase.threads = 3;
+    pooled = compress_buffer(model, input.data(), input.size(), twoPhase);
+    assert(pooled == expectedFixed);
+
+    std::cout << "[test_worker_pool] OK\n";
+    return 0;
+}
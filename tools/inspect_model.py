@@ -6,6 +6,76 @@ def read_floats(f, n):
     data = f.read(n * 4)
     return struct.unpack("<" + "f" * n, data)
 
+PRIMED_MAGIC = 0x31535A4E  # "NZS1"
+
+def print_primed(f, offset, hidden, vectors):
+    """Primed states (optional) follow the last weight array."""
+    f.seek(offset)
+    head = f.read(12)
+    if not head:
+        print("Primed states: none")
+        return
+    magic, count, vecs = struct.unpack("<III", head) if len(head) == 12 else (0, 0, 0)
+    if magic != PRIMED_MAGIC or vecs != vectors:
+        print("Primed states: (unexpected data after the weights)")
+        return
+    print("Primed states:", count, "(%d floats each)" % (vectors * hidden))
+
+# GRU / MGU files start with a magic instead of the input size.
+RNN_CELLS = {0x31475A4E: ("GRU", 3), 0x314D5A4E: ("MGU", 2)}
+
+def inspect_rnn(f, cell):
+    name, gates = cell
+    inputSize, hidden, output_head = struct.unpack("<III", f.read(12))
+    print("Cell:", name)
+    print("Input size:", inputSize)
+    print("Hidden size:", hidden)
+    print("Output head:", {0: "byte"}.get(output_head, output_head))
+
+    print("Total expected weights:")
+    print("  W_ih:", gates * hidden * inputSize)
+    print("  W_hh:", gates * hidden * hidden)
+    print("  b_ih:", gates * hidden)
+    print("  b_hh:", gates * hidden)
+    print("  W_out:", 256 * hidden)
+    print("  b_out:", 256)
+    weights = gates * hidden * (inputSize + hidden) + 2 * gates * hidden + 256 * hidden + 256
+    print_primed(f, 16 + 4 * weights, hidden, 1)
+
+    print("\nModel appears structurally valid.")
+
+TOKEN_MAGIC = 0x31545A4E  # "NZT1"
+
+def inspect_token(f):
+    vocab, hidden, _ = struct.unpack("<III", f.read(12))
+    tokens = []
+    for _ in range(vocab - 256):
+        n = f.read(1)[0]
+        tokens.append(f.read(n))
+    print("Cell: LSTM (token vocabulary)")
+    print("Vocabulary:", vocab, "(256 bytes + %d tokens)" % len(tokens))
+    if tokens:
+        longest = max(len(t) for t in tokens)
+        print("Token bytes: mean %.2f, max %d" % (sum(len(t) for t in tokens) / len(tokens), longest))
+        print("First tokens:", ", ".join(repr(t.decode("latin-1")) for t in tokens[:8]))
+    print("Hidden size:", hidden)
+
+    print("Total expected weights:")
+    print("  W_ih:", 4 * hidden * vocab)
+    print("  W_hh:", 4 * hidden * hidden)
+    print("  b_ih:", 4 * hidden)
+    print("  b_hh:", 4 * hidden)
+    print("  W_out:", vocab * hidden)
+    print("  b_out:", vocab)
+    weights = 4 * hidden * (vocab + hidden) + 8 * hidden + vocab * hidden + vocab
+    start = f.tell()
+    f.seek(0, 2)
+    if f.tell() != start + 4 * weights:
+        print("\nFile size does not match the header.")
+        return
+
+    print("\nModel appears structurally valid.")
+
 def main():
     if len(sys.argv) < 2:
         print("Usage: inspect_model.py <tiny_lstm.bin>")
@@ -13,21 +83,47 @@ def main():
 
     path = sys.argv[1]
     with open(path, "rb") as f:
-        inputSize = struct.unpack("<I", f.read(4))[0]
+        first = struct.unpack("<I", f.read(4))[0]
+        if first in RNN_CELLS:
+            inspect_rnn(f, RNN_CELLS[first])
+            return
+        if first == TOKEN_MAGIC:
+            inspect_token(f)
+            return
+        inputSize = first
         hidden = struct.unpack("<I", f.read(4))[0]
         layers = struct.unpack("<I", f.read(4))[0]
-        reserved = struct.unpack("<I", f.read(4))[0]
+        output_head = struct.unpack("<I", f.read(4))[0]
+        flags = output_head & ~0xFF
+        output_head &= 0xFF
 
         print("Input size:", inputSize)
         print("Hidden size:", hidden)
         print("Layers:", layers)
+        print("Output head:", {0: "byte", 1: "nibble"}.get(output_head, output_head))
+        if flags:
+            sparse = [name for bit, name in ((1 << 8, "W_hh"), (1 << 9, "W_out")) if flags & bit]
+            print("Block sparse:", ", ".join(sparse))
 
-        print("Total expected weights:")
+        print("Total expected weights (dense):")
         print("  W_ih:", 4 * hidden * inputSize)
         print("  W_hh:", 4 * hidden * hidden)
         print("  b_ih:", 4 * hidden)
         print("  b_hh:", 4 * hidden)
-        print("  W_out:", 256 * hidden)
-        print("  b_out:", 256)
+        if output_head == 1:
+            print("  W_hi:", 16 * hidden)
+            print("  b_hi:", 16)
+            print("  W_lo:", 256 * hidden)
+            print("  b_lo:", 256)
+        else:
+            print("  W_out:", 256 * hidden)
+            print("  b_out:", 256)
+        if not flags:
+            head = 16 * hidden + 16 + 256 * hidden + 256 if output_head == 1 else 256 * hidden + 256
+            weights = 4 * hidden * (inputSize + hidden) + 8 * hidden + head
+            print_primed(f, 16 + 4 * weights, hidden, 2)
 
         print("\nModel appears structurally valid.")
+
+if __name__ == "__main__":
+    main()